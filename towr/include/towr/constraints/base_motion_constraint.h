@@ -63,6 +63,7 @@ public:
 private:
   NodeSpline::Ptr base_linear_;
   NodeSpline::Ptr base_angular_;
+  BaseKinematicsCache::Ptr base_kinematics_;
 
   VecBound node_bounds_;     ///< same bounds for each discretized node
   int GetRow (int node, int dim) const;
@@ -78,7 +78,7 @@ public:
 
 private:
   NodeSpline::Ptr base_linear_;   ///< lin. base pos/vel/acc in world frame
-  EulerConverter base_angular_;        ///< angular base state
+  BaseKinematicsCache::Ptr base_kinematics_; ///< base state shared with other constraints
   std::vector<NodeSpline::Ptr> ee_forces_; ///< endeffector forces in world frame.
   std::vector<NodeSpline::Ptr> ee_motion_; ///< endeffector position in world frame.
 
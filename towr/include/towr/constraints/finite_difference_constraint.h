@@ -0,0 +1,122 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_CONSTRAINTS_FINITE_DIFFERENCE_CONSTRAINT_H_
+#define TOWR_CONSTRAINTS_FINITE_DIFFERENCE_CONSTRAINT_H_
+
+#include <string>
+#include <vector>
+
+#include <ifopt/constraint_set.h>
+
+#include "finite_difference_jacobian.h"
+
+namespace towr {
+
+/**
+ * @brief A constraint whose Jacobian is approximated by finite differences.
+ *
+ * For prototyping custom constraints without analytic derivatives: derive
+ * from this class and implement only EvaluateAt() and GetBounds(). Instead
+ * of IPOPT's jacobian_approximation, which perturbs every variable of the
+ * whole problem, this only requires one evaluation per colour of the
+ * declared sparsity (see FiniteDifferenceJacobian), and the other
+ * constraints keep their analytic Jacobians.
+ *
+ * The constraint may depend on several variable sets, whose values are
+ * passed to EvaluateAt() one after the other. EvaluateAt() must compute the
+ * constraint from these values alone. Constraints that read the
+ * SplineHolder, as most towr constraints do, can't be prototyped this way:
+ * the splines follow the current variables of the problem, not the
+ * perturbed values, and several threads would share them. Such
+ * constraints need analytic Jacobians, or IPOPT's finite differences.
+ *
+ * @ingroup Constraints
+ */
+class FiniteDifferenceConstraint : public ifopt::ConstraintSet {
+public:
+  using VariableSetNames = std::vector<std::string>;
+
+  /**
+   * @param n_constraints  The number of constraint values.
+   * @param name           The name of this constraint set.
+   * @param variable_sets  The names of the variables the values depend on.
+   * @param sparsity       Where the n_constraints x n Jacobian w.r.t. these
+   *                       variables, in the same order, can be nonzero.
+   * @param thread_count   Threads evaluating EvaluateAt() concurrently, see
+   *                       FiniteDifferenceJacobian.
+   */
+  FiniteDifferenceConstraint (int n_constraints, const std::string& name,
+                              const VariableSetNames& variable_sets,
+                              const Jacobian& sparsity,
+                              int thread_count = 1);
+
+  /**
+   * @brief A constraint depending on a single variable set.
+   */
+  FiniteDifferenceConstraint (int n_constraints, const std::string& name,
+                              const std::string& variable_set,
+                              const Jacobian& sparsity,
+                              int thread_count = 1);
+  virtual ~FiniteDifferenceConstraint () = default;
+
+  VectorXd GetValues() const final;
+  void FillJacobianBlock (std::string var_set, Jacobian&) const final;
+
+  /**
+   * @returns The evaluations of EvaluateAt() per Jacobian, minus one.
+   */
+  int GetColorCount () const { return jacobian_.GetColorCount(); };
+
+protected:
+  /**
+   * @brief The constraint values for the given values of the variable sets.
+   *
+   * @param x  The values of all variable sets, in the order they were given.
+   *
+   * Must not depend on the current values of the variables, e.g. through
+   * the splines, and be thread-safe if more than one thread is used.
+   */
+  virtual VectorXd EvaluateAt (const VectorXd& x) const = 0;
+
+  FiniteDifferenceJacobian jacobian_;
+
+private:
+  VariableSetNames variable_sets_;
+
+  /// the Jacobian w.r.t. all variable sets, reused for each of them.
+  mutable VectorXd x_jacobian_;
+  mutable Jacobian jacobian_all_;
+
+  VectorXd GetVariableValues () const;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_CONSTRAINTS_FINITE_DIFFERENCE_CONSTRAINT_H_ */
@@ -0,0 +1,114 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_CONSTRAINTS_FINITE_DIFFERENCE_JACOBIAN_H_
+#define TOWR_CONSTRAINTS_FINITE_DIFFERENCE_JACOBIAN_H_
+
+#include <functional>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+namespace towr {
+
+/**
+ * @brief Sparse Jacobian of a function by compressed finite differences.
+ *
+ * Approximating each column of an m x n Jacobian separately requires n+1
+ * evaluations of the function g(x). If two columns have no nonzero in the
+ * same row, however, both variables can be perturbed at once and the
+ * difference in g assigned to each column by its row. The columns are
+ * therefore grouped (coloured) with the Curtis-Powell-Reid heuristic,
+ * greedily in order of decreasing column count, which reduces the cost to
+ * one evaluation per colour plus one. For the banded Jacobians typical of
+ * constraints along a trajectory, this number is independent of n.
+ *
+ * The colours are evaluated in parallel if more than one thread is given.
+ * The function is then called concurrently and must be thread-safe, e.g.
+ * a pure function of x. As threads are started per evaluation, this only
+ * pays off for expensive functions.
+ *
+ * @ingroup Constraints
+ */
+class FiniteDifferenceJacobian {
+public:
+  using Jacobian = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+  using VectorXd = Eigen::VectorXd;
+  using Function = std::function<VectorXd(const VectorXd& x)>;
+
+  /**
+   * @param sparsity      The m x n matrix whose stored elements mark where
+   *                      the Jacobian can be nonzero; the values are ignored.
+   * @param thread_count  Number of threads evaluating the function, 0 for
+   *                      one per core.
+   */
+  FiniteDifferenceJacobian (const Jacobian& sparsity, int thread_count = 1);
+  virtual ~FiniteDifferenceJacobian () = default;
+
+  /**
+   * @brief The forward-difference Jacobian of g at x.
+   *
+   * Every variable is perturbed by step*max(1,|x_j|), see SetStepSize().
+   *
+   * @param g  The function to differentiate, returning m values.
+   * @param x  The n values at which to differentiate.
+   * @return   The Jacobian with the structure of the sparsity pattern.
+   */
+  Jacobian Evaluate (const Function& g, const VectorXd& x) const;
+
+  /**
+   * @brief The relative perturbation of the variables, default 1e-7.
+   */
+  void SetStepSize (double step) { step_ = step; };
+
+  /**
+   * @returns The number of colours, so evaluations of g are one more.
+   */
+  int GetColorCount () const { return cols_of_color_.size(); };
+
+  /**
+   * @returns The colour of each column.
+   */
+  const std::vector<int>& GetColors () const { return color_of_col_; };
+
+private:
+  Jacobian structure_;
+  std::vector<int> color_of_col_;
+  std::vector<std::vector<int>> cols_of_color_;
+
+  int thread_count_;
+  double step_ = 1e-7;
+
+  void ColorColumns ();
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_CONSTRAINTS_FINITE_DIFFERENCE_JACOBIAN_H_ */
@@ -0,0 +1,86 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_CONSTRAINTS_PERIODIC_CONSTRAINT_H_
+#define TOWR_CONSTRAINTS_PERIODIC_CONSTRAINT_H_
+
+#include <ifopt/constraint_set.h>
+
+#include <towr/variables/cartesian_dimensions.h>
+#include <towr/variables/nodes_variables.h>
+
+namespace towr {
+
+/**
+ * @brief Makes the last node equal to the first, shifted by a translation.
+ *
+ * For steady-state locomotion only a single gait cycle is optimized. This
+ * constraint links the end of the cycle to its start, so the cycle can be
+ * repeated (see TileTrajectory()):
+ * x_last = x_first + translation, xd_last = xd_first.
+ *
+ * Node values that are not optimized over (e.g. the zero velocity of a foot
+ * in stance) are taken as constants. If neither node value is optimized,
+ * no constraint is added for it.
+ *
+ * @ingroup Constraints
+ */
+class PeriodicConstraint : public ifopt::ConstraintSet {
+public:
+  using Vector3d = Eigen::Vector3d;
+
+  /**
+   * @param nodes_id  The name of the node variables.
+   * @param translation  The offset in position between the first and last node.
+   * @param pos_dims  The dimensions of the position that are constrained.
+   */
+  PeriodicConstraint (const std::string& nodes_id,
+                      const Vector3d& translation,
+                      const std::vector<int>& pos_dims = {X,Y,Z});
+  virtual ~PeriodicConstraint () = default;
+
+  void InitVariableDependedQuantities(const VariablesPtr& x) override;
+
+  VectorXd GetValues() const override;
+  VecBound GetBounds() const override;
+  void FillJacobianBlock (std::string var_set, Jacobian&) const override;
+
+private:
+  NodesVariables::Ptr nodes_;
+  std::string nodes_id_;
+  Vector3d translation_;
+  std::vector<int> pos_dims_;
+
+  /// the node values at the last node, constrained relative to the first.
+  std::vector<NodesVariables::NodeValueInfo> constrained_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_CONSTRAINTS_PERIODIC_CONSTRAINT_H_ */
@@ -73,7 +73,7 @@ public:
 
 private:
   NodeSpline::Ptr base_linear_;     ///< the linear position of the base.
-  EulerConverter base_angular_; ///< the orientation of the base.
+  BaseKinematicsCache::Ptr base_kinematics_; ///< position and orientation of the base.
   NodeSpline::Ptr ee_motion_;       ///< the linear position of the endeffectors.
 
   Eigen::Vector3d max_deviation_from_nominal_;
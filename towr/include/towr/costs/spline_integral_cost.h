@@ -0,0 +1,120 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_COSTS_SPLINE_INTEGRAL_COST_H_
+#define TOWR_COSTS_SPLINE_INTEGRAL_COST_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Sparse>
+
+#include <ifopt/cost_term.h>
+
+#include <towr/variables/nodes_variables.h>
+
+namespace towr {
+
+/**
+ * @brief Integrates a squared derivative of a spline over its duration.
+ *
+ * For a cubic-Hermite polynomial of duration T with start/end node values
+ * u = (p0, v0, p1, v1) the integral of the squared k-th derivative
+ *
+ *     int_0^T (d^k x/dt^k)^2 dt = u^T M_k(T) u
+ *
+ * has a closed form, so for fixed durations the cost
+ *
+ *     c = weight * sum_dim int_0^T_total ||d^k x/dt^k||^2 dt
+ *
+ * is a constant quadratic form in the node values. E.g. k=2 penalizes the
+ * acceleration of the base, k=3 its jerk, and on force nodes k=0 the
+ * impulse of squared forces and k=1 their rate of change. In contrast to
+ * the NodeCost this regards the motion between the nodes, and no samples
+ * have to be evaluated.
+ *
+ * @ingroup Costs
+ */
+class SplineIntegralCost : public ifopt::CostTerm {
+public:
+  using VecTimes = std::vector<double>;
+  using Hessian  = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+  /**
+   * @param nodes_id  The name of the node variables.
+   * @param durations The durations of the polynomials, or of the phases for
+   *                  NodesVariablesPhaseBased, which are kept constant.
+   * @param deriv     The derivative whose square is integrated (kPos-kJerk).
+   * @param weight    The weight of the integral.
+   */
+  SplineIntegralCost (const std::string& nodes_id, const VecTimes& durations,
+                      Dx deriv, double weight);
+  virtual ~SplineIntegralCost () = default;
+
+  void InitVariableDependedQuantities(const VariablesPtr& x) override;
+
+  double GetCost () const override;
+
+  /**
+   * @returns The constant Hessian of the cost w.r.t. the optimization
+   *          variables of the nodes (GetOptVariablesName()).
+   */
+  const Hessian& GetHessian () const { return hessian_; };
+
+  /** @returns The name of the variables the Hessian refers to. */
+  std::string GetHessianVariablesName () const;
+
+  /**
+   * @returns M_k(T), so that the integral of the squared k-th derivative of
+   *          a polynomial is u^T M_k u with u = (p0, v0, p1, v1).
+   */
+  static Eigen::Matrix4d GetSegmentMatrix (double T, Dx deriv);
+
+private:
+  std::shared_ptr<NodesVariables> nodes_;
+
+  std::string node_id_;
+  VecTimes durations_;
+  Dx deriv_;
+  double weight_;
+
+  Hessian H_;         ///< cost = weight*u^T*H*u, u all node positions/velocities.
+  Hessian gradient_;  ///< gradient = gradient_*u.
+  Hessian hessian_;   ///< w.r.t. optimization variables.
+
+  Eigen::VectorXd GetNodeValues() const;
+  int GetValueIndex(int node_id, Dx deriv, int dim) const;
+
+  void FillJacobianBlock(std::string var_set, Jacobian&) const override;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_COSTS_SPLINE_INTEGRAL_COST_H_ */
@@ -0,0 +1,147 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_INITIALIZATION_GAIT_SEARCH_H_
+#define TOWR_INITIALIZATION_GAIT_SEARCH_H_
+
+#include <vector>
+
+#include <towr/nlp_formulation.h>
+
+#include "gait_generator.h"
+
+namespace towr {
+
+/**
+ * @brief Settings of the gait search.
+ */
+struct GaitSearchOptions {
+  /// The strides to combine, if empty GaitSearch::GetDefaultStrides().
+  std::vector<GaitGenerator::Gaits> strides_;
+  int min_stride_count_ = 1; ///< strides between initial and final stand.
+  int max_stride_count_ = 3;
+
+  /// How many of the geometrically best sequences are checked by the LP.
+  int impulse_check_count_ = 20;
+
+  /// Terrain roughness is measured this far [m] around each foothold.
+  double foothold_radius_ = 0.05;
+
+  double weight_reach_   = 10.0; ///< per [m] of kinematic range violation.
+  double weight_terrain_ = 1.0;
+  double weight_impulse_ = 1.0;  ///< per [m] or [m/s] the goal is missed.
+};
+
+
+/**
+ * @brief Finds promising contact sequences without solving the NLP.
+ *
+ * Contact sequences are enumerated by combining the strides of the
+ * GaitGenerator (e.g. {Stand, Walk1, Run1, Stand}) and each is scored by
+ * checks that are orders of magnitude cheaper than the NLP:
+ *
+ * 1. Reach: The base is assumed to move linearly from start to goal and each
+ *    stance foot to be placed below it. The stance foot must stay inside the
+ *    kinematic range during the whole stance phase.
+ * 2. Terrain: Each foothold is scored by the deviation of the terrain from
+ *    its tangent plane around the foothold (edges, gaps) and its slope
+ *    compared to the friction cone.
+ * 3. Impulse: A point mass must reach the goal position and velocity with
+ *    constant contact forces per phase inside the (linearized) friction cones
+ *    of the footholds, while staying close to the linear base path. This
+ *    linear program is solved with a phase-one simplex, whose optimal value
+ *    is the L1 distance to feasibility.
+ *
+ * Since the first two are much cheaper, only the best of those continue to
+ * the LP. The top-k candidates can then be solved by the NLP, e.g. in
+ * parallel by the PortfolioPlanner.
+ */
+class GaitSearch {
+public:
+  using Gaits = std::vector<GaitGenerator::Gaits>;
+
+  /**
+   * @brief A contact sequence and its scores, lower is better.
+   */
+  struct Candidate {
+    Gaits gaits_;
+    std::vector<Parameters::VecTimes> ee_phase_durations_;
+    std::vector<bool> ee_in_contact_at_start_;
+
+    double reach_violation_   = 0.0; ///< summed over all stance phases [m].
+    double terrain_cost_      = 0.0; ///< summed over all footholds.
+    double impulse_violation_ = 0.0; ///< optimal value of the phase-one LP.
+    double score_ = 0.0;             ///< weighted sum of the above.
+  };
+
+  explicit GaitSearch (const GaitSearchOptions& options = GaitSearchOptions());
+  virtual ~GaitSearch () = default;
+
+  /**
+   * @brief Enumerates all stride combinations and returns the best ones.
+   * @param problem  Robot, terrain, start and goal. The total duration is
+   *                 taken from the currently set phase durations.
+   * @param k  The maximum number of candidates to return.
+   * @returns the candidates sorted by score, best first.
+   */
+  std::vector<Candidate> Search (const NlpFormulation& problem, int k) const;
+
+  /**
+   * @brief Scores the contact sequence currently set in the problem.
+   */
+  Candidate Evaluate (const NlpFormulation& problem) const;
+
+  /**
+   * @brief Sets the contact sequence of a candidate in the problem.
+   */
+  static void Apply (const Candidate& candidate, NlpFormulation& problem);
+
+  /**
+   * @returns the strides the GaitGenerator implements for this leg count.
+   */
+  static Gaits GetDefaultStrides (int ee_count);
+
+  /**
+   * @brief Phase one of the simplex method for A*x = b, x >= 0.
+   * @returns The L1 distance to feasibility, min |A*x - b|_1 over x >= 0,
+   *          zero if the system is feasible.
+   */
+  static double GetDistanceToFeasibility (Eigen::MatrixXd A, Eigen::VectorXd b);
+
+private:
+  GaitSearchOptions options_;
+
+  void ScoreGeometry (const NlpFormulation& problem, Candidate& c) const;
+  void ScoreImpulse (const NlpFormulation& problem, Candidate& c) const;
+  void UpdateScore (Candidate& c) const;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_INITIALIZATION_GAIT_SEARCH_H_ */
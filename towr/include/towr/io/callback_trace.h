@@ -0,0 +1,203 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_IO_CALLBACK_TRACE_H_
+#define TOWR_IO_CALLBACK_TRACE_H_
+
+#include <array>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <ifopt/problem.h>
+
+#include <towr/planning/planning_protocol.h>
+
+namespace towr {
+
+/**
+ * @brief Binary file of the evaluation callbacks a solver requested.
+ *
+ * A file is a FileHeader, holding the PlanRequest that describes the
+ * problem, followed by one event per callback. Every event is an
+ * EventHeader and, if the variables differ from those of the previous
+ * event, the new variables as native-endian doubles. Solvers evaluate the
+ * values and derivatives at the same point in a row, so this stores each
+ * iterate once.
+ *
+ * Replaying a file against a problem built from its request repeats
+ * exactly the evaluations of the original solve without the solver. This
+ * makes benchmarks of the evaluation code independent of the solver, and
+ * two versions of it (e.g. SingleRigidBodyDynamics::Kernels) can be
+ * compared on identical workloads, down to the bits of their outputs.
+ */
+namespace callback_trace {
+
+static const char     kMagic[8] = {'T','O','W','R','C','B','T','\0'};
+static const uint32_t kVersion  = 1; ///< increased on layout changes.
+
+/** The evaluations of an ifopt::Problem requested by the solver. */
+enum Callback : uint32_t { kConstraints = 0, ///< values of all constraints.
+                           kJacobian,        ///< Jacobian of the constraints.
+                           kCost,            ///< value of the cost.
+                           kGradient,        ///< gradient of the cost.
+                           kCallbackCount };
+
+struct FileHeader {
+  char magic_[8];
+  uint32_t version_;
+  uint32_t variable_count_;
+  planning_protocol::PlanRequest request_;
+};
+
+struct EventHeader {
+  uint32_t callback_;  ///< Callback.
+  uint32_t new_x_;     ///< 1 if the variables follow this header.
+};
+
+/** @returns The name of a callback, e.g. for printing. */
+std::string GetName (Callback callback);
+
+} /* namespace callback_trace */
+
+
+/**
+ * @brief Appends the callbacks to a file as they are requested.
+ *
+ * Events are written immediately, so the trace is usable up to the last
+ * complete event even if the solve doesn't end.
+ *
+ * @ingroup Planning
+ */
+class CallbackTraceWriter {
+public:
+  using Ptr      = std::shared_ptr<CallbackTraceWriter>;
+  using VectorXd = Eigen::VectorXd;
+
+  /**
+   * @brief Creates the file and writes the file header.
+   * @param request         Describes the problem whose callbacks are stored.
+   * @param variable_count  The number of optimization variables.
+   * @throws std::runtime_error if the file can't be opened.
+   */
+  CallbackTraceWriter (const std::string& path,
+                       const planning_protocol::PlanRequest& request,
+                       int variable_count);
+  virtual ~CallbackTraceWriter () = default;
+
+  /**
+   * @brief Writes the next event.
+   * @param x  The values of all optimization variables.
+   */
+  void Append (callback_trace::Callback callback, const VectorXd& x);
+
+  /** @returns The number of events written. */
+  int GetEventCount () const { return event_count_; };
+
+  /** @brief Forces all events to be written to the file. */
+  void Flush ();
+
+private:
+  std::ofstream file_;
+  VectorXd x_prev_;
+  int event_count_ = 0;
+};
+
+
+/**
+ * @brief Reads all events of a trace into memory.
+ *
+ * An incomplete event at the end of the file is ignored.
+ *
+ * @ingroup Planning
+ */
+class CallbackTraceReader {
+public:
+  using VectorXd = Eigen::VectorXd;
+
+  /**
+   * @throws std::runtime_error if the file can't be read or isn't compatible.
+   */
+  explicit CallbackTraceReader (const std::string& path);
+  virtual ~CallbackTraceReader () = default;
+
+  /** @returns The description of the traced problem. */
+  const planning_protocol::PlanRequest& GetRequest () const { return header_.request_; };
+
+  /** @returns The number of optimization variables of the traced problem. */
+  int GetVariableCount () const { return header_.variable_count_; };
+
+  int GetEventCount () const { return callbacks_.size(); };
+  callback_trace::Callback GetCallback (int event) const { return callbacks_.at(event); };
+  const VectorXd& GetVariables (int event) const { return xs_.at(x_of_event_.at(event)); };
+
+private:
+  callback_trace::FileHeader header_;
+  std::vector<callback_trace::Callback> callbacks_;
+  std::vector<int> x_of_event_; ///< index into xs_ for every event.
+  std::vector<VectorXd> xs_;
+};
+
+
+/**
+ * @brief Records all evaluation callbacks of a problem into a trace.
+ *
+ * Adds probes to the problem that are called with every evaluation, but
+ * don't change its results: an empty constraint set and, if the problem
+ * has costs, a cost term that is always zero. Must be called after all
+ * other variables, constraints and costs were added.
+ *
+ * @param nlp     The problem to be solved.
+ * @param writer  The trace receiving the callbacks.
+ */
+void RecordCallbacks (ifopt::Problem& nlp, const CallbackTraceWriter::Ptr& writer);
+
+/**
+ * @brief The outcome of replaying a trace.
+ */
+struct ReplayResult {
+  using PerCallback = std::array<double, callback_trace::kCallbackCount>;
+
+  std::vector<uint64_t> digests_; ///< hash of the output bytes of each event.
+  PerCallback time_;              ///< time [s] spent in each callback type.
+  std::array<int, callback_trace::kCallbackCount> count_; ///< events of each type.
+};
+
+/**
+ * @brief Repeats the evaluations of a trace, as the solver requested them.
+ * @param trace  The recorded callbacks.
+ * @param nlp    The problem built from trace.GetRequest(), without probes.
+ * @throws std::runtime_error if the number of variables differs.
+ */
+ReplayResult ReplayCallbacks (const CallbackTraceReader& trace, ifopt::Problem& nlp);
+
+} /* namespace towr */
+
+#endif /* TOWR_IO_CALLBACK_TRACE_H_ */
@@ -0,0 +1,134 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_IO_ITERATION_HISTORY_H_
+#define TOWR_IO_ITERATION_HISTORY_H_
+
+#include <string>
+#include <vector>
+
+#include <ifopt/problem.h>
+
+#include <towr/nlp_formulation.h>
+#include <towr/variables/spline_holder.h>
+#include <towr/variables/trajectory.h>
+
+#include "trajectory_file.h"
+
+namespace towr {
+
+/**
+ * @brief Which solver iterations to keep and how to store them.
+ *
+ * @ingroup Planning
+ */
+struct IterationHistoryOptions {
+  enum Decimation { All, EveryKth, LogSpaced };
+
+  Decimation decimation_ = All;
+  int every_k_   = 10;   ///< for EveryKth, keeps iterations 0, k, 2k, ...
+  int log_count_ = 50;   ///< for LogSpaced, the approximate number to keep.
+
+  /// Only store the optimization variables (one column "x") instead of the
+  /// trajectory, reconstructed on demand through IterationHistoryReader.
+  bool x_only_ = false;
+  double sample_dt_ = 0.0; ///< if > 0 and not x_only_, also store samples.
+};
+
+/**
+ * @returns The sorted indices of the iterations to keep out of n_iterations.
+ *
+ * The first and last iteration are always kept, LogSpaced keeps the early
+ * iterations where the motion changes most and thins out the later ones.
+ */
+std::vector<int> GetKeptIterations (int n_iterations,
+                                    const IterationHistoryOptions& options);
+
+/**
+ * @brief Streams the kept solver iterations of a solved problem to a file.
+ *
+ * Replaces setting every iteration and keeping all resulting trajectories in
+ * memory: each kept iterate is set, converted and appended to the file
+ * before the next one, so memory stays constant in the number of iterations.
+ * Each record's stamp is the index of the solver iteration. The variables of
+ * the problem are reset to the last iteration afterwards.
+ *
+ * @param nlp      The solved problem, built from the variables linked to splines.
+ * @param splines  The splines that change with the variables of nlp.
+ * @param options  Which iterations to write and how.
+ * @param file     The file to append the iterations to.
+ * @returns The number of records written.
+ */
+int WriteIterationHistory (ifopt::Problem& nlp, const SplineHolder& splines,
+                           const IterationHistoryOptions& options,
+                           TrajectoryFileWriter& file);
+
+/**
+ * @brief Reads iteration histories written by WriteIterationHistory().
+ *
+ * Records stored as trajectories are returned directly. Records that only
+ * store the optimization variables are turned back into trajectories by
+ * setting them on variables built from the same formulation that was solved,
+ * which is only done when the iteration is actually requested.
+ *
+ * @ingroup Planning
+ */
+class IterationHistoryReader {
+public:
+  /**
+   * @param path         The file written by WriteIterationHistory().
+   * @param formulation  The formulation that produced the history, only
+   *                     needed if iterations were stored as x-vectors.
+   */
+  IterationHistoryReader (const std::string& path,
+                          const NlpFormulation& formulation);
+  virtual ~IterationHistoryReader () = default;
+
+  /** @returns The number of stored iterations. */
+  int GetRecordCount () const;
+
+  /** @returns The solver iteration stored in a record. */
+  int GetIteration (int record) const;
+
+  /**
+   * @returns The trajectory of a stored iteration.
+   * @throws std::runtime_error if the variables don't match the formulation.
+   */
+  Trajectory GetTrajectory (int record);
+
+private:
+  TrajectoryFileReader file_;
+  NlpFormulation formulation_;
+  SplineHolder splines_;
+  NlpFormulation::VariablePtrVec variables_; ///< built on first use.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_IO_ITERATION_HISTORY_H_ */
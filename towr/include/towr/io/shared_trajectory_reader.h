@@ -0,0 +1,406 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_IO_SHARED_TRAJECTORY_READER_H_
+#define TOWR_IO_SHARED_TRAJECTORY_READER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// This file is self-contained (no Eigen, towr or ROS dependencies), so it
+// can be copied into the code base of an out-of-process controller.
+
+namespace towr {
+
+/**
+ * @brief Memory layout of trajectories published into POSIX shared memory.
+ *
+ * The region starts with a RegionHeader followed by slot_count_ slots of
+ * slot_size_ bytes each, forming a ring that the writer fills one after the
+ * other. Each slot starts with a SlotHeader protected by a sequence lock
+ * (odd while being written), followed by the payload:
+ *
+ *   PayloadHeader
+ *   uint64_t block_offsets[block_count_]     (bytes from payload start)
+ *   blocks: base linear, base angular, ee motions, ee forces, ee contacts
+ *
+ * A spline block is a SplineBlockHeader followed by the segment_count_+1
+ * knot times and, for every segment, coeff_count_ times the dim_
+ * coefficients A,B,C,D(,E,F) of
+ *   f(t) = A + Bt + Ct^2 + Dt^3 (+ Et^4 + Ft^5),   t in [0, segment duration],
+ * with 4 coefficients for cubic and 6 for quintic segments.
+ * A contact block is a ContactBlockHeader followed by the end time of every
+ * phase. All values are native-endian doubles and 8-byte aligned.
+ */
+namespace shm {
+
+static const uint32_t kMagic   = 0x52574f54; ///< "TOWR" in little-endian.
+static const uint32_t kVersion = 2;          ///< increased on layout changes.
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory needs lock-free atomics");
+
+struct RegionHeader {
+  uint32_t magic_;
+  uint32_t version_;
+  uint32_t slot_count_;
+  uint32_t slot_size_;            ///< bytes per slot, including SlotHeader.
+  std::atomic<uint64_t> latest_;  ///< id of the last complete write, 0 if none.
+};
+
+struct SlotHeader {
+  std::atomic<uint64_t> sequence_; ///< odd while the slot is being written.
+  uint64_t write_id_;              ///< 1 for the first trajectory written, ...
+  uint64_t payload_size_;          ///< bytes following this header.
+};
+
+struct PayloadHeader {
+  double total_time_;
+  uint32_t ee_count_;
+  uint32_t block_count_;  ///< 2 + 3*ee_count_.
+};
+
+struct SplineBlockHeader {
+  uint32_t segment_count_;
+  uint32_t dim_;
+  uint32_t coeff_count_;  ///< 4 for cubic, 6 for quintic segments.
+  uint32_t reserved_;     ///< keeps the knot times 8-byte aligned.
+};
+
+struct ContactBlockHeader {
+  uint32_t phase_count_;
+  uint32_t in_contact_at_start_;
+};
+
+static const std::size_t kRegionHeaderSize = 64; ///< RegionHeader padded to a cache line.
+static_assert(sizeof(RegionHeader) <= kRegionHeaderSize, "RegionHeader too large");
+
+/** @returns The byte offset of a slot from the start of the region. */
+inline std::size_t GetSlotOffset (uint32_t slot, uint32_t slot_size)
+{
+  return kRegionHeaderSize + std::size_t(slot)*slot_size;
+}
+
+} /* namespace shm */
+
+
+/**
+ * @brief Evaluates one spline directly from the shared memory.
+ */
+class SharedSplineView {
+public:
+  SharedSplineView () = default;
+  SharedSplineView (const double* knot_times, const double* coeff,
+                    uint32_t segment_count, uint32_t dim, uint32_t coeff_count)
+      : t_(knot_times), coeff_(coeff), n_(segment_count), dim_(dim),
+        n_coeff_(coeff_count) {}
+
+  uint32_t GetDim () const { return dim_; }
+  double GetTotalTime () const { return t_[n_]; }
+
+  /**
+   * @brief Evaluates the spline at time t, clamped to the spline duration.
+   * @param[out] pos,vel,acc  GetDim() values each, or nullptr if not needed.
+   */
+  void GetPoint (double t, double* pos, double* vel = nullptr,
+                 double* acc = nullptr) const
+  {
+    t = std::max(t_[0], std::min(t, t_[n_]));
+
+    // at junctions, returns the previous segment
+    uint32_t k = std::lower_bound(t_+1, t_+n_, t) - (t_+1);
+    double dt = t - t_[k];
+
+    // Horner's scheme for the value and both derivatives
+    const double* c = coeff_ + std::size_t(k)*n_coeff_*dim_;
+    for (uint32_t i=0; i<dim_; ++i) {
+      double p = 0.0, v = 0.0, a = 0.0;
+      for (uint32_t j=n_coeff_; j-- > 0;) {
+        a = a*dt + 2*v;
+        v = v*dt + p;
+        p = p*dt + c[j*dim_+i];
+      }
+      if (pos) pos[i] = p;
+      if (vel) vel[i] = v;
+      if (acc) acc[i] = a;
+    }
+  }
+
+private:
+  const double* t_ = nullptr;
+  const double* coeff_ = nullptr;
+  uint32_t n_ = 0;
+  uint32_t dim_ = 0;
+  uint32_t n_coeff_ = 0;
+};
+
+/**
+ * @brief Evaluates a trajectory directly from the shared memory.
+ *
+ * Construction checks that all counts and offsets stay inside the payload,
+ * so a view created from a slot that is concurrently overwritten never
+ * reads outside the slot. The values it returns are only meaningful if the
+ * read is confirmed by SharedTrajectoryReader::Read() though.
+ */
+class SharedTrajectoryView {
+public:
+  SharedTrajectoryView () = default;
+
+  SharedTrajectoryView (const char* payload, uint64_t size)
+      : payload_(payload), size_(size)
+  {
+    valid_ = Parse();
+  }
+
+  bool IsValid () const { return valid_; }
+  double GetTotalTime () const { return header_->total_time_; }
+  uint32_t GetEECount () const { return header_->ee_count_; }
+
+  SharedSplineView GetBaseLinear () const  { return GetSpline(0); }
+  SharedSplineView GetBaseAngular () const { return GetSpline(1); }
+  SharedSplineView GetEEMotion (uint32_t ee) const { return GetSpline(2+ee); }
+  SharedSplineView GetEEForce (uint32_t ee) const  { return GetSpline(2+GetEECount()+ee); }
+
+  /**
+   * @returns True if the endeffector is in contact at time t.
+   */
+  bool IsContactPhase (uint32_t ee, double t) const
+  {
+    const char* block = payload_ + offsets_[2+2*GetEECount()+ee];
+    auto h = reinterpret_cast<const shm::ContactBlockHeader*>(block);
+    auto phase_end = reinterpret_cast<const double*>(block + sizeof(*h));
+
+    // at junctions, returns the previous phase
+    uint32_t phase = std::lower_bound(phase_end, phase_end+h->phase_count_-1, t) - phase_end;
+    bool initial = h->in_contact_at_start_ != 0;
+    return phase%2 == 0? initial : !initial;
+  }
+
+private:
+  const char* payload_ = nullptr;
+  uint64_t size_ = 0;
+  const shm::PayloadHeader* header_ = nullptr;
+  const uint64_t* offsets_ = nullptr;
+  bool valid_ = false;
+
+  SharedSplineView GetSpline (uint32_t block_id) const
+  {
+    const char* block = payload_ + offsets_[block_id];
+    auto h = reinterpret_cast<const shm::SplineBlockHeader*>(block);
+    auto t = reinterpret_cast<const double*>(block + sizeof(*h));
+    return SharedSplineView(t, t + h->segment_count_+1, h->segment_count_, h->dim_,
+                            h->coeff_count_);
+  }
+
+  bool Parse ()
+  {
+    if (size_ < sizeof(shm::PayloadHeader))
+      return false;
+
+    header_  = reinterpret_cast<const shm::PayloadHeader*>(payload_);
+    offsets_ = reinterpret_cast<const uint64_t*>(payload_ + sizeof(shm::PayloadHeader));
+
+    uint64_t n_ee = header_->ee_count_;
+    uint64_t n_blocks = header_->block_count_;
+    if (n_blocks != 2 + 3*n_ee || sizeof(shm::PayloadHeader) + 8*n_blocks > size_)
+      return false;
+
+    for (uint64_t b=0; b<n_blocks; ++b) {
+      uint64_t offset = offsets_[b];
+      bool is_spline = b < 2 + 2*n_ee;
+      uint64_t header_size = is_spline? sizeof(shm::SplineBlockHeader)
+                                      : sizeof(shm::ContactBlockHeader);
+      if (offset%8 != 0 || offset + header_size > size_)
+        return false;
+
+      const char* block = payload_ + offset;
+      uint64_t n_doubles;
+      if (is_spline) {
+        auto h = reinterpret_cast<const shm::SplineBlockHeader*>(block);
+        if (h->segment_count_ == 0 || h->segment_count_ > size_/8 || h->dim_ == 0 || h->dim_ > 16
+            || (h->coeff_count_ != 4 && h->coeff_count_ != 6))
+          return false;
+        n_doubles = (h->segment_count_+1) + uint64_t(h->segment_count_)*h->coeff_count_*h->dim_;
+      } else {
+        auto h = reinterpret_cast<const shm::ContactBlockHeader*>(block);
+        if (h->phase_count_ == 0 || h->phase_count_ > size_/8)
+          return false;
+        n_doubles = h->phase_count_;
+      }
+
+      if (offset + header_size + 8*n_doubles > size_)
+        return false;
+    }
+
+    return true;
+  }
+};
+
+
+/**
+ * @brief Reads trajectories a SharedTrajectoryWriter publishes, zero-copy.
+ *
+ * The trajectory is evaluated in place in the shared memory. Since the
+ * writer never waits for readers, every read is validated afterwards with
+ * the sequence lock of the slot, and repeated if the writer modified the
+ * slot in the meantime. With a ring of several slots this only happens if
+ * the reader is slower than multiple writes.
+ *
+ * Usage in a control loop:
+ *
+ *     SharedTrajectoryReader reader("/towr_trajectory");
+ *     double p[3];
+ *     bool ok = reader.Read([&](const SharedTrajectoryView& traj, uint64_t id) {
+ *       traj.GetBaseLinear().GetPoint(t, p);
+ *     });
+ *     // only use p if ok
+ */
+class SharedTrajectoryReader {
+public:
+  /**
+   * @param name  The POSIX shared memory name given to the writer.
+   */
+  explicit SharedTrajectoryReader (const std::string& name)
+  {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+      return;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(shm::kRegionHeaderSize)) {
+      void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (addr != MAP_FAILED) {
+        region_ = static_cast<const char*>(addr);
+        region_size_ = st.st_size;
+      }
+    }
+    close(fd);
+
+    if (region_ && !IsCompatible()) {
+      munmap(const_cast<char*>(region_), region_size_);
+      region_ = nullptr;
+    }
+  }
+
+  ~SharedTrajectoryReader ()
+  {
+    if (region_)
+      munmap(const_cast<char*>(region_), region_size_);
+  }
+
+  SharedTrajectoryReader (const SharedTrajectoryReader&) = delete;
+  SharedTrajectoryReader& operator=(const SharedTrajectoryReader&) = delete;
+
+  /**
+   * @returns True if the region exists and has a compatible layout version.
+   */
+  bool IsOpen () const { return region_ != nullptr; }
+
+  /**
+   * @returns The id of the latest published trajectory, 0 if none yet.
+   */
+  uint64_t GetLatestId () const
+  {
+    return region_? GetHeader()->latest_.load(std::memory_order_acquire) : 0;
+  }
+
+  /**
+   * @brief Calls fn(view, write_id) with the latest trajectory.
+   *
+   * fn might be called several times if the slot was overwritten while
+   * reading. Everything fn computes must only be used if true is returned.
+   *
+   * @param fn  Callable taking (const SharedTrajectoryView&, uint64_t).
+   * @param max_attempts  How often to retry if the slot was overwritten.
+   * @returns True if fn was called with a consistent trajectory.
+   */
+  template<typename Fn>
+  bool Read (Fn fn, int max_attempts = 3) const
+  {
+    for (int attempt=0; attempt<max_attempts; ++attempt) {
+      uint64_t id = GetLatestId();
+      if (id == 0)
+        return false;
+
+      const shm::RegionHeader* header = GetHeader();
+      uint32_t slot_id = (id-1) % header->slot_count_;
+      const char* slot = region_ + shm::GetSlotOffset(slot_id, header->slot_size_);
+      auto slot_header = reinterpret_cast<const shm::SlotHeader*>(slot);
+
+      uint64_t seq_before = slot_header->sequence_.load(std::memory_order_acquire);
+      if (seq_before%2 != 0)
+        continue; // being written
+
+      uint64_t payload_size = std::min<uint64_t>(slot_header->payload_size_,
+                                                 header->slot_size_ - sizeof(shm::SlotHeader));
+      uint64_t write_id = slot_header->write_id_;
+      SharedTrajectoryView view(slot + sizeof(shm::SlotHeader), payload_size);
+      if (view.IsValid())
+        fn(static_cast<const SharedTrajectoryView&>(view), write_id);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint64_t seq_after = slot_header->sequence_.load(std::memory_order_relaxed);
+      if (seq_after == seq_before && view.IsValid())
+        return true;
+    }
+
+    return false;
+  }
+
+private:
+  const char* region_ = nullptr;
+  std::size_t region_size_ = 0;
+
+  const shm::RegionHeader* GetHeader () const
+  {
+    return reinterpret_cast<const shm::RegionHeader*>(region_);
+  }
+
+  bool IsCompatible () const
+  {
+    const shm::RegionHeader* h = GetHeader();
+    return h->magic_ == shm::kMagic
+        && h->version_ == shm::kVersion
+        && h->slot_count_ > 0
+        && h->slot_size_ > sizeof(shm::SlotHeader)
+        && h->slot_size_%8 == 0
+        && shm::GetSlotOffset(h->slot_count_, h->slot_size_) <= region_size_;
+  }
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_IO_SHARED_TRAJECTORY_READER_H_ */
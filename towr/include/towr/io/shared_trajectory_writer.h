@@ -0,0 +1,98 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_IO_SHARED_TRAJECTORY_WRITER_H_
+#define TOWR_IO_SHARED_TRAJECTORY_WRITER_H_
+
+#include <string>
+#include <vector>
+
+#include <towr/variables/trajectory.h>
+
+#include "shared_trajectory_reader.h"
+
+namespace towr {
+
+/**
+ * @brief Publishes trajectories into a POSIX shared-memory ring.
+ *
+ * Each trajectory is written as flat polynomial-coefficient blocks into the
+ * next slot of the ring (see the shm namespace for the layout), protected by
+ * a sequence lock. The writer never waits for readers, readers in other
+ * processes use the header-only SharedTrajectoryReader to evaluate the
+ * trajectory in place.
+ *
+ * Only one writer per shared-memory name must exist at a time.
+ *
+ * @ingroup Planning
+ */
+class SharedTrajectoryWriter {
+public:
+  /**
+   * @brief Creates (or resets) the shared memory region.
+   * @param name  POSIX shared memory name, e.g. "/towr_trajectory".
+   * @param slot_count  How many trajectories the ring holds.
+   * @param slot_size   The maximum size [bytes] of each serialized trajectory.
+   * @throws std::runtime_error if the region can't be created.
+   */
+  SharedTrajectoryWriter (const std::string& name,
+                          uint32_t slot_count = 4,
+                          uint32_t slot_size = 1<<20);
+
+  /**
+   * @brief Unmaps and removes the shared memory region.
+   */
+  virtual ~SharedTrajectoryWriter ();
+
+  SharedTrajectoryWriter (const SharedTrajectoryWriter&) = delete;
+  SharedTrajectoryWriter& operator=(const SharedTrajectoryWriter&) = delete;
+
+  /**
+   * @brief Publishes a trajectory into the next slot of the ring.
+   * @returns The id of the written trajectory, 0 if it didn't fit into a slot.
+   */
+  uint64_t Write (const Trajectory& trajectory);
+
+  /**
+   * @brief Converts a trajectory to the payload stored in a slot.
+   * @param[out] payload  Is resized to exactly the number of bytes needed.
+   */
+  static void Serialize (const Trajectory& trajectory, std::vector<char>& payload);
+
+private:
+  std::string name_;
+  char* region_ = nullptr;
+  std::size_t region_size_ = 0;
+  uint64_t write_count_ = 0;
+  std::vector<char> payload_; ///< reused to avoid allocations.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_IO_SHARED_TRAJECTORY_WRITER_H_ */
@@ -0,0 +1,105 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_IO_TRAJECTORY_COMPRESSION_H_
+#define TOWR_IO_TRAJECTORY_COMPRESSION_H_
+
+#include <towr/variables/cubic_hermite_spline.h>
+#include <towr/variables/spline_holder.h>
+#include <towr/variables/trajectory.h>
+
+namespace towr {
+
+/**
+ * @brief The maximum deviation allowed when compressing a trajectory.
+ *
+ * The error is measured as the Euclidean distance between the original and
+ * the compressed spline at a dense set of sample times (the knots of the
+ * original spline and samples_per_polynomial_ points in between).
+ *
+ * @ingroup Planning
+ */
+struct CompressionTolerance {
+  double position_    = 1e-3; ///< base and endeffector position error [m].
+  double orientation_ = 1e-3; ///< base Euler angle error [rad].
+  double force_       = 1.0;  ///< endeffector force error [N].
+  int samples_per_polynomial_ = 10; ///< error checks per original polynomial.
+};
+
+/**
+ * @brief Removes knots from a spline as long as it stays within tolerance.
+ *
+ * Adaptive knot removal: repeatedly removes the interior knot whose removal
+ * causes the smallest error. Removing a knot refits the values and
+ * first-derivatives of its two neighbours by least squares over the samples
+ * of the polynomials they touch, and the error is that of the refit spline
+ * compared against the original one (not the previous approximation, so
+ * errors can't accumulate). The first and last knot keep their values.
+ *
+ * Since the remaining knots are refit, the result depends on the shape of
+ * the motion rather than on where the optimization placed its nodes, e.g. a
+ * base motion with a polynomial every 0.1s that is almost linear collapses
+ * to a few knots.
+ *
+ * The fit uses cubic segments, so splines of quintic segments are returned
+ * unchanged.
+ *
+ * @param spline     The spline to compress, with strictly increasing knots.
+ * @param tolerance  The maximum Euclidean error at the sample times.
+ * @param samples_per_polynomial  Error checks per polynomial of spline, at
+ *                                least 3 so every fit is well determined.
+ */
+CubicHermiteSpline
+CompressSpline (const CubicHermiteSpline& spline, double tolerance,
+                int samples_per_polynomial = 10);
+
+/**
+ * @brief Compresses all base and endeffector splines of a trajectory.
+ *
+ * Each spline is compressed independently, the contact schedule is copied.
+ */
+Trajectory
+CompressTrajectory (const Trajectory& trajectory,
+                    const CompressionTolerance& tolerance = CompressionTolerance());
+
+/**
+ * @brief Copies the current values of a solved motion and compresses them.
+ */
+Trajectory
+CompressTrajectory (const SplineHolder& splines,
+                    const CompressionTolerance& tolerance = CompressionTolerance());
+
+/**
+ * @returns The total number of knots over all splines of the trajectory.
+ */
+int GetKnotCount (const Trajectory& trajectory);
+
+} /* namespace towr */
+
+#endif /* TOWR_IO_TRAJECTORY_COMPRESSION_H_ */
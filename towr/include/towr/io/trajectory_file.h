@@ -0,0 +1,228 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_IO_TRAJECTORY_FILE_H_
+#define TOWR_IO_TRAJECTORY_FILE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <towr/variables/trajectory.h>
+
+#include "trajectory_compression.h"
+
+namespace towr {
+
+/**
+ * @brief Columnar binary file storing many trajectories.
+ *
+ * A file is a FileHeader followed by one record per trajectory. Every
+ * record is a RecordHeader, a table of ColumnInfo and the column data as
+ * native-endian doubles. Each column holds one quantity, e.g. the knot times
+ * or the x-positions of all knots of one spline, so single columns can be
+ * read without touching the rest of the record.
+ *
+ * The knots of the splines are stored exactly, so the trajectory can be
+ * reconstructed bit-identical. These columns are named
+ *
+ *   <spline>/t, <spline>/p<dim>, <spline>/v<dim>
+ *   ee<i>_contact/durations, ee<i>_contact/start
+ *
+ * with <spline> one of base_lin, base_ang, ee<i>_motion, ee<i>_force.
+ * Splines of quintic segments additionally store <spline>/a<dim>.
+ * Optionally the record also stores dense samples of the trajectory in the
+ * columns sample/t, sample/<spline>/{p,v,a}<dim> and sample/ee<i>_contact.
+ */
+namespace trajectory_file {
+
+static const char     kMagic[8] = {'T','O','W','R','T','R','J','\0'};
+static const uint32_t kVersion  = 1; ///< increased on layout changes.
+
+struct FileHeader {
+  char magic_[8];
+  uint32_t version_;
+  uint32_t reserved_;
+};
+
+struct RecordHeader {
+  uint64_t size_;          ///< bytes of the record, including this header.
+  uint64_t id_;            ///< 0 for the first record in the file, 1, ...
+  double stamp_;           ///< user-defined time stamp, e.g. of planning.
+  uint32_t ee_count_;
+  uint32_t column_count_;
+};
+
+struct ColumnInfo {
+  char name_[48];          ///< null-terminated column name.
+  uint64_t offset_;        ///< bytes from the start of the record.
+  uint64_t count_;         ///< number of doubles in this column.
+};
+
+using Column  = std::pair<std::string, std::vector<double>>;
+using Columns = std::vector<Column>;
+
+/**
+ * @returns The columns describing the exact knots of the trajectory.
+ */
+Columns GetKnotColumns (const Trajectory& trajectory);
+
+/**
+ * @returns Samples of the trajectory every dt seconds, named "sample/...".
+ */
+Columns GetSampleColumns (const Trajectory& trajectory, double dt);
+
+} /* namespace trajectory_file */
+
+
+/**
+ * @brief Appends trajectories to a file as they are produced.
+ *
+ * Each trajectory is written as soon as Append() is called, so nothing is
+ * kept in memory and the file is usable even if the program stops early.
+ *
+ * @ingroup Planning
+ */
+class TrajectoryFileWriter {
+public:
+  /**
+   * @brief Creates the file and writes the file header.
+   * @throws std::runtime_error if the file can't be opened.
+   */
+  explicit TrajectoryFileWriter (const std::string& path);
+  virtual ~TrajectoryFileWriter () = default;
+
+  /**
+   * @brief Writes a trajectory as the next record of the file.
+   * @param trajectory  The motion to store exactly through its knots.
+   * @param sample_dt   If > 0, also stores samples every sample_dt seconds.
+   * @param stamp       User-defined time stamp of this record.
+   * @returns The id of the record.
+   */
+  uint64_t Append (const Trajectory& trajectory,
+                   double sample_dt = 0.0,
+                   double stamp = 0.0);
+
+  /**
+   * @brief Stores the knots of subsequently appended trajectories compressed.
+   *
+   * The knots are reduced by CompressTrajectory(), the optional samples are
+   * still taken from the original trajectory.
+   */
+  void SetCompression (const CompressionTolerance& tolerance);
+
+  /**
+   * @brief Writes a record with arbitrary user-defined columns.
+   */
+  uint64_t Append (const trajectory_file::Columns& columns,
+                   int ee_count, double stamp);
+
+  /**
+   * @brief Forces all appended records to be written to the file.
+   */
+  void Flush ();
+
+private:
+  std::ofstream file_;
+  uint64_t record_count_ = 0;
+  bool compress_ = false;
+  CompressionTolerance tolerance_;
+};
+
+
+/**
+ * @brief Reads a trajectory file through memory mapping.
+ *
+ * Columns are returned as pointers into the mapped file, so reading a
+ * single quantity of one record out of thousands only touches those bytes.
+ *
+ * @ingroup Planning
+ */
+class TrajectoryFileReader {
+public:
+  /**
+   * @brief Maps the file and indexes its records.
+   *
+   * A partially written last record is ignored, but the columns of every
+   * complete record must lie inside of it.
+   *
+   * @throws std::runtime_error if the file can't be read, isn't compatible
+   *         or a record is corrupt.
+   */
+  explicit TrajectoryFileReader (const std::string& path);
+  virtual ~TrajectoryFileReader ();
+
+  TrajectoryFileReader (const TrajectoryFileReader&) = delete;
+  TrajectoryFileReader& operator=(const TrajectoryFileReader&) = delete;
+
+  /** @returns The number of trajectories in the file. */
+  int GetRecordCount () const;
+
+  /** @returns The user-defined time stamp of a record. */
+  double GetStamp (int record) const;
+
+  /** @returns The names of all columns in a record. */
+  std::vector<std::string> GetColumnNames (int record) const;
+
+  /**
+   * @returns A pointer to the values of a column, nullptr if it doesn't exist.
+   * @param[out] count  The number of values in the column.
+   */
+  const double* GetColumn (int record, const std::string& name, uint64_t& count) const;
+
+  /** @returns True if the record contains dense samples. */
+  bool HasSamples (int record) const;
+
+  /** @returns The exact trajectory stored in a record. */
+  Trajectory GetTrajectory (int record) const;
+
+private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+  std::vector<const trajectory_file::RecordHeader*> records_;
+
+  /** @returns True if all columns of a complete record lie inside of it. */
+  static bool IsValidRecord (const trajectory_file::RecordHeader* record);
+};
+
+
+/**
+ * @brief Writes the samples of a record as comma-separated values.
+ *
+ * Uses the dense samples if the record has them, otherwise samples the
+ * stored trajectory every @a dt seconds. The first line holds the names.
+ */
+void WriteCsv (const TrajectoryFileReader& reader, int record,
+               std::ostream& out, double dt = 0.01);
+
+} /* namespace towr */
+
+#endif /* TOWR_IO_TRAJECTORY_FILE_H_ */
@@ -61,6 +61,10 @@ namespace towr {
  * motion trajectory complies to this. Currently, only SingleRigidBodyDynamics
  * is implemented.
  *
+ * Thread safety: SetCurrent() modifies the model, so every DynamicConstraint
+ * evaluates its own Clone() and the original can be shared read-only (e.g.
+ * through a RobotModel) between formulations solved on different threads.
+ *
  * @ingroup Robots
  */
 class DynamicModel {
@@ -90,6 +94,15 @@ public:
                   const Matrix3d& w_R_b, const AngVel& omega_W, const Vector3d& omega_dot_W,
                   const EELoad& force_W, const EEPos& pos_W);
 
+  /**
+   * @returns A copy of this model, including the current state.
+   *
+   * Needed because SetCurrent() changes the model, so each user that sets
+   * a state, e.g. one DynamicConstraint per optimization problem, requires
+   * its own copy.
+   */
+  virtual Ptr Clone() const = 0;
+
   /**
    * @brief  The violation of the system dynamics incurred by the current values.
    * @return The 6-dimension generalized force violation (angular + linear).
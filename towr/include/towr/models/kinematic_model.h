@@ -43,6 +43,8 @@ namespace towr {
  * This class is mainly used to formulate the @ref RangeOfMotionConstraint,
  * restricting each endeffector to stay inside it's kinematic range.
  *
+ * Only read after construction, so it can be shared between threads.
+ *
  * @ingroup Robots
  */
 class KinematicModel {
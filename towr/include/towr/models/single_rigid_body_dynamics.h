@@ -55,6 +55,16 @@ namespace towr {
  */
 class SingleRigidBodyDynamics : public DynamicModel {
 public:
+  /**
+   * @brief How the violation and its derivatives are evaluated.
+   *
+   * HandWrittenKernels uses the sparse expressions in this class,
+   * GeneratedKernels the flat functions in srbd_kernels, generated from the
+   * same equations by scripts/generate_srbd_kernels.py. Both return the
+   * same values and sparsity.
+   */
+  enum Kernels { HandWrittenKernels, GeneratedKernels };
+
   /**
    * @brief Constructs a specific model.
    * @param mass         The mass of the robot.
@@ -78,6 +88,8 @@ public:
 
   virtual ~SingleRigidBodyDynamics () = default;
 
+  Ptr Clone() const override;
+
   BaseAcc GetDynamicViolation() const override;
 
   Jac GetJacobianWrtBaseLin(const Jac& jac_base_lin_pos,
@@ -88,11 +100,31 @@ public:
 
   Jac GetJacobianWrtEEPos(const Jac& jac_ee_pos, EE) const override;
 
+  /**
+   * @brief Selects the kernels used by all of the above, also in clones.
+   */
+  void SetKernels(Kernels kernels) { kernels_ = kernels; };
+  Kernels GetKernels() const { return kernels_; };
+
 private:
+  using Matrix3dRows = Eigen::Matrix<double, 3, 3, Eigen::RowMajor>;
+
+  BaseAcc GetDynamicViolationGenerated() const;
+  Jac GetJacobianWrtBaseLinGenerated(const Jac& jac_base_lin_pos,
+                                     const Jac& jac_acc_base_lin) const;
+  Jac GetJacobianWrtBaseAngGenerated(const EulerConverter& base_angular,
+                                     double t) const;
+  Jac GetJacobianWrtForceGenerated(const Jac& jac_force, EE) const;
+  Jac GetJacobianWrtEEPosGenerated(const Jac& jac_ee_pos, EE) const;
+
+  Kernels kernels_ = HandWrittenKernels;
+
   /** Inertia of entire robot around the CoM expressed in a frame anchored
    *  in the base.
    */
   Eigen::SparseMatrix<double, Eigen::RowMajor> I_b;
+  Eigen::Matrix3d I_b_dense; ///< same as above, to evaluate without allocating.
+  Matrix3dRows I_b_rows;     ///< same as above, in the layout of srbd_kernels.
 };
 
 
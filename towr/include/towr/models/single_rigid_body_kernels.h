@@ -0,0 +1,80 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_MODELS_SINGLE_RIGID_BODY_KERNELS_H_
+#define TOWR_MODELS_SINGLE_RIGID_BODY_KERNELS_H_
+
+namespace towr {
+
+/**
+ * @brief Generated kernels of the Single Rigid Body Dynamics.
+ *
+ * Flat, common-subexpression-eliminated functions derived symbolically from
+ * the same equations as SingleRigidBodyDynamics by
+ * scripts/generate_srbd_kernels.py. They take the partial derivatives w.r.t.
+ * the physical quantities (rotation matrix, angular velocity, endeffector
+ * force,...), the chain rule to the optimization variables is then applied
+ * by SingleRigidBodyDynamics.
+ *
+ * All 3x3 and 6x3 matrices are stored row-major. The violation is split
+ * into a base part and a contact part that is summed over all endeffectors.
+ *
+ * @ingroup Robots
+ */
+namespace srbd_kernels {
+
+/** @brief Base part of the 6D violation (angular, linear). */
+void BaseViolation (double m, double g, const double* I_b, const double* w_R_b,
+                    const double* w, const double* wd, const double* acc,
+                    double* out);
+
+/** @brief Linear rows of the base part w.r.t. the linear acceleration (3x3). */
+void BaseJacobianWrtLinAcc (double m, double* d_acc);
+
+/** @brief Angular rows of the base part w.r.t. w_R_b (3x9), w (3x3) and wd (3x3). */
+void BaseJacobianWrtAng (const double* I_b, const double* w_R_b, const double* w,
+                         const double* wd, double* d_R, double* d_w, double* d_wd);
+
+/** @brief Contribution of one endeffector to the 6D violation (angular, linear). */
+void ContactViolation (const double* com, const double* p, const double* f,
+                       double* out);
+
+/** @brief Angular rows of one contact w.r.t. the CoM position (3x3). */
+void ContactJacobianWrtCom (const double* f, double* d_com);
+
+/** @brief Angular rows of one contact w.r.t. the endeffector position (3x3). */
+void ContactJacobianWrtPos (const double* f, double* d_p);
+
+/** @brief Both rows of one contact w.r.t. the endeffector force (6x3). */
+void ContactJacobianWrtForce (const double* com, const double* p, double* d_f);
+
+} /* namespace srbd_kernels */
+} /* namespace towr */
+
+#endif /* TOWR_MODELS_SINGLE_RIGID_BODY_KERNELS_H_ */
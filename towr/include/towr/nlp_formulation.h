@@ -35,6 +35,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <ifopt/cost_term.h>
 
 #include <towr/variables/spline_holder.h>
+#include <towr/variables/trajectory.h>
 #include <towr/models/robot_model.h>
 #include <towr/terrain/height_map.h>
 #include <towr/parameters.h>
@@ -78,9 +79,17 @@ public:
   using EEPos            = std::vector<Eigen::Vector3d>;
   using Vector3d         = Eigen::Vector3d;
 
+  /**
+   * @brief Prints the banner on the first construction in the process.
+   */
   NlpFormulation ();
   virtual ~NlpFormulation () = default;
 
+  /**
+   * @brief Prints the towr version and copyright information.
+   */
+  static void PrintBanner ();
+
   /**
    * @brief The ifopt variable sets that will be optimized over.
    * @param[in/out] builds fully-constructed splines from the variables.
@@ -96,6 +105,26 @@ public:
   /** @brief The ifopt costs to tune the motion. */
   ContraintPtrVec GetCosts() const;
 
+  /**
+   * @brief Moves variables built by GetVariableSets() to a new start and goal.
+   *
+   * Sets the bounds and initial values as GetVariableSets() would for the
+   * current initial_base_, final_base_, initial_ee_W_ and initial_guess_,
+   * so the constraints and costs built on them can be solved again. The
+   * model, terrain and parameters must be the ones they were built with.
+   * @param variables  The variables returned by GetVariableSets().
+   * @param s          The splines built together with them.
+   * @throws std::runtime_error for periodic or mirrored formulations, whose
+   *         constraints or shared variables depend on start and goal.
+   */
+  void ResetVariables(const VariablePtrVec& variables, const SplineHolder& s) const;
+
+  /**
+   * @returns Per endeffector the one whose variables it shares, or -1.
+   * @sa Parameters::share_mirrored_ee_
+   */
+  std::vector<int> GetMirroredEndeffectors() const;
+
 
   BaseState initial_base_;
   BaseState final_base_;
@@ -104,11 +133,24 @@ public:
   HeightMap::Ptr terrain_;
   Parameters params_;
 
+  /// if set, the variables are initialized from this motion (e.g. the
+  /// solution of a similar problem) instead of interpolating start and goal.
+  std::shared_ptr<const Trajectory> initial_guess_;
+
 private:
   // variables
+  void SetInitialGuess(const SplineHolder& s,
+                       const std::vector<NodesVariables::Ptr>& base,
+                       const std::vector<NodesVariablesPhaseBased::Ptr>& ee_motion,
+                       const std::vector<NodesVariablesPhaseBased::Ptr>& ee_force) const;
+  void ShareMirroredVariables(const std::vector<NodesVariablesPhaseBased::Ptr>& ee_motion,
+                              const std::vector<NodesVariablesPhaseBased::Ptr>& ee_force) const;
   std::vector<NodesVariables::Ptr> MakeBaseVariables() const;
   std::vector<NodesVariablesPhaseBased::Ptr> MakeEndeffectorVariables() const;
   std::vector<NodesVariablesPhaseBased::Ptr> MakeForceVariables() const;
+  void SetBaseStartAndGoal(NodesVariables& lin, NodesVariables& ang) const;
+  void SetEndeffectorStartAndGoal(int ee, NodesVariables& nodes) const;
+  void SetForceStartAndGoal(NodesVariables& nodes) const;
   std::vector<PhaseDurations::Ptr> MakeContactScheduleVariables() const;
 
   // constraints
@@ -122,11 +164,14 @@ private:
   ContraintPtrVec MakeSwingConstraint() const;
   ContraintPtrVec MakeBaseRangeOfMotionConstraint(const SplineHolder& s) const;
   ContraintPtrVec MakeBaseAccConstraint(const SplineHolder& s) const;
+  ContraintPtrVec MakePeriodicConstraint() const;
 
   // costs
   CostPtrVec GetCost(const Parameters::CostName& id, double weight) const;
   CostPtrVec MakeForcesCost(double weight) const;
   CostPtrVec MakeEEMotionCost(double weight) const;
+  CostPtrVec MakeBaseIntegralCost(Dx deriv, double weight) const;
+  CostPtrVec MakeForcesIntegralCost(Dx deriv, double weight) const;
 };
 
 } /* namespace towr */
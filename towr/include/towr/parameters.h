@@ -75,6 +75,11 @@ namespace towr {
  * to unphysical motions that will be impossible to track on a real system. The
  * more finely the constraint discretization is set, the more sure one can be
  * that the dynamic model is being respected.
+ * The base state at each of these times is computed once per iteration and
+ * shared between the constraints (BaseKinematicsCache), so choosing
+ * intervals that are multiples of each other (e.g. 0.1s for both
+ * @ref dt_constraint_dynamic_ and @ref dt_constraint_range_of_motion_)
+ * makes evaluating the constraints cheaper.
  *
  * ### Number of optimization variables ###
  * In order to shorten the solution time, another way is to use less
@@ -87,6 +92,12 @@ namespace towr {
  * it is often also required that the base motion has enough freedom (short
  * durations) to enable this.
  *
+ * Instead of uniform polynomials, AlignBaseKnotsWithContacts() places the
+ * base nodes at the times the feet touch down or lift off, where the forces
+ * and therefore the base acceleration change sharply. The polynomials in
+ * between are limited by @ref bound_base_poly_duration_, so raising its
+ * maximum spans long stance phases by fewer polynomials.
+ *
  * ### Available steps ###
  * One of the main reasons that the solver **fails to find a solution**, is when
  * there are are not enough steps available to reach a goal position that is
@@ -105,7 +116,9 @@ namespace towr {
  * few constraints that restrict the motion, so these extra and unnecessary
  * values can be set to extreme values. The cleanest way to counter this
  * is to add a cost term that e.g. penalizes base and endeffector accelerations.
- * See @ref Costs for some inspiration. We try to avoid cost terms if possible,
+ * See @ref Costs for some inspiration, e.g. BaseAccCostID or ForceRateCostID
+ * integrate these quantities over the whole motion in closed form (see
+ * SplineIntegralCost). We try to avoid cost terms if possible,
  * as they require tuning different weighing parameters w.r.t. each other and
  * make the problem slower. Other ways to remove the jittering are as follows:
  *   * Increase @ref duration_base_polynomial_ to remove some DoF.
@@ -128,6 +141,24 @@ namespace towr {
  * this option is initializing with different gaits and/or changing the
  * parameters described above.
  *
+ * ### Symmetric gaits ###
+ * In gaits where left and right legs move together (e.g. bound, pronk or
+ * biped hopping), setting @ref share_mirrored_ee_ lets each mirrored leg
+ * reuse the variables of the other one. This halves the endeffector
+ * variables of straight-line motions. Legs moving in alternation (walk,
+ * trot, pace, run) are not mirror images at the same time, but only half a
+ * cycle apart. Sharing their variables would need the nodes of one leg to
+ * line up with those of the other shifted by that time, so such gaits are
+ * rejected and keep their own variables.
+ *
+ * ### Periodic gaits ###
+ * For long, steady-state walks, the problem size grows with every step.
+ * Calling MakePeriodic() instead optimizes a single gait cycle, whose end
+ * state equals its start state shifted by the distance from the initial
+ * to the final base position. The start velocities and final base state
+ * are then free and given by this periodicity. The cycle must start and
+ * end in contact, and TileTrajectory() repeats it to the full walk.
+ *
  * @ingroup Parameters
  */
 class Parameters {
@@ -143,14 +174,33 @@ public:
                         Force,          ///< sets ForceConstraint
                         Swing,          ///< sets SwingConstraint
                         BaseRom,        ///< sets BaseMotionConstraint
-                        BaseAcc         ///< sets SplineAccConstraint
+                        BaseAcc,        ///< sets SplineAccConstraint
+                        Periodic        ///< sets PeriodicConstraint
   };
   /**
    *  @brief Indentifiers to be used to add certain costs to the optimization
    *  problem.
    */
   enum CostName       { ForcesCostID,    ///< sets NodeCost on force nodes
-                        EEMotionCostID   ///< sets NodeCost on endeffector velocity
+                        EEMotionCostID,  ///< sets NodeCost on endeffector velocity
+                        BaseAccCostID,   ///< integral of squared base acceleration
+                        BaseJerkCostID,  ///< integral of squared base jerk
+                        ForcesIntegralCostID, ///< integral of squared forces
+                        ForceRateCostID  ///< integral of squared force derivative
+  };
+
+  /**
+   * @brief The polynomials representing the base motion.
+   */
+  enum SplineBasis    { CubicHermite,   ///< nodes hold position and velocity
+                        QuinticHermite  ///< nodes additionally hold acceleration
+  };
+
+  /**
+   * @brief Where the nodes of the base motion are placed in time.
+   */
+  enum KnotPlacement  { UniformKnots,   ///< every duration_base_polynomial_
+                        ContactKnots    ///< at the contact switches of all feet
   };
 
   using CostWeights      = std::vector<std::pair<CostName, double>>;
@@ -188,6 +238,25 @@ public:
   /// Fixed duration of each cubic polynomial describing the base motion.
   double duration_base_polynomial_;
 
+  /// The polynomials of the base motion, see UseQuinticBase().
+  SplineBasis base_spline_basis_;
+
+  /// Where the base nodes are placed, see AlignBaseKnotsWithContacts().
+  KnotPlacement base_knot_placement_;
+
+  /** Minimum and maximum duration [s] of each base polynomial.
+   *
+   *  Only used when the base knots are aligned with the contacts. Switches
+   *  closer than the minimum to each other share one knot, placed at the
+   *  switch nearest to the middle of the group, and switches closer than
+   *  the minimum to the start or end snap to it. Longer intervals are split
+   *  into equal polynomials below the maximum, which defaults to twice
+   *  duration_base_polynomial_: as the acceleration changes mostly at the
+   *  knots, a phase of a typical trot is spanned by a single polynomial,
+   *  giving fewer base variables than the uniform knots.
+   */
+  std::pair<double,double> bound_base_poly_duration_;
+
   /// Number of polynomials to parameterize foot movement during swing phases.
   int ee_polynomials_per_swing_phase_;
 
@@ -203,6 +272,13 @@ public:
                    bounds_final_ang_pos_,
                    bounds_final_ang_vel_;
 
+  /// If true, endeffectors that are mirror images of each other (left/right)
+  /// and have identical phase durations share their motion and force
+  /// variables. Requires a straight motion along x and at least one such
+  /// pair, so alternating gaits (walk, trot, pace, run) are rejected. Both
+  /// feet are still constrained by the terrain.
+  bool share_mirrored_ee_;
+
   /** Minimum and maximum time [s] for each phase (swing,stance).
    *
    *  Only used when optimizing over phase durations.
@@ -214,20 +290,50 @@ public:
   /// Specifies that timings of all feet, so the gait, should be optimized.
   void OptimizePhaseDurations();
 
+  /// Specifies that the motion is one cycle of a periodic gait.
+  void MakePeriodic();
+
+  /**
+   * @brief Represents the base motion by quintic-Hermite polynomials.
+   *
+   * Their nodes also hold the acceleration, so the base acceleration is
+   * continuous by construction and the BaseAcc constraint is dropped. Each
+   * polynomial is expressive enough to span 0.2s (duration_base_polynomial_),
+   * which gives fewer variables than the default cubic polynomials.
+   */
+  void UseQuinticBase();
+
+  /**
+   * @brief Places the base nodes at the contact switches of all feet.
+   *
+   * The knots follow the initial phase durations, so when these are
+   * optimized the knots stay where the switches were initially.
+   */
+  void AlignBaseKnotsWithContacts();
+
   /// The durations of each base polynomial in the spline (lin+ang).
   VecTimes GetBasePolyDurations() const;
 
+  /// The sorted times [s] at which any foot touches down or lifts off.
+  VecTimes GetContactSwitchTimes() const;
+
   /// The number of phases allowed for endeffector ee.
   int GetPhaseCount(EEID ee) const;
 
   /// True if the phase durations should be optimized over.
   bool IsOptimizeTimings() const;
 
+  /// True if the motion is one cycle of a periodic gait.
+  bool IsPeriodic() const;
+
   /// The number of endeffectors.
   int GetEECount() const;
 
   /// Total duration [s] of the motion.
   double GetTotalTime() const;
+
+private:
+  VecTimes GetContactAlignedPolyDurations() const;
 };
 
 } // namespace towr
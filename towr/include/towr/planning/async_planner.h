@@ -0,0 +1,153 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_ASYNC_PLANNER_H_
+#define TOWR_PLANNING_ASYNC_PLANNER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <ifopt/solver.h>
+
+#include <towr/nlp_formulation.h>
+#include <towr/variables/trajectory.h>
+
+#include "double_buffer.h"
+#include "solve_monitor.h"
+
+namespace towr {
+
+/**
+ * @defgroup Planning
+ * @brief Running the optimization alongside the robot's control loop.
+ *
+ * Folder: @ref include/towr/planning
+ */
+
+/**
+ * @brief Solves motion-planning problems on a background thread.
+ *
+ * Goals are passed in as fully specified formulations and solved one after
+ * the other on a worker thread. A goal that arrives while another one is
+ * still waiting replaces the waiting one, so the worker always starts on the
+ * most recent goal. Every finished motion is published into a DoubleBuffer,
+ * from which e.g. the control thread can read the latest plan wait-free,
+ * independent of how long the optimization takes.
+ *
+ * By default a new goal also cancels the solve that is currently running,
+ * which then stops within one solver iteration and isn't published.
+ *
+ * @ingroup Planning
+ */
+class AsyncPlanner {
+public:
+  /**
+   * @brief A finished motion and where it came from.
+   */
+  struct Plan {
+    int goal_id_ = -1;        ///< the id returned by RequestPlan().
+    double solve_time_ = 0.0; ///< wall-clock time [s] spent optimizing.
+    SolveResult result_;      ///< how the solve ended and if it's feasible.
+    Trajectory trajectory_;   ///< the optimized motion.
+  };
+  using PlanBuffer = DoubleBuffer<Plan>;
+
+  /**
+   * @brief Starts the worker thread.
+   * @param solver  The solver (e.g. Ipopt) with all options already set.
+   * @param max_solve_time  Wall-clock time [s] after which a solve is
+   *                        aborted and the best iterate so far published.
+   * @param preempt  True if a new goal cancels the running solve.
+   */
+  explicit AsyncPlanner (ifopt::Solver::Ptr solver,
+                         double max_solve_time = std::numeric_limits<double>::infinity(),
+                         bool preempt = true);
+
+  /**
+   * @brief Discards waiting goals and cancels the current solve.
+   */
+  virtual ~AsyncPlanner ();
+
+  AsyncPlanner (const AsyncPlanner&) = delete;
+  AsyncPlanner& operator=(const AsyncPlanner&) = delete;
+
+  /**
+   * @brief Queues a new goal, replacing a goal that hasn't been started yet
+   *        and, if preempting, cancelling the one being solved.
+   * @param formulation  The fully specified problem to solve.
+   * @returns The id that the resulting Plan will carry.
+   */
+  int RequestPlan (const NlpFormulation& formulation);
+
+  /**
+   * @returns The most recently finished plan. Wait-free.
+   *
+   * Check ReadHandle::IsValid() before use, as no plan might be finished yet.
+   */
+  PlanBuffer::ReadHandle GetLatestPlan () const;
+
+  /**
+   * @returns True if a goal is being solved or waiting to be solved.
+   */
+  bool IsBusy () const;
+
+  /**
+   * @brief Blocks until all requested goals are solved or discarded.
+   */
+  void WaitUntilIdle ();
+
+private:
+  void Run ();
+  Plan Solve (NlpFormulation& goal, int goal_id, const CancellationToken& token);
+
+  ifopt::Solver::Ptr solver_;
+  double max_solve_time_;
+  bool preempt_;
+  PlanBuffer plans_;
+
+  mutable std::mutex mutex_;                  ///< protects the members below.
+  std::condition_variable goal_changed_;
+  std::condition_variable idle_;
+  std::unique_ptr<NlpFormulation> pending_goal_;
+  int pending_goal_id_ = -1;
+  int last_goal_id_ = -1;
+  CancellationToken running_solve_;
+  bool is_solving_ = false;
+  bool stop_ = false;
+
+  std::thread worker_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_ASYNC_PLANNER_H_ */
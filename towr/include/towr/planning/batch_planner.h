@@ -0,0 +1,141 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_BATCH_PLANNER_H_
+#define TOWR_PLANNING_BATCH_PLANNER_H_
+
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ifopt/solver.h>
+
+#include <towr/nlp_formulation.h>
+#include <towr/variables/trajectory.h>
+
+#include "solve_monitor.h"
+
+namespace towr {
+
+/**
+ * @brief Solves many independent motion-planning problems in parallel.
+ *
+ * Each problem is a fully specified NlpFormulation. The problems are handed
+ * out one at a time to a fixed number of worker threads, and the results are
+ * returned in the order of the input, independent of which thread solved
+ * which problem or how long each solve took.
+ *
+ * ### Thread-safety contract
+ * Problems may share (and usually should, to save memory and setup time):
+ *  - the RobotModel, i.e. the KinematicModel and DynamicModel. The kinematic
+ *    model is only read; every DynamicConstraint works on its own
+ *    DynamicModel::Clone(), so the shared model is never modified.
+ *  - the HeightMap, whose queries are all const.
+ *
+ * Everything that is created from a formulation (variables, constraints,
+ * costs, the SplineHolder and the ifopt::Problem) is built by the worker
+ * that solves it and never shared. Solvers are created per worker through
+ * the SolverFactory, as e.g. IpoptSolver isn't meant to be used by several
+ * threads at once. Custom models and terrains must follow the same rules:
+ * no state may be changed through const member functions.
+ *
+ * Separate IpoptSolver instances are only independent if the linear solver
+ * is re-entrant as well:
+ *  - MUMPS, as IPOPT is usually built with it (sequential, with the MPI
+ *    stub library), keeps global state and must not be used by several
+ *    threads at once. With "mumps" (the IPOPT default, also selected by
+ *    towr_ros) use a thread_count of 1.
+ *  - The HSL solvers ma57, ma86 and ma97 are thread-safe and can be used
+ *    by every worker. ma27 stores its statistics in Fortran common blocks
+ *    and should be treated like MUMPS.
+ *  - ma86/ma97 and a multi-threaded BLAS start threads of their own, so set
+ *    OMP_NUM_THREADS=1 when all cores already run a worker.
+ *
+ * @ingroup Planning
+ */
+class BatchPlanner {
+public:
+  using SolverFactory = std::function<ifopt::Solver::Ptr()>;
+
+  /**
+   * @brief The outcome of one problem of the batch.
+   */
+  struct Result {
+    double solve_time_ = 0.0; ///< wall-clock time [s] spent on this problem.
+    SolveResult result_;      ///< how the solve ended and if it's feasible.
+    Trajectory trajectory_;   ///< the optimized motion.
+    std::string error_;       ///< if not empty, why the problem couldn't be solved.
+  };
+
+  /**
+   * @param solver_factory  Creates a solver with all options set, called
+   *                        once by each worker thread.
+   * @param thread_count    Number of worker threads, 0 for one per core.
+   * @param max_solve_time  Wall-clock time [s] after which a single solve
+   *                        is aborted and its best iterate returned.
+   */
+  explicit BatchPlanner (const SolverFactory& solver_factory,
+                         int thread_count = 0,
+                         double max_solve_time = std::numeric_limits<double>::infinity());
+  virtual ~BatchPlanner () = default;
+
+  /**
+   * @brief Solves all problems and blocks until they are finished.
+   * @param problems  The formulations, may share models and terrains.
+   * @returns One result per problem, in the same order.
+   */
+  std::vector<Result> Solve (const std::vector<NlpFormulation>& problems);
+
+  /**
+   * @brief Stops the running batch, may be called from any thread.
+   *
+   * Running solves return within one iteration with status Cancelled,
+   * problems that haven't been started are returned as cancelled as well.
+   */
+  void Cancel ();
+
+  /**
+   * @returns The number of worker threads used to solve a batch.
+   */
+  int GetThreadCount () const;
+
+private:
+  SolverFactory solver_factory_;
+  int thread_count_;
+  double max_solve_time_;
+
+  std::mutex mutex_;        ///< protects the token of the running batch.
+  CancellationToken token_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_BATCH_PLANNER_H_ */
@@ -0,0 +1,146 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_DOUBLE_BUFFER_H_
+#define TOWR_PLANNING_DOUBLE_BUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace towr {
+
+/**
+ * @brief A slot that one writer fills and many readers access wait-free.
+ *
+ * The slot holds two copies of the value. The writer always fills the copy
+ * that is currently not published and then flips which copy readers see.
+ * The index of the published copy and the number of readers that entered
+ * it are packed into a single atomic word, so a reader registers itself
+ * and learns which copy to read in one atomic instruction. Readers count
+ * themselves out per copy when released. When flipping, the writer takes
+ * the number of readers that entered the old copy, and before overwriting
+ * it the next time waits until as many have left. Readers therefore never
+ * block or retry, and only ever register on the published copy, so the
+ * writer only waits for readers that still hold the copy it overwrites.
+ *
+ * Only a single thread may call Write(), any number of threads Read().
+ *
+ * @ingroup Planning
+ */
+template<typename T>
+class DoubleBuffer {
+public:
+  /**
+   * @brief Read access to the published value, released on destruction.
+   *
+   * Keep the handle only as long as needed, as the writer can't overwrite
+   * this copy while it is held.
+   */
+  class ReadHandle {
+  public:
+    ReadHandle (ReadHandle&& other) : buffer_(other.buffer_), id_(other.id_)
+    {
+      other.buffer_ = nullptr;
+    }
+
+    ~ReadHandle ()
+    {
+      if (buffer_)
+        buffer_->left_[id_].fetch_add(1, std::memory_order_release);
+    }
+
+    /** @returns True if a value has been written before. */
+    bool IsValid() const { return GetVersion() > 0; }
+
+    /** @returns How many values have been written up to this one. */
+    uint64_t GetVersion() const { return buffer_->versions_[id_]; }
+
+    const T& operator*() const { return buffer_->values_[id_]; }
+    const T* operator->() const { return &buffer_->values_[id_]; }
+
+  private:
+    friend class DoubleBuffer;
+    ReadHandle (const DoubleBuffer* buffer, int id) : buffer_(buffer), id_(id) {}
+    ReadHandle (const ReadHandle&) = delete;
+    ReadHandle& operator=(const ReadHandle&) = delete;
+
+    const DoubleBuffer* buffer_;
+    int id_;
+  };
+
+  DoubleBuffer () : state_(0), left_{{0}, {0}}, versions_{0, 0} {}
+
+  /**
+   * @returns The most recently written value. Wait-free.
+   */
+  ReadHandle Read () const
+  {
+    uint64_t state = state_.fetch_add(kReader, std::memory_order_acq_rel);
+    return ReadHandle(this, state & kIndexMask);
+  }
+
+  /**
+   * @brief Publishes a new value, replacing the previous one.
+   */
+  void Write (T value)
+  {
+    int id = 1 - (state_.load(std::memory_order_relaxed) & kIndexMask);
+
+    // readers that entered while this copy was published may still use it,
+    // no new ones can enter as it isn't published anymore.
+    while (left_[id].load(std::memory_order_acquire) != entered_[id])
+      std::this_thread::yield();
+    left_[id].store(0, std::memory_order_relaxed);
+    entered_[id] = 0;
+
+    values_[id]   = std::move(value);
+    versions_[id] = ++write_count_;
+
+    uint64_t state = state_.exchange(id, std::memory_order_acq_rel);
+    entered_[1-id] = state / kReader;
+  }
+
+private:
+  // bit 0: index of the published copy, bits 1-63: readers that entered it.
+  static constexpr uint64_t kIndexMask = 1;
+  static constexpr uint64_t kReader    = 2;
+
+  mutable std::atomic<uint64_t> state_;
+  mutable std::atomic<uint64_t> left_[2]; ///< released readers of each copy.
+  uint64_t entered_[2] = {0, 0};          ///< readers of each unpublished copy.
+  T values_[2];
+  uint64_t versions_[2];
+  uint64_t write_count_ = 0;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_DOUBLE_BUFFER_H_ */
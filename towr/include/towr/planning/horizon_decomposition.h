@@ -0,0 +1,140 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_HORIZON_DECOMPOSITION_H_
+#define TOWR_PLANNING_HORIZON_DECOMPOSITION_H_
+
+#include <limits>
+#include <vector>
+
+#include <towr/nlp_formulation.h>
+#include <towr/variables/trajectory.h>
+
+#include "batch_planner.h"
+
+namespace towr {
+
+/**
+ * @brief Settings of the HorizonDecomposition.
+ */
+struct HorizonDecompositionOptions {
+  int window_count_ = 4;
+  double overlap_ = 0.6;      ///< time [s] neighbouring windows share.
+  int max_iterations_ = 10;   ///< rounds of parallel window solves.
+  double tolerance_ = 1e-3;   ///< max disagreement [m, m/s] at the seams, without forces.
+  double relaxation_ = 1.0;   ///< step towards the neighbour's state, (0,1].
+  int thread_count_ = 0;      ///< 0 for one per core.
+  double max_solve_time_ = std::numeric_limits<double>::infinity(); ///< per window solve.
+};
+
+
+/**
+ * @brief Solves a long motion as overlapping windows in parallel.
+ *
+ * The solve time of one NLP grows superlinearly with its horizon. Instead,
+ * the horizon is split into overlapping windows, which are solved in
+ * parallel. Each window starts at the state its predecessor reaches at that
+ * time, and ends at the state its successor passes through at that time
+ * (overlapping Schwarz decomposition). Since these boundary states come from
+ * the previous round, the windows are solved again, warm-started, until the
+ * neighbours agree on the state in the middle of their overlap (the seam).
+ * The windows are then stitched together at the seams.
+ *
+ * The seam error compares the base states and endeffector positions, the
+ * quantities the windows exchange. Forces are not compared: no boundary
+ * condition of a window constrains them (nor the base acceleration), so
+ * more rounds wouldn't make them agree. They can therefore jump at the
+ * seams, where Stitch() takes the average of both neighbours.
+ *
+ * Window boundaries and seams are placed where all feet are in contact,
+ * as close as possible to evenly split the horizon, such that neighbours
+ * overlap. The phase durations of
+ * the problem are kept and can't be optimized.
+ *
+ * @ingroup Planning
+ */
+class HorizonDecomposition {
+public:
+  /**
+   * @brief One part of the horizon and its problem.
+   */
+  struct Window {
+    double t_start_;   ///< global time [s] at which the window starts.
+    double t_end_;
+    double t_seam_;    ///< end of the part used from this window.
+    NlpFormulation formulation_; ///< in window time, starting at zero.
+  };
+
+  /**
+   * @brief The stitched motion and how the coordination went.
+   */
+  struct Result {
+    Trajectory trajectory_;   ///< the whole motion, stitched at the seams.
+    int iteration_count_ = 0; ///< rounds of window solves.
+    double seam_error_ = std::numeric_limits<double>::infinity(); ///< of the last round.
+    bool converged_ = false;  ///< seam error below tolerance.
+    std::vector<BatchPlanner::Result> window_results_; ///< of the last round.
+  };
+
+  HorizonDecomposition (const BatchPlanner::SolverFactory& solver_factory,
+                        const HorizonDecompositionOptions& options = HorizonDecompositionOptions());
+  virtual ~HorizonDecomposition () = default;
+
+  /**
+   * @brief Solves the problem window by window and stitches the result.
+   * @param problem  The whole motion, of which the phase durations are fixed.
+   */
+  Result Solve (const NlpFormulation& problem) const;
+
+  /**
+   * @brief Splits the problem into windows with boundaries in full stance.
+   *
+   * The boundary states are initialized by moving the base linearly from
+   * start to goal, with the feet at their nominal stance below it.
+   */
+  std::vector<Window> GetWindows (const NlpFormulation& problem) const;
+
+  /**
+   * @brief Joins the window solutions at the seams.
+   * @param problem  The whole motion, providing the contact schedule.
+   * @param windows  The windows the motions belong to.
+   * @param motions  The solution of each window, in window time.
+   */
+  static Trajectory Stitch (const NlpFormulation& problem,
+                            const std::vector<Window>& windows,
+                            const std::vector<Trajectory>& motions);
+
+private:
+  BatchPlanner::SolverFactory solver_factory_;
+  HorizonDecompositionOptions options_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_HORIZON_DECOMPOSITION_H_ */
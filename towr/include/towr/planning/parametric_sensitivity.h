@@ -0,0 +1,166 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_PARAMETRIC_SENSITIVITY_H_
+#define TOWR_PLANNING_PARAMETRIC_SENSITIVITY_H_
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <Eigen/SparseLU>
+
+#include <ifopt/problem.h>
+
+#include <towr/nlp_formulation.h>
+
+namespace towr {
+
+/**
+ * @brief Updates a solved motion to a slightly different start and goal.
+ *
+ * The parameters p are the initial and final base state and the initial
+ * endeffector positions of the formulation. They enter the NLP only
+ * through the bounds of variables and constraints, so at a solution x*
+ * the constraints that are active (at one of their bounds) define how x*
+ * moves with p: the active variables follow their bounds, and the free
+ * variables x_F and the multipliers of the active constraints follow from
+ * the KKT conditions, linearized around the solution,
+ *
+ *     [ H_FF  J_AF^T ] [ dx_F   ]   [ -H_Fx dx_x             ]
+ *     [ J_AF  0      ] [ dlambda] = [ db_A/dp dp - J_Ax dx_x ],
+ *
+ * where dx_x is the change of the active variables and H the Hessian of
+ * the Lagrangian. The solvers don't expose the multipliers or H, so
+ * Linearize() estimates the multipliers from grad f + J_AF^T lambda = 0 by
+ * least squares and approximates H by compressed finite differences of
+ * grad f + J^T lambda. Its sparsity is taken from the active constraints
+ * and the cost terms, each of which is assumed to couple all variables it
+ * depends on. The sparse KKT matrix is factorized once and slightly
+ * regularized, so redundant active constraints and directions without
+ * curvature take the smallest step. Predict() is then only a matrix-vector
+ * product, and Correct() does one Newton step on the KKT conditions of the
+ * perturbed problem, reusing the factorization.
+ *
+ * This is accurate for perturbations that don't change the active set
+ * (which contacts and limits are at their bounds); larger changes should
+ * be solved again, warm started from the prediction.
+ *
+ * @ingroup Planning
+ */
+class ParametricSensitivity {
+public:
+  using VectorXd = Eigen::VectorXd;
+  using MatrixXd = Eigen::MatrixXd;
+  using Jacobian = ifopt::Problem::Jacobian;
+  using SparseMatrix = Eigen::SparseMatrix<double>;
+
+  /**
+   * @param formulation  The formulation the solved problem was built from.
+   * @param active_tolerance  Distance to a bound at which it is active.
+   */
+  explicit ParametricSensitivity (const NlpFormulation& formulation,
+                                  double active_tolerance = 1e-6);
+  virtual ~ParametricSensitivity () = default;
+
+  /**
+   * @brief Computes the sensitivity at the current variables of the problem.
+   * @param nlp  The problem built from the formulation, usually solved.
+   * @throws std::runtime_error if nlp wasn't built from the formulation.
+   */
+  void Linearize (ifopt::Problem& nlp);
+
+  /**
+   * @returns The first order prediction of the solution of the perturbed
+   *          formulation, which must only differ in its start and goal.
+   */
+  VectorXd Predict (const NlpFormulation& perturbed) const;
+
+  /**
+   * @brief One Newton step on the KKT conditions of the perturbed problem,
+   *        starting from the current variables of nlp.
+   * @returns The corrected variables, which are also set in nlp.
+   */
+  VectorXd Correct (ifopt::Problem& nlp, const NlpFormulation& perturbed) const;
+
+  /**
+   * @brief Sets the variables of nlp to the predicted (and corrected) solution.
+   *
+   * Afterwards the SplineHolder of nlp holds the updated motion.
+   */
+  void Update (ifopt::Problem& nlp, const NlpFormulation& perturbed,
+               bool correct = true) const;
+
+  /**
+   * @returns The initial/final base lin/ang position/velocity followed by
+   *          the initial endeffector positions of a formulation.
+   */
+  static VectorXd GetParameters (const NlpFormulation& formulation);
+
+  /** @returns dx/dp, variables x parameters. */
+  const MatrixXd& GetSensitivity () const { return dx_dp_; }
+
+  /** @returns The number of constraints and variables at their bounds. */
+  int GetActiveCount () const;
+
+private:
+  /// the lower and upper bounds of variables and constraints.
+  struct Bounds {
+    VectorXd x_lower_, x_upper_, g_lower_, g_upper_;
+  };
+
+  static Bounds GetBounds (ifopt::Problem& nlp);
+  static Bounds GetBounds (NlpFormulation formulation, const VectorXd& p);
+  static void SetParameters (NlpFormulation& formulation, const VectorXd& p);
+  static VectorXd GetLagrangianGradient (ifopt::Problem& nlp, const VectorXd& x,
+                                         const VectorXd& lambda);
+  Jacobian GetLagrangianHessian (ifopt::Problem& nlp, const VectorXd& lambda) const;
+  VectorXd GetParameterChange (const NlpFormulation& perturbed) const;
+  VectorXd GetMultipliers (const VectorXd& dp, int n_constraints) const;
+
+  NlpFormulation formulation_;
+  double active_tolerance_;
+
+  VectorXd p0_;         ///< parameters at the linearization point.
+  VectorXd x0_;         ///< variables at the linearization point.
+  MatrixXd dx_dp_;      ///< sensitivity of the solution.
+
+  std::vector<int> free_;           ///< variables not at a bound.
+  std::vector<int> fixed_;          ///< variables at a bound.
+  std::vector<int> active_g_;       ///< constraints at a bound.
+  VectorXd active_g_bound_;         ///< the bound each active constraint is at.
+  MatrixXd active_g_bound_dp_;      ///< how this bound changes with p.
+  VectorXd lambda0_;                ///< multipliers of the active constraints.
+  MatrixXd dlambda_dp_;             ///< sensitivity of the multipliers.
+  Eigen::SparseLU<SparseMatrix> kkt_; ///< KKT matrix of the free variables.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_PARAMETRIC_SENSITIVITY_H_ */
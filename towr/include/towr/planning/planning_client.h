@@ -0,0 +1,182 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_PLANNING_CLIENT_H_
+#define TOWR_PLANNING_PLANNING_CLIENT_H_
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "planning_protocol.h"
+
+// This file is self-contained (no Eigen, towr or ROS dependencies), so it
+// can be copied into the code base of any client of the PlanningServer.
+
+namespace towr {
+
+/**
+ * @brief Minimal blocking client of the PlanningServer.
+ *
+ * Several requests may be sent before receiving, the replies then arrive
+ * in the order the server finishes them. Not thread-safe, use one client
+ * per thread.
+ *
+ * @ingroup Planning
+ */
+class PlanningClient {
+public:
+  using PlanRequest = planning_protocol::PlanRequest;
+  using PlanReply   = planning_protocol::PlanReply;
+
+  /**
+   * @brief Connects to the server listening on a Unix socket.
+   */
+  explicit PlanningClient (const std::string& socket_path)
+  {
+    sockaddr_un addr;
+    if (socket_path.size() >= sizeof(addr.sun_path))
+      return;
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, socket_path.c_str());
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ >= 0 && connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+  }
+
+  virtual ~PlanningClient ()
+  {
+    if (fd_ >= 0)
+      close(fd_);
+  }
+
+  PlanningClient (const PlanningClient&) = delete;
+  PlanningClient& operator=(const PlanningClient&) = delete;
+
+  bool IsConnected () const { return fd_ >= 0; };
+
+  /**
+   * @brief Sends a request without waiting for the reply.
+   * @returns The id of the request, 0 if the connection failed.
+   */
+  uint32_t Send (const PlanRequest& request)
+  {
+    using namespace planning_protocol;
+    MessageHeader header;
+    header.magic_      = kMagic;
+    header.version_    = kVersion;
+    header.type_       = kPlanRequest;
+    header.request_id_ = ++last_request_id_;
+    header.size_       = sizeof(PlanRequest);
+
+    if (!Write(&header, sizeof(header)) || !Write(&request, sizeof(request)))
+      return 0;
+
+    return header.request_id_;
+  }
+
+  /**
+   * @brief Blocks until the next reply arrives.
+   * @param[out] request_id  The id of the request this reply belongs to.
+   * @param[out] reply       How the solve ended.
+   * @param[out] trajectory  The motion in the shm payload format, can be
+   *                         evaluated through SharedTrajectoryView.
+   * @returns False if the connection failed or the server misbehaved.
+   */
+  bool Receive (uint32_t& request_id, PlanReply& reply, std::vector<char>& trajectory)
+  {
+    using namespace planning_protocol;
+    MessageHeader header;
+    if (!Read(&header, sizeof(header)))
+      return false;
+
+    if (header.magic_ != kMagic || header.version_ != kVersion ||
+        header.type_ != kPlanReply || header.size_ < sizeof(PlanReply) ||
+        header.size_ > kMaxMessageSize) {
+      close(fd_);
+      fd_ = -1;
+      return false;
+    }
+
+    if (!Read(&reply, sizeof(reply)) || reply.trajectory_size_ != header.size_-sizeof(PlanReply))
+      return false;
+
+    trajectory.resize(reply.trajectory_size_);
+    request_id = header.request_id_;
+    return Read(trajectory.data(), trajectory.size());
+  }
+
+private:
+  int fd_ = -1;
+  uint32_t last_request_id_ = 0;
+
+  bool Write (const void* data, std::size_t size)
+  {
+    const char* p = static_cast<const char*>(data);
+    while (fd_ >= 0 && size > 0) {
+      ssize_t n = send(fd_, p, size, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      p += n;
+      size -= n;
+    }
+    return fd_ >= 0;
+  }
+
+  bool Read (void* data, std::size_t size)
+  {
+    char* p = static_cast<char*>(data);
+    while (fd_ >= 0 && size > 0) {
+      ssize_t n = recv(fd_, p, size, 0);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      p += n;
+      size -= n;
+    }
+    return fd_ >= 0;
+  }
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_PLANNING_CLIENT_H_ */
@@ -0,0 +1,106 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_PLANNING_PROTOCOL_H_
+#define TOWR_PLANNING_PLANNING_PROTOCOL_H_
+
+#include <cstdint>
+
+// This file is self-contained (no Eigen, towr or ROS dependencies), so it
+// can be copied into the code base of any client of the PlanningServer.
+
+namespace towr {
+
+/**
+ * @brief Binary messages exchanged with the PlanningServer.
+ *
+ * Every message is a MessageHeader followed by size_ bytes of body, all
+ * values native-endian (client and server run on the same machine):
+ *
+ *   client -> server:  MessageHeader, PlanRequest
+ *   server -> client:  MessageHeader, PlanReply, trajectory
+ *
+ * Replies carry the request_id_ of their request, but are sent in the order
+ * the requests finish, not the order they were sent. The trajectory is in
+ * the payload format of the shared-memory ring (see the shm namespace), so
+ * it can be evaluated in place with SharedTrajectoryView.
+ */
+namespace planning_protocol {
+
+static const uint32_t kMagic   = 0x50574f54; ///< "TOWP" in little-endian.
+static const uint16_t kVersion = 2;          ///< increased on layout changes, also of the payload.
+static const uint32_t kMaxMessageSize = 64u<<20; ///< larger bodies are rejected.
+
+enum MessageType : uint16_t { kPlanRequest = 1, kPlanReply = 2 };
+
+struct MessageHeader {
+  uint32_t magic_;
+  uint16_t version_;
+  uint16_t type_;        ///< MessageType.
+  uint32_t request_id_;  ///< chosen by the client, copied into the reply.
+  uint32_t size_;        ///< bytes of the body following this header.
+};
+
+enum RequestFlags : uint32_t { kOptimizePhaseDurations = 1 };
+
+struct PlanRequest {
+  int32_t robot_;            ///< RobotModel::Robot.
+  int32_t terrain_;          ///< HeightMap::TerrainID or a registered handle.
+  int32_t gait_;             ///< GaitGenerator::Combos.
+  int32_t priority_;         ///< higher priorities are solved first.
+  double total_duration_;    ///< duration [s] of the motion.
+  double max_solve_time_;    ///< wall-clock limit [s], <= 0 for the server default.
+  double initial_base_[6];   ///< x, y, z [m], roll, pitch, yaw [rad].
+  double final_base_[6];     ///< x, y, z [m], roll, pitch, yaw [rad].
+  uint32_t flags_;           ///< RequestFlags.
+  uint32_t reserved_;
+};
+
+enum ReplyStatus : int32_t {
+  kFinished        = 0,  ///< solver terminated on its own.
+  kCancelled       = 1,  ///< server shut down during the solve.
+  kDeadlineReached = 2,  ///< the best iterate when max_solve_time_ ran out.
+  kRejected        = -1, ///< queue full or invalid request, nothing solved.
+  kFailed          = -2, ///< formulating or solving the problem threw.
+};
+
+struct PlanReply {
+  int32_t status_;               ///< ReplyStatus.
+  uint32_t is_feasible_;         ///< 1 if all constraints are satisfied.
+  double constraint_violation_;  ///< maximum violation of any bound.
+  double queue_time_;            ///< time [s] from receiving to starting the solve.
+  double solve_time_;            ///< wall-clock time [s] of the solve.
+  uint32_t iteration_count_;
+  uint32_t trajectory_size_;     ///< bytes of the trajectory following the reply.
+};
+
+} /* namespace planning_protocol */
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_PLANNING_PROTOCOL_H_ */
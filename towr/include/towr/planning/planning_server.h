@@ -0,0 +1,223 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_PLANNING_SERVER_H_
+#define TOWR_PLANNING_PLANNING_SERVER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <towr/models/robot_model.h>
+#include <towr/nlp_formulation.h>
+#include <towr/terrain/height_map.h>
+
+#include "batch_planner.h"
+#include "planning_protocol.h"
+#include "solution_cache.h"
+
+namespace towr {
+
+/**
+ * @brief Serves planning requests from other processes over a Unix socket.
+ *
+ * Requests (robot, terrain handle, start/goal, gait) arrive through the
+ * binary planning_protocol, are queued by priority (and in order of arrival
+ * within one priority) and solved by a pool of worker threads. Each reply
+ * carries the trajectory in the compact shm payload format.
+ *
+ * Robot models and terrains are loaded once on first use and then shared
+ * read-only by all workers (see the thread-safety contract of BatchPlanner).
+ * Each worker keeps its solver and the built variables, constraints and
+ * costs per robot, terrain and gait between requests, so a request only
+ * resets the bounds and initial values to its start and goal
+ * (see NlpFormulation::ResetVariables()).
+ *
+ * The workers solve concurrently, so the solvers of the factory must be
+ * re-entrant, including their linear solver: with MUMPS (the IPOPT
+ * default) or ma27 use a worker_count of 1, see BatchPlanner.
+ *
+ * Replies are queued per connection and sent without blocking, so a client
+ * that doesn't read its replies stalls neither the workers nor the others.
+ *
+ * Requests of a client that disconnects are dropped without being solved.
+ *
+ * @ingroup Planning
+ */
+class PlanningServer {
+public:
+  using PlanRequest = planning_protocol::PlanRequest;
+
+  /**
+   * @brief Creates the listening socket and starts the worker threads.
+   * @param socket_path     Path of the Unix socket, an old one is replaced.
+   * @param solver_factory  Creates the solver of each worker, which must be
+   *                        re-entrant if there is more than one worker.
+   * @param worker_count    Number of worker threads, 0 for one per core.
+   * @param max_solve_time  Default wall-clock limit [s] of each solve.
+   * @param queue_capacity  Requests exceeding this are rejected immediately.
+   * @throws std::runtime_error if the socket can't be created.
+   */
+  PlanningServer (const std::string& socket_path,
+                  const BatchPlanner::SolverFactory& solver_factory,
+                  int worker_count = 0,
+                  double max_solve_time = std::numeric_limits<double>::infinity(),
+                  int queue_capacity = 1000);
+
+  /**
+   * @brief Stops the workers, closes all connections and removes the socket.
+   */
+  virtual ~PlanningServer ();
+
+  PlanningServer (const PlanningServer&) = delete;
+  PlanningServer& operator=(const PlanningServer&) = delete;
+
+  /**
+   * @brief Makes a terrain available to requests under a handle.
+   *
+   * Handles that aren't registered are interpreted as HeightMap::TerrainID,
+   * these have version 0. Must be called before Run().
+   *
+   * @param version  Identifies the content of the terrain, also across
+   *                 restarts, e.g. the revision of the map it was built from.
+   *                 Cached solutions, also those loaded from a file, are
+   *                 only reused for the same handle and version.
+   */
+  void RegisterTerrain (int handle, const HeightMap::Ptr& terrain, int version);
+
+  /**
+   * @brief Answers repeated requests from a cache of feasible solutions.
+   *
+   * Exact hits are replied without solving, otherwise the nearest cached
+   * solution is the initial guess. Feasible solutions are added to the cache.
+   * Must be called before Run().
+   */
+  void SetSolutionCache (const std::shared_ptr<SolutionCache>& cache);
+
+  /**
+   * @brief Accepts connections and requests until Stop() is called.
+   */
+  void Run ();
+
+  /**
+   * @brief Makes Run() return. Async-signal-safe, may be called from anywhere.
+   */
+  void Stop ();
+
+  /**
+   * @brief Builds the problem described by a request.
+   * @param request  The robot, gait, start and goal.
+   * @param model    The model of request.robot_.
+   * @param terrain  The terrain of request.terrain_.
+   */
+  static NlpFormulation GetFormulation (const PlanRequest& request,
+                                        const RobotModel& model,
+                                        const HeightMap::Ptr& terrain);
+
+private:
+  struct Connection {
+    int fd_ = -1;
+    std::mutex mutex_;          ///< protects closed_ and outbox_.
+    bool closed_ = false;       ///< set when the client disconnected.
+    std::vector<char> outbox_;  ///< replies the socket didn't accept yet.
+    std::vector<char> buffer_;  ///< received bytes of incomplete messages.
+  };
+
+  struct Job {
+    int priority_;
+    uint64_t sequence_;         ///< order of arrival.
+    std::shared_ptr<Connection> connection_;
+    uint32_t request_id_;
+    PlanRequest request_;
+    std::chrono::steady_clock::time_point received_;
+  };
+
+  /// higher priority first, then first come, first served.
+  struct JobOrder {
+    bool operator()(const Job& a, const Job& b) const
+    {
+      if (a.priority_ != b.priority_)
+        return a.priority_ < b.priority_;
+      return a.sequence_ > b.sequence_;
+    }
+  };
+
+  void Work ();
+  /// queues the reply and sends as much as the socket accepts.
+  void Reply (Connection& connection, uint32_t request_id,
+              const planning_protocol::PlanReply& reply,
+              const std::vector<char>& trajectory) const;
+  /// @returns false if the client disconnected. Requires the connection's mutex.
+  static bool SendQueued (Connection& connection);
+  /// makes Run() poll again, e.g. to wait until a socket accepts replies.
+  void Wake () const;
+  /// @returns false if the client disconnected or broke the protocol.
+  bool ReadRequests (const std::shared_ptr<Connection>& connection);
+  bool Enqueue (const std::shared_ptr<Connection>& connection,
+                uint32_t request_id, const PlanRequest& request);
+
+  RobotModel GetRobotModel (int robot);
+  HeightMap::Ptr GetTerrain (int handle);
+  int GetTerrainVersion (int handle);
+
+  std::string socket_path_;
+  int listen_fd_ = -1;
+  int wake_pipe_[2] = {-1, -1};  ///< written to by Wake() to wake up Run().
+  std::atomic<bool> stop_{false};
+  BatchPlanner::SolverFactory solver_factory_;
+  double max_solve_time_;
+  int queue_capacity_;
+
+  std::mutex models_mutex_;      ///< protects the loaded models and terrains.
+  std::map<int, RobotModel> models_;
+  std::map<int, HeightMap::Ptr> terrains_;
+  std::map<int, int> terrain_versions_;
+  std::shared_ptr<SolutionCache> cache_;
+
+  std::mutex queue_mutex_;       ///< protects the members below.
+  std::condition_variable job_added_;
+  std::priority_queue<Job, std::vector<Job>, JobOrder> jobs_;
+  uint64_t job_count_ = 0;
+  bool stop_workers_ = false;
+  CancellationToken shutdown_;   ///< cancels running solves on destruction.
+
+  std::vector<std::thread> workers_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_PLANNING_SERVER_H_ */
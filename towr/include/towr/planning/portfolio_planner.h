@@ -0,0 +1,139 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_PORTFOLIO_PLANNER_H_
+#define TOWR_PLANNING_PORTFOLIO_PLANNER_H_
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <towr/nlp_formulation.h>
+#include <towr/variables/trajectory.h>
+
+#include "batch_planner.h"
+#include "solve_monitor.h"
+
+namespace towr {
+
+/**
+ * @brief Solves several variants of one problem in parallel, keeps the best.
+ *
+ * Which gait, initialization or solver setting works for a given terrain is
+ * often not known in advance. Instead of trying them one after the other,
+ * all variants are solved at the same time, on a pool of threads. Either
+ * the first feasible solution is returned and all other solves are
+ * cancelled, or all variants run until the deadline and the best one is
+ * returned.
+ *
+ * Variants differ in their formulation (e.g. gait, initial_guess_) and their
+ * solver, e.g. one factory setting Ipopt's "mu_strategy" to "adaptive" and
+ * another one to "monotone".
+ *
+ * At most thread_count variants are solved at once, the others wait for a
+ * free thread and aren't started anymore once a solution was selected. The
+ * formulations and solver factories must follow the thread-safety contract
+ * of the BatchPlanner; in particular, with a linear solver that isn't
+ * re-entrant (e.g. MUMPS, the IPOPT default) use a thread_count of 1.
+ *
+ * @ingroup Planning
+ */
+class PortfolioPlanner {
+public:
+  /**
+   * @brief One way of solving the problem.
+   */
+  struct Variant {
+    std::string name_;                             ///< for reporting only.
+    NlpFormulation formulation_;
+    BatchPlanner::SolverFactory solver_factory_;   ///< solver with its options.
+  };
+
+  /**
+   * @brief How a variant ended.
+   */
+  struct Outcome {
+    SolveResult result_;
+    double cost_ = std::numeric_limits<double>::infinity(); ///< of the final iterate.
+    double solve_time_ = 0.0;
+    std::string error_;   ///< if not empty, why the variant couldn't be solved.
+  };
+
+  /**
+   * @brief The selected solution and how all variants ended.
+   */
+  struct Result {
+    int variant_ = -1;              ///< index of the selected variant, -1 if none.
+    Trajectory trajectory_;         ///< the motion of the selected variant.
+    std::vector<Outcome> outcomes_; ///< one per variant, in input order.
+  };
+
+  /**
+   * @param deadline  Wall-clock time [s] after which all solves are stopped.
+   * @param first_feasible  If true, returns the first feasible solution and
+   *                        cancels the others, otherwise waits for all.
+   * @param thread_count  Variants solved at once, 0 for one per core.
+   */
+  explicit PortfolioPlanner (double deadline = std::numeric_limits<double>::infinity(),
+                             bool first_feasible = true,
+                             int thread_count = 0);
+  virtual ~PortfolioPlanner () = default;
+
+  /**
+   * @brief Solves all variants and blocks until a solution is selected.
+   *
+   * The selected variant is the first one that finished feasible, or, if
+   * waiting for all of them, the feasible one with the lowest cost. If none
+   * is feasible, the one with the smallest constraint violation is selected.
+   */
+  Result Solve (const std::vector<Variant>& variants) const;
+
+  /**
+   * @brief Creates one variant per gait combination (GaitGenerator::Combos).
+   * @param formulation  The problem, of which the phase durations are replaced.
+   * @param solver_factory  The solver used for all variants.
+   */
+  static std::vector<Variant>
+  MakeGaitVariants (const NlpFormulation& formulation,
+                    const BatchPlanner::SolverFactory& solver_factory);
+
+  /**
+   * @returns The number of variants solved at once.
+   */
+  int GetThreadCount () const;
+
+private:
+  double deadline_;
+  bool first_feasible_;
+  int thread_count_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_PORTFOLIO_PLANNER_H_ */
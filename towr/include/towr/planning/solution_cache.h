@@ -0,0 +1,159 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_SOLUTION_CACHE_H_
+#define TOWR_PLANNING_SOLUTION_CACHE_H_
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <towr/nlp_formulation.h>
+#include <towr/variables/trajectory.h>
+
+namespace towr {
+
+/**
+ * @brief Stores solved motions to answer repeated and similar requests.
+ *
+ * Solutions are grouped by everything that changes the structure of the
+ * problem (robot, terrain and its version, gait, duration, flags). Within a group
+ * they are identified by their start and goal base pose, quantized to a
+ * resolution: a request for the same quantized start/goal is an exact hit
+ * and can be answered without solving. Otherwise a k-d tree over the
+ * start/goal space of the group returns the nearest solved motion, which
+ * is a good initial guess (see NlpFormulation::initial_guess_).
+ *
+ * The cache can be saved to and loaded from a trajectory file, e.g. to
+ * pre-populate it offline. All member functions are thread-safe.
+ *
+ * @ingroup Planning
+ */
+class SolutionCache {
+public:
+  using TrajectoryPtr = std::shared_ptr<const Trajectory>;
+  static constexpr int kPoseDim = 12; ///< start and goal base x,y,z,roll,pitch,yaw.
+  using Pose = std::array<double, kPoseDim>;
+
+  /**
+   * @brief Describes a problem to look up.
+   */
+  struct Problem {
+    int robot_ = 0;            ///< e.g. RobotModel::Robot.
+    int terrain_ = 0;          ///< e.g. HeightMap::TerrainID or a handle.
+    int terrain_version_ = 0;  ///< identifies the terrain's content, also across processes.
+    int gait_ = 0;             ///< e.g. GaitGenerator::Combos.
+    uint32_t flags_ = 0;       ///< e.g. planning_protocol::RequestFlags.
+    double total_duration_ = 0.0;
+    Pose pose_ = Pose();       ///< start base pose followed by goal base pose.
+  };
+
+  /**
+   * @brief Fills the duration, start and goal of a problem from a formulation.
+   */
+  static Problem GetProblem (int robot, int terrain, int terrain_version,
+                             int gait, uint32_t flags,
+                             const NlpFormulation& formulation);
+
+  /**
+   * @param resolution  Start/goal values closer than this [m or rad] are
+   *                    considered the same for exact hits.
+   */
+  explicit SolutionCache (double resolution = 0.01);
+  virtual ~SolutionCache () = default;
+
+  /**
+   * @brief Adds a solution, replacing one with the same quantized problem.
+   */
+  void Insert (const Problem& problem, const TrajectoryPtr& solution);
+
+  /**
+   * @returns The solution of the same quantized problem, nullptr if none.
+   */
+  TrajectoryPtr Find (const Problem& problem) const;
+
+  /**
+   * @returns The solution of the same group with the closest start/goal,
+   *          nullptr if the group is empty.
+   * @param[out] distance  If given, the Euclidean start/goal distance.
+   */
+  TrajectoryPtr FindNearest (const Problem& problem, double* distance = nullptr) const;
+
+  /** @returns The number of stored solutions. */
+  int GetSize () const;
+
+  /**
+   * @brief Writes all solutions into a trajectory file.
+   */
+  void Save (const std::string& path) const;
+
+  /**
+   * @brief Adds all solutions stored in a trajectory file by Save().
+   * @throws std::runtime_error if the file isn't a saved cache.
+   */
+  void Load (const std::string& path);
+
+private:
+  using GroupKey     = std::tuple<int, int, int, int, uint32_t, int64_t>;
+  using QuantizedKey = std::array<int64_t, kPoseDim>;
+
+  /// node of a k-d tree, splitting at the pose of the entry along axis_.
+  struct TreeNode {
+    int entry_;
+    int axis_;
+    int left_  = -1;
+    int right_ = -1;
+  };
+
+  struct Group {
+    std::vector<Problem> problems_;
+    std::vector<TrajectoryPtr> solutions_;
+    std::map<QuantizedKey, int> exact_;  ///< quantized pose -> entry.
+    std::vector<TreeNode> tree_;         ///< root is tree_.front().
+  };
+
+  GroupKey GetGroupKey (const Problem& p) const;
+  QuantizedKey Quantize (const Pose& pose) const;
+  static void AddToTree (Group& group, int entry);
+  static void FindNearest (const Group& group, int node, const Pose& pose,
+                           int& best, double& best_dist2);
+
+  double resolution_;
+  mutable std::mutex mutex_;  ///< protects the groups.
+  std::map<GroupKey, Group> groups_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_SOLUTION_CACHE_H_ */
@@ -0,0 +1,177 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_SOLVE_MONITOR_H_
+#define TOWR_PLANNING_SOLVE_MONITOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include <ifopt/problem.h>
+#include <ifopt/solver.h>
+#include <ifopt/variable_set.h>
+
+namespace towr {
+
+/**
+ * @brief A flag shared between copies, used to request the end of a solve.
+ *
+ * Copies of a token refer to the same flag, so the thread that started a
+ * solve can hand a copy to another thread, which then cancels it.
+ *
+ * @ingroup Planning
+ */
+class CancellationToken {
+public:
+  CancellationToken () : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+  void Cancel () { cancelled_->store(true); }
+  bool IsCancelled () const { return cancelled_->load(); }
+
+private:
+  std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+
+/**
+ * @brief Thrown from within the solver callbacks to abort a running solve.
+ */
+class SolveInterrupted : public std::runtime_error {
+public:
+  SolveInterrupted (const std::string& reason) : std::runtime_error(reason) {}
+};
+
+
+/**
+ * @brief How a monitored solve ended and the quality of the returned iterate.
+ *
+ * @ingroup Planning
+ */
+struct SolveResult {
+  enum Status { Finished,         ///< solver terminated on its own.
+                Cancelled,        ///< CancellationToken was triggered.
+                DeadlineReached   ///< wall-clock deadline passed.
+  };
+
+  Status status_ = Finished;
+  bool is_feasible_ = false;          ///< all bounds fulfilled within tolerance.
+  double constraint_violation_ = 0.0; ///< largest violation of any bound.
+  int iteration_count_ = 0;           ///< completed solver iterations.
+  double wall_time_ = 0.0;            ///< time [s] spent in the solver.
+};
+
+
+/**
+ * @brief Aborts a solve when cancelled or when a deadline passes.
+ *
+ * This is an empty variable set whose only purpose is to be notified by the
+ * ifopt::Problem. Every evaluation callback (costs, constraints and their
+ * derivatives) first sets the current variables and every completed
+ * iteration stores them, which calls SetVariables() and GetValues() of all
+ * variable sets. If the solve is cancelled or the deadline has passed, these
+ * calls throw SolveInterrupted, which makes the solver return at the latest
+ * after one more iteration.
+ *
+ * The checks are only active between Start() and Stop(), so the problem can
+ * still be evaluated normally after the solve was interrupted.
+ *
+ * @ingroup Planning
+ */
+class SolveMonitor : public ifopt::VariableSet {
+public:
+  using Ptr   = std::shared_ptr<SolveMonitor>;
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @param token  Triggering this token aborts the solve.
+   * @param max_wall_time  Time [s] after Start() at which to abort the solve.
+   */
+  SolveMonitor (const CancellationToken& token,
+                double max_wall_time = std::numeric_limits<double>::infinity());
+  virtual ~SolveMonitor () = default;
+
+  /** @brief Starts the clock and activates the checks. */
+  void Start ();
+
+  /** @brief Deactivates the checks. */
+  void Stop ();
+
+  /** @returns Why the checks aborted the solve, Finished if they didn't. */
+  SolveResult::Status GetStatus () const { return status_; };
+
+  /** @returns The time [s] passed since Start(). */
+  double GetElapsedTime () const;
+
+  VectorXd GetValues () const override;
+  void SetVariables (const VectorXd& x) override;
+  VecBound GetBounds () const override { return VecBound(); };
+
+private:
+  CancellationToken token_;
+  double max_wall_time_;
+  Clock::time_point start_;
+  bool is_active_ = false;
+  mutable SolveResult::Status status_ = SolveResult::Finished;
+
+  void CheckForInterrupt () const;
+};
+
+
+/**
+ * @brief Solves a problem, aborting when cancelled or after a deadline.
+ *
+ * If the solve is aborted, the problem variables are reset to the last
+ * iterate the solver accepted (or the initial guess, if no iteration
+ * completed). In both cases the returned result states whether these
+ * values fulfill all constraints.
+ *
+ * @param solver  The solver with all options already set.
+ * @param nlp     The problem, to which an empty SolveMonitor variable set is added.
+ * @param token   Triggering this token from any thread aborts the solve.
+ * @param max_wall_time  Time [s] after which to abort the solve.
+ * @param feasibility_tolerance  Allowed bound violation to count as feasible.
+ */
+SolveResult SolveInterruptible (ifopt::Solver& solver,
+                                ifopt::Problem& nlp,
+                                const CancellationToken& token,
+                                double max_wall_time = std::numeric_limits<double>::infinity(),
+                                double feasibility_tolerance = 1e-4);
+
+/**
+ * @returns The largest violation of any constraint or variable bound.
+ * @param nlp  The problem evaluated at its current variables.
+ */
+double GetMaxBoundViolation (ifopt::Problem& nlp);
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_SOLVE_MONITOR_H_ */
@@ -0,0 +1,139 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PLANNING_TRAJECTORY_VALIDATOR_H_
+#define TOWR_PLANNING_TRAJECTORY_VALIDATOR_H_
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <towr/models/robot_model.h>
+#include <towr/terrain/height_map.h>
+#include <towr/variables/state.h>
+#include <towr/variables/trajectory.h>
+
+namespace towr {
+
+/**
+ * @brief How finely and how strictly a TrajectoryValidator checks.
+ *
+ * The NLP only enforces the dynamics at discrete times (see
+ * Parameters::dt_constraint_dynamic_), so in between a solved motion
+ * violates them slightly and the tolerances shouldn't be too tight.
+ */
+struct TrajectoryValidatorOptions {
+  double dt_ = 0.01;                ///< spacing of the time grid [s].
+  double dynamic_tolerance_ = 5.0;  ///< generalized force residual [N, Nm].
+  double distance_tolerance_ = 0.01;///< range of motion and terrain [m].
+  double force_tolerance_ = 1.0;    ///< unilateral/friction/swing force [N].
+  double force_limit_ = 1000.0;     ///< see Parameters::force_limit_in_normal_direction_.
+};
+
+/**
+ * @brief Decides quickly whether a motion is still executable.
+ *
+ * After the terrain estimate or the robot state changed, a replan is only
+ * needed if the current motion violates one of the towr constraints. This
+ * class evaluates the residuals of the
+ *  - dynamics (as in DynamicConstraint),
+ *  - range of motion (as in RangeOfMotionConstraint),
+ *  - terrain (stance feet on, swing feet above the terrain) and
+ *  - friction pyramid and force limits (as in ForceConstraint, zero force
+ *    during swing)
+ *
+ * on a dense time grid, and returns at the first violation. All buffers are
+ * allocated in the constructor, so Validate() doesn't allocate any memory.
+ * For the same reason a validator must not be used by several threads at
+ * once; give each thread its own.
+ *
+ * @ingroup Planning
+ */
+class TrajectoryValidator {
+public:
+  /** The constraint that is violated. */
+  enum Check { None, Dynamics, RangeOfMotion, Terrain, Friction };
+
+  struct Result {
+    Check check_ = None;      ///< None if the motion is valid.
+    int ee_ = -1;             ///< the violating endeffector, -1 for dynamics.
+    double time_ = 0.0;       ///< the first grid time with a violation [s].
+    double magnitude_ = 0.0;  ///< by how much the tolerance is exceeded.
+
+    bool IsValid () const { return check_ == None; };
+  };
+
+  TrajectoryValidator (const RobotModel& model,
+                       const HeightMap::Ptr& terrain,
+                       const TrajectoryValidatorOptions& options = TrajectoryValidatorOptions());
+  virtual ~TrajectoryValidator () = default;
+
+  /**
+   * @brief Replaces the terrain, e.g. with an updated height map.
+   */
+  void SetTerrain (const HeightMap::Ptr& terrain);
+
+  /**
+   * @brief Checks the motion from t_start to its end.
+   * @param motion  Must have as many endeffectors as the robot model.
+   * @param t_start  e.g. the current time along the motion [s].
+   * @returns the first violation, Check::None if there is none.
+   */
+  Result Validate (const Trajectory& motion, double t_start = 0.0) const;
+
+  /**
+   * @returns The largest difference between the base position/velocity of
+   *          the motion at time t and a (measured) state.
+   */
+  static double GetDeviation (const Trajectory& motion, double t,
+                              const BaseState& state);
+
+private:
+  bool CheckDynamics (double t, Result& r) const;
+  bool CheckEndeffector (const Trajectory& motion, int ee, double t, Result& r) const;
+  static bool Exceeds (double violation, double tolerance, Check check,
+                       int ee, double t, Result& r);
+
+  DynamicModel::Ptr dynamic_model_; ///< own copy, SetCurrent() modifies it.
+  std::vector<Eigen::Vector3d> nominal_ee_pos_B_;
+  Eigen::Vector3d max_deviation_from_nominal_;
+  HeightMap::Ptr terrain_;
+  TrajectoryValidatorOptions options_;
+
+  // preallocated for evaluating the splines
+  mutable Eigen::VectorXd base_pos_, base_vel_, base_acc_;
+  mutable Eigen::VectorXd euler_, euler_vel_, euler_acc_;
+  mutable Eigen::VectorXd pos_, vel_, acc_;
+  mutable std::vector<Eigen::Vector3d> ee_pos_, ee_force_;
+  mutable Eigen::Matrix3d w_R_b_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PLANNING_TRAJECTORY_VALIDATOR_H_ */
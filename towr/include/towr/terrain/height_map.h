@@ -66,6 +66,9 @@ namespace towr {
  * "foot must be touching terrain during stance phase".
  * @sa TerrainConstraint
  *
+ * All queries are const and must not modify the height map, so one terrain
+ * can be shared by formulations solved on different threads.
+ *
  * @ingroup Terrains
  */
 class HeightMap {
@@ -0,0 +1,148 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_VARIABLES_BASE_KINEMATICS_CACHE_H_
+#define TOWR_VARIABLES_BASE_KINEMATICS_CACHE_H_
+
+#include <memory>
+#include <unordered_map>
+
+#include "node_spline.h"
+#include "nodes_observer.h"
+#include "euler_converter.h"
+
+namespace towr {
+
+/**
+ * @brief The base state at one time, as needed by the constraints.
+ */
+struct BaseKinematics {
+  State lin_ = State(k3D, 3);         ///< base position, velocity, acceleration in world.
+  State ang_ = State(k3D, 3);         ///< Euler angles and their derivatives.
+  EulerConverter::MatrixSXd w_R_b_;   ///< rotation from base to world frame.
+  EulerConverter::MatrixSXd b_R_w_;   ///< rotation from world to base frame.
+  Eigen::Vector3d omega_;             ///< angular velocity in world frame.
+  Eigen::Vector3d omega_dot_;         ///< angular acceleration in world frame.
+};
+
+
+/**
+ * @brief Evaluates the base motion once per time and solver iteration.
+ *
+ * The DynamicConstraint, every RangeOfMotionConstraint and the
+ * BaseMotionConstraint all need the base position and orientation at
+ * their discretization times, and the constraints evaluate them again for
+ * every variable set they fill the Jacobian of. Converting the Euler angles
+ * to rotation matrices, angular velocities and their derivatives w.r.t. the
+ * node values dominates these evaluations. This cache, owned by the
+ * SplineHolder and shared by these constraints, computes these values only
+ * the first time a time is queried and returns the stored ones afterwards.
+ *
+ * The cache observes the linear and angular base nodes, so all entries are
+ * invalidated as soon as the solver sets new variables. The storage of
+ * the entries is kept, so once all times were queried in the first
+ * iteration no more memory is allocated.
+ *
+ * Times are matched to a nanosecond, so constraints discretized with
+ * multiples of the same interval share their entries.
+ */
+class BaseKinematicsCache {
+public:
+  using Ptr = std::shared_ptr<BaseKinematicsCache>;
+  using JacRowMatrix = EulerConverter::JacRowMatrix;
+  using Jacobian     = EulerConverter::Jacobian;
+
+  /**
+   * @param base_linear   The spline of the linear base motion.
+   * @param base_angular  The spline of the base Euler angles.
+   */
+  BaseKinematicsCache (const NodeSpline::Ptr& base_linear,
+                       const NodeSpline::Ptr& base_angular);
+  virtual ~BaseKinematicsCache () = default;
+
+  /**
+   * @returns The base state at time t, computed if not cached.
+   */
+  const BaseKinematics& GetBaseKinematics (double t) const;
+
+  /**
+   * @returns The derivatives of the base to world rotation matrix w.r.t.
+   *          the Euler node values at time t, computed if not cached.
+   */
+  const JacRowMatrix& GetDerivOfRotationWrtNodes (double t) const;
+
+  /**
+   * @brief Derivative of the rotated vector w.r.t. the Euler node values.
+   * @see EulerConverter::DerivOfRotVecMult().
+   */
+  Jacobian DerivOfRotVecMult (double t, const Eigen::Vector3d& v, bool inverse) const;
+
+  /** @returns The converter of the Euler angles of the base. */
+  const EulerConverter& GetEulerConverter () const { return base_angular_; };
+
+  /** @brief Marks all entries as outdated. */
+  void Invalidate () { ++revision_; };
+
+  /** @returns The number of times any entry was (re)computed. */
+  int GetComputeCount () const { return n_computed_; };
+
+private:
+  // notifies the cache when the values of its node variables change.
+  class Invalidator : public NodesObserver {
+  public:
+    Invalidator (NodeSubjectPtr nodes, BaseKinematicsCache* cache);
+    void UpdateNodes () override { cache_->Invalidate(); };
+  private:
+    BaseKinematicsCache* cache_;
+  };
+
+  struct Entry {
+    BaseKinematics kin_;
+    JacRowMatrix dR_wrt_nodes_;
+    int revision_          = -1; ///< revision at which kin_ was computed.
+    int deriv_revision_    = -1; ///< revision at which dR_wrt_nodes_ was computed.
+  };
+
+  Entry& GetEntry (double t) const;
+
+  NodeSpline::Ptr base_linear_;
+  NodeSpline::Ptr base_euler_;
+  EulerConverter base_angular_;
+
+  std::unique_ptr<Invalidator> lin_observer_;
+  std::unique_ptr<Invalidator> ang_observer_;
+
+  mutable std::unordered_map<long long, Entry> entries_;
+  int revision_ = 0;
+  mutable int n_computed_ = 0;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_VARIABLES_BASE_KINEMATICS_CACHE_H_ */
@@ -0,0 +1,180 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_VARIABLES_CUBIC_HERMITE_SPLINE_H_
+#define TOWR_VARIABLES_CUBIC_HERMITE_SPLINE_H_
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "state.h"
+
+namespace towr {
+
+class NodeSpline;
+
+/**
+ * @brief A cubic-Hermite spline that stores its knots by value.
+ *
+ * In contrast to the NodeSpline, this spline is not linked to any
+ * optimization variables. It is a plain copy of the knot times, positions
+ * and velocities, so it can be copied, stored and evaluated long after the
+ * nonlinear program that produced it has been destroyed, e.g. by a control
+ * thread while the next motion is being optimized.
+ *
+ * The knots are stored column-wise (one column per knot), which is also the
+ * layout used when writing the spline to files or shared memory.
+ *
+ * If the knots also store the second derivative, each segment is the
+ * quintic Hermite polynomial through value, first and second derivative at
+ * both ends, the same as CubicHermitePolynomial with quintic nodes.
+ *
+ * @ingroup Variables
+ */
+class CubicHermiteSpline {
+public:
+  using VecTimes = std::vector<double>;
+  using VectorXd = Eigen::VectorXd;
+  using MatrixXd = Eigen::MatrixXd;
+
+  /**
+   * @brief Attention, nothing initialized.
+   */
+  CubicHermiteSpline () = default;
+
+  /**
+   * @brief Copies the current node values and durations of the spline.
+   *
+   * Quintic polynomials (nodes with acceleration) are copied exactly.
+   */
+  explicit CubicHermiteSpline (const NodeSpline& spline);
+
+  /**
+   * @brief Constructs a spline from nodes and the durations in between.
+   * @param nodes  The n+1 nodes (pos, vel[, acc]) joining the polynomials.
+   * @param poly_durations  The n durations [s] of each polynomial.
+   */
+  CubicHermiteSpline (const std::vector<Node>& nodes,
+                      const VecTimes& poly_durations);
+
+  /**
+   * @brief Constructs a spline directly from the knots.
+   * @param knot_times  The strictly increasing times [s] of each knot.
+   * @param pos  The knot values, one column per knot.
+   * @param vel  The knot first-derivatives, one column per knot.
+   */
+  CubicHermiteSpline (const VecTimes& knot_times,
+                      const MatrixXd& pos,
+                      const MatrixXd& vel);
+
+  /**
+   * @brief Constructs a spline of quintic segments from the knots.
+   * @param acc  The knot second-derivatives, one column per knot.
+   */
+  CubicHermiteSpline (const VecTimes& knot_times,
+                      const MatrixXd& pos,
+                      const MatrixXd& vel,
+                      const MatrixXd& acc);
+
+  /**
+   * @returns The position, velocity and acceleration at time t.
+   *
+   * Times outside the spline are clamped to the first and last knot.
+   */
+  State GetPoint(double t) const;
+
+  /**
+   * @brief Evaluates the spline without allocating any memory.
+   * @param t  The time at which to evaluate, clamped to the spline.
+   * @param[out] pos  The value at time t, must have GetDim() rows.
+   * @param[out] vel  The first derivative at time t.
+   * @param[out] acc  The second derivative at time t.
+   */
+  void GetPoint(double t, Eigen::Ref<VectorXd> pos,
+                Eigen::Ref<VectorXd> vel,
+                Eigen::Ref<VectorXd> acc) const;
+
+  /**
+   * @returns The coefficients of a segment in local time, one column per
+   *          power of t: 4 columns if cubic, 6 if quintic.
+   */
+  MatrixXd GetSegmentCoefficients(int segment) const;
+
+  /**
+   * @returns The polynomial that is active at time t, 0 is the first one.
+   */
+  int GetSegmentID(double t) const;
+
+  /**
+   * @returns The time of the last knot.
+   */
+  double GetTotalTime() const;
+
+  /**
+   * @returns The number of knots (polynomials + 1), zero if empty.
+   */
+  int GetKnotCount() const;
+
+  /**
+   * @returns The number of dimensions, e.g. 3 for x,y,z.
+   */
+  int GetDim() const;
+
+  /**
+   * @returns The durations of each polynomial.
+   */
+  VecTimes GetPolyDurations() const;
+
+  /**
+   * @returns True if the segments are quintic, i.e. the knots store the
+   *          second derivative as well.
+   */
+  bool IsQuintic() const { return acc_.cols() > 0; };
+
+  /**
+   * @returns The nodes (pos, vel[, acc]) at each knot.
+   */
+  std::vector<Node> GetNodes() const;
+
+  const VecTimes& GetKnotTimes() const { return knot_times_; };
+  const MatrixXd& GetKnotPositions() const { return pos_; };
+  const MatrixXd& GetKnotVelocities() const { return vel_; };
+  const MatrixXd& GetKnotAccelerations() const { return acc_; }; ///< empty if cubic.
+
+private:
+  VecTimes knot_times_; ///< the global time [s] of each knot.
+  MatrixXd pos_;        ///< the value at each knot, one column per knot.
+  MatrixXd vel_;        ///< the first-derivative at each knot.
+  MatrixXd acc_;        ///< the second-derivative at each knot, if quintic.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_VARIABLES_CUBIC_HERMITE_SPLINE_H_ */
@@ -114,6 +114,10 @@ public:
    */
   Vector3d GetAngularVelocityInWorld(double t) const;
 
+  /** @see GetAngularVelocityInWorld(t)  */
+  static Vector3d GetAngularVelocityInWorld(const EulerAngles& pos,
+                                            const EulerRates& vel);
+
   /**
    * @brief Converts Euler angles, rates and rate derivatives  o angular accelerations.
    * @param t The current time in the euler angles spline.
@@ -121,6 +125,9 @@ public:
    */
   Vector3d GetAngularAccelerationInWorld(double t) const;
 
+  /** @see GetAngularAccelerationInWorld(t)  */
+  static Vector3d GetAngularAccelerationInWorld(State euler);
+
   /**
    * @brief Jacobian of the angular velocity with respect to the Euler nodes.
    * @param t  The current time in the Euler angles spline.
@@ -152,6 +159,20 @@ public:
    */
   Jacobian DerivOfRotVecMult(double t, const Vector3d& v, bool inverse) const;
 
+  /** @brief Same as DerivOfRotVecMult(t,v,inverse), but for precomputed
+   *         derivatives of the rotation matrix.
+   *
+   * @param Rd  The derivatives given by GetDerivativeOfRotationMatrixWrtNodes().
+   */
+  Jacobian DerivOfRotVecMult(const JacRowMatrix& Rd, const Vector3d& v, bool inverse) const;
+
+  /** @brief matrix of derivatives of each cell w.r.t node values.
+   *
+   * This 2d-array has the same dimensions as the rotation matrix M_IB, but
+   * each cell if filled with a row vector.
+   */
+  JacRowMatrix GetDerivativeOfRotationMatrixWrtNodes(double t) const;
+
   /** @see GetQuaternionBaseToWorld(t)  */
   static Eigen::Quaterniond GetQuaternionBaseToWorld(const EulerAngles& pos);
 
@@ -191,20 +212,6 @@ private:
    */
   Jacobian GetDerivMdotwrtNodes(double t, Dim3D dim) const;
 
-  /** @brief matrix of derivatives of each cell w.r.t node values.
-   *
-   * This 2d-array has the same dimensions as the rotation matrix M_IB, but
-   * each cell if filled with a row vector.
-   */
-  JacRowMatrix GetDerivativeOfRotationMatrixWrtNodes(double t) const;
-
-  /** @see GetAngularAccelerationInWorld(t)  */
-  static Vector3d GetAngularAccelerationInWorld(State euler);
-
-  /** @see GetAngularVelocityInWorld(t)  */
-  static Vector3d GetAngularVelocityInWorld(const EulerAngles& pos,
-                                            const EulerRates& vel);
-
   JacobianRow GetJac(double t, Dx deriv, Dim3D dim) const;
   Jacobian jac_wrt_nodes_structure_;
 };
@@ -91,6 +91,21 @@ public:
    */
   int GetNodeVariablesCount() const;
 
+  /**
+   * @returns The name of the variables the Jacobians are taken with respect to.
+   */
+  std::string GetNodeVariablesName() const;
+
+  /**
+   * @returns The node variables the polynomials are constructed from.
+   */
+  NodeSubjectPtr GetNodeVariables() const { return node_values_; };
+
+  /**
+   * @returns The current node values the polynomials are constructed from.
+   */
+  const std::vector<Node> GetNodes() const;
+
   /**
    * @brief How the spline position changes when the polynomial durations change.
    * @param t  The time along the spline at which the sensitivity is required.
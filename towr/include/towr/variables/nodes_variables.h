@@ -37,6 +37,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace towr {
 
+class CubicHermiteSpline;
+
 /**
  * @defgroup Variables
  * @brief Variables of the trajectory optimization problem.
@@ -185,6 +187,49 @@ public:
                                 const VectorXd& final_val,
                                 double t_total);
 
+  /**
+   * @brief Sets the node values to those of a spline at the node times.
+   * @param spline  The motion to sample, e.g. a previous solution.
+   * @param poly_durations  The durations of the polynomials between the nodes.
+   *
+   * Used to warm-start the optimization. Nodes that share one optimization
+   * variable take the value at the first of these nodes, and values are
+   * clamped to the bounds. Notifies all observers.
+   */
+  void SetBySampling(const CubicHermiteSpline& spline,
+                     const VecDurations& poly_durations);
+
+  /**
+   * @brief Lets these nodes follow the optimization variables of others.
+   * @param nodes  Nodes with the same structure, e.g. of a mirrored foot.
+   * @param scale  Multiplies every node value per dimension, e.g. -1 for y.
+   * @param offset  Is added to every node position.
+   *
+   * Every node value is then scale*value+offset of the same node value in
+   * @a nodes, and these nodes have no optimization variables of their own.
+   * Used to exploit left/right symmetry, as this halves the variables.
+   * Constraints and costs on these nodes fill their derivatives into the
+   * Jacobian of GetOptVariablesName(), multiplied by GetScale().
+   */
+  void UseVariablesOf(const Ptr& nodes, const VectorXd& scale,
+                      const VectorXd& offset);
+
+  /**
+   * @returns The name of the variable set these node values depend on.
+   */
+  std::string GetOptVariablesName() const;
+
+  /**
+   * @returns The number of optimization variables these node values depend on.
+   */
+  int GetOptVariablesCount() const;
+
+  /**
+   * @returns The derivative of a node value in dimension @a dim w.r.t. the
+   *          optimization variable it depends on, 1 unless mirrored.
+   */
+  double GetScale(int dim) const;
+
   /**
    * @brief Restricts the first node in the spline.
    * @param deriv Which derivative (pos,vel,...) should be restricted.
@@ -222,6 +267,29 @@ private:
   void UpdateObservers() const;
   std::vector<ObserverPtr> observers_;
 
+  /**
+   * @brief Sets the node values from the nodes whose variables are used.
+   */
+  void UpdateFromSharedNodes();
+  Ptr shared_;                          ///< nodes holding the variables, if any.
+  std::vector<NodesVariables*> sharing_; ///< nodes using these variables.
+  VectorXd scale_, offset_;
+  int n_opt_variables_ = 0;
+
+  /**
+   * @brief Flattens GetNodeValuesInfo() of all optimization variables into
+   * contiguous tables, together with the reverse lookup of GetOptIndex().
+   *
+   * Built on first use, as the parameterization is only complete after the
+   * constructor of the derived class ran. Afterwards, setting and getting
+   * the variables and looking up indices neither searches nor allocates.
+   */
+  void BuildIndexTables() const;
+  int GetKey(const NodeValueInfo& nvi) const;
+  mutable std::vector<NodeValueInfo> node_values_info_; ///< of all variables, in order.
+  mutable std::vector<int> first_node_value_;  ///< entry in the above of each variable.
+  mutable std::vector<int> opt_index_;         ///< variable of each node value (GetKey()).
+
   /**
    * @brief Bounds a specific node variables.
    * @param node_id  The ID of the node to bound.
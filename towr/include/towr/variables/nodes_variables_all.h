@@ -48,11 +48,16 @@ public:
    * @param n_nodes  Number of nodes to construct the spline.
    * @param n_dim    Number of dimensions of each node.
    * @param variable_id  Name of this variables set in the optimization.
+   * @param n_derivatives  Optimized derivatives per node, 3 for quintic splines.
    */
-  NodesVariablesAll (int n_nodes, int n_dim, std::string variable_id);
+  NodesVariablesAll (int n_nodes, int n_dim, std::string variable_id,
+                     int n_derivatives = Node::n_derivatives);
   virtual ~NodesVariablesAll () = default;
 
   std::vector<NodeValueInfo> GetNodeValuesInfo(int idx) const override;
+
+private:
+  int n_derivatives_; ///< e.g. pos, vel (and acc) of each node.
 };
 
 } /* namespace towr */
@@ -90,6 +90,8 @@ public:
 
   /**
    * @returns the value of the first node of the phase.
+   *
+   * For the motion of a foot in a stance phase this is the foothold.
    */
   Eigen::Vector3d GetValueAtStartOfPhase(int phase) const;
 
@@ -175,6 +177,15 @@ private:
   /** @brief semantic information associated with each polynomial */
   std::vector<PolyInfo> polynomial_info_;
 
+  // Lookup tables of the phase structure, which is fixed at construction,
+  // so querying it while evaluating constraints doesn't search or allocate.
+  std::vector<int> phase_of_node_;       ///< phase of the left polynomial of each node.
+  std::vector<bool> is_constant_node_;   ///< see IsConstantNode().
+  std::vector<int> first_poly_of_phase_; ///< ID of the first polynomial of each phase.
+
+  /** @brief Fills the lookup tables from the polynomial infos. */
+  void BuildPhaseTables(int phase_count);
+
   /** @brief ID of the first polynomial of a phase. */
   int GetPolyIDAtStartOfPhase(int phase) const;
 
@@ -105,12 +105,26 @@ private:
  * | \image html nodes.jpg | |
  *
  * See also matlab/cubic_hermite_polynomial.m for generation of derivatives.
+ *
+ * If the nodes also hold the acceleration, the same class represents the
+ * fifth-order ("quintic") Hermite polynomial through the start and end
+ * position, velocity and acceleration. Splines of these are continuous in
+ * acceleration without additional constraints.
  */
 class CubicHermitePolynomial : public Polynomial {
 public:
-  CubicHermitePolynomial(int dim);
+  /**
+   * @param dim  The dimensions of f(t), e.g. x,y,z.
+   * @param n_node_derivatives  2 for cubic, 3 (with acceleration) for quintic.
+   */
+  CubicHermitePolynomial(int dim, int n_node_derivatives = Node::n_derivatives);
   virtual ~CubicHermitePolynomial() = default;
 
+  /**
+   * @returns True if the nodes hold accelerations (fifth-order polynomial).
+   */
+  bool IsQuintic() const { return n0_.GetDerivativeCount() > Node::n_derivatives; };
+
 
   /**
    * @brief  sets the total duration of the polynomial.
@@ -168,6 +182,10 @@ private:
   double GetDerivativeOfPosWrtEndNode(Dx node_deriv, double t_local) const;
   double GetDerivativeOfVelWrtEndNode(Dx node_deriv, double t_local) const;
   double GetDerivativeOfAccWrtEndNode(Dx node_deriv, double t_local) const;
+
+  // quintic: coefficient c w.r.t node value (p0,v0,a0,p1,v1,a1)
+  double GetQuinticCoeffWrtNode(Coefficients c, int node_value) const;
+  double GetQuinticDerivativeWrtNode(Dx dfdt, int node_value, double t) const;
 };
 
 } // namespace towr
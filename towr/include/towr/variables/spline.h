@@ -47,7 +47,13 @@ public:
   using VecTimes = std::vector<double>;
   using VecPoly  = std::vector<CubicHermitePolynomial>;
 
-  Spline(const VecTimes& poly_durations, int n_dim);
+  /**
+   * @param poly_durations  The duration [s] of each polynomial.
+   * @param n_dim  The dimensions of the spline, e.g. x,y,z.
+   * @param n_node_derivatives  3 if the nodes hold accelerations (quintic).
+   */
+  Spline(const VecTimes& poly_durations, int n_dim,
+         int n_node_derivatives = Node::n_derivatives);
   virtual ~Spline () = default;
 
   /**
@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "node_spline.h"
 #include "nodes_variables.h"
 #include "nodes_variables_phase_based.h"
+#include "base_kinematics_cache.h"
 
 namespace towr {
 
@@ -71,6 +72,9 @@ struct SplineHolder {
   NodeSpline::Ptr base_linear_;
   NodeSpline::Ptr base_angular_;
 
+  /// The base motion evaluated once per time and iteration, see BaseKinematicsCache.
+  BaseKinematicsCache::Ptr base_kinematics_;
+
   std::vector<NodeSpline::Ptr> ee_motion_;
   std::vector<NodeSpline::Ptr> ee_force_;
   std::vector<PhaseDurations::Ptr> phase_durations_;
@@ -65,7 +65,7 @@ public:
    * @param   deriv  Index for that specific derivative (pos=0, vel=1, acc=2).
    * @return  Read-only n-dimensional position, velocity or acceleration.
    */
-  const VectorXd at(Dx deriv) const;
+  const VectorXd& at(Dx deriv) const;
 
   /**
    * @brief   Read or write a specific state derivative by index.
@@ -77,17 +77,22 @@ public:
   /**
    * @brief read access to the zero-derivative of the state, e.g. position.
    */
-  const VectorXd p() const;
+  const VectorXd& p() const;
 
   /**
    * @brief read access to the first-derivative of the state, e.g. velocity.
    */
-  const VectorXd v() const;
+  const VectorXd& v() const;
 
   /**
    * @brief read access to the second-derivative of the state, e.g. acceleration.
    */
-  const VectorXd a() const;
+  const VectorXd& a() const;
+
+  /**
+   * @returns The number of derivatives stored, e.g. 2 for position/velocity.
+   */
+  int GetDerivativeCount() const;
 
 private:
   std::vector<VectorXd> values_; ///< e.g. position, velocity and acceleration, ...
@@ -101,8 +106,9 @@ private:
  * between them. Therefore, if optimal node values have been found, the
  * continuous trajectory for that spline can be reconstructed.
  *
- * In this framework a node only has position and velocity values, no
- * acceleration.
+ * By default a node only has position and velocity values, no
+ * acceleration. Nodes of quintic splines (see Parameters::SplineBasis)
+ * additionally hold the acceleration.
  */
 class Node : public State {
 public:
@@ -110,8 +116,9 @@ public:
 
   /**
    * @brief Constructs a @a dim - dimensional node (default zero-dimensional).
+   * @param n_values  The number of derivatives, 3 to include acceleration.
    */
-  explicit Node(int dim = 0) : State(dim, n_derivatives) {};
+  explicit Node(int dim = 0, int n_values = n_derivatives) : State(dim, n_values) {};
   virtual ~Node() = default;
 };
 
@@ -0,0 +1,107 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_VARIABLES_TRAJECTORY_H_
+#define TOWR_VARIABLES_TRAJECTORY_H_
+
+#include <vector>
+
+#include "cubic_hermite_spline.h"
+#include "spline_holder.h"
+
+namespace towr {
+
+/**
+ * @brief A copy of an optimized motion that is independent of the NLP.
+ *
+ * The splines in the SplineHolder are linked to the optimization variables,
+ * so they change with every iteration of the solver and can't outlive the
+ * nonlinear program. This class copies the current knots of all splines and
+ * the contact schedule by value, so a finished motion can be handed to other
+ * threads, written to disk or executed while the next one is optimized.
+ *
+ * @ingroup Variables
+ */
+struct Trajectory {
+  using VecDurations = std::vector<double>;
+
+  /**
+   * @brief Attention, nothing initialized.
+   */
+  Trajectory () = default;
+
+  /**
+   * @brief Copies the current values of all splines.
+   */
+  explicit Trajectory (const SplineHolder& splines);
+
+  /**
+   * @returns True if the endeffector is in contact with the environment.
+   * @param ee  The endeffector ID.
+   * @param t   The time [s], clamped to the duration of the motion.
+   */
+  bool IsContactPhase(int ee, double t) const;
+
+  /**
+   * @returns The duration [s] of the motion.
+   */
+  double GetTotalTime() const;
+
+  /**
+   * @returns The number of endeffectors.
+   */
+  int GetEECount() const;
+
+  CubicHermiteSpline base_linear_;
+  CubicHermiteSpline base_angular_;
+  std::vector<CubicHermiteSpline> ee_motion_;
+  std::vector<CubicHermiteSpline> ee_force_;
+
+  std::vector<VecDurations> ee_phase_durations_; ///< alternating stance/swing [s].
+  std::vector<bool> ee_in_contact_at_start_;     ///< the contact state of the first phase.
+};
+
+/**
+ * @brief Repeats one cycle of a periodic gait.
+ * @param cycle  The motion of a single cycle, e.g. solved with
+ *               Parameters::MakePeriodic().
+ * @param cycle_count  How often the cycle is repeated.
+ * @param translation  The base and foot displacement of each cycle.
+ * @returns the motion of all cycles after each other.
+ *
+ * The first knot of each repeated cycle is dropped, as it coincides with the
+ * last knot of the previous one. Phases of the same contact state at the
+ * seams are merged.
+ */
+Trajectory TileTrajectory(const Trajectory& cycle, int cycle_count,
+                          const Eigen::Vector3d& translation);
+
+} /* namespace towr */
+
+#endif /* TOWR_VARIABLES_TRAJECTORY_H_ */
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""Generates the flat Single Rigid Body Dynamics kernels.
+
+Derives the dynamic violation of SingleRigidBodyDynamics and its partial
+derivatives symbolically, removes common subexpressions and writes the
+result as plain C++ functions on double arrays. The generated file is
+committed, so building towr does not require python or sympy; it is only
+rerun (CMake option TOWR_GENERATE_KERNELS) when the model changes.
+
+Usage: generate_srbd_kernels.py <output.cc>
+
+All matrices are passed row-major. The violation is split into a base part,
+that only depends on the base state, and a contact part, added once per
+endeffector, so the kernels have fixed sizes independent of the robot.
+
+Author: Alexander Winkler
+"""
+
+import os
+import sys
+
+import sympy as sp
+from sympy.printing.c import C99CodePrinter
+
+
+class KernelPrinter(C99CodePrinter):
+    """Writes small integer powers as products, avoiding calls to pow()."""
+
+    def _print_Pow(self, expr):
+        if expr.exp.is_Integer and 1 < expr.exp <= 3:
+            return '*'.join([self.parenthesize(expr.base, 100)]*int(expr.exp))
+        return super()._print_Pow(expr)
+
+
+def ccode(expr):
+    return KernelPrinter().doprint(expr)
+
+
+def vec(name, n):
+    return sp.Matrix(sp.symbols('{}[0:{}]'.format(name, n), real=True))
+
+
+def mat(name):
+    return vec(name, 9).reshape(3, 3)
+
+
+def flat(M):
+    return [M[i, j] for i in range(M.rows) for j in range(M.cols)]
+
+
+# --- symbolic model (see single_rigid_body_dynamics.cc) ----------------------
+m, g = sp.symbols('m g', real=True)
+I_b  = mat('I_b')   # inertia around the CoM in base frame
+R    = mat('w_R_b') # rotation from base to world frame
+w    = vec('w', 3)  # angular velocity in world frame
+wd   = vec('wd', 3) # angular acceleration in world frame
+acc  = vec('acc', 3)
+com  = vec('com', 3)
+p    = vec('p', 3)  # endeffector position
+f    = vec('f', 3)  # endeffector force
+
+I_w = R*I_b*R.T
+base_ang = I_w*wd + w.cross(I_w*w)
+base_lin = m*acc - sp.Matrix([0, 0, -m*g])
+
+contact_ang = -f.cross(com - p)
+contact_lin = -f
+
+
+# --- kernels -----------------------------------------------------------------
+# (name, doc, inputs, outputs), outputs as (argument, expressions).
+kernels = [
+  ('BaseViolation',
+   'Base part of the 6D violation (angular, linear).',
+   [('m', None), ('g', None), ('I_b', 9), ('w_R_b', 9), ('w', 3), ('wd', 3), ('acc', 3)],
+   [('out', flat(base_ang.col_join(base_lin)))]),
+  ('BaseJacobianWrtLinAcc',
+   'Linear rows of the base part w.r.t. the linear acceleration (3x3).',
+   [('m', None)],
+   [('d_acc', flat(base_lin.jacobian(acc)))]),
+  ('BaseJacobianWrtAng',
+   'Angular rows of the base part w.r.t. w_R_b (3x9), w (3x3) and wd (3x3).',
+   [('I_b', 9), ('w_R_b', 9), ('w', 3), ('wd', 3)],
+   [('d_R',  flat(base_ang.jacobian(flat(R)))),
+    ('d_w',  flat(base_ang.jacobian(w))),
+    ('d_wd', flat(base_ang.jacobian(wd)))]),
+  ('ContactViolation',
+   'Contribution of one endeffector to the 6D violation (angular, linear).',
+   [('com', 3), ('p', 3), ('f', 3)],
+   [('out', flat(contact_ang.col_join(contact_lin)))]),
+  ('ContactJacobianWrtCom',
+   'Angular rows of one contact w.r.t. the CoM position (3x3).',
+   [('f', 3)],
+   [('d_com', flat(contact_ang.jacobian(com)))]),
+  ('ContactJacobianWrtPos',
+   'Angular rows of one contact w.r.t. the endeffector position (3x3).',
+   [('f', 3)],
+   [('d_p', flat(contact_ang.jacobian(p)))]),
+  ('ContactJacobianWrtForce',
+   'Both rows of one contact w.r.t. the endeffector force (6x3).',
+   [('com', 3), ('p', 3)],
+   [('d_f', flat(contact_ang.col_join(contact_lin).jacobian(f)))]),
+]
+
+
+def wrap(head, args, tail, width=80):
+    lines, line = [], head
+    for i, a in enumerate(args):
+        a += tail if i == len(args)-1 else ','
+        if len(line) + len(a) + 1 > width and line.strip() != head.strip():
+            lines.append(line.rstrip())
+            line = ' '*len(head)
+        line += a + ' '
+    lines.append(line.rstrip())
+    return '\n'.join(lines)
+
+
+def emit_kernel(name, doc, inputs, outputs):
+    args = ['double {}'.format(n) if size is None else 'const double* {}'.format(n)
+            for n, size in inputs]
+    args += ['double* {}'.format(n) for n, _ in outputs]
+
+    exprs = [e for _, es in outputs for e in es]
+    tmps, reduced = sp.cse(exprs, symbols=sp.numbered_symbols('x'), optimizations='basic')
+
+    lines = ['/** @brief {} */'.format(doc)]
+    lines.append('void\n' + wrap(name + ' (', args, ')'))
+    lines.append('{')
+    for s, e in tmps:
+        lines.append('  const double {} = {};'.format(s, ccode(e)))
+    k = 0
+    for n, es in outputs:
+        for i in range(len(es)):
+            lines.append('  {}[{}] = {};'.format(n, i, ccode(reduced[k])))
+            k += 1
+    lines.append('}\n')
+    return '\n'.join(lines)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit('usage: {} <output.cc>'.format(sys.argv[0]))
+
+    # same license block as the hand-written model this is derived from
+    here = os.path.dirname(os.path.abspath(__file__))
+    with open(os.path.join(here, '..', 'src', 'single_rigid_body_dynamics.cc')) as f:
+        model = f.read()
+    license = model[:model.index('*/') + 3]
+
+    body = []
+    for k in kernels:
+        body.append(emit_kernel(*k))
+
+    src = (license +
+           '\n// Generated by scripts/generate_srbd_kernels.py, do not edit.\n\n'
+           '#include <towr/models/single_rigid_body_kernels.h>\n\n'
+           'namespace towr {\nnamespace srbd_kernels {\n\n' +
+           '\n'.join(body) +
+           '} /* namespace srbd_kernels */\n} /* namespace towr */\n')
+
+    with open(sys.argv[1], 'w') as f:
+        f.write(src)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,150 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/planning/async_planner.h>
+
+#include <chrono>
+
+#include <ifopt/problem.h>
+
+namespace towr {
+
+AsyncPlanner::AsyncPlanner (ifopt::Solver::Ptr solver,
+                            double max_solve_time,
+                            bool preempt)
+    : solver_(solver),
+      max_solve_time_(max_solve_time),
+      preempt_(preempt)
+{
+  worker_ = std::thread(&AsyncPlanner::Run, this);
+}
+
+AsyncPlanner::~AsyncPlanner ()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    pending_goal_.reset();
+    running_solve_.Cancel();
+  }
+  goal_changed_.notify_all();
+  worker_.join();
+}
+
+int
+AsyncPlanner::RequestPlan (const NlpFormulation& formulation)
+{
+  int goal_id;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    goal_id = ++last_goal_id_;
+    pending_goal_.reset(new NlpFormulation(formulation));
+    pending_goal_id_ = goal_id;
+
+    if (preempt_)
+      running_solve_.Cancel();
+  }
+  goal_changed_.notify_all();
+  return goal_id;
+}
+
+AsyncPlanner::PlanBuffer::ReadHandle
+AsyncPlanner::GetLatestPlan () const
+{
+  return plans_.Read();
+}
+
+bool
+AsyncPlanner::IsBusy () const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return is_solving_ || pending_goal_;
+}
+
+void
+AsyncPlanner::WaitUntilIdle ()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [this]{ return !is_solving_ && !pending_goal_; });
+}
+
+void
+AsyncPlanner::Run ()
+{
+  while (true) {
+    std::unique_ptr<NlpFormulation> goal;
+    int goal_id;
+    CancellationToken token;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      is_solving_ = false;
+      idle_.notify_all();
+      goal_changed_.wait(lock, [this]{ return stop_ || pending_goal_; });
+
+      if (stop_)
+        return;
+
+      goal = std::move(pending_goal_);
+      goal_id = pending_goal_id_;
+      running_solve_ = token;
+      is_solving_ = true;
+    }
+
+    Plan plan = Solve(*goal, goal_id, token);
+
+    // a cancelled plan has already been superseded by a newer goal
+    if (plan.result_.status_ != SolveResult::Cancelled)
+      plans_.Write(std::move(plan));
+  }
+}
+
+AsyncPlanner::Plan
+AsyncPlanner::Solve (NlpFormulation& goal, int goal_id,
+                     const CancellationToken& token)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  ifopt::Problem nlp;
+  SplineHolder solution;
+  for (auto c : goal.GetVariableSets(solution))
+    nlp.AddVariableSet(c);
+  for (auto c : goal.GetConstraints(solution))
+    nlp.AddConstraintSet(c);
+  for (auto c : goal.GetCosts())
+    nlp.AddCostSet(c);
+
+  Plan plan;
+  plan.result_     = SolveInterruptible(*solver_, nlp, token, max_solve_time_);
+  plan.goal_id_    = goal_id;
+  plan.trajectory_ = Trajectory(solution);
+  plan.solve_time_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return plan;
+}
+
+} /* namespace towr */
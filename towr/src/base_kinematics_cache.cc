@@ -0,0 +1,102 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/variables/base_kinematics_cache.h>
+
+#include <cmath>
+
+namespace towr {
+
+BaseKinematicsCache::Invalidator::Invalidator (NodeSubjectPtr nodes,
+                                               BaseKinematicsCache* cache)
+    :NodesObserver(nodes)
+{
+  cache_ = cache;
+}
+
+BaseKinematicsCache::BaseKinematicsCache (const NodeSpline::Ptr& base_linear,
+                                          const NodeSpline::Ptr& base_angular)
+{
+  base_linear_  = base_linear;
+  base_euler_   = base_angular;
+  base_angular_ = EulerConverter(base_angular);
+
+  lin_observer_.reset(new Invalidator(base_linear->GetNodeVariables(), this));
+  ang_observer_.reset(new Invalidator(base_angular->GetNodeVariables(), this));
+}
+
+BaseKinematicsCache::Entry&
+BaseKinematicsCache::GetEntry (double t) const
+{
+  long long key = std::llround(t*1e9); // nanoseconds
+  return entries_[key];
+}
+
+const BaseKinematics&
+BaseKinematicsCache::GetBaseKinematics (double t) const
+{
+  Entry& e = GetEntry(t);
+
+  if (e.revision_ != revision_) {
+    BaseKinematics& k = e.kin_;
+    k.lin_       = base_linear_->GetPoint(t);
+    k.ang_       = base_euler_->GetPoint(t);
+    k.w_R_b_     = EulerConverter::GetRotationMatrixBaseToWorld(k.ang_.p());
+    k.b_R_w_     = k.w_R_b_.transpose();
+    k.omega_     = EulerConverter::GetAngularVelocityInWorld(k.ang_.p(), k.ang_.v());
+    k.omega_dot_ = EulerConverter::GetAngularAccelerationInWorld(k.ang_);
+    e.revision_  = revision_;
+    n_computed_++;
+  }
+
+  return e.kin_;
+}
+
+const BaseKinematicsCache::JacRowMatrix&
+BaseKinematicsCache::GetDerivOfRotationWrtNodes (double t) const
+{
+  Entry& e = GetEntry(t);
+
+  if (e.deriv_revision_ != revision_) {
+    e.dR_wrt_nodes_   = base_angular_.GetDerivativeOfRotationMatrixWrtNodes(t);
+    e.deriv_revision_ = revision_;
+    n_computed_++;
+  }
+
+  return e.dR_wrt_nodes_;
+}
+
+BaseKinematicsCache::Jacobian
+BaseKinematicsCache::DerivOfRotVecMult (double t, const Eigen::Vector3d& v,
+                                        bool inverse) const
+{
+  return base_angular_.DerivOfRotVecMult(GetDerivOfRotationWrtNodes(t), v, inverse);
+}
+
+} /* namespace towr */
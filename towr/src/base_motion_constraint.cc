@@ -41,6 +41,7 @@ BaseMotionConstraint::BaseMotionConstraint (double T, double dt,
 {
   base_linear_  = spline_holder.base_linear_;
   base_angular_ = spline_holder.base_angular_;
+  base_kinematics_ = spline_holder.base_kinematics_;
 
   double dev_rad = 0.05;
   node_bounds_.resize(k6D);
@@ -61,8 +62,9 @@ void
 BaseMotionConstraint::UpdateConstraintAtInstance (double t, int k,
                                                   VectorXd& g) const
 {
-  g.middleRows(GetRow(k, LX), k3D) = base_linear_->GetPoint(t).p();
-  g.middleRows(GetRow(k, AX), k3D) = base_angular_->GetPoint(t).p();
+  const BaseKinematics& base = base_kinematics_->GetBaseKinematics(t);
+  g.middleRows(GetRow(k, LX), k3D) = base.lin_.p();
+  g.middleRows(GetRow(k, AX), k3D) = base.ang_.p();
 }
 
 void
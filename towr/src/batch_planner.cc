@@ -0,0 +1,125 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/planning/batch_planner.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
+
+#include <ifopt/problem.h>
+
+namespace towr {
+
+BatchPlanner::BatchPlanner (const SolverFactory& solver_factory,
+                            int thread_count,
+                            double max_solve_time)
+    : solver_factory_(solver_factory),
+      max_solve_time_(max_solve_time)
+{
+  thread_count_ = thread_count > 0? thread_count : std::thread::hardware_concurrency();
+  thread_count_ = std::max(1, thread_count_);
+}
+
+int
+BatchPlanner::GetThreadCount () const
+{
+  return thread_count_;
+}
+
+void
+BatchPlanner::Cancel ()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  token_.Cancel();
+}
+
+std::vector<BatchPlanner::Result>
+BatchPlanner::Solve (const std::vector<NlpFormulation>& problems)
+{
+  CancellationToken token;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    token_ = token;
+  }
+
+  int n_problems = problems.size();
+  std::vector<Result> results(n_problems);
+  std::atomic<int> next_problem(0);
+
+  // each worker takes the next unsolved problem until none are left, so
+  // long and short solves are balanced over the threads.
+  auto work = [&]() {
+    ifopt::Solver::Ptr solver = solver_factory_();
+
+    int i;
+    while ((i = next_problem++) < n_problems) {
+      Result& r = results.at(i);
+
+      if (token.IsCancelled()) {
+        r.result_.status_ = SolveResult::Cancelled;
+        continue;
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      try {
+        NlpFormulation formulation = problems.at(i);
+        SplineHolder solution;
+        ifopt::Problem nlp;
+        for (auto c : formulation.GetVariableSets(solution))
+          nlp.AddVariableSet(c);
+        for (auto c : formulation.GetConstraints(solution))
+          nlp.AddConstraintSet(c);
+        for (auto c : formulation.GetCosts())
+          nlp.AddCostSet(c);
+
+        r.result_     = SolveInterruptible(*solver, nlp, token, max_solve_time_);
+        r.trajectory_ = Trajectory(solution);
+      } catch (const std::exception& e) {
+        r.error_ = e.what();
+      }
+      r.solve_time_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+  };
+
+  int n_threads = std::min(thread_count_, std::max(1, n_problems));
+  std::vector<std::thread> workers;
+  for (int t=1; t<n_threads; ++t)
+    workers.emplace_back(work);
+  work(); // the calling thread works as well instead of just waiting.
+
+  for (auto& w : workers)
+    w.join();
+
+  return results;
+}
+
+} /* namespace towr */
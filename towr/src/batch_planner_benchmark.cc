@@ -0,0 +1,121 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <ifopt/ipopt_solver.h>
+
+#include <towr/initialization/gait_generator.h>
+#include <towr/planning/batch_planner.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+using namespace towr;
+using Clock = std::chrono::steady_clock;
+
+/**
+ * Measures the throughput of the BatchPlanner for increasing thread counts:
+ *
+ *   towr-batch-benchmark [problems, default 32] [linear solver, default ma57]
+ *                        [max threads, default one per core]
+ *
+ * The problems are biped walks to different goals, sharing one robot model
+ * and terrain. The same batch is solved with 1, 2, 4, ... threads. See
+ * BatchPlanner for which linear solvers may be used by several threads.
+ */
+int main(int argc, char *argv[])
+{
+  int n_problems = argc > 1? std::stoi(argv[1]) : 32;
+  std::string linear_solver = argc > 2? argv[2] : "ma57";
+  int max_threads = argc > 3? std::stoi(argv[3]) : std::thread::hardware_concurrency();
+
+  RobotModel model(RobotModel::Biped);
+  auto terrain = std::make_shared<FlatGround>(0.0);
+  auto nominal_stance_B = model.kinematic_model_->GetNominalStanceInBase();
+  double z = -nominal_stance_B.front().z();
+  int n_ee = nominal_stance_B.size();
+  auto gait_gen = GaitGenerator::MakeGaitGenerator(n_ee);
+  gait_gen->SetCombo(GaitGenerator::C0);
+
+  std::vector<NlpFormulation> problems;
+  for (int i=0; i<n_problems; ++i) {
+    NlpFormulation f;
+    f.model_ = model;
+    f.terrain_ = terrain;
+    f.initial_base_.lin.at(kPos).z() = z;
+    f.initial_ee_W_ = nominal_stance_B;
+    for (auto& p : f.initial_ee_W_)
+      p.z() = 0.0;
+    f.final_base_.lin.at(kPos) << 0.5 + 1.0*i/n_problems, 0.0, z;
+    for (int ee=0; ee<n_ee; ++ee) {
+      f.params_.ee_phase_durations_.push_back(gait_gen->GetPhaseDurations(2.0, ee));
+      f.params_.ee_in_contact_at_start_.push_back(gait_gen->IsInContactAtStart(ee));
+    }
+    problems.push_back(f);
+  }
+
+  auto factory = [&]() {
+    auto solver = std::make_shared<ifopt::IpoptSolver>();
+    solver->SetOption("linear_solver", linear_solver);
+    solver->SetOption("jacobian_approximation", "exact");
+    solver->SetOption("print_level", 0);
+    solver->SetOption("print_timing_statistics", "no");
+    return solver;
+  };
+
+  std::cout << std::setw(8) << "threads" << std::setw(11) << "time [s]"
+            << std::setw(14) << "problems/s" << std::setw(10) << "speedup"
+            << std::setw(10) << "feasible" << std::endl;
+
+  double throughput_1 = 0.0;
+  for (int n_threads=1; n_threads<=max_threads; n_threads*=2) {
+    auto start = Clock::now();
+    auto results = BatchPlanner(factory, n_threads).Solve(problems);
+    double time = std::chrono::duration<double>(Clock::now() - start).count();
+
+    int n_feasible = 0;
+    for (const auto& r : results)
+      n_feasible += r.error_.empty() && r.result_.is_feasible_;
+
+    double throughput = n_problems/time;
+    if (n_threads == 1)
+      throughput_1 = throughput;
+
+    std::cout << std::setw(8) << n_threads << std::fixed << std::setprecision(2)
+              << std::setw(11) << time << std::setw(14) << throughput
+              << std::setw(10) << throughput/throughput_1
+              << std::setw(10) << n_feasible << std::endl;
+  }
+
+  return 0;
+}
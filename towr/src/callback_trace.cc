@@ -0,0 +1,277 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/io/callback_trace.h>
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace towr {
+namespace callback_trace {
+
+std::string
+GetName (Callback callback)
+{
+  switch (callback) {
+    case kConstraints: return "constraints";
+    case kJacobian:    return "jacobian";
+    case kCost:        return "cost";
+    case kGradient:    return "gradient";
+    default: throw std::runtime_error("unknown callback " + std::to_string(callback) + "!");
+  }
+}
+
+} /* namespace callback_trace */
+
+
+using namespace callback_trace;
+
+CallbackTraceWriter::CallbackTraceWriter (const std::string& path,
+                                          const planning_protocol::PlanRequest& request,
+                                          int variable_count)
+{
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_)
+    throw std::runtime_error("callback trace " + path + " can't be opened!");
+
+  FileHeader header;
+  std::memcpy(header.magic_, kMagic, sizeof(kMagic));
+  header.version_        = kVersion;
+  header.variable_count_ = variable_count;
+  header.request_        = request;
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void
+CallbackTraceWriter::Append (Callback callback, const VectorXd& x)
+{
+  // bitwise comparison, as the replay must see exactly the same values.
+  bool new_x = x.size() != x_prev_.size()
+      || std::memcmp(x.data(), x_prev_.data(), x.size()*sizeof(double)) != 0;
+
+  EventHeader header;
+  header.callback_ = callback;
+  header.new_x_    = new_x;
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  if (new_x) {
+    file_.write(reinterpret_cast<const char*>(x.data()), x.size()*sizeof(double));
+    x_prev_ = x;
+  }
+
+  event_count_++;
+}
+
+void
+CallbackTraceWriter::Flush ()
+{
+  file_.flush();
+}
+
+
+CallbackTraceReader::CallbackTraceReader (const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("callback trace " + path + " can't be opened!");
+
+  if (!file.read(reinterpret_cast<char*>(&header_), sizeof(header_)) ||
+      std::memcmp(header_.magic_, kMagic, sizeof(kMagic)) != 0 ||
+      header_.version_ != kVersion)
+    throw std::runtime_error("callback trace " + path + " has an unknown format!");
+
+  EventHeader event;
+  VectorXd x(header_.variable_count_);
+  while (file.read(reinterpret_cast<char*>(&event), sizeof(event))) {
+    if (event.callback_ >= kCallbackCount)
+      throw std::runtime_error("callback trace " + path + " is corrupt!");
+
+    if (event.new_x_) {
+      if (!file.read(reinterpret_cast<char*>(x.data()), x.size()*sizeof(double)))
+        break;
+      xs_.push_back(x);
+    }
+
+    if (xs_.empty())
+      throw std::runtime_error("callback trace " + path + " is corrupt!");
+
+    callbacks_.push_back(static_cast<Callback>(event.callback_));
+    x_of_event_.push_back(xs_.size()-1);
+  }
+}
+
+
+/**
+ * @brief Empty constraint set, called with every evaluation of the constraints.
+ */
+class ConstraintProbe : public ifopt::ConstraintSet {
+public:
+  ConstraintProbe (const CallbackTraceWriter::Ptr& writer)
+      : ConstraintSet(0, "callback-trace-constraint-probe"), writer_(writer) {}
+
+  VectorXd GetValues () const override
+  {
+    writer_->Append(kConstraints, GetVariables()->GetValues());
+    return VectorXd();
+  }
+
+  VecBound GetBounds () const override { return VecBound(); };
+
+  void FillJacobianBlock (std::string var_set, Jacobian&) const override
+  {
+    // called once per variable set for every Jacobian.
+    if (var_set == first_variable_set_)
+      writer_->Append(kJacobian, GetVariables()->GetValues());
+  }
+
+private:
+  CallbackTraceWriter::Ptr writer_;
+  std::string first_variable_set_;
+
+  void InitVariableDependedQuantities (const VariablesPtr& x) override
+  {
+    first_variable_set_ = x->GetComponents().front()->GetName();
+  }
+};
+
+/**
+ * @brief Zero cost, called with every evaluation of the cost and gradient.
+ */
+class CostProbe : public ifopt::CostTerm {
+public:
+  CostProbe (const CallbackTraceWriter::Ptr& writer)
+      : CostTerm("callback-trace-cost-probe"), writer_(writer) {}
+
+  double GetCost () const override
+  {
+    writer_->Append(kCost, GetVariables()->GetValues());
+    return 0.0;
+  }
+
+  void FillJacobianBlock (std::string var_set, Jacobian&) const override
+  {
+    if (var_set == first_variable_set_)
+      writer_->Append(kGradient, GetVariables()->GetValues());
+  }
+
+private:
+  CallbackTraceWriter::Ptr writer_;
+  std::string first_variable_set_;
+
+  void InitVariableDependedQuantities (const VariablesPtr& x) override
+  {
+    first_variable_set_ = x->GetComponents().front()->GetName();
+  }
+};
+
+void
+RecordCallbacks (ifopt::Problem& nlp, const CallbackTraceWriter::Ptr& writer)
+{
+  nlp.AddConstraintSet(std::make_shared<ConstraintProbe>(writer));
+
+  // a cost probe would make a problem without costs look like it has one.
+  if (nlp.HasCostTerms())
+    nlp.AddCostSet(std::make_shared<CostProbe>(writer));
+}
+
+
+// FNV-1a, only to detect any difference in the output bits.
+static uint64_t
+Hash (const void* data, std::size_t size, uint64_t hash = 14695981039346656037ull)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (std::size_t i=0; i<size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+static uint64_t
+Hash (const Eigen::VectorXd& v)
+{
+  return Hash(v.data(), v.size()*sizeof(double));
+}
+
+ReplayResult
+ReplayCallbacks (const CallbackTraceReader& trace, ifopt::Problem& nlp)
+{
+  if (trace.GetVariableCount() != nlp.GetNumberOfOptimizationVariables())
+    throw std::runtime_error("callback trace has " + std::to_string(trace.GetVariableCount())
+                             + " variables, but the problem "
+                             + std::to_string(nlp.GetNumberOfOptimizationVariables()) + "!");
+
+  ReplayResult result;
+  result.time_.fill(0.0);
+  result.count_.fill(0);
+  result.digests_.reserve(trace.GetEventCount());
+
+  using Clock = std::chrono::steady_clock;
+
+  // the same calls of ifopt::Problem as those of the solver interface.
+  for (int e=0; e<trace.GetEventCount(); ++e) {
+    const double* x = trace.GetVariables(e).data();
+    Callback callback = trace.GetCallback(e);
+
+    uint64_t digest;
+    auto start = Clock::now();
+    switch (callback) {
+      case kConstraints:
+        digest = Hash(nlp.EvaluateConstraints(x));
+        break;
+      case kJacobian: {
+        nlp.SetVariables(x);
+        ifopt::Problem::Jacobian jac = nlp.GetJacobianOfConstraints();
+        jac.makeCompressed();
+        digest = Hash(jac.valuePtr(), jac.nonZeros()*sizeof(double));
+        digest = Hash(jac.innerIndexPtr(), jac.nonZeros()*sizeof(int), digest);
+        digest = Hash(jac.outerIndexPtr(), (jac.outerSize()+1)*sizeof(int), digest);
+        break;
+      }
+      case kCost: {
+        double cost = nlp.EvaluateCostFunction(x);
+        digest = Hash(&cost, sizeof(cost));
+        break;
+      }
+      case kGradient:
+        digest = Hash(nlp.EvaluateCostFunctionGradient(x));
+        break;
+      default:
+        throw std::runtime_error("unknown callback!");
+    }
+    result.time_.at(callback) += std::chrono::duration<double>(Clock::now() - start).count();
+    result.count_.at(callback)++;
+    result.digests_.push_back(digest);
+  }
+
+  return result;
+}
+
+} /* namespace towr */
@@ -0,0 +1,197 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ifopt/ipopt_solver.h>
+
+#include <towr/io/callback_trace.h>
+#include <towr/models/single_rigid_body_dynamics.h>
+#include <towr/planning/planning_server.h>
+
+using namespace towr;
+using namespace towr::callback_trace;
+
+static void
+BuildProblem (const planning_protocol::PlanRequest& request, bool generated_kernels,
+              SplineHolder& solution, ifopt::Problem& nlp)
+{
+  RobotModel model(static_cast<RobotModel::Robot>(request.robot_));
+  if (generated_kernels) {
+    auto srbd = std::dynamic_pointer_cast<SingleRigidBodyDynamics>(model.dynamic_model_);
+    if (!srbd)
+      throw std::runtime_error("generated kernels require a SingleRigidBodyDynamics model!");
+    srbd->SetKernels(SingleRigidBodyDynamics::GeneratedKernels);
+  }
+
+  auto terrain = HeightMap::MakeTerrain(static_cast<HeightMap::TerrainID>(request.terrain_));
+  NlpFormulation formulation = PlanningServer::GetFormulation(request, model, terrain);
+
+  for (auto c : formulation.GetVariableSets(solution))
+    nlp.AddVariableSet(c);
+  for (auto c : formulation.GetConstraints(solution))
+    nlp.AddConstraintSet(c);
+  for (auto c : formulation.GetCosts())
+    nlp.AddCostSet(c);
+}
+
+static int
+Record (const std::string& path, const std::vector<std::string>& args)
+{
+  planning_protocol::PlanRequest r = planning_protocol::PlanRequest();
+  r.robot_   = args.size() > 0? std::stoi(args.at(0)) : RobotModel::Anymal;
+  r.terrain_ = args.size() > 1? std::stoi(args.at(1)) : 0;
+  r.gait_    = args.size() > 2? std::stoi(args.at(2)) : 0;
+  r.total_duration_  = 2.0;
+  r.initial_base_[2] = 0.5;
+  r.final_base_[0]   = args.size() > 3? std::stod(args.at(3)) : 1.0;
+  r.final_base_[2]   = 0.5;
+
+  SplineHolder solution;
+  ifopt::Problem nlp;
+  BuildProblem(r, false, solution, nlp);
+
+  auto writer = std::make_shared<CallbackTraceWriter>(path, r, nlp.GetNumberOfOptimizationVariables());
+  RecordCallbacks(nlp, writer);
+
+  ifopt::IpoptSolver solver;
+  solver.SetOption("jacobian_approximation", "exact");
+  solver.SetOption("print_level", 0);
+  solver.SetOption("print_timing_statistics", "no");
+  solver.Solve(nlp);
+  writer->Flush();
+
+  std::cout << "Recorded " << writer->GetEventCount() << " callbacks of "
+            << nlp.GetIterationCount() << " iterations to " << path << std::endl;
+  return 0;
+}
+
+static int
+Replay (const std::string& path, const std::vector<std::string>& args)
+{
+  bool generated_kernels = false;
+  std::string save_digests, check_digests;
+  for (std::size_t i=0; i<args.size(); ++i) {
+    if (args.at(i) == "--generated-kernels")
+      generated_kernels = true;
+    else if (args.at(i) == "--save-digests" && i+1 < args.size())
+      save_digests = args.at(++i);
+    else if (args.at(i) == "--check-digests" && i+1 < args.size())
+      check_digests = args.at(++i);
+    else
+      throw std::runtime_error("unknown argument " + args.at(i) + "!");
+  }
+
+  CallbackTraceReader trace(path);
+  SplineHolder solution;
+  ifopt::Problem nlp;
+  BuildProblem(trace.GetRequest(), generated_kernels, solution, nlp);
+
+  ReplayResult result = ReplayCallbacks(trace, nlp);
+
+  double total = 0.0;
+  for (int c=0; c<static_cast<int>(kCallbackCount); ++c) {
+    total += result.time_.at(c);
+    std::cout << std::setw(12) << GetName(static_cast<Callback>(c)) << ": "
+              << std::setw(6) << result.count_.at(c) << " calls, "
+              << 1e3*result.time_.at(c) << " ms\n";
+  }
+  std::cout << std::setw(12) << "total" << ": " << std::setw(6) << trace.GetEventCount()
+            << " calls, " << 1e3*total << " ms" << std::endl;
+
+  if (!save_digests.empty()) {
+    std::ofstream file(save_digests);
+    for (uint64_t d : result.digests_)
+      file << std::hex << d << "\n";
+  }
+
+  if (!check_digests.empty()) {
+    std::ifstream file(check_digests);
+    std::vector<uint64_t> expected;
+    uint64_t d;
+    while (file >> std::hex >> d)
+      expected.push_back(d);
+
+    std::size_t n = std::min(expected.size(), result.digests_.size());
+    for (std::size_t e=0; e<n; ++e) {
+      if (expected.at(e) != result.digests_.at(e)) {
+        std::cout << "Outputs differ from the first at event " << e << " ("
+                  << GetName(trace.GetCallback(e)) << ")" << std::endl;
+        return 1;
+      }
+    }
+    if (expected.size() != result.digests_.size()) {
+      std::cout << "Digest file has " << expected.size() << " events, the trace "
+                << result.digests_.size() << std::endl;
+      return 1;
+    }
+    std::cout << "Outputs of all " << n << " events are bit-identical" << std::endl;
+  }
+
+  return 0;
+}
+
+/**
+ * Records the evaluation callbacks of a solve and replays them without
+ * the solver, e.g. to benchmark or compare versions of the evaluation code:
+ *
+ *   towr-callback-trace record <trace> [robot, default Anymal] [terrain, default 0]
+ *                                      [gait, default 0] [goal x, default 1.0]
+ *   towr-callback-trace replay <trace> [--generated-kernels]
+ *                                      [--save-digests <file>] [--check-digests <file>]
+ *
+ * The digests are a hash of the outputs of every event, so replaying with
+ * --save-digests in one build and --check-digests in another verifies that
+ * both compute bit-identical values.
+ */
+int main(int argc, char *argv[])
+{
+  if (argc < 3 || (std::string(argv[1]) != "record" && std::string(argv[1]) != "replay")) {
+    std::cerr << "Usage: " << argv[0] << " record <trace> [robot] [terrain] [gait] [goal_x]\n"
+              << "       " << argv[0] << " replay <trace> [--generated-kernels]"
+              << " [--save-digests <file>] [--check-digests <file>]" << std::endl;
+    return 1;
+  }
+
+  std::vector<std::string> args(argv+3, argv+argc);
+  try {
+    if (std::string(argv[1]) == "record")
+      return Record(argv[2], args);
+    else
+      return Replay(argv[2], args);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,234 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/variables/cubic_hermite_spline.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include <towr/variables/node_spline.h>
+
+namespace towr {
+
+CubicHermiteSpline::CubicHermiteSpline (const NodeSpline& spline)
+    : CubicHermiteSpline(spline.GetNodes(), spline.GetPolyDurations())
+{
+}
+
+CubicHermiteSpline::CubicHermiteSpline (const std::vector<Node>& nodes,
+                                        const VecTimes& poly_durations)
+{
+  assert(nodes.size() == poly_durations.size()+1);
+
+  int n_knots = nodes.size();
+  int n_dim   = nodes.front().p().rows();
+
+  bool is_quintic = nodes.front().GetDerivativeCount() > Node::n_derivatives;
+
+  knot_times_.resize(n_knots);
+  pos_.resize(n_dim, n_knots);
+  vel_.resize(n_dim, n_knots);
+  if (is_quintic)
+    acc_.resize(n_dim, n_knots);
+
+  double t = 0.0;
+  for (int k=0; k<n_knots; ++k) {
+    knot_times_.at(k) = t;
+    pos_.col(k) = nodes.at(k).p();
+    vel_.col(k) = nodes.at(k).v();
+    if (is_quintic)
+      acc_.col(k) = nodes.at(k).a();
+
+    if (k < poly_durations.size())
+      t += poly_durations.at(k);
+  }
+}
+
+CubicHermiteSpline::CubicHermiteSpline (const VecTimes& knot_times,
+                                        const MatrixXd& pos,
+                                        const MatrixXd& vel)
+    : knot_times_(knot_times),
+      pos_(pos),
+      vel_(vel)
+{
+  assert(knot_times.size() >= 2);
+  assert(pos.cols() == knot_times.size() && vel.cols() == knot_times.size());
+  assert(std::is_sorted(knot_times.begin(), knot_times.end()));
+}
+
+CubicHermiteSpline::CubicHermiteSpline (const VecTimes& knot_times,
+                                        const MatrixXd& pos,
+                                        const MatrixXd& vel,
+                                        const MatrixXd& acc)
+    : CubicHermiteSpline(knot_times, pos, vel)
+{
+  assert(acc.cols() == knot_times.size());
+  acc_ = acc;
+}
+
+// The coefficients of the polynomial from (p0,v0,a0) to (p1,v1,a1) of
+// duration T, the same as CubicHermitePolynomial::UpdateCoeff().
+static int
+GetCoeff (double p0, double v0, double a0, double p1, double v1, double a1,
+          double T, bool is_quintic, double* c)
+{
+  double T2 = T*T;
+  double T3 = T2*T;
+
+  if (!is_quintic) {
+    c[0] = p0;
+    c[1] = v0;
+    c[2] = -( 3*(p0 - p1) +  T*(2*v0 + v1) ) / T2;
+    c[3] =  ( 2*(p0 - p1) +  T*(  v0 + v1) ) / T3;
+    return 4;
+  }
+
+  double T4 = T3*T;
+  double T5 = T4*T;
+  c[0] = p0;
+  c[1] = v0;
+  c[2] = 0.5*a0;
+  c[3] = (-10*p0 - 6*T*v0 - 1.5*T2*a0 + 10*p1 - 4*T*v1 + 0.5*T2*a1) / T3;
+  c[4] = ( 15*p0 + 8*T*v0 + 1.5*T2*a0 - 15*p1 + 7*T*v1 -     T2*a1) / T4;
+  c[5] = ( -6*p0 - 3*T*v0 - 0.5*T2*a0 +  6*p1 - 3*T*v1 + 0.5*T2*a1) / T5;
+  return 6;
+}
+
+CubicHermiteSpline::MatrixXd
+CubicHermiteSpline::GetSegmentCoefficients (int k) const
+{
+  double T = knot_times_.at(k+1) - knot_times_.at(k);
+  MatrixXd coeff(GetDim(), IsQuintic()? 6 : 4);
+
+  double c[6];
+  for (int dim=0; dim<GetDim(); ++dim) {
+    double a0 = IsQuintic()? acc_(dim,k)   : 0.0;
+    double a1 = IsQuintic()? acc_(dim,k+1) : 0.0;
+    int n = GetCoeff(pos_(dim,k), vel_(dim,k), a0, pos_(dim,k+1), vel_(dim,k+1), a1,
+                     T, IsQuintic(), c);
+    for (int i=0; i<n; ++i)
+      coeff(dim,i) = c[i];
+  }
+
+  return coeff;
+}
+
+int
+CubicHermiteSpline::GetSegmentID (double t) const
+{
+  // at junctions, returns previous polynomial, same as Spline::GetSegmentID()
+  auto first = knot_times_.begin()+1;
+  auto last  = knot_times_.end()-1;
+  return std::lower_bound(first, last, t) - first;
+}
+
+void
+CubicHermiteSpline::GetPoint (double t_global,
+                              Eigen::Ref<VectorXd> pos,
+                              Eigen::Ref<VectorXd> vel,
+                              Eigen::Ref<VectorXd> acc) const
+{
+  t_global = std::max(knot_times_.front(), std::min(t_global, knot_times_.back()));
+
+  int k     = GetSegmentID(t_global);
+  double T  = knot_times_.at(k+1) - knot_times_.at(k);
+  double t  = t_global - knot_times_.at(k);
+
+  double c[6];
+  for (int dim=0; dim<pos_.rows(); ++dim) {
+    double a0 = IsQuintic()? acc_(dim,k)   : 0.0;
+    double a1 = IsQuintic()? acc_(dim,k+1) : 0.0;
+    int n = GetCoeff(pos_(dim,k), vel_(dim,k), a0, pos_(dim,k+1), vel_(dim,k+1), a1,
+                     T, IsQuintic(), c);
+
+    // Horner's scheme for the value and both derivatives
+    double p = 0.0, v = 0.0, a = 0.0;
+    for (int i=n-1; i>=0; --i) {
+      a = a*t + 2*v;
+      v = v*t + p;
+      p = p*t + c[i];
+    }
+    pos(dim) = p;
+    vel(dim) = v;
+    acc(dim) = a;
+  }
+}
+
+State
+CubicHermiteSpline::GetPoint (double t) const
+{
+  State state(GetDim(), 3);
+  GetPoint(t, state.at(kPos), state.at(kVel), state.at(kAcc));
+  return state;
+}
+
+double
+CubicHermiteSpline::GetTotalTime () const
+{
+  return knot_times_.empty()? 0.0 : knot_times_.back();
+}
+
+int
+CubicHermiteSpline::GetKnotCount () const
+{
+  return knot_times_.size();
+}
+
+int
+CubicHermiteSpline::GetDim () const
+{
+  return pos_.rows();
+}
+
+CubicHermiteSpline::VecTimes
+CubicHermiteSpline::GetPolyDurations () const
+{
+  VecTimes durations;
+  for (int k=1; k<knot_times_.size(); ++k)
+    durations.push_back(knot_times_.at(k) - knot_times_.at(k-1));
+
+  return durations;
+}
+
+std::vector<Node>
+CubicHermiteSpline::GetNodes () const
+{
+  int n_values = IsQuintic()? Node::n_derivatives+1 : Node::n_derivatives;
+  std::vector<Node> nodes(GetKnotCount(), Node(GetDim(), n_values));
+  for (int k=0; k<nodes.size(); ++k) {
+    nodes.at(k).at(kPos) = pos_.col(k);
+    nodes.at(k).at(kVel) = vel_.col(k);
+    if (IsQuintic())
+      nodes.at(k).at(kAcc) = acc_.col(k);
+  }
+
+  return nodes;
+}
+
+} /* namespace towr */
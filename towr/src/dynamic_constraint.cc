@@ -43,7 +43,7 @@ DynamicConstraint::DynamicConstraint (const DynamicModel::Ptr& m,
 
   // link with up-to-date spline variables
   base_linear_  = spline_holder.base_linear_;
-  base_angular_ = EulerConverter(spline_holder.base_angular_);
+  base_kinematics_ = spline_holder.base_kinematics_;
   ee_forces_    = spline_holder.ee_force_;
   ee_motion_    = spline_holder.ee_motion_;
 
@@ -89,19 +89,20 @@ DynamicConstraint::UpdateJacobianAtInstance(double t, int k, std::string var_set
   }
 
   if (var_set == id::base_ang_nodes) {
-    jac_model = model_->GetJacobianWrtBaseAng(base_angular_, t);
+    jac_model = model_->GetJacobianWrtBaseAng(base_kinematics_->GetEulerConverter(), t);
   }
 
-  // sensitivity of dynamic constraint w.r.t. endeffector variables
+  // sensitivity of dynamic constraint w.r.t. endeffector variables, which
+  // mirrored endeffectors share.
   for (int ee=0; ee<model_->GetEECount(); ++ee) {
-    if (var_set == id::EEForceNodes(ee)) {
+    if (var_set == ee_forces_.at(ee)->GetNodeVariablesName()) {
       Jacobian jac_ee_force = ee_forces_.at(ee)->GetJacobianWrtNodes(t,kPos);
-      jac_model = model_->GetJacobianWrtForce(jac_ee_force, ee);
+      jac_model += model_->GetJacobianWrtForce(jac_ee_force, ee);
     }
 
-    if (var_set == id::EEMotionNodes(ee)) {
+    if (var_set == ee_motion_.at(ee)->GetNodeVariablesName()) {
       Jacobian jac_ee_pos = ee_motion_.at(ee)->GetJacobianWrtNodes(t,kPos);
-      jac_model = model_->GetJacobianWrtEEPos(jac_ee_pos, ee);
+      jac_model += model_->GetJacobianWrtEEPos(jac_ee_pos, ee);
     }
 
     if (var_set == id::EESchedule(ee)) {
@@ -119,11 +120,7 @@ DynamicConstraint::UpdateJacobianAtInstance(double t, int k, std::string var_set
 void
 DynamicConstraint::UpdateModel (double t) const
 {
-  auto com = base_linear_->GetPoint(t);
-
-  Eigen::Matrix3d w_R_b = base_angular_.GetRotationMatrixBaseToWorld(t);
-  Eigen::Vector3d omega = base_angular_.GetAngularVelocityInWorld(t);
-  Eigen::Vector3d omega_dot = base_angular_.GetAngularAccelerationInWorld(t);
+  const BaseKinematics& base = base_kinematics_->GetBaseKinematics(t);
 
   int n_ee = model_->GetEECount();
   std::vector<Eigen::Vector3d> ee_pos;
@@ -133,7 +130,8 @@ DynamicConstraint::UpdateModel (double t) const
     ee_pos.push_back(ee_motion_.at(ee)->GetPoint(t).p());
   }
 
-  model_->SetCurrent(com.p(), com.a(), w_R_b, omega, omega_dot, ee_force, ee_pos);
+  model_->SetCurrent(base.lin_.p(), base.lin_.a(), base.w_R_b_, base.omega_,
+                     base.omega_dot_, ee_force, ee_pos);
 }
 
 } /* namespace towr */
@@ -223,7 +223,13 @@ EulerConverter::GetRotationMatrixBaseToWorld (const EulerAngles& xyz)
 EulerConverter::Jacobian
 EulerConverter::DerivOfRotVecMult (double t, const Vector3d& v, bool inverse) const
 {
-  JacRowMatrix Rd = GetDerivativeOfRotationMatrixWrtNodes(t);
+  return DerivOfRotVecMult(GetDerivativeOfRotationMatrixWrtNodes(t), v, inverse);
+}
+
+EulerConverter::Jacobian
+EulerConverter::DerivOfRotVecMult (const JacRowMatrix& Rd, const Vector3d& v,
+                                   bool inverse) const
+{
   Jacobian jac = jac_wrt_nodes_structure_;
 
   for (int row : {X,Y,Z}) {
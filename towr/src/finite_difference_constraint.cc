@@ -0,0 +1,102 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/constraints/finite_difference_constraint.h>
+
+namespace towr {
+
+FiniteDifferenceConstraint::FiniteDifferenceConstraint (int n_constraints,
+                                                        const std::string& name,
+                                                        const VariableSetNames& variable_sets,
+                                                        const Jacobian& sparsity,
+                                                        int thread_count)
+    : ConstraintSet(n_constraints, name),
+      jacobian_(sparsity, thread_count)
+{
+  variable_sets_ = variable_sets;
+}
+
+FiniteDifferenceConstraint::FiniteDifferenceConstraint (int n_constraints,
+                                                        const std::string& name,
+                                                        const std::string& variable_set,
+                                                        const Jacobian& sparsity,
+                                                        int thread_count)
+    : FiniteDifferenceConstraint(n_constraints, name,
+                                 VariableSetNames{variable_set},
+                                 sparsity, thread_count)
+{
+}
+
+FiniteDifferenceConstraint::VectorXd
+FiniteDifferenceConstraint::GetVariableValues () const
+{
+  std::vector<VectorXd> values;
+  int n = 0;
+  for (const auto& set : variable_sets_) {
+    values.push_back(GetVariables()->GetComponent(set)->GetValues());
+    n += values.back().rows();
+  }
+
+  VectorXd x(n);
+  int row = 0;
+  for (const auto& v : values) {
+    x.segment(row, v.rows()) = v;
+    row += v.rows();
+  }
+
+  return x;
+}
+
+FiniteDifferenceConstraint::VectorXd
+FiniteDifferenceConstraint::GetValues () const
+{
+  return EvaluateAt(GetVariableValues());
+}
+
+void
+FiniteDifferenceConstraint::FillJacobianBlock (std::string var_set, Jacobian& jac) const
+{
+  int col = 0;
+  for (const auto& set : variable_sets_) {
+    int n = GetVariables()->GetComponent(set)->GetRows();
+    if (set == var_set) {
+      // the variables don't change between the blocks of one Jacobian
+      VectorXd x = GetVariableValues();
+      if (x.size() != x_jacobian_.size() || x != x_jacobian_) {
+        jacobian_all_ = jacobian_.Evaluate([this](const VectorXd& x_h) { return EvaluateAt(x_h); }, x);
+        x_jacobian_ = x;
+      }
+      jac = jacobian_all_.middleCols(col, n);
+      return;
+    }
+    col += n;
+  }
+}
+
+} /* namespace towr */
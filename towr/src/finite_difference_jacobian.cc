@@ -0,0 +1,168 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/constraints/finite_difference_jacobian.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace towr {
+
+FiniteDifferenceJacobian::FiniteDifferenceJacobian (const Jacobian& sparsity,
+                                                    int thread_count)
+{
+  structure_ = sparsity;
+  structure_.makeCompressed();
+
+  thread_count_ = thread_count > 0? thread_count : std::thread::hardware_concurrency();
+  thread_count_ = std::max(1, thread_count_);
+
+  ColorColumns();
+}
+
+void
+FiniteDifferenceJacobian::ColorColumns ()
+{
+  int n_cols = structure_.cols();
+
+  // rows in which each column is nonzero, the transpose of the structure
+  std::vector<std::vector<int>> rows_of_col(n_cols);
+  for (int row=0; row<structure_.outerSize(); ++row)
+    for (Jacobian::InnerIterator it(structure_, row); it; ++it)
+      rows_of_col.at(it.col()).push_back(row);
+
+  // the densest columns are the most constrained, so are coloured first
+  std::vector<int> order(n_cols);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return rows_of_col.at(a).size() > rows_of_col.at(b).size();
+  });
+
+  const int uncolored = -1;
+  color_of_col_.assign(n_cols, uncolored);
+  std::vector<int> forbidden_for; // the column a colour was last excluded for
+
+  for (int col : order) {
+    // a column can't share a colour with any column it shares a row with
+    for (int row : rows_of_col.at(col)) {
+      for (Jacobian::InnerIterator it(structure_, row); it; ++it) {
+        int c = color_of_col_.at(it.col());
+        if (c != uncolored)
+          forbidden_for.at(c) = col;
+      }
+    }
+
+    int color = 0;
+    while (color < forbidden_for.size() && forbidden_for.at(color) == col)
+      ++color;
+
+    if (color == forbidden_for.size()) {
+      forbidden_for.push_back(uncolored);
+      cols_of_color_.push_back({});
+    }
+
+    color_of_col_.at(col) = color;
+    cols_of_color_.at(color).push_back(col);
+  }
+}
+
+FiniteDifferenceJacobian::Jacobian
+FiniteDifferenceJacobian::Evaluate (const Function& g, const VectorXd& x) const
+{
+  if (x.rows() != structure_.cols())
+    throw std::runtime_error("FiniteDifferenceJacobian: sparsity has "
+                             + std::to_string(structure_.cols()) + " columns, but "
+                             + std::to_string(x.rows()) + " variables given!");
+
+  VectorXd g_x = g(x);
+  if (g_x.rows() != structure_.rows())
+    throw std::runtime_error("FiniteDifferenceJacobian: sparsity has "
+                             + std::to_string(structure_.rows()) + " rows, but "
+                             + std::to_string(g_x.rows()) + " values returned!");
+
+  // the perturbation actually representable in floating point
+  VectorXd h(x.rows());
+  for (int j=0; j<x.rows(); ++j) {
+    volatile double x_h = x(j) + step_*std::max(1.0, std::abs(x(j)));
+    h(j) = x_h - x(j);
+  }
+
+  int n_colors = GetColorCount();
+  std::vector<VectorXd> diff(n_colors);
+  std::atomic<int> next_color(0);
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  // as in BatchPlanner, each thread takes the next colour until none are left.
+  auto work = [&]() {
+    int c;
+    while ((c = next_color++) < n_colors) {
+      try {
+        VectorXd x_h = x;
+        for (int col : cols_of_color_.at(c))
+          x_h(col) += h(col);
+        diff.at(c) = g(x_h) - g_x;
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        error = std::current_exception();
+      }
+    }
+  };
+
+  int n_threads = std::min(thread_count_, std::max(1, n_colors));
+  std::vector<std::thread> workers;
+  for (int t=1; t<n_threads; ++t)
+    workers.emplace_back(work);
+  work();
+
+  for (auto& w : workers)
+    w.join();
+
+  if (error)
+    std::rethrow_exception(error);
+
+  // each nonzero is read from the evaluation of its column's colour
+  Jacobian jac = structure_;
+  for (int row=0; row<jac.outerSize(); ++row) {
+    for (Jacobian::InnerIterator it(jac, row); it; ++it) {
+      int col = it.col();
+      it.valueRef() = diff.at(color_of_col_.at(col))(row)/h(col);
+    }
+  }
+
+  return jac;
+}
+
+} /* namespace towr */
@@ -65,22 +65,28 @@ ForceConstraint::GetValues () const
   VectorXd g(GetRows());
 
   int row=0;
+  int phase = -1;
+  Vector3d n, t1, t2;
   auto force_nodes = ee_force_->GetNodes();
   for (int f_node_id : pure_stance_force_node_ids_) {
-    int phase  = ee_force_->GetPhase(f_node_id);
-    Vector3d p = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during stance phase
-    Vector3d n = terrain_->GetNormalizedBasis(HeightMap::Normal, p.x(), p.y());
+    // foothold and therefore terrain don't change during the stance phase
+    if (ee_force_->GetPhase(f_node_id) != phase) {
+      phase = ee_force_->GetPhase(f_node_id);
+      Vector3d p = ee_motion_->GetValueAtStartOfPhase(phase);
+      n  = terrain_->GetNormalizedBasis(HeightMap::Normal,   p.x(), p.y());
+      t1 = terrain_->GetNormalizedBasis(HeightMap::Tangent1, p.x(), p.y());
+      t2 = terrain_->GetNormalizedBasis(HeightMap::Tangent2, p.x(), p.y());
+    }
+
     Vector3d f = force_nodes.at(f_node_id).p();
 
     // unilateral force
     g(row++) = f.transpose() * n; // >0 (unilateral forces)
 
     // frictional pyramid
-    Vector3d t1 = terrain_->GetNormalizedBasis(HeightMap::Tangent1, p.x(), p.y());
     g(row++) = f.transpose() * (t1 - mu_*n); // t1 < mu*n
     g(row++) = f.transpose() * (t1 + mu_*n); // t1 > -mu*n
 
-    Vector3d t2 = terrain_->GetNormalizedBasis(HeightMap::Tangent2, p.x(), p.y());
     g(row++) = f.transpose() * (t2 - mu_*n); // t2 < mu*n
     g(row++) = f.transpose() * (t2 + mu_*n); // t2 > -mu*n
   }
@@ -108,26 +114,30 @@ void
 ForceConstraint::FillJacobianBlock (std::string var_set,
                                     Jacobian& jac) const
 {
-  if (var_set == ee_force_->GetName()) {
+  if (var_set == ee_force_->GetOptVariablesName()) {
     int row = 0;
+    int phase = -1;
+    Vector3d n, t1, t2;
     for (int f_node_id : pure_stance_force_node_ids_) {
-      // unilateral force
-      int phase   = ee_force_->GetPhase(f_node_id);
-      Vector3d p  = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during phase
-      Vector3d n  = terrain_->GetNormalizedBasis(HeightMap::Normal,   p.x(), p.y());
-      Vector3d t1 = terrain_->GetNormalizedBasis(HeightMap::Tangent1, p.x(), p.y());
-      Vector3d t2 = terrain_->GetNormalizedBasis(HeightMap::Tangent2, p.x(), p.y());
+      if (ee_force_->GetPhase(f_node_id) != phase) {
+        phase = ee_force_->GetPhase(f_node_id);
+        Vector3d p = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during phase
+        n  = terrain_->GetNormalizedBasis(HeightMap::Normal,   p.x(), p.y());
+        t1 = terrain_->GetNormalizedBasis(HeightMap::Tangent1, p.x(), p.y());
+        t2 = terrain_->GetNormalizedBasis(HeightMap::Tangent2, p.x(), p.y());
+      }
 
       for (auto dim : {X,Y,Z}) {
         int idx = ee_force_->GetOptIndex(NodesVariables::NodeValueInfo(f_node_id, kPos, dim));
+        double s = ee_force_->GetScale(dim);
 
         int row_reset=row;
 
-        jac.coeffRef(row_reset++, idx) = n(dim);              // unilateral force
-        jac.coeffRef(row_reset++, idx) = t1(dim)-mu_*n(dim);  // f_t1 <  mu*n
-        jac.coeffRef(row_reset++, idx) = t1(dim)+mu_*n(dim);  // f_t1 > -mu*n
-        jac.coeffRef(row_reset++, idx) = t2(dim)-mu_*n(dim);  // f_t2 <  mu*n
-        jac.coeffRef(row_reset++, idx) = t2(dim)+mu_*n(dim);  // f_t2 > -mu*n
+        jac.coeffRef(row_reset++, idx) = s*n(dim);                // unilateral force
+        jac.coeffRef(row_reset++, idx) = s*(t1(dim)-mu_*n(dim));  // f_t1 <  mu*n
+        jac.coeffRef(row_reset++, idx) = s*(t1(dim)+mu_*n(dim));  // f_t1 > -mu*n
+        jac.coeffRef(row_reset++, idx) = s*(t2(dim)-mu_*n(dim));  // f_t2 <  mu*n
+        jac.coeffRef(row_reset++, idx) = s*(t2(dim)+mu_*n(dim));  // f_t2 > -mu*n
       }
 
       row += n_constraints_per_node_;
@@ -135,34 +145,41 @@ ForceConstraint::FillJacobianBlock (std::string var_set,
   }
 
 
-  if (var_set == ee_motion_->GetName()) {
+  if (var_set == ee_motion_->GetOptVariablesName()) {
     int row = 0;
+    int phase = -1, ee_node_id = -1;
+    Vector3d dn[k2D], dt1[k2D], dt2[k2D];
     auto force_nodes = ee_force_->GetNodes();
     for (int f_node_id : pure_stance_force_node_ids_) {
-      int phase  = ee_force_->GetPhase(f_node_id);
-      int ee_node_id = ee_motion_->GetNodeIDAtStartOfPhase(phase);
+      if (ee_force_->GetPhase(f_node_id) != phase) {
+        phase = ee_force_->GetPhase(f_node_id);
+        ee_node_id = ee_motion_->GetNodeIDAtStartOfPhase(phase);
+
+        Vector3d p = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during phase
+        for (auto dim : {X_,Y_}) {
+          dn[dim]  = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Normal, dim, p.x(), p.y());
+          dt1[dim] = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Tangent1, dim, p.x(), p.y());
+          dt2[dim] = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Tangent2, dim, p.x(), p.y());
+        }
+      }
 
-      Vector3d p = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during pahse
       Vector3d f = force_nodes.at(f_node_id).p();
 
       for (auto dim : {X_,Y_}) {
-        Vector3d dn  = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Normal, dim, p.x(), p.y());
-        Vector3d dt1 = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Tangent1, dim, p.x(), p.y());
-        Vector3d dt2 = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Tangent2, dim, p.x(), p.y());
-
         int idx = ee_motion_->GetOptIndex(NodesVariables::NodeValueInfo(ee_node_id, kPos, dim));
+        double s = ee_motion_->GetScale(dim);
         int row_reset=row;
 
         // unilateral force
-        jac.coeffRef(row_reset++, idx) = f.transpose()*dn;
+        jac.coeffRef(row_reset++, idx) = s*f.transpose()*dn[dim];
 
         // friction force tangent 1 derivative
-        jac.coeffRef(row_reset++, idx) = f.transpose()*(dt1-mu_*dn);
-        jac.coeffRef(row_reset++, idx) = f.transpose()*(dt1+mu_*dn);
+        jac.coeffRef(row_reset++, idx) = s*f.transpose()*(dt1[dim]-mu_*dn[dim]);
+        jac.coeffRef(row_reset++, idx) = s*f.transpose()*(dt1[dim]+mu_*dn[dim]);
 
         // friction force tangent 2 derivative
-        jac.coeffRef(row_reset++, idx) = f.transpose()*(dt2-mu_*dn);
-        jac.coeffRef(row_reset++, idx) = f.transpose()*(dt2+mu_*dn);
+        jac.coeffRef(row_reset++, idx) = s*f.transpose()*(dt2[dim]-mu_*dn[dim]);
+        jac.coeffRef(row_reset++, idx) = s*f.transpose()*(dt2[dim]+mu_*dn[dim]);
       }
 
       row += n_constraints_per_node_;
@@ -0,0 +1,423 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/initialization/gait_search.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include <Eigen/Geometry>
+
+namespace towr {
+
+using Eigen::Vector3d;
+using Eigen::Matrix3d;
+
+namespace {
+
+// A foot in contact with the terrain at a fixed foothold.
+struct Stance {
+  int ee;
+  double t0, t1;
+  Vector3d p;
+};
+
+// The base moves linearly from start to goal at a constant height above
+// the terrain. This is the reference all cheap checks are relative to.
+class BasePath {
+public:
+  BasePath (const NlpFormulation& problem, double T)
+      : problem_(problem), T_(T)
+  {
+    const Vector3d& p0 = problem.initial_base_.lin.p();
+    const Vector3d& p1 = problem.final_base_.lin.p();
+    h0_ = p0.z() - problem.terrain_->GetHeight(p0.x(), p0.y());
+    h1_ = p1.z() - problem.terrain_->GetHeight(p1.x(), p1.y());
+  }
+
+  Vector3d GetPos (double t) const
+  {
+    double s = t/T_;
+    Vector3d p = (1-s)*problem_.initial_base_.lin.p() + s*problem_.final_base_.lin.p();
+    p.z() = problem_.terrain_->GetHeight(p.x(), p.y()) + (1-s)*h0_ + s*h1_;
+    return p;
+  }
+
+  Matrix3d GetYawRotation (double t) const
+  {
+    double s = t/T_;
+    double yaw = (1-s)*problem_.initial_base_.ang.p().z() + s*problem_.final_base_.ang.p().z();
+    return Eigen::AngleAxisd(yaw, Vector3d::UnitZ()).toRotationMatrix();
+  }
+
+private:
+  const NlpFormulation& problem_;
+  double T_, h0_, h1_;
+};
+
+// Footholds below the base path at the middle of each stance phase, except
+// for the initial ones, which are fixed by the problem.
+std::vector<Stance>
+GetStances (const NlpFormulation& problem, const BasePath& path,
+            const GaitSearch::Candidate& c)
+{
+  auto nominal = problem.model_.kinematic_model_->GetNominalStanceInBase();
+
+  std::vector<Stance> stances;
+  for (int ee=0; ee<c.ee_phase_durations_.size(); ++ee) {
+    bool contact = c.ee_in_contact_at_start_.at(ee);
+    double t = 0.0;
+    for (double d : c.ee_phase_durations_.at(ee)) {
+      if (contact) {
+        Stance s;
+        s.ee = ee;
+        s.t0 = t;
+        s.t1 = t+d;
+        if (t == 0.0 && ee < problem.initial_ee_W_.size()) {
+          s.p = problem.initial_ee_W_.at(ee);
+        } else {
+          double t_mid = t + d/2;
+          s.p = path.GetPos(t_mid) + path.GetYawRotation(t_mid)*nominal.at(ee);
+          s.p.z() = problem.terrain_->GetHeight(s.p.x(), s.p.y());
+        }
+        stances.push_back(s);
+      }
+      t += d;
+      contact = !contact;
+    }
+  }
+
+  return stances;
+}
+
+} // namespace
+
+
+GaitSearch::GaitSearch (const GaitSearchOptions& options)
+    : options_(options)
+{
+}
+
+// Returns the minimum of the summed artificial variables.
+double
+GaitSearch::GetDistanceToFeasibility (Eigen::MatrixXd A, Eigen::VectorXd b)
+{
+  int m = A.rows();
+  int n = A.cols();
+
+  for (int i=0; i<m; ++i) {
+    if (b(i) < 0.0) {
+      A.row(i) *= -1;
+      b(i) *= -1;
+    }
+  }
+
+  // artificial variables start as the basis and never re-enter once they
+  // left it, so their columns are not stored.
+  Eigen::MatrixXd tableau(m+1, n+1);
+  tableau.topLeftCorner(m, n) = A;
+  tableau.topRightCorner(m, 1) = b;
+  tableau.bottomLeftCorner(1, n) = -A.colwise().sum();
+  tableau(m, n) = -b.sum();
+
+  const double eps = 1e-9;
+  int max_iterations = 10*(m+n);
+  for (int iter=0; iter<max_iterations; ++iter) {
+    int col;
+    if (tableau.row(m).head(n).minCoeff(&col) > -eps)
+      break; // optimal
+
+    int row = -1;
+    double min_ratio = std::numeric_limits<double>::infinity();
+    for (int i=0; i<m; ++i) {
+      if (tableau(i, col) > eps) {
+        double ratio = tableau(i, n)/tableau(i, col);
+        if (ratio < min_ratio) {
+          min_ratio = ratio;
+          row = i;
+        }
+      }
+    }
+
+    if (row < 0)
+      break; // unbounded, can't happen as objective is bounded by zero.
+
+    tableau.row(row) /= tableau(row, col);
+    for (int i=0; i<=m; ++i)
+      if (i != row && tableau(i, col) != 0.0)
+        tableau.row(i) -= tableau(i, col)*tableau.row(row);
+  }
+
+  return std::max(0.0, -tableau(m, n));
+}
+
+GaitSearch::Gaits
+GaitSearch::GetDefaultStrides (int ee_count)
+{
+  using G = GaitGenerator;
+  switch (ee_count) {
+    case 1: return {G::Hop1, G::Hop2};
+    case 2: return {G::Walk1, G::Run1, G::Hop1, G::Hop2, G::Hop3, G::Hop5};
+    case 4: return {G::Walk1, G::Walk2, G::Run1, G::Run2, G::Run3,
+                    G::Hop1, G::Hop2, G::Hop3, G::Hop5};
+    default: throw std::runtime_error("no gaits for " + std::to_string(ee_count) + " legs!");
+  }
+}
+
+void
+GaitSearch::Apply (const Candidate& candidate, NlpFormulation& problem)
+{
+  problem.params_.ee_phase_durations_     = candidate.ee_phase_durations_;
+  problem.params_.ee_in_contact_at_start_ = candidate.ee_in_contact_at_start_;
+}
+
+GaitSearch::Candidate
+GaitSearch::Evaluate (const NlpFormulation& problem) const
+{
+  Candidate c;
+  c.ee_phase_durations_     = problem.params_.ee_phase_durations_;
+  c.ee_in_contact_at_start_ = problem.params_.ee_in_contact_at_start_;
+
+  ScoreGeometry(problem, c);
+  ScoreImpulse(problem, c);
+  UpdateScore(c);
+  return c;
+}
+
+std::vector<GaitSearch::Candidate>
+GaitSearch::Search (const NlpFormulation& problem, int k) const
+{
+  double T = problem.params_.GetTotalTime();
+  if (T <= 0.0)
+    throw std::runtime_error("set phase durations to define the total duration of the search!");
+
+  int n_ee = problem.model_.kinematic_model_->GetNumberOfEndeffectors();
+  auto gait_gen = GaitGenerator::MakeGaitGenerator(n_ee);
+  Gaits strides = options_.strides_.empty()? GetDefaultStrides(n_ee) : options_.strides_;
+
+  // all sequences of strides, counting through them like an odometer
+  std::vector<Candidate> candidates;
+  for (int n=options_.min_stride_count_; n<=options_.max_stride_count_; ++n) {
+    std::vector<int> digits(n, 0);
+    while (true) {
+      Candidate c;
+      c.gaits_.push_back(GaitGenerator::Stand);
+      for (int d : digits)
+        c.gaits_.push_back(strides.at(d));
+      c.gaits_.push_back(GaitGenerator::Stand);
+
+      gait_gen->SetGaits(c.gaits_);
+      for (int ee=0; ee<n_ee; ++ee) {
+        c.ee_phase_durations_.push_back(gait_gen->GetPhaseDurations(T, ee));
+        c.ee_in_contact_at_start_.push_back(gait_gen->IsInContactAtStart(ee));
+      }
+
+      ScoreGeometry(problem, c);
+      UpdateScore(c);
+      candidates.push_back(c);
+
+      int i = 0;
+      while (i<n && ++digits.at(i) == strides.size())
+        digits.at(i++) = 0;
+      if (i == n)
+        break;
+    }
+  }
+
+  auto by_score = [](const Candidate& a, const Candidate& b) { return a.score_ < b.score_; };
+
+  // only the geometrically most promising ones are worth the LP
+  int n_impulse = std::min<int>(candidates.size(), std::max(k, options_.impulse_check_count_));
+  std::partial_sort(candidates.begin(), candidates.begin()+n_impulse, candidates.end(), by_score);
+  candidates.resize(n_impulse);
+
+  for (auto& c : candidates) {
+    ScoreImpulse(problem, c);
+    UpdateScore(c);
+  }
+
+  std::stable_sort(candidates.begin(), candidates.end(), by_score);
+  candidates.resize(std::min<int>(k, candidates.size()));
+  return candidates;
+}
+
+void
+GaitSearch::UpdateScore (Candidate& c) const
+{
+  c.score_ = options_.weight_reach_  *c.reach_violation_
+           + options_.weight_terrain_*c.terrain_cost_
+           + options_.weight_impulse_*c.impulse_violation_;
+}
+
+void
+GaitSearch::ScoreGeometry (const NlpFormulation& problem, Candidate& c) const
+{
+  double T = problem.params_.GetTotalTime();
+  BasePath path(problem, T);
+  auto nominal = problem.model_.kinematic_model_->GetNominalStanceInBase();
+  Vector3d max_dev = problem.model_.kinematic_model_->GetMaximumDeviationFromNominal();
+  const HeightMap& terrain = *problem.terrain_;
+  double mu = terrain.GetFrictionCoeff();
+  double r = options_.foothold_radius_;
+
+  c.reach_violation_ = 0.0;
+  c.terrain_cost_    = 0.0;
+  for (const Stance& s : GetStances(problem, path, c)) {
+    // the foot doesn't move while in stance, but the base does
+    for (double t : {s.t0, s.t1}) {
+      Vector3d dev = path.GetYawRotation(t).transpose()*(s.p - path.GetPos(t)) - nominal.at(s.ee);
+      c.reach_violation_ += (dev.cwiseAbs() - max_dev).cwiseMax(0.0).sum();
+    }
+
+    // edges and gaps show as deviation from the tangent plane
+    double h  = terrain.GetHeight(s.p.x(), s.p.y());
+    double dx = terrain.GetDerivativeOfHeightWrt(X_, s.p.x(), s.p.y());
+    double dy = terrain.GetDerivativeOfHeightWrt(Y_, s.p.x(), s.p.y());
+    double roughness = 0.0;
+    for (int i=0; i<8; ++i) {
+      double ox = r*std::cos(i*M_PI/4);
+      double oy = r*std::sin(i*M_PI/4);
+      double h_plane = h + dx*ox + dy*oy;
+      roughness = std::max(roughness, std::abs(terrain.GetHeight(s.p.x()+ox, s.p.y()+oy) - h_plane));
+    }
+
+    Vector3d n = terrain.GetNormalizedBasis(HeightMap::Normal, s.p.x(), s.p.y());
+    double tan_slope = std::sqrt(std::max(0.0, 1.0 - n.z()*n.z()))/n.z();
+    c.terrain_cost_ += roughness/r + (1.0 - n.z()) + std::max(0.0, tan_slope - mu);
+  }
+}
+
+void
+GaitSearch::ScoreImpulse (const NlpFormulation& problem, Candidate& c) const
+{
+  double T = problem.params_.GetTotalTime();
+  BasePath path(problem, T);
+  std::vector<Stance> stances = GetStances(problem, path, c);
+  Vector3d max_dev = problem.model_.kinematic_model_->GetMaximumDeviationFromNominal();
+  const HeightMap& terrain = *problem.terrain_;
+  double mu = terrain.GetFrictionCoeff();
+
+  // forces are in units of the robot's weight for a well scaled LP
+  double m = problem.model_.dynamic_model_->m();
+  double g = problem.model_.dynamic_model_->g();
+  double f_max = problem.params_.force_limit_in_normal_direction_/(m*g);
+  Vector3d gravity(0.0, 0.0, -g);
+
+  // phases of the whole robot, during which no contact changes
+  std::vector<double> times = {0.0, T};
+  for (const Stance& s : stances) {
+    times.push_back(s.t0);
+    times.push_back(s.t1);
+  }
+  std::sort(times.begin(), times.end());
+  times.erase(std::unique(times.begin(), times.end(),
+                          [](double a, double b) { return std::abs(a-b) < 1e-9; }),
+              times.end());
+  int n_phases = times.size()-1;
+
+  // the force of every stance foot in every phase is a nonnegative
+  // combination of the edges of the friction pyramid.
+  struct Force { int phase; Eigen::Matrix<double,3,4> edges; };
+  std::vector<Force> forces;
+  for (int j=0; j<n_phases; ++j) {
+    double t_mid = (times.at(j) + times.at(j+1))/2;
+    for (const Stance& s : stances) {
+      if (s.t0 <= t_mid && t_mid < s.t1) {
+        Vector3d n  = terrain.GetNormalizedBasis(HeightMap::Normal,   s.p.x(), s.p.y());
+        Vector3d t1 = terrain.GetNormalizedBasis(HeightMap::Tangent1, s.p.x(), s.p.y());
+        Vector3d t2 = terrain.GetNormalizedBasis(HeightMap::Tangent2, s.p.x(), s.p.y());
+        Force f;
+        f.phase = j;
+        f.edges << n+mu*t1, n-mu*t1, n+mu*t2, n-mu*t2;
+        forces.push_back(f);
+      }
+    }
+  }
+
+  int n_lambda = 4*forces.size();
+  int n_ineq   = 6*(n_phases-1) + forces.size();
+  int n_rows   = 6 + n_ineq;
+  Eigen::MatrixXd A = Eigen::MatrixXd::Zero(n_rows, n_lambda + n_ineq);
+  Eigen::VectorXd b(n_rows);
+
+  // Effect of the constant acceleration in phase j on the position at t:
+  // a*h*(t - t_j - h/2), and on the velocity: a*h.
+  auto position_weight = [&](int j, double t) {
+    double h = times.at(j+1) - times.at(j);
+    return h*(t - times.at(j) - h/2);
+  };
+
+  const Vector3d& p0 = problem.initial_base_.lin.p();
+  const Vector3d& v0 = problem.initial_base_.lin.v();
+
+  // reach the goal position and velocity
+  for (int i=0; i<forces.size(); ++i) {
+    int j = forces.at(i).phase;
+    double h = times.at(j+1) - times.at(j);
+    A.block(0, 4*i, 3, 4) = g*position_weight(j, T)*forces.at(i).edges;
+    A.block(3, 4*i, 3, 4) = g*h*forces.at(i).edges;
+  }
+  b.segment(0, 3) = problem.final_base_.lin.p() - p0 - v0*T - gravity*T*T/2;
+  b.segment(3, 3) = problem.final_base_.lin.v() - v0 - gravity*T;
+
+  // stay within the kinematic range around the base path at phase switches
+  int row = 6;
+  int slack = n_lambda;
+  for (int k=1; k<n_phases; ++k) {
+    double t = times.at(k);
+    for (int i=0; i<forces.size(); ++i) {
+      int j = forces.at(i).phase;
+      if (j < k) {
+        A.block(row,   4*i, 3, 4) =  g*position_weight(j, t)*forces.at(i).edges;
+        A.block(row+3, 4*i, 3, 4) = -g*position_weight(j, t)*forces.at(i).edges;
+      }
+    }
+    Vector3d p_free = p0 + v0*t + gravity*t*t/2;
+    Vector3d p_ref  = path.GetPos(t);
+    b.segment(row,   3) =  (p_ref + max_dev - p_free);
+    b.segment(row+3, 3) = -(p_ref - max_dev - p_free);
+    for (int d=0; d<6; ++d)
+      A(row+d, slack++) = 1.0;
+    row += 6;
+  }
+
+  // edges are normalized in normal direction, so their sum is the normal force
+  for (int i=0; i<forces.size(); ++i) {
+    A.block(row, 4*i, 1, 4).setOnes();
+    A(row, slack++) = 1.0;
+    b(row++) = f_max;
+  }
+
+  c.impulse_violation_ = GetDistanceToFeasibility(A, b);
+}
+
+} /* namespace towr */
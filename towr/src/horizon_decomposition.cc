@@ -0,0 +1,415 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/planning/horizon_decomposition.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <Eigen/Geometry>
+
+namespace towr {
+
+namespace {
+
+using Interval = std::pair<double,double>;
+using Vector3d = Eigen::Vector3d;
+
+// The times during which all endeffectors are in contact.
+std::vector<Interval>
+GetFullStanceIntervals (const Parameters& params)
+{
+  std::vector<Interval> full = {{0.0, params.GetTotalTime()}};
+
+  for (int ee=0; ee<params.GetEECount(); ++ee) {
+    std::vector<Interval> stance;
+    bool contact = params.ee_in_contact_at_start_.at(ee);
+    double t = 0.0;
+    for (double d : params.ee_phase_durations_.at(ee)) {
+      if (contact)
+        stance.push_back({t, t+d});
+      t += d;
+      contact = !contact;
+    }
+
+    std::vector<Interval> intersection;
+    for (const auto& a : full) {
+      for (const auto& b : stance) {
+        Interval i(std::max(a.first, b.first), std::min(a.second, b.second));
+        if (i.second - i.first > 1e-6)
+          intersection.push_back(i);
+      }
+    }
+    full = intersection;
+  }
+
+  return full;
+}
+
+// The time closest to t within [t_min, t_max] at which all feet are in
+// contact, away from the edges of the full stance interval.
+double
+SnapToFullStance (const std::vector<Interval>& intervals, double t,
+                  double t_min = -std::numeric_limits<double>::infinity(),
+                  double t_max =  std::numeric_limits<double>::infinity())
+{
+  double snapped = t;
+  double min_distance = std::numeric_limits<double>::infinity();
+  for (const auto& i : intervals) {
+    double margin = 0.25*(i.second - i.first);
+    double lower = std::max(i.first+margin, t_min);
+    double upper = std::min(i.second-margin, t_max);
+    if (lower > upper)
+      continue;
+
+    double c = std::max(lower, std::min(t, upper));
+    if (std::abs(c-t) < min_distance) {
+      min_distance = std::abs(c-t);
+      snapped = c;
+    }
+  }
+
+  if (std::isinf(min_distance))
+    throw std::runtime_error("too many windows for the contact schedule!");
+
+  return snapped;
+}
+
+// The phases of each endeffector between t0 and t1.
+std::vector<Parameters::VecTimes>
+CutPhaseDurations (const Parameters& params, double t0, double t1)
+{
+  std::vector<Parameters::VecTimes> cut(params.GetEECount());
+  for (int ee=0; ee<params.GetEECount(); ++ee) {
+    double t = 0.0;
+    for (double d : params.ee_phase_durations_.at(ee)) {
+      double overlap = std::min(t+d, t1) - std::max(t, t0);
+      if (overlap > 1e-9)
+        cut.at(ee).push_back(overlap);
+      t += d;
+    }
+  }
+
+  return cut;
+}
+
+BaseState
+GetBaseState (const Trajectory& motion, double t)
+{
+  BaseState s;
+  State lin = motion.base_linear_.GetPoint(t);
+  State ang = motion.base_angular_.GetPoint(t);
+  s.lin.at(kPos) = lin.p();
+  s.lin.at(kVel) = lin.v();
+  s.ang.at(kPos) = ang.p();
+  s.ang.at(kVel) = ang.v();
+  return s;
+}
+
+BaseState
+Blend (const BaseState& from, const BaseState& to, double w)
+{
+  BaseState s;
+  for (Dx d : {kPos, kVel}) {
+    s.lin.at(d) = (1-w)*from.lin.at(d) + w*to.lin.at(d);
+    s.ang.at(d) = (1-w)*from.ang.at(d) + w*to.ang.at(d);
+  }
+  return s;
+}
+
+// Linear base motion from start to goal, as used to initialize the NLP.
+BaseState
+GetInitialBaseState (const NlpFormulation& problem, double t)
+{
+  double T = problem.params_.GetTotalTime();
+  double s = t/T;
+  double z_nominal = -problem.model_.kinematic_model_->GetNominalStanceInBase().front().z();
+
+  BaseState b;
+  Vector3d p0 = problem.initial_base_.lin.p();
+  Vector3d p1 = problem.final_base_.lin.p();
+  Vector3d p = (1-s)*p0 + s*p1;
+  p.z() = problem.terrain_->GetHeight(p.x(), p.y()) + z_nominal;
+  b.lin.at(kPos) = p;
+  b.lin.at(kVel) = (p1-p0)/T;
+  b.lin.at(kVel).z() = 0.0;
+
+  Vector3d a0 = problem.initial_base_.ang.p();
+  Vector3d a1 = problem.final_base_.ang.p();
+  b.ang.at(kPos) = (1-s)*a0 + s*a1;
+  b.ang.at(kVel) = (a1-a0)/T;
+  return b;
+}
+
+NlpFormulation::EEPos
+GetNominalFootholds (const NlpFormulation& problem, const BaseState& base)
+{
+  double yaw = base.ang.p().z();
+  Eigen::Matrix3d R = Eigen::AngleAxisd(yaw, Vector3d::UnitZ()).toRotationMatrix();
+
+  NlpFormulation::EEPos footholds;
+  for (const auto& nominal : problem.model_.kinematic_model_->GetNominalStanceInBase()) {
+    Vector3d p = base.lin.p() + R*nominal;
+    p.z() = problem.terrain_->GetHeight(p.x(), p.y());
+    footholds.push_back(p);
+  }
+
+  return footholds;
+}
+
+// Appends the knots of a spline between t0 and t1 (global time), where the
+// spline starts at global time t_offset.
+void
+AppendKnots (const CubicHermiteSpline& s, double t_offset, double t0, double t1,
+             CubicHermiteSpline::VecTimes& times,
+             std::vector<Eigen::VectorXd>& pos, std::vector<Eigen::VectorXd>& vel,
+             std::vector<Eigen::VectorXd>& acc)
+{
+  const double eps = 1e-6;
+  for (int k=0; k<s.GetKnotCount(); ++k) {
+    double t = s.GetKnotTimes().at(k) + t_offset;
+    if (t > t0+eps && t < t1-eps) {
+      times.push_back(t);
+      pos.push_back(s.GetKnotPositions().col(k));
+      vel.push_back(s.GetKnotVelocities().col(k));
+      if (s.IsQuintic())
+        acc.push_back(s.GetKnotAccelerations().col(k));
+    }
+  }
+}
+
+} // namespace
+
+
+HorizonDecomposition::HorizonDecomposition (const BatchPlanner::SolverFactory& solver_factory,
+                                            const HorizonDecompositionOptions& options)
+    : solver_factory_(solver_factory),
+      options_(options)
+{
+}
+
+std::vector<HorizonDecomposition::Window>
+HorizonDecomposition::GetWindows (const NlpFormulation& problem) const
+{
+  if (problem.params_.IsOptimizeTimings())
+    throw std::runtime_error("horizon decomposition requires fixed phase durations!");
+
+  double T = problem.params_.GetTotalTime();
+  int n_windows = std::max(1, options_.window_count_);
+  auto full_stance = GetFullStanceIntervals(problem.params_);
+  if (n_windows > 1 && full_stance.empty())
+    throw std::runtime_error("no time at which all feet are in contact to split the horizon!");
+
+  std::vector<Window> windows(n_windows);
+  windows.front().t_start_ = 0.0;
+  windows.back().t_end_    = T;
+  windows.back().t_seam_   = T;
+  for (int k=0; k+1<n_windows; ++k) {
+    // neighbours must overlap, otherwise they only exchange their states
+    // at the seam and never agree.
+    const double eps = 1e-6;
+    double seam = SnapToFullStance(full_stance, T*(k+1)/n_windows);
+    windows.at(k).t_seam_    = seam;
+    windows.at(k).t_end_     = SnapToFullStance(full_stance, seam + options_.overlap_/2, seam+eps);
+    windows.at(k+1).t_start_ = SnapToFullStance(full_stance, seam - options_.overlap_/2,
+                                                -std::numeric_limits<double>::infinity(), seam-eps);
+  }
+
+  for (int k=0; k<n_windows; ++k) {
+    Window& w = windows.at(k);
+    if (w.t_end_ - w.t_start_ < 1e-6 || (k>0 && w.t_start_ < windows.at(k-1).t_start_))
+      throw std::runtime_error("too many windows for the contact schedule!");
+
+    NlpFormulation& f = w.formulation_;
+    f = problem;
+    f.initial_guess_.reset();
+    f.params_.ee_phase_durations_ = CutPhaseDurations(problem.params_, w.t_start_, w.t_end_);
+
+    if (k > 0) {
+      f.initial_base_ = GetInitialBaseState(problem, w.t_start_);
+      f.initial_ee_W_ = GetNominalFootholds(problem, f.initial_base_);
+      f.params_.ee_in_contact_at_start_.assign(problem.params_.GetEECount(), true);
+    }
+
+    if (k+1 < n_windows)
+      f.final_base_ = GetInitialBaseState(problem, w.t_end_);
+  }
+
+  return windows;
+}
+
+HorizonDecomposition::Result
+HorizonDecomposition::Solve (const NlpFormulation& problem) const
+{
+  std::vector<Window> windows = GetWindows(problem);
+  int n_windows = windows.size();
+  double w = options_.relaxation_;
+
+  BatchPlanner planner(solver_factory_, options_.thread_count_, options_.max_solve_time_);
+
+  Result result;
+  std::vector<Trajectory> motions(n_windows);
+  for (int iter=0; iter<options_.max_iterations_; ++iter) {
+    std::vector<NlpFormulation> formulations;
+    for (const auto& window : windows)
+      formulations.push_back(window.formulation_);
+
+    result.window_results_ = planner.Solve(formulations);
+    result.iteration_count_ = iter+1;
+    for (int k=0; k<n_windows; ++k) {
+      const auto& r = result.window_results_.at(k);
+      if (!r.error_.empty())
+        throw std::runtime_error("window " + std::to_string(k) + ": " + r.error_);
+      motions.at(k) = r.trajectory_;
+    }
+
+    // how much neighbours disagree in the middle of their overlap. Forces
+    // are left out, as the windows only exchange base states and footholds,
+    // which leave the forces at the seam free.
+    result.seam_error_ = 0.0;
+    for (int k=0; k+1<n_windows; ++k) {
+      double t = windows.at(k).t_seam_;
+      const Trajectory& left  = motions.at(k);
+      const Trajectory& right = motions.at(k+1);
+      double tl = t - windows.at(k).t_start_;
+      double tr = t - windows.at(k+1).t_start_;
+
+      BaseState bl = GetBaseState(left, tl), br = GetBaseState(right, tr);
+      double e = std::max((bl.lin.p()-br.lin.p()).norm(), (bl.lin.v()-br.lin.v()).norm());
+      e = std::max(e, std::max((bl.ang.p()-br.ang.p()).norm(), (bl.ang.v()-br.ang.v()).norm()));
+      for (int ee=0; ee<left.GetEECount(); ++ee)
+        e = std::max(e, (left.ee_motion_.at(ee).GetPoint(tl).p() - right.ee_motion_.at(ee).GetPoint(tr).p()).norm());
+      result.seam_error_ = std::max(result.seam_error_, e);
+    }
+
+    result.converged_ = result.seam_error_ < options_.tolerance_;
+    if (result.converged_)
+      break;
+
+    // each window starts where its predecessor is at that time, and ends
+    // where its successor is.
+    for (int k=0; k+1<n_windows; ++k) {
+      Window& curr = windows.at(k);
+      Window& next = windows.at(k+1);
+      double t_next_start = next.t_start_ - curr.t_start_;
+      double t_curr_end   = curr.t_end_   - next.t_start_;
+
+      NlpFormulation& f_next = next.formulation_;
+      f_next.initial_base_ = Blend(f_next.initial_base_, GetBaseState(motions.at(k), t_next_start), w);
+      for (int ee=0; ee<f_next.initial_ee_W_.size(); ++ee) {
+        Vector3d p = motions.at(k).ee_motion_.at(ee).GetPoint(t_next_start).p();
+        Vector3d& p_start = f_next.initial_ee_W_.at(ee);
+        p_start = (1-w)*p_start + w*p;
+        p_start.z() = problem.terrain_->GetHeight(p_start.x(), p_start.y()); // in contact
+      }
+
+      NlpFormulation& f_curr = curr.formulation_;
+      f_curr.final_base_ = Blend(f_curr.final_base_, GetBaseState(motions.at(k+1), t_curr_end), w);
+    }
+
+    for (int k=0; k<n_windows; ++k)
+      windows.at(k).formulation_.initial_guess_ = std::make_shared<const Trajectory>(motions.at(k));
+  }
+
+  result.trajectory_ = Stitch(problem, windows, motions);
+  return result;
+}
+
+Trajectory
+HorizonDecomposition::Stitch (const NlpFormulation& problem,
+                              const std::vector<Window>& windows,
+                              const std::vector<Trajectory>& motions)
+{
+  using SplineOf = std::function<const CubicHermiteSpline&(const Trajectory&)>;
+
+  // each window contributes the part from the previous seam to its own,
+  // seams take the average of both neighbours.
+  auto stitch = [&](const SplineOf& spline_of) {
+    CubicHermiteSpline::VecTimes times;
+    std::vector<Eigen::VectorXd> pos, vel, acc;
+    bool is_quintic = spline_of(motions.front()).IsQuintic();
+
+    State s = spline_of(motions.front()).GetPoint(0.0);
+    times.push_back(0.0);
+    pos.push_back(s.p());
+    vel.push_back(s.v());
+    if (is_quintic)
+      acc.push_back(s.a());
+
+    for (int k=0; k<windows.size(); ++k) {
+      const Window& window = windows.at(k);
+      double t0 = k==0? 0.0 : windows.at(k-1).t_seam_;
+      double t1 = window.t_seam_;
+      AppendKnots(spline_of(motions.at(k)), window.t_start_, t0, t1, times, pos, vel, acc);
+
+      State end = spline_of(motions.at(k)).GetPoint(t1 - window.t_start_);
+      if (k+1 < windows.size()) {
+        State next = spline_of(motions.at(k+1)).GetPoint(t1 - windows.at(k+1).t_start_);
+        end.at(kPos) = (end.p() + next.p())/2;
+        end.at(kVel) = (end.v() + next.v())/2;
+        end.at(kAcc) = (end.a() + next.a())/2;
+      }
+      times.push_back(t1);
+      pos.push_back(end.p());
+      vel.push_back(end.v());
+      if (is_quintic)
+        acc.push_back(end.a());
+    }
+
+    int dim = pos.front().size();
+    Eigen::MatrixXd P(dim, pos.size()), V(dim, vel.size()), A(dim, acc.size());
+    for (int i=0; i<pos.size(); ++i) {
+      P.col(i) = pos.at(i);
+      V.col(i) = vel.at(i);
+      if (is_quintic)
+        A.col(i) = acc.at(i);
+    }
+    return is_quintic? CubicHermiteSpline(times, P, V, A)
+                     : CubicHermiteSpline(times, P, V);
+  };
+
+  Trajectory t;
+  t.base_linear_  = stitch([](const Trajectory& m) -> const CubicHermiteSpline& { return m.base_linear_; });
+  t.base_angular_ = stitch([](const Trajectory& m) -> const CubicHermiteSpline& { return m.base_angular_; });
+  for (int ee=0; ee<motions.front().GetEECount(); ++ee) {
+    t.ee_motion_.push_back(stitch([ee](const Trajectory& m) -> const CubicHermiteSpline& { return m.ee_motion_.at(ee); }));
+    t.ee_force_.push_back(stitch([ee](const Trajectory& m) -> const CubicHermiteSpline& { return m.ee_force_.at(ee); }));
+  }
+  t.ee_phase_durations_     = problem.params_.ee_phase_durations_;
+  t.ee_in_contact_at_start_ = problem.params_.ee_in_contact_at_start_;
+
+  return t;
+}
+
+} /* namespace towr */
@@ -0,0 +1,146 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/io/iteration_history.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace towr {
+
+std::vector<int>
+GetKeptIterations (int n_iterations, const IterationHistoryOptions& options)
+{
+  std::vector<int> iterations;
+  if (n_iterations <= 0)
+    return iterations;
+
+  int last = n_iterations-1;
+  switch (options.decimation_) {
+    case IterationHistoryOptions::All:
+      for (int i=0; i<=last; ++i)
+        iterations.push_back(i);
+      break;
+    case IterationHistoryOptions::EveryKth:
+      for (int i=0; i<=last; i+=std::max(1, options.every_k_))
+        iterations.push_back(i);
+      break;
+    case IterationHistoryOptions::LogSpaced: {
+      // equally spaced in log(1+i), rounded and without duplicates.
+      int n = std::max(2, options.log_count_);
+      double log_last = std::log(1.0 + last);
+      for (int k=0; k<n; ++k) {
+        int i = std::lround(std::exp(k*log_last/(n-1)) - 1.0);
+        if (iterations.empty() || i > iterations.back())
+          iterations.push_back(std::min(i, last));
+      }
+      break;
+    }
+    default:
+      assert(false); // decimation not implemented
+  }
+
+  if (iterations.back() != last)
+    iterations.push_back(last);
+
+  return iterations;
+}
+
+int
+WriteIterationHistory (ifopt::Problem& nlp, const SplineHolder& splines,
+                       const IterationHistoryOptions& options,
+                       TrajectoryFileWriter& file)
+{
+  auto iterations = GetKeptIterations(nlp.GetIterationCount(), options);
+
+  for (int iter : iterations) {
+    nlp.SetOptVariables(iter);
+
+    if (options.x_only_) {
+      Eigen::VectorXd x = nlp.GetOptVariables()->GetValues();
+      trajectory_file::Columns columns;
+      columns.emplace_back("x", std::vector<double>(x.data(), x.data()+x.size()));
+      file.Append(columns, splines.ee_motion_.size(), iter);
+    } else {
+      file.Append(Trajectory(splines), options.sample_dt_, iter);
+    }
+  }
+
+  if (!iterations.empty())
+    nlp.SetOptVariablesFinal();
+
+  return iterations.size();
+}
+
+IterationHistoryReader::IterationHistoryReader (const std::string& path,
+                                                const NlpFormulation& formulation)
+    : file_(path), formulation_(formulation)
+{
+}
+
+int
+IterationHistoryReader::GetRecordCount () const
+{
+  return file_.GetRecordCount();
+}
+
+int
+IterationHistoryReader::GetIteration (int record) const
+{
+  return file_.GetStamp(record);
+}
+
+Trajectory
+IterationHistoryReader::GetTrajectory (int record)
+{
+  uint64_t n_x;
+  const double* x = file_.GetColumn(record, "x", n_x);
+  if (!x)
+    return file_.GetTrajectory(record);
+
+  if (variables_.empty())
+    variables_ = formulation_.GetVariableSets(splines_);
+
+  uint64_t n_vars = 0;
+  for (const auto& v : variables_)
+    n_vars += v->GetRows();
+  if (n_vars != n_x)
+    throw std::runtime_error("stored iteration doesn't match the formulation!");
+
+  for (const auto& v : variables_) {
+    v->SetVariables(Eigen::Map<const Eigen::VectorXd>(x, v->GetRows()));
+    x += v->GetRows();
+  }
+
+  return Trajectory(splines_);
+}
+
+} /* namespace towr */
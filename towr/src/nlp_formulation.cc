@@ -40,15 +40,29 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <towr/constraints/terrain_constraint.h>
 #include <towr/constraints/total_duration_constraint.h>
 #include <towr/constraints/spline_acc_constraint.h>
+#include <towr/constraints/periodic_constraint.h>
 
 #include <towr/costs/node_cost.h>
+#include <towr/costs/spline_integral_cost.h>
 #include <towr/variables/nodes_variables_all.h>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <stdexcept>
+#include <mutex>
 
 namespace towr {
 
 NlpFormulation::NlpFormulation ()
+{
+  // only once per process, formulations are also created in batches/threads
+  static std::once_flag banner_printed;
+  std::call_once(banner_printed, &NlpFormulation::PrintBanner);
+}
+
+void
+NlpFormulation::PrintBanner ()
 {
   using namespace std;
   cout << "\n";
@@ -74,6 +88,8 @@ NlpFormulation::GetVariableSets (SplineHolder& spline_holder)
   auto ee_force = MakeForceVariables();
   vars.insert(vars.end(), ee_force.begin(), ee_force.end());
 
+  ShareMirroredVariables(ee_motion, ee_force);
+
   auto contact_schedule = MakeContactScheduleVariables();
   // can also just be fixed timings that aren't optimized over, but still added
   // to spline_holder.
@@ -89,39 +105,193 @@ NlpFormulation::GetVariableSets (SplineHolder& spline_holder)
                                ee_force,
                                contact_schedule,
                                params_.IsOptimizeTimings());
+
+  if (initial_guess_)
+    SetInitialGuess(spline_holder, base_motion, ee_motion, ee_force);
+
   return vars;
 }
 
+void
+NlpFormulation::SetInitialGuess (const SplineHolder& s,
+                                 const std::vector<NodesVariables::Ptr>& base,
+                                 const std::vector<NodesVariablesPhaseBased::Ptr>& ee_motion,
+                                 const std::vector<NodesVariablesPhaseBased::Ptr>& ee_force) const
+{
+  const Trajectory& guess = *initial_guess_;
+  if (guess.GetEECount() != ee_motion.size())
+    throw std::runtime_error("initial guess has wrong number of endeffectors!");
+
+  base.at(0)->SetBySampling(guess.base_linear_, s.base_linear_->GetPolyDurations());
+  base.at(1)->SetBySampling(guess.base_angular_, s.base_angular_->GetPolyDurations());
+
+  for (int ee=0; ee<ee_motion.size(); ++ee) {
+    ee_motion.at(ee)->SetBySampling(guess.ee_motion_.at(ee), s.ee_motion_.at(ee)->GetPolyDurations());
+    ee_force.at(ee)->SetBySampling(guess.ee_force_.at(ee), s.ee_force_.at(ee)->GetPolyDurations());
+  }
+}
+
+void
+NlpFormulation::ResetVariables (const VariablePtrVec& variables,
+                                const SplineHolder& s) const
+{
+  if (params_.IsPeriodic() || params_.share_mirrored_ee_)
+    throw std::runtime_error("periodic and mirrored formulations depend on start and goal, build them again!");
+
+  auto get = [&variables](const std::string& name) {
+    for (const auto& v : variables)
+      if (v->GetName() == name)
+        return v;
+    throw std::runtime_error("variables " + name + " not built by this formulation!");
+  };
+
+  // durations first, they define where the nodes are sampled
+  if (params_.IsOptimizeTimings()) {
+    auto schedule = MakeContactScheduleVariables();
+    for (int ee=0; ee<params_.GetEECount(); ++ee)
+      get(id::EESchedule(ee))->SetVariables(schedule.at(ee)->GetValues());
+  }
+
+  std::vector<NodesVariables::Ptr> base, nodes;
+  std::vector<NodesVariablesPhaseBased::Ptr> ee_motion, ee_force;
+  for (auto name : {id::base_lin_nodes, id::base_ang_nodes})
+    base.push_back(std::dynamic_pointer_cast<NodesVariables>(get(name)));
+  for (int ee=0; ee<params_.GetEECount(); ++ee) {
+    ee_motion.push_back(std::dynamic_pointer_cast<NodesVariablesPhaseBased>(get(id::EEMotionNodes(ee))));
+    ee_force.push_back(std::dynamic_pointer_cast<NodesVariablesPhaseBased>(get(id::EEForceNodes(ee))));
+  }
+  nodes.insert(nodes.end(), base.begin(), base.end());
+  nodes.insert(nodes.end(), ee_motion.begin(), ee_motion.end());
+  nodes.insert(nodes.end(), ee_force.begin(), ee_force.end());
+
+  // values the interpolation doesn't set (e.g. accelerations) start at zero
+  for (auto& n : nodes)
+    n->SetVariables(Eigen::VectorXd::Zero(n->GetRows()));
+
+  SetBaseStartAndGoal(*base.at(0), *base.at(1));
+  for (int ee=0; ee<params_.GetEECount(); ++ee) {
+    SetEndeffectorStartAndGoal(ee, *ee_motion.at(ee));
+    SetForceStartAndGoal(*ee_force.at(ee));
+  }
+
+  // the interpolation doesn't notify the splines
+  for (auto& n : nodes)
+    n->SetVariables(n->GetValues());
+
+  if (initial_guess_)
+    SetInitialGuess(s, base, ee_motion, ee_force);
+}
+
+std::vector<int>
+NlpFormulation::GetMirroredEndeffectors () const
+{
+  int n_ee = params_.GetEECount();
+  std::vector<int> mirrored(n_ee, -1);
+  if (!params_.share_mirrored_ee_)
+    return mirrored;
+
+  auto nominal = model_.kinematic_model_->GetNominalStanceInBase();
+  const double eps = 1e-6;
+  for (int i=0; i<n_ee; ++i) {
+    for (int j=i+1; j<n_ee; ++j) {
+      bool is_mirror_image = std::abs(nominal.at(i).x() - nominal.at(j).x()) < eps
+                          && std::abs(nominal.at(i).y() + nominal.at(j).y()) < eps
+                          && std::abs(nominal.at(i).z() - nominal.at(j).z()) < eps
+                          && std::abs(nominal.at(i).y()) > eps;
+
+      // only legs that move together, not in alternation
+      bool same_phases = params_.ee_in_contact_at_start_.at(i) == params_.ee_in_contact_at_start_.at(j)
+                      && params_.ee_phase_durations_.at(i) == params_.ee_phase_durations_.at(j);
+
+      if (is_mirror_image && same_phases && mirrored.at(i) < 0 && mirrored.at(j) < 0)
+        mirrored.at(j) = i;
+    }
+  }
+
+  return mirrored;
+}
+
+void
+NlpFormulation::ShareMirroredVariables (const std::vector<NodesVariablesPhaseBased::Ptr>& ee_motion,
+                                        const std::vector<NodesVariablesPhaseBased::Ptr>& ee_force) const
+{
+  if (!params_.share_mirrored_ee_)
+    return;
+
+  auto mirrored = GetMirroredEndeffectors();
+  if (std::all_of(mirrored.begin(), mirrored.end(), [](int m) { return m < 0; }))
+    throw std::runtime_error("no mirrored endeffectors with identical phases to share variables!");
+
+  if (params_.IsOptimizeTimings())
+    throw std::runtime_error("mirrored endeffectors can't be combined with optimized phase durations!");
+
+  // reflection about the vertical plane the base moves in
+  double y0 = initial_base_.lin.p().y();
+  const double eps = 1e-6;
+  bool is_straight = std::abs(final_base_.lin.p().y() - y0) < eps
+                  && std::abs(initial_base_.ang.p().x()) < eps && std::abs(final_base_.ang.p().x()) < eps
+                  && std::abs(initial_base_.ang.p().z()) < eps && std::abs(final_base_.ang.p().z()) < eps;
+  if (!is_straight)
+    throw std::runtime_error("mirrored endeffectors require a straight motion along x!");
+
+  Vector3d scale(1.0, -1.0, 1.0);
+  Vector3d offset(0.0, 2*y0, 0.0);
+
+  for (int ee=0; ee<mirrored.size(); ++ee) {
+    int m = mirrored.at(ee);
+    if (m < 0)
+      continue;
+
+    Vector3d reflected = scale.cwiseProduct(initial_ee_W_.at(m)) + offset;
+    if (!params_.IsPeriodic() && !reflected.isApprox(initial_ee_W_.at(ee), eps))
+      throw std::runtime_error("initial positions of mirrored endeffectors aren't symmetric!");
+
+    ee_motion.at(ee)->UseVariablesOf(ee_motion.at(m), scale, offset);
+    ee_force.at(ee)->UseVariablesOf(ee_force.at(m), scale, Vector3d::Zero());
+  }
+}
+
 std::vector<NodesVariables::Ptr>
 NlpFormulation::MakeBaseVariables () const
 {
   std::vector<NodesVariables::Ptr> vars;
 
   int n_nodes = params_.GetBasePolyDurations().size() + 1;
+  int n_derivatives = params_.base_spline_basis_ == Parameters::QuinticHermite? 3 : Node::n_derivatives;
 
-  auto spline_lin = std::make_shared<NodesVariablesAll>(n_nodes, k3D, id::base_lin_nodes);
+  auto spline_lin = std::make_shared<NodesVariablesAll>(n_nodes, k3D, id::base_lin_nodes, n_derivatives);
+  auto spline_ang = std::make_shared<NodesVariablesAll>(n_nodes, k3D, id::base_ang_nodes, n_derivatives);
+  SetBaseStartAndGoal(*spline_lin, *spline_ang);
+  vars.push_back(spline_lin);
+  vars.push_back(spline_ang);
+
+  return vars;
+}
 
+void
+NlpFormulation::SetBaseStartAndGoal (NodesVariables& spline_lin,
+                                     NodesVariables& spline_ang) const
+{
   double x = final_base_.lin.p().x();
   double y = final_base_.lin.p().y();
   double z = terrain_->GetHeight(x,y) - model_.kinematic_model_->GetNominalStanceInBase().front().z();
   Vector3d final_pos(x, y, z);
 
-  spline_lin->SetByLinearInterpolation(initial_base_.lin.p(), final_pos, params_.GetTotalTime());
-  spline_lin->AddStartBound(kPos, {X,Y,Z}, initial_base_.lin.p());
-  spline_lin->AddStartBound(kVel, {X,Y,Z}, initial_base_.lin.v());
-  spline_lin->AddFinalBound(kPos, params_.bounds_final_lin_pos_,   final_base_.lin.p());
-  spline_lin->AddFinalBound(kVel, params_.bounds_final_lin_vel_, final_base_.lin.v());
-  vars.push_back(spline_lin);
-
-  auto spline_ang = std::make_shared<NodesVariablesAll>(n_nodes, k3D, id::base_ang_nodes);
-  spline_ang->SetByLinearInterpolation(initial_base_.ang.p(), final_base_.ang.p(), params_.GetTotalTime());
-  spline_ang->AddStartBound(kPos, {X,Y,Z}, initial_base_.ang.p());
-  spline_ang->AddStartBound(kVel, {X,Y,Z}, initial_base_.ang.v());
-  spline_ang->AddFinalBound(kPos, params_.bounds_final_ang_pos_, final_base_.ang.p());
-  spline_ang->AddFinalBound(kVel, params_.bounds_final_ang_vel_, final_base_.ang.v());
-  vars.push_back(spline_ang);
+  spline_lin.SetByLinearInterpolation(initial_base_.lin.p(), final_pos, params_.GetTotalTime());
+  spline_lin.AddStartBound(kPos, {X,Y,Z}, initial_base_.lin.p());
+  if (!params_.IsPeriodic()) { // otherwise given by the PeriodicConstraint
+    spline_lin.AddStartBound(kVel, {X,Y,Z}, initial_base_.lin.v());
+    spline_lin.AddFinalBound(kPos, params_.bounds_final_lin_pos_,   final_base_.lin.p());
+    spline_lin.AddFinalBound(kVel, params_.bounds_final_lin_vel_, final_base_.lin.v());
+  }
 
-  return vars;
+  spline_ang.SetByLinearInterpolation(initial_base_.ang.p(), final_base_.ang.p(), params_.GetTotalTime());
+  spline_ang.AddStartBound(kPos, {X,Y,Z}, initial_base_.ang.p());
+  if (!params_.IsPeriodic()) {
+    spline_ang.AddStartBound(kVel, {X,Y,Z}, initial_base_.ang.v());
+    spline_ang.AddFinalBound(kPos, params_.bounds_final_ang_pos_, final_base_.ang.p());
+    spline_ang.AddFinalBound(kVel, params_.bounds_final_ang_vel_, final_base_.ang.v());
+  }
 }
 
 std::vector<NodesVariablesPhaseBased::Ptr>
@@ -130,37 +300,42 @@ NlpFormulation::MakeEndeffectorVariables () const
   std::vector<NodesVariablesPhaseBased::Ptr> vars;
 
   // Endeffector Motions
-  double T = params_.GetTotalTime();
   for (int ee=0; ee<params_.GetEECount(); ee++) {
     auto nodes = std::make_shared<NodesVariablesEEMotion>(
                                               params_.GetPhaseCount(ee),
                                               params_.ee_in_contact_at_start_.at(ee),
                                               id::EEMotionNodes(ee),
                                               params_.ee_polynomials_per_swing_phase_);
-
-    // initialize towards final footholds
-    double yaw = final_base_.ang.p().z();
-    Eigen::Vector3d euler(0.0, 0.0, yaw);
-    Eigen::Matrix3d w_R_b = EulerConverter::GetRotationMatrixBaseToWorld(euler);
-    Vector3d final_ee_pos_W = final_base_.lin.p() + w_R_b*model_.kinematic_model_->GetNominalStanceInBase().at(ee);
-    double x = final_ee_pos_W.x();
-    double y = final_ee_pos_W.y();
-    double z = terrain_->GetHeight(x,y);
-    nodes->SetByLinearInterpolation(initial_ee_W_.at(ee), Vector3d(x,y,z), T);
-
-    nodes->AddStartBound(kPos, {X,Y,Z}, initial_ee_W_.at(ee));
+    SetEndeffectorStartAndGoal(ee, *nodes);
     vars.push_back(nodes);
   }
 
   return vars;
 }
 
+void
+NlpFormulation::SetEndeffectorStartAndGoal (int ee, NodesVariables& nodes) const
+{
+  // initialize towards final footholds
+  double yaw = final_base_.ang.p().z();
+  Eigen::Vector3d euler(0.0, 0.0, yaw);
+  Eigen::Matrix3d w_R_b = EulerConverter::GetRotationMatrixBaseToWorld(euler);
+  Vector3d final_ee_pos_W = final_base_.lin.p() + w_R_b*model_.kinematic_model_->GetNominalStanceInBase().at(ee);
+  double x = final_ee_pos_W.x();
+  double y = final_ee_pos_W.y();
+  double z = terrain_->GetHeight(x,y);
+  nodes.SetByLinearInterpolation(initial_ee_W_.at(ee), Vector3d(x,y,z), params_.GetTotalTime());
+
+  // a periodic cycle can start at any foothold that repeats at its end
+  if (!params_.IsPeriodic())
+    nodes.AddStartBound(kPos, {X,Y,Z}, initial_ee_W_.at(ee));
+}
+
 std::vector<NodesVariablesPhaseBased::Ptr>
 NlpFormulation::MakeForceVariables () const
 {
   std::vector<NodesVariablesPhaseBased::Ptr> vars;
 
-  double T = params_.GetTotalTime();
   for (int ee=0; ee<params_.GetEECount(); ee++) {
     auto nodes = std::make_shared<NodesVariablesEEForce>(
                                               params_.GetPhaseCount(ee),
@@ -168,18 +343,24 @@ NlpFormulation::MakeForceVariables () const
                                               id::EEForceNodes(ee),
                                               params_.force_polynomials_per_stance_phase_);
 
-    // initialize with mass of robot distributed equally on all legs
-    double m = model_.dynamic_model_->m();
-    double g = model_.dynamic_model_->g();
-
-    Vector3d f_stance(0.0, 0.0, m*g/params_.GetEECount());
-    nodes->SetByLinearInterpolation(f_stance, f_stance, T); // stay constant
+    SetForceStartAndGoal(*nodes);
     vars.push_back(nodes);
   }
 
   return vars;
 }
 
+void
+NlpFormulation::SetForceStartAndGoal (NodesVariables& nodes) const
+{
+  // initialize with mass of robot distributed equally on all legs
+  double m = model_.dynamic_model_->m();
+  double g = model_.dynamic_model_->g();
+
+  Vector3d f_stance(0.0, 0.0, m*g/params_.GetEECount());
+  nodes.SetByLinearInterpolation(f_stance, f_stance, params_.GetTotalTime()); // stay constant
+}
+
 std::vector<PhaseDurations::Ptr>
 NlpFormulation::MakeContactScheduleVariables () const
 {
@@ -221,6 +402,7 @@ NlpFormulation::GetConstraint (Parameters::ConstraintName name,
     case Parameters::Force:          return MakeForceConstraint();
     case Parameters::Swing:          return MakeSwingConstraint();
     case Parameters::BaseAcc:        return MakeBaseAccConstraint(s);
+    case Parameters::Periodic:       return MakePeriodicConstraint();
     default: throw std::runtime_error("constraint not defined!");
   }
 }
@@ -237,7 +419,8 @@ NlpFormulation::MakeBaseRangeOfMotionConstraint (const SplineHolder& s) const
 NlpFormulation::ContraintPtrVec
 NlpFormulation::MakeDynamicConstraint(const SplineHolder& s) const
 {
-  auto constraint = std::make_shared<DynamicConstraint>(model_.dynamic_model_,
+  // own copy, as the constraint sets the current state of the model
+  auto constraint = std::make_shared<DynamicConstraint>(model_.dynamic_model_->Clone(),
                                                         params_.GetTotalTime(),
                                                         params_.dt_constraint_dynamic_,
                                                         s);
@@ -280,6 +463,7 @@ NlpFormulation::MakeTerrainConstraint () const
 {
   ContraintPtrVec constraints;
 
+  // also for mirrored endeffectors, the terrain needn't be symmetric.
   for (int ee=0; ee<params_.GetEECount(); ee++) {
     auto c = std::make_shared<TerrainConstraint>(terrain_, id::EEMotionNodes(ee));
     constraints.push_back(c);
@@ -293,6 +477,7 @@ NlpFormulation::MakeForceConstraint () const
 {
   ContraintPtrVec constraints;
 
+  // also for mirrored endeffectors, the terrain normals needn't be symmetric.
   for (int ee=0; ee<params_.GetEECount(); ee++) {
     auto c = std::make_shared<ForceConstraint>(terrain_,
                                                params_.force_limit_in_normal_direction_,
@@ -308,7 +493,11 @@ NlpFormulation::MakeSwingConstraint () const
 {
   ContraintPtrVec constraints;
 
+  auto mirrored = GetMirroredEndeffectors();
   for (int ee=0; ee<params_.GetEECount(); ee++) {
+    if (mirrored.at(ee) >= 0)
+      continue; // linear in the nodes, so identical for the mirror image
+
     auto swing = std::make_shared<SwingConstraint>(id::EEMotionNodes(ee));
     constraints.push_back(swing);
   }
@@ -321,6 +510,10 @@ NlpFormulation::MakeBaseAccConstraint (const SplineHolder& s) const
 {
   ContraintPtrVec constraints;
 
+  // quintic polynomials are continuous in acceleration already
+  if (params_.base_spline_basis_ == Parameters::QuinticHermite)
+    return constraints;
+
   constraints.push_back(std::make_shared<SplineAccConstraint>
                         (s.base_linear_, id::base_lin_nodes));
 
@@ -330,6 +523,40 @@ NlpFormulation::MakeBaseAccConstraint (const SplineHolder& s) const
   return constraints;
 }
 
+NlpFormulation::ContraintPtrVec
+NlpFormulation::MakePeriodicConstraint () const
+{
+  ContraintPtrVec constraints;
+
+  // one cycle moves forward by the base displacement, the height only
+  // changes with the terrain (e.g. stairs).
+  Vector3d p0 = initial_base_.lin.p();
+  Vector3d p1 = final_base_.lin.p();
+  Vector3d translation = p1 - p0;
+  translation.z() = terrain_->GetHeight(p1.x(), p1.y()) - terrain_->GetHeight(p0.x(), p0.y());
+
+  constraints.push_back(std::make_shared<PeriodicConstraint>(id::base_lin_nodes, translation));
+  constraints.push_back(std::make_shared<PeriodicConstraint>(id::base_ang_nodes, Vector3d::Zero()));
+
+  auto mirrored = GetMirroredEndeffectors();
+  for (int ee=0; ee<params_.GetEECount(); ee++) {
+    bool contact_at_start = params_.ee_in_contact_at_start_.at(ee);
+    bool contact_at_end   = params_.GetPhaseCount(ee)%2 == 1? contact_at_start : !contact_at_start;
+    if (!contact_at_start || !contact_at_end)
+      throw std::runtime_error("periodic gait cycle must start and end in contact!");
+
+    if (mirrored.at(ee) >= 0)
+      continue;
+
+    // the height of the footholds is already given by the TerrainConstraint
+    constraints.push_back(std::make_shared<PeriodicConstraint>(id::EEMotionNodes(ee), translation,
+                                                               std::vector<int>{X,Y}));
+    constraints.push_back(std::make_shared<PeriodicConstraint>(id::EEForceNodes(ee), Vector3d::Zero()));
+  }
+
+  return constraints;
+}
+
 NlpFormulation::ContraintPtrVec
 NlpFormulation::GetCosts() const
 {
@@ -347,6 +574,10 @@ NlpFormulation::GetCost(const Parameters::CostName& name, double weight) const
   switch (name) {
     case Parameters::ForcesCostID:   return MakeForcesCost(weight);
     case Parameters::EEMotionCostID: return MakeEEMotionCost(weight);
+    case Parameters::BaseAccCostID:  return MakeBaseIntegralCost(kAcc, weight);
+    case Parameters::BaseJerkCostID: return MakeBaseIntegralCost(kJerk, weight);
+    case Parameters::ForcesIntegralCostID: return MakeForcesIntegralCost(kPos, weight);
+    case Parameters::ForceRateCostID:      return MakeForcesIntegralCost(kVel, weight);
     default: throw std::runtime_error("cost not defined!");
   }
 }
@@ -375,4 +606,33 @@ NlpFormulation::MakeEEMotionCost(double weight) const
   return cost;
 }
 
+NlpFormulation::CostPtrVec
+NlpFormulation::MakeBaseIntegralCost(Dx deriv, double weight) const
+{
+  CostPtrVec cost;
+
+  auto durations = params_.GetBasePolyDurations();
+  cost.push_back(std::make_shared<SplineIntegralCost>(id::base_lin_nodes, durations, deriv, weight));
+  cost.push_back(std::make_shared<SplineIntegralCost>(id::base_ang_nodes, durations, deriv, weight));
+
+  return cost;
+}
+
+NlpFormulation::CostPtrVec
+NlpFormulation::MakeForcesIntegralCost(Dx deriv, double weight) const
+{
+  // the quadratic form is constant only for fixed durations
+  if (params_.IsOptimizeTimings())
+    throw std::runtime_error("integral costs require fixed phase durations!");
+
+  CostPtrVec cost;
+
+  for (int ee=0; ee<params_.GetEECount(); ee++)
+    cost.push_back(std::make_shared<SplineIntegralCost>(id::EEForceNodes(ee),
+                                                        params_.ee_phase_durations_.at(ee),
+                                                        deriv, weight));
+
+  return cost;
+}
+
 } /* namespace towr */
@@ -53,7 +53,7 @@ NodeCost::InitVariableDependedQuantities (const VariablesPtr& x)
 double
 NodeCost::GetCost () const
 {
-  double cost;
+  double cost = 0.0;
   for (auto n : nodes_->GetNodes()) {
     double val = n.at(deriv_)(dim_);
     cost += weight_*std::pow(val,2);
@@ -65,12 +65,12 @@ NodeCost::GetCost () const
 void
 NodeCost::FillJacobianBlock (std::string var_set, Jacobian& jac) const
 {
-  if (var_set == node_id_) {
-    for (int i=0; i<nodes_->GetRows(); ++i)
+  if (var_set == nodes_->GetOptVariablesName()) {
+    for (int i=0; i<nodes_->GetOptVariablesCount(); ++i)
       for (auto nvi : nodes_->GetNodeValuesInfo(i))
         if (nvi.deriv_==deriv_ && nvi.dim_==dim_) {
           double val = nodes_->GetNodes().at(nvi.id_).at(deriv_)(dim_);
-          jac.coeffRef(0, i) += weight_*2.0*val;
+          jac.coeffRef(0, i) += weight_*2.0*val*nodes_->GetScale(dim_);
         }
   }
 }
@@ -35,11 +35,12 @@ namespace towr {
 
 NodeSpline::NodeSpline(NodeSubjectPtr const node_variables,
                        const VecTimes& polynomial_durations)
-    :   Spline(polynomial_durations, node_variables->GetDim()),
+    :   Spline(polynomial_durations, node_variables->GetDim(),
+               node_variables->GetNodes().front().GetDerivativeCount()),
         NodesObserver(node_variables)
 {
   UpdateNodes();
-  jac_wrt_nodes_structure_ = Jacobian(node_variables->GetDim(), node_variables->GetRows());
+  jac_wrt_nodes_structure_ = Jacobian(node_variables->GetDim(), node_variables->GetOptVariablesCount());
 }
 
 void
@@ -56,7 +57,19 @@ NodeSpline::UpdateNodes ()
 int
 NodeSpline::GetNodeVariablesCount() const
 {
-  return node_values_->GetRows();
+  return node_values_->GetOptVariablesCount();
+}
+
+std::string
+NodeSpline::GetNodeVariablesName() const
+{
+  return node_values_->GetOptVariablesName();
+}
+
+const std::vector<Node>
+NodeSpline::GetNodes() const
+{
+  return node_values_->GetNodes();
 }
 
 NodeSpline::Jacobian
@@ -85,27 +98,32 @@ void
 NodeSpline::FillJacobianWrtNodes (int poly_id, double t_local, Dx dxdt,
                                   Jacobian& jac, bool fill_with_zeros) const
 {
-  for (int idx=0; idx<jac.cols(); ++idx) {
-    for (auto nvi : node_values_->GetNodeValuesInfo(idx)) {
-      for (auto side : {NodesVariables::Side::Start, NodesVariables::Side::End}) { // every jacobian is affected by two nodes
-        int node = node_values_->GetNodeId(poly_id, side);
-
-        if (node == nvi.id_) {
-          double val = 0.0;
-
-          if (side == NodesVariables::Side::Start)
-            val = cubic_polys_.at(poly_id).GetDerivativeWrtStartNode(dxdt, nvi.deriv_, t_local);
-          else if (side == NodesVariables::Side::End)
-            val = cubic_polys_.at(poly_id).GetDerivativeWrtEndNode(dxdt, nvi.deriv_, t_local);
-          else
-            assert(false); // this shouldn't happen
-
-          // if only want structure
-          if (fill_with_zeros)
-            val = 0.0;
-
-          jac.coeffRef(nvi.dim_, idx) += val;
-        }
+  int n_derivatives = cubic_polys_.at(poly_id).IsQuintic()? 3 : 2;
+
+  for (auto side : {NodesVariables::Side::Start, NodesVariables::Side::End}) { // every jacobian is affected by two nodes
+    int node = node_values_->GetNodeId(poly_id, side);
+
+    for (int d=0; d<n_derivatives; ++d) {
+      Dx deriv = static_cast<Dx>(d);
+      for (int dim=0; dim<jac.rows(); ++dim) {
+        int idx = node_values_->GetOptIndex(NodesVariables::NodeValueInfo(node, deriv, dim));
+        if (idx == NodesVariables::NodeValueNotOptimized)
+          continue;
+
+        double val = 0.0;
+
+        if (side == NodesVariables::Side::Start)
+          val = cubic_polys_.at(poly_id).GetDerivativeWrtStartNode(dxdt, deriv, t_local);
+        else if (side == NodesVariables::Side::End)
+          val = cubic_polys_.at(poly_id).GetDerivativeWrtEndNode(dxdt, deriv, t_local);
+        else
+          assert(false); // this shouldn't happen
+
+        // if only want structure
+        if (fill_with_zeros)
+          val = 0.0;
+
+        jac.coeffRef(dim, idx) += node_values_->GetScale(dim)*val;
       }
     }
   }
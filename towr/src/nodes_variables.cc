@@ -29,34 +29,75 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/nodes_variables.h>
 
+#include <algorithm>
+#include <cassert>
+
+#include <towr/variables/cubic_hermite_spline.h>
+
 namespace towr {
 
+const int NodesVariables::NodeValueNotOptimized;
 
 NodesVariables::NodesVariables (const std::string& name)
     : VariableSet(kSpecifyLater, name)
 {
 }
 
+void
+NodesVariables::BuildIndexTables () const
+{
+  int n_variables = GetOptVariablesCount();
+  node_values_info_.clear();
+  first_node_value_.resize(n_variables+1);
+  opt_index_.assign(nodes_.size()*nodes_.front().GetDerivativeCount()*n_dim_,
+                    NodeValueNotOptimized);
+
+  for (int idx=0; idx<n_variables; ++idx) {
+    first_node_value_.at(idx) = node_values_info_.size();
+    for (const NodeValueInfo& nvi : GetNodeValuesInfo(idx)) {
+      node_values_info_.push_back(nvi);
+      opt_index_.at(GetKey(nvi)) = idx;
+    }
+  }
+  first_node_value_.at(n_variables) = node_values_info_.size();
+}
+
+int
+NodesVariables::GetKey (const NodeValueInfo& nvi) const
+{
+  int n_derivatives = nodes_.front().GetDerivativeCount();
+  if (nvi.id_ < 0 || nvi.id_ >= nodes_.size() || nvi.deriv_ >= n_derivatives)
+    return -1;
+
+  return (nvi.id_*n_derivatives + nvi.deriv_)*n_dim_ + nvi.dim_;
+}
+
 int
 NodesVariables::GetOptIndex(const NodeValueInfo& nvi_des) const
 {
-  // could also cache this as map for more efficiency, but adding complexity
-  for (int idx=0; idx<GetRows(); ++idx)
-    for ( NodeValueInfo nvi : GetNodeValuesInfo(idx))
-      if ( nvi == nvi_des )
-        return idx;
+  if (first_node_value_.empty())
+    BuildIndexTables();
+
+  int key = GetKey(nvi_des);
+  if (key < 0)
+    return NodeValueNotOptimized;
 
-  return NodeValueNotOptimized; // index representing these quantities doesn't exist
+  return opt_index_.at(key); // NodeValueNotOptimized if no variable represents it
 }
 
 Eigen::VectorXd
 NodesVariables::GetValues () const
 {
+  if (first_node_value_.empty())
+    BuildIndexTables();
+
   VectorXd x(GetRows());
 
-  for (int idx=0; idx<x.rows(); ++idx)
-    for (auto nvi : GetNodeValuesInfo(idx))
-      x(idx) = nodes_.at(nvi.id_).at(nvi.deriv_)(nvi.dim_);
+  for (int idx=0; idx<x.rows(); ++idx) {
+    // if a variable sets multiple node values, the last one defines it
+    const NodeValueInfo& nvi = node_values_info_[first_node_value_[idx+1]-1];
+    x(idx) = nodes_[nvi.id_].at(nvi.deriv_)(nvi.dim_);
+  }
 
   return x;
 }
@@ -64,13 +105,71 @@ NodesVariables::GetValues () const
 void
 NodesVariables::SetVariables (const VectorXd& x)
 {
-  for (int idx=0; idx<x.rows(); ++idx)
-    for (auto nvi : GetNodeValuesInfo(idx))
-      nodes_.at(nvi.id_).at(nvi.deriv_)(nvi.dim_) = x(idx);
+  if (first_node_value_.empty())
+    BuildIndexTables();
+
+  for (int idx=0; idx<x.rows(); ++idx) {
+    for (int i=first_node_value_[idx]; i<first_node_value_[idx+1]; ++i) {
+      const NodeValueInfo& nvi = node_values_info_[i];
+      nodes_[nvi.id_].at(nvi.deriv_)(nvi.dim_) = x(idx);
+    }
+  }
+
+  UpdateObservers();
+
+  for (auto& n : sharing_)
+    n->UpdateFromSharedNodes();
+}
+
+void
+NodesVariables::UseVariablesOf (const Ptr& nodes, const VectorXd& scale,
+                                const VectorXd& offset)
+{
+  assert(nodes->nodes_.size() == nodes_.size() && nodes->GetRows() == GetRows());
+
+  shared_ = nodes;
+  scale_  = scale;
+  offset_ = offset;
+  n_opt_variables_ = GetRows();
+  shared_->sharing_.push_back(this);
+
+  // no variables of its own anymore
+  SetRows(0);
+  bounds_.clear();
+
+  UpdateFromSharedNodes();
+}
+
+void
+NodesVariables::UpdateFromSharedNodes ()
+{
+  for (int i=0; i<nodes_.size(); ++i) {
+    const Node& n = shared_->nodes_.at(i);
+    nodes_.at(i).at(kPos) = scale_.cwiseProduct(n.p()) + offset_;
+    nodes_.at(i).at(kVel) = scale_.cwiseProduct(n.v());
+  }
 
   UpdateObservers();
 }
 
+std::string
+NodesVariables::GetOptVariablesName () const
+{
+  return shared_? shared_->GetName() : GetName();
+}
+
+int
+NodesVariables::GetOptVariablesCount () const
+{
+  return shared_? n_opt_variables_ : GetRows();
+}
+
+double
+NodesVariables::GetScale (int dim) const
+{
+  return shared_? scale_(dim) : 1.0;
+}
+
 void
 NodesVariables::UpdateObservers() const
 {
@@ -134,8 +233,12 @@ NodesVariables::SetByLinearInterpolation(const VectorXd& initial_val,
   VectorXd average_velocity = dp / t_total;
   int num_nodes = nodes_.size();
 
+  if (first_node_value_.empty())
+    BuildIndexTables();
+
   for (int idx=0; idx<GetRows(); ++idx) {
-    for (auto nvi : GetNodeValuesInfo(idx)) {
+    for (int i=first_node_value_[idx]; i<first_node_value_[idx+1]; ++i) {
+      const NodeValueInfo& nvi = node_values_info_[i];
 
       if (nvi.deriv_ == kPos) {
         VectorXd pos = initial_val + nvi.id_/static_cast<double>(num_nodes-1)*dp;
@@ -149,6 +252,28 @@ NodesVariables::SetByLinearInterpolation(const VectorXd& initial_val,
   }
 }
 
+void
+NodesVariables::SetBySampling (const CubicHermiteSpline& spline,
+                               const VecDurations& poly_durations)
+{
+  assert(spline.GetDim() == GetDim());
+  assert(poly_durations.size()+1 == nodes_.size());
+
+  std::vector<double> node_times(1, 0.0);
+  for (double d : poly_durations)
+    node_times.push_back(node_times.back() + d);
+
+  VectorXd x = GetValues();
+  for (int idx=0; idx<GetRows(); ++idx) {
+    NodeValueInfo nvi = GetNodeValuesInfo(idx).front();
+    State s = spline.GetPoint(node_times.at(nvi.id_));
+    double val = s.at(nvi.deriv_)(nvi.dim_);
+    x(idx) = std::max(bounds_.at(idx).lower_, std::min(val, bounds_.at(idx).upper_));
+  }
+
+  SetVariables(x);
+}
+
 void
 NodesVariables::AddBounds(int node_id, Dx deriv,
                  const std::vector<int>& dimensions,
@@ -161,10 +286,9 @@ NodesVariables::AddBounds(int node_id, Dx deriv,
 void
 NodesVariables::AddBound (const NodeValueInfo& nvi_des, double val)
 {
-  for (int idx=0; idx<GetRows(); ++idx)
-    for (auto nvi : GetNodeValuesInfo(idx))
-      if (nvi == nvi_des)
-        bounds_.at(idx) = ifopt::Bounds(val, val);
+  int idx = GetOptIndex(nvi_des);
+  if (idx != NodeValueNotOptimized && idx < GetRows())
+    bounds_.at(idx) = ifopt::Bounds(val, val);
 }
 
 void
@@ -31,13 +31,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace towr {
 
-NodesVariablesAll::NodesVariablesAll (int n_nodes, int n_dim, std::string variable_id)
+NodesVariablesAll::NodesVariablesAll (int n_nodes, int n_dim, std::string variable_id,
+                                      int n_derivatives)
     : NodesVariables(variable_id)
 {
-  int n_opt_variables = n_nodes*Node::n_derivatives*n_dim;
+  int n_opt_variables = n_nodes*n_derivatives*n_dim;
 
   n_dim_ = n_dim;
-  nodes_  = std::vector<Node>(n_nodes, Node(n_dim));
+  n_derivatives_ = n_derivatives;
+  nodes_  = std::vector<Node>(n_nodes, Node(n_dim, n_derivatives));
   bounds_ = VecBound(n_opt_variables, ifopt::NoBound);
   SetRows(n_opt_variables);
 }
@@ -47,11 +49,11 @@ NodesVariablesAll::GetNodeValuesInfo (int idx) const
 {
   std::vector<NodeValueInfo> vec_nvi;
 
-  int n_opt_values_per_node_ = 2*GetDim();
-  int internal_id = idx%n_opt_values_per_node_; // 0...6 (p.x, p.y, p.z, v.x, v.y. v.z)
+  int n_opt_values_per_node_ = n_derivatives_*GetDim();
+  int internal_id = idx%n_opt_values_per_node_; // 0...6 (p.x, p.y, p.z, v.x, v.y. v.z, (a.x...))
 
   NodeValueInfo nvi;
-  nvi.deriv_ = internal_id<GetDim()? kPos : kVel;
+  nvi.deriv_ = static_cast<Dx>(internal_id/GetDim());
   nvi.dim_   = internal_id%GetDim();
   nvi.id_    = std::floor(idx/n_opt_values_per_node_);
 
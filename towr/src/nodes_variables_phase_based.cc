@@ -68,6 +68,33 @@ NodesVariablesPhaseBased::NodesVariablesPhaseBased (int phase_count,
   n_dim_ = k3D;
   int n_nodes = polynomial_info_.size()+1;
   nodes_  = std::vector<Node>(n_nodes, Node(n_dim_));
+
+  BuildPhaseTables(phase_count);
+}
+
+void
+NodesVariablesPhaseBased::BuildPhaseTables (int phase_count)
+{
+  int n_nodes = nodes_.size();
+  phase_of_node_.resize(n_nodes);
+  is_constant_node_.resize(n_nodes);
+
+  // node is considered constant if either left or right polynomial
+  // belongs to a constant phase
+  for (int node_id=0; node_id<n_nodes; ++node_id) {
+    std::vector<int> poly_ids = GetAdjacentPolyIds(node_id);
+    phase_of_node_.at(node_id) = polynomial_info_.at(poly_ids.front()).phase_;
+
+    bool is_constant = false;
+    for (int poly_id : poly_ids)
+      if (polynomial_info_.at(poly_id).is_constant_)
+        is_constant = true;
+    is_constant_node_.at(node_id) = is_constant;
+  }
+
+  first_poly_of_phase_.assign(phase_count, -1);
+  for (int i=polynomial_info_.size()-1; i>=0; --i)
+    first_poly_of_phase_.at(polynomial_info_.at(i).phase_) = i;
 }
 
 NodesVariablesPhaseBased::VecDurations
@@ -99,15 +126,7 @@ NodesVariablesPhaseBased::GetNumberOfPrevPolynomialsInPhase(int poly_id) const
 bool
 NodesVariablesPhaseBased::IsConstantNode (int node_id) const
 {
-  bool is_constant = false;
-
-  // node is considered constant if either left or right polynomial
-  // belongs to a constant phase
-  for (int poly_id : GetAdjacentPolyIds(node_id))
-    if (IsInConstantPhase(poly_id))
-      is_constant = true;
-
-  return is_constant;
+  return is_constant_node_.at(node_id);
 }
 
 bool
@@ -121,7 +140,7 @@ NodesVariablesPhaseBased::GetIndicesOfNonConstantNodes() const
 {
   NodeIds node_ids;
 
-  for (int id=0; id<GetNodes().size(); ++id)
+  for (int id=0; id<nodes_.size(); ++id)
     if (!IsConstantNode(id))
       node_ids.push_back(id);
 
@@ -133,24 +152,20 @@ NodesVariablesPhaseBased::GetPhase (int node_id) const
 {
   assert(!IsConstantNode(node_id)); // because otherwise it has two phases
 
-  int poly_id = GetAdjacentPolyIds(node_id).front();
-  return polynomial_info_.at(poly_id).phase_;
+  return phase_of_node_.at(node_id);
 }
 
 int
 NodesVariablesPhaseBased::GetPolyIDAtStartOfPhase (int phase) const
 {
-  int poly_id=0;
-  for (int i=0; i<polynomial_info_.size(); ++i)
-    if (polynomial_info_.at(i).phase_ == phase)
-      return i;
+  return first_poly_of_phase_.at(phase);
 }
 
 Eigen::Vector3d
 NodesVariablesPhaseBased::GetValueAtStartOfPhase (int phase) const
 {
   int node_id = GetNodeIDAtStartOfPhase(phase);
-  return GetNodes().at(node_id).p();
+  return nodes_.at(node_id).p();
 }
 
 int
@@ -164,7 +179,7 @@ std::vector<int>
 NodesVariablesPhaseBased::GetAdjacentPolyIds (int node_id) const
 {
   std::vector<int> poly_ids;
-  int last_node_id = GetNodes().size()-1;
+  int last_node_id = nodes_.size()-1;
 
   if (node_id==0)
     poly_ids.push_back(0);
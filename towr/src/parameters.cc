@@ -32,7 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <algorithm>
 #include <numeric>      // std::accumulate
-#include <math.h>       // fabs
+#include <math.h>       // fabs, ceil
 #include <cassert>
 
 namespace towr {
@@ -41,6 +41,9 @@ Parameters::Parameters ()
 {
   // constructs optimization variables
   duration_base_polynomial_ = 0.1;
+  base_spline_basis_ = CubicHermite;
+  base_knot_placement_ = UniformKnots;
+  bound_base_poly_duration_ = std::make_pair(0.05, 2*duration_base_polynomial_); // only for contact aligned knots
   force_polynomials_per_stance_phase_ = 3;
   ee_polynomials_per_swing_phase_ = 2; // so step can at least lift leg
 
@@ -50,6 +53,7 @@ Parameters::Parameters ()
   dt_constraint_dynamic_ = 0.1;
   dt_constraint_base_motion_ = duration_base_polynomial_/4.; // only for base RoM constraint
   bound_phase_duration_ = std::make_pair(0.2, 1.0);  // used only when optimizing phase durations, so gait
+  share_mirrored_ee_ = false;
 
   // a minimal set of basic constraints
   constraints_.push_back(Terrain);
@@ -79,9 +83,37 @@ Parameters::OptimizePhaseDurations ()
   constraints_.push_back(TotalTime);
 }
 
+void
+Parameters::MakePeriodic ()
+{
+  constraints_.push_back(Periodic);
+}
+
+void
+Parameters::UseQuinticBase ()
+{
+  base_spline_basis_ = QuinticHermite;
+  duration_base_polynomial_ = 0.2;
+  bound_base_poly_duration_.second = 2*duration_base_polynomial_;
+  dt_constraint_base_motion_ = duration_base_polynomial_/4.;
+
+  // accelerations are continuous across the nodes anyway
+  constraints_.erase(std::remove(constraints_.begin(), constraints_.end(), BaseAcc),
+                     constraints_.end());
+}
+
+void
+Parameters::AlignBaseKnotsWithContacts ()
+{
+  base_knot_placement_ = ContactKnots;
+}
+
 Parameters::VecTimes
 Parameters::GetBasePolyDurations () const
 {
+  if (base_knot_placement_ == ContactKnots)
+    return GetContactAlignedPolyDurations();
+
   std::vector<double> base_spline_timings_;
   double dt = duration_base_polynomial_;
   double t_left = GetTotalTime ();
@@ -97,6 +129,65 @@ Parameters::GetBasePolyDurations () const
   return base_spline_timings_;
 }
 
+Parameters::VecTimes
+Parameters::GetContactAlignedPolyDurations () const
+{
+  double t_min = bound_base_poly_duration_.first;
+  double t_max = bound_base_poly_duration_.second;
+  double T = GetTotalTime();
+
+  // switches closer than t_min to each other share one knot at the switch
+  // nearest to the middle of the group, or the knot at the start or end of
+  // the motion if the group is closer than t_min to it.
+  VecTimes switches = GetContactSwitchTimes();
+  VecTimes knots = {0.0};
+  std::size_t i = 0;
+  while (i < switches.size()) {
+    std::size_t begin = i++;
+    while (i < switches.size() && switches.at(i) - switches.at(i-1) < t_min)
+      ++i;
+
+    double first = switches.at(begin);
+    double last  = switches.at(i-1);
+    if (first < t_min || T-last < t_min)
+      continue;
+
+    double middle = (first+last)/2;
+    double knot = first;
+    for (std::size_t k=begin; k<i; ++k)
+      if (fabs(switches.at(k)-middle) < fabs(knot-middle))
+        knot = switches.at(k);
+    knots.push_back(knot);
+  }
+  knots.push_back(T);
+
+  VecTimes durations;
+  for (std::size_t k=1; k<knots.size(); ++k) {
+    double interval = knots.at(k) - knots.at(k-1);
+    int n_polys = ceil(interval/t_max - 1e-10);
+    for (int i=0; i<n_polys; ++i)
+      durations.push_back(interval/n_polys);
+  }
+
+  return durations;
+}
+
+Parameters::VecTimes
+Parameters::GetContactSwitchTimes () const
+{
+  VecTimes switches;
+  for (const auto& v : ee_phase_durations_) {
+    double t = 0.0;
+    for (int phase=0; phase<static_cast<int>(v.size())-1; ++phase) {
+      t += v.at(phase);
+      switches.push_back(t);
+    }
+  }
+
+  std::sort(switches.begin(), switches.end());
+  return switches;
+}
+
 int
 Parameters::GetPhaseCount(EEID ee) const
 {
@@ -134,4 +225,11 @@ Parameters::IsOptimizeTimings () const
   return std::find(v.begin(), v.end(), c) != v.end();
 }
 
+bool
+Parameters::IsPeriodic () const
+{
+  auto v = constraints_; // shorthand
+  return std::find(v.begin(), v.end(), Periodic) != v.end();
+}
+
 } // namespace towr
@@ -0,0 +1,395 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/planning/parametric_sensitivity.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <towr/constraints/finite_difference_jacobian.h>
+
+namespace towr {
+
+// keeps the KKT matrix regular for redundant active constraints and
+// directions in which the Lagrangian has no curvature.
+static const double kRegularization = 1e-8;
+
+ParametricSensitivity::ParametricSensitivity (const NlpFormulation& formulation,
+                                              double active_tolerance)
+    : formulation_(formulation),
+      active_tolerance_(active_tolerance)
+{
+}
+
+ParametricSensitivity::VectorXd
+ParametricSensitivity::GetParameters (const NlpFormulation& f)
+{
+  int n_ee = f.initial_ee_W_.size();
+  VectorXd p(24 + 3*n_ee);
+  int row = 0;
+  for (const BaseState* b : {&f.initial_base_, &f.final_base_}) {
+    for (const Node* n : {&b->lin, &b->ang}) {
+      p.segment(row, 3) = n->p(); row += 3;
+      p.segment(row, 3) = n->v(); row += 3;
+    }
+  }
+
+  for (const auto& ee : f.initial_ee_W_) {
+    p.segment(row, 3) = ee;
+    row += 3;
+  }
+
+  return p;
+}
+
+void
+ParametricSensitivity::SetParameters (NlpFormulation& f, const VectorXd& p)
+{
+  int row = 0;
+  for (BaseState* b : {&f.initial_base_, &f.final_base_}) {
+    for (Node* n : {&b->lin, &b->ang}) {
+      n->at(kPos) = p.segment(row, 3); row += 3;
+      n->at(kVel) = p.segment(row, 3); row += 3;
+    }
+  }
+
+  for (auto& ee : f.initial_ee_W_) {
+    ee = p.segment(row, 3);
+    row += 3;
+  }
+}
+
+ParametricSensitivity::Bounds
+ParametricSensitivity::GetBounds (ifopt::Problem& nlp)
+{
+  auto x_bounds = nlp.GetBoundsOnOptimizationVariables();
+  auto g_bounds = nlp.GetBoundsOnConstraints();
+
+  Bounds b;
+  b.x_lower_.resize(x_bounds.size());
+  b.x_upper_.resize(x_bounds.size());
+  for (std::size_t i=0; i<x_bounds.size(); ++i) {
+    b.x_lower_(i) = x_bounds.at(i).lower_;
+    b.x_upper_(i) = x_bounds.at(i).upper_;
+  }
+
+  b.g_lower_.resize(g_bounds.size());
+  b.g_upper_.resize(g_bounds.size());
+  for (std::size_t i=0; i<g_bounds.size(); ++i) {
+    b.g_lower_(i) = g_bounds.at(i).lower_;
+    b.g_upper_(i) = g_bounds.at(i).upper_;
+  }
+
+  return b;
+}
+
+ParametricSensitivity::Bounds
+ParametricSensitivity::GetBounds (NlpFormulation formulation, const VectorXd& p)
+{
+  SetParameters(formulation, p);
+
+  SplineHolder splines;
+  ifopt::Problem nlp;
+  for (auto c : formulation.GetVariableSets(splines))
+    nlp.AddVariableSet(c);
+  for (auto c : formulation.GetConstraints(splines))
+    nlp.AddConstraintSet(c);
+
+  return GetBounds(nlp);
+}
+
+ParametricSensitivity::VectorXd
+ParametricSensitivity::GetLagrangianGradient (ifopt::Problem& nlp, const VectorXd& x,
+                                              const VectorXd& lambda)
+{
+  nlp.SetVariables(x.data());
+  VectorXd grad = nlp.EvaluateCostFunctionGradient(x.data());
+  return grad + nlp.GetJacobianOfConstraints().transpose()*lambda;
+}
+
+ParametricSensitivity::Jacobian
+ParametricSensitivity::GetLagrangianHessian (ifopt::Problem& nlp,
+                                             const VectorXd& lambda) const
+{
+  int n_x = x0_.size();
+  std::vector<Eigen::Triplet<double>> pattern;
+  for (int i=0; i<n_x; ++i)
+    pattern.emplace_back(i, i, 1.0);
+
+  // a constraint or cost couples all the variables it depends on
+  auto couple = [&pattern](const Jacobian& jac, int row) {
+    std::vector<int> cols;
+    for (Jacobian::InnerIterator it(jac, row); it; ++it)
+      cols.push_back(it.col());
+    for (int i : cols)
+      for (int j : cols)
+        pattern.emplace_back(i, j, 1.0);
+  };
+
+  nlp.SetVariables(x0_.data());
+  Jacobian jac = nlp.GetJacobianOfConstraints();
+  for (int i=0; i<lambda.size(); ++i)
+    if (lambda(i) != 0.0)
+      couple(jac, i);
+  for (const auto& c : nlp.GetCosts().GetComponents())
+    couple(c->GetJacobian(), 0);
+
+  Jacobian sparsity(n_x, n_x);
+  sparsity.setFromTriplets(pattern.begin(), pattern.end());
+
+  FiniteDifferenceJacobian fd(sparsity);
+  Jacobian hessian = fd.Evaluate([&](const VectorXd& x) {
+    return GetLagrangianGradient(nlp, x, lambda);
+  }, x0_);
+  nlp.SetVariables(x0_.data());
+
+  Jacobian hessian_t = hessian.transpose();
+  return 0.5*(hessian + hessian_t);
+}
+
+void
+ParametricSensitivity::Linearize (ifopt::Problem& nlp)
+{
+  x0_ = nlp.GetVariableValues();
+  p0_ = GetParameters(formulation_);
+  int n_x = x0_.size();
+  int n_p = p0_.size();
+
+  Bounds b = GetBounds(nlp);
+  Bounds b0 = GetBounds(formulation_, p0_);
+  if (b0.x_lower_.size() != n_x || b0.g_lower_.size() != b.g_lower_.size())
+    throw std::runtime_error("problem wasn't built from this formulation!");
+
+  // the bounds are (close to) linear in the parameters, so a single
+  // forward difference per parameter suffices.
+  const double h = 1e-4;
+  MatrixXd dx_lower(n_x, n_p), dx_upper(n_x, n_p);
+  MatrixXd dg_lower(b.g_lower_.size(), n_p), dg_upper(b.g_lower_.size(), n_p);
+  for (int i=0; i<n_p; ++i) {
+    Bounds bi = GetBounds(formulation_, p0_ + h*VectorXd::Unit(n_p, i));
+    dx_lower.col(i) = (bi.x_lower_ - b0.x_lower_)/h;
+    dx_upper.col(i) = (bi.x_upper_ - b0.x_upper_)/h;
+    dg_lower.col(i) = (bi.g_lower_ - b0.g_lower_)/h;
+    dg_upper.col(i) = (bi.g_upper_ - b0.g_upper_)/h;
+  }
+
+  // active variables follow their bound
+  dx_dp_ = MatrixXd::Zero(n_x, n_p);
+  free_.clear();
+  fixed_.clear();
+  std::vector<int> col(n_x);      // index among the free or fixed variables
+  std::vector<bool> is_free(n_x);
+  for (int i=0; i<n_x; ++i) {
+    double to_lower = x0_(i) - b.x_lower_(i);
+    double to_upper = b.x_upper_(i) - x0_(i);
+    is_free.at(i) = std::min(to_lower, to_upper) > active_tolerance_;
+    if (is_free.at(i)) {
+      col.at(i) = free_.size();
+      free_.push_back(i);
+      continue;
+    }
+    col.at(i) = fixed_.size();
+    fixed_.push_back(i);
+    dx_dp_.row(i) = to_lower <= to_upper? dx_lower.row(i) : dx_upper.row(i);
+  }
+
+  // active constraints stay at their bound
+  VectorXd g = nlp.EvaluateConstraints(x0_.data());
+  active_g_.clear();
+  std::vector<double> bound;
+  std::vector<int> at_lower;
+  for (int i=0; i<g.size(); ++i) {
+    double to_lower = g(i) - b.g_lower_(i);
+    double to_upper = b.g_upper_(i) - g(i);
+    if (std::min(to_lower, to_upper) > active_tolerance_)
+      continue;
+    active_g_.push_back(i);
+    at_lower.push_back(to_lower <= to_upper);
+    bound.push_back(to_lower <= to_upper? b.g_lower_(i) : b.g_upper_(i));
+  }
+
+  int n_active = active_g_.size();
+  int n_free = free_.size();
+  int n_fixed = fixed_.size();
+  active_g_bound_.resize(n_active);
+  active_g_bound_dp_.resize(n_active, n_p);
+  for (int a=0; a<n_active; ++a) {
+    active_g_bound_(a) = bound.at(a);
+    active_g_bound_dp_.row(a) = at_lower.at(a)? dg_lower.row(active_g_.at(a))
+                                              : dg_upper.row(active_g_.at(a));
+  }
+
+  // Jacobian of the active constraints w.r.t. the free and fixed variables
+  Jacobian jac = nlp.GetJacobianOfConstraints();
+  std::vector<Eigen::Triplet<double>> free_triplets, fixed_triplets;
+  for (int a=0; a<n_active; ++a)
+    for (Jacobian::InnerIterator it(jac, active_g_.at(a)); it; ++it)
+      (is_free.at(it.col())? free_triplets : fixed_triplets)
+          .emplace_back(a, col.at(it.col()), it.value());
+
+  SparseMatrix jac_free(n_active, n_free), jac_fixed(n_active, n_fixed);
+  jac_free.setFromTriplets(free_triplets.begin(), free_triplets.end());
+  jac_fixed.setFromTriplets(fixed_triplets.begin(), fixed_triplets.end());
+
+  // multipliers that best satisfy the stationarity of the free variables,
+  // grad_F f + J_A^T lambda = 0, in the least squares sense.
+  VectorXd grad = nlp.EvaluateCostFunctionGradient(x0_.data());
+  VectorXd grad_free(n_free);
+  for (int j=0; j<n_free; ++j)
+    grad_free(j) = grad(free_.at(j));
+
+  lambda0_ = VectorXd::Zero(n_active);
+  if (n_active > 0) {
+    SparseMatrix identity(n_active, n_active);
+    identity.setIdentity();
+    SparseMatrix normal = jac_free*jac_free.transpose();
+    Eigen::SimplicialLDLT<SparseMatrix> ldlt(normal + kRegularization*identity);
+    lambda0_ = ldlt.solve(-(jac_free*grad_free));
+  }
+
+  VectorXd lambda = VectorXd::Zero(g.size());
+  for (int a=0; a<n_active; ++a)
+    lambda(active_g_.at(a)) = lambda0_(a);
+  Jacobian hessian = GetLagrangianHessian(nlp, lambda);
+
+  // KKT matrix of the free variables and multipliers
+  std::vector<Eigen::Triplet<double>> kkt_triplets, coupling_triplets;
+  for (int j=0; j<n_free; ++j) {
+    for (Jacobian::InnerIterator it(hessian, free_.at(j)); it; ++it)
+      (is_free.at(it.col())? kkt_triplets : coupling_triplets)
+          .emplace_back(j, col.at(it.col()), it.value());
+    kkt_triplets.emplace_back(j, j, kRegularization);
+  }
+  for (int k=0; k<jac_free.outerSize(); ++k)
+    for (SparseMatrix::InnerIterator it(jac_free, k); it; ++it) {
+      kkt_triplets.emplace_back(n_free+it.row(), it.col(), it.value());
+      kkt_triplets.emplace_back(it.col(), n_free+it.row(), it.value());
+    }
+  for (int a=0; a<n_active; ++a)
+    kkt_triplets.emplace_back(n_free+a, n_free+a, -kRegularization);
+
+  SparseMatrix kkt(n_free+n_active, n_free+n_active);
+  kkt.setFromTriplets(kkt_triplets.begin(), kkt_triplets.end());
+  SparseMatrix hessian_fixed(n_free, n_fixed);
+  hessian_fixed.setFromTriplets(coupling_triplets.begin(), coupling_triplets.end());
+
+  kkt_.compute(kkt);
+  if (kkt_.info() != Eigen::Success)
+    throw std::runtime_error("KKT matrix of the active set couldn't be factorized!");
+
+  MatrixXd dx_dp_fixed(n_fixed, n_p);
+  for (int j=0; j<n_fixed; ++j)
+    dx_dp_fixed.row(j) = dx_dp_.row(fixed_.at(j));
+
+  MatrixXd rhs(n_free+n_active, n_p);
+  rhs.topRows(n_free) = -(hessian_fixed*dx_dp_fixed);
+  rhs.bottomRows(n_active) = active_g_bound_dp_ - jac_fixed*dx_dp_fixed;
+
+  MatrixXd sol = kkt_.solve(rhs);
+  for (int j=0; j<n_free; ++j)
+    dx_dp_.row(free_.at(j)) = sol.row(j);
+  dlambda_dp_ = sol.bottomRows(n_active);
+}
+
+ParametricSensitivity::VectorXd
+ParametricSensitivity::GetParameterChange (const NlpFormulation& perturbed) const
+{
+  if (dx_dp_.size() == 0)
+    throw std::runtime_error("sensitivity must be linearized first!");
+
+  VectorXd p = GetParameters(perturbed);
+  if (p.size() != p0_.size())
+    throw std::runtime_error("perturbed formulation has a different number of endeffectors!");
+
+  return p - p0_;
+}
+
+ParametricSensitivity::VectorXd
+ParametricSensitivity::Predict (const NlpFormulation& perturbed) const
+{
+  return x0_ + dx_dp_*GetParameterChange(perturbed);
+}
+
+ParametricSensitivity::VectorXd
+ParametricSensitivity::GetMultipliers (const VectorXd& dp, int n_constraints) const
+{
+  VectorXd lambda_active = lambda0_ + dlambda_dp_*dp;
+  VectorXd lambda = VectorXd::Zero(n_constraints);
+  for (std::size_t a=0; a<active_g_.size(); ++a)
+    lambda(active_g_.at(a)) = lambda_active(a);
+
+  return lambda;
+}
+
+ParametricSensitivity::VectorXd
+ParametricSensitivity::Correct (ifopt::Problem& nlp, const NlpFormulation& perturbed) const
+{
+  VectorXd dp = GetParameterChange(perturbed);
+  VectorXd x = nlp.GetVariableValues();
+  for (int i : fixed_)
+    x(i) = x0_(i) + dx_dp_.row(i)*dp;
+
+  // the KKT matrix at the prediction is close to the one at the solution
+  VectorXd g = nlp.EvaluateConstraints(x.data());
+  VectorXd grad = GetLagrangianGradient(nlp, x, GetMultipliers(dp, g.size()));
+
+  int n_free = free_.size();
+  VectorXd residual(n_free + active_g_.size());
+  for (int j=0; j<n_free; ++j)
+    residual(j) = -grad(free_.at(j));
+  for (std::size_t a=0; a<active_g_.size(); ++a)
+    residual(n_free+a) = active_g_bound_(a) + active_g_bound_dp_.row(a)*dp
+                         - g(active_g_.at(a));
+
+  VectorXd step = kkt_.solve(residual);
+  for (int j=0; j<n_free; ++j)
+    x(free_.at(j)) += step(j);
+
+  nlp.SetVariables(x.data());
+  return x;
+}
+
+void
+ParametricSensitivity::Update (ifopt::Problem& nlp, const NlpFormulation& perturbed,
+                               bool correct) const
+{
+  VectorXd x = Predict(perturbed);
+  nlp.SetVariables(x.data());
+
+  if (correct)
+    Correct(nlp, perturbed);
+}
+
+int
+ParametricSensitivity::GetActiveCount () const
+{
+  return (x0_.size() - free_.size()) + active_g_.size();
+}
+
+} /* namespace towr */
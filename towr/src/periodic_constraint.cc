@@ -0,0 +1,114 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/constraints/periodic_constraint.h>
+
+namespace towr {
+
+PeriodicConstraint::PeriodicConstraint (const std::string& nodes_id,
+                                        const Vector3d& translation,
+                                        const std::vector<int>& pos_dims)
+    :ConstraintSet(kSpecifyLater, "periodic-" + nodes_id)
+{
+  nodes_id_    = nodes_id;
+  translation_ = translation;
+  pos_dims_    = pos_dims;
+}
+
+void
+PeriodicConstraint::InitVariableDependedQuantities (const VariablesPtr& x)
+{
+  nodes_ = x->GetComponent<NodesVariables>(nodes_id_);
+
+  int last = nodes_->GetNodes().size()-1;
+
+  constrained_.clear();
+  for (Dx deriv : {kPos, kVel}) {
+    std::vector<int> dims = deriv == kPos? pos_dims_ : std::vector<int>{X,Y,Z};
+    for (int dim : dims) {
+      if (dim >= nodes_->GetDim())
+        continue;
+
+      NodesVariables::NodeValueInfo first(0, deriv, dim), end(last, deriv, dim);
+      int idx_first = nodes_->GetOptIndex(first);
+      int idx_end   = nodes_->GetOptIndex(end);
+
+      bool any_optimized = idx_first != NodesVariables::NodeValueNotOptimized
+                        || idx_end   != NodesVariables::NodeValueNotOptimized;
+      if (any_optimized && idx_first != idx_end)
+        constrained_.push_back(end);
+    }
+  }
+
+  SetRows(constrained_.size());
+}
+
+Eigen::VectorXd
+PeriodicConstraint::GetValues () const
+{
+  VectorXd g(GetRows());
+
+  auto nodes = nodes_->GetNodes();
+  for (int row=0; row<constrained_.size(); ++row) {
+    const auto& nvi = constrained_.at(row);
+    double offset = nvi.deriv_ == kPos? translation_(nvi.dim_) : 0.0;
+    g(row) = nodes.back().at(nvi.deriv_)(nvi.dim_)
+           - nodes.front().at(nvi.deriv_)(nvi.dim_) - offset;
+  }
+
+  return g;
+}
+
+PeriodicConstraint::VecBound
+PeriodicConstraint::GetBounds () const
+{
+  return VecBound(GetRows(), ifopt::BoundZero);
+}
+
+void
+PeriodicConstraint::FillJacobianBlock (std::string var_set,
+                                       Jacobian& jac) const
+{
+  if (var_set == nodes_->GetOptVariablesName()) {
+    for (int row=0; row<constrained_.size(); ++row) {
+      const auto& end = constrained_.at(row);
+      NodesVariables::NodeValueInfo first(0, end.deriv_, end.dim_);
+
+      int idx_end   = nodes_->GetOptIndex(end);
+      int idx_first = nodes_->GetOptIndex(first);
+      double s = nodes_->GetScale(end.dim_);
+      if (idx_end != NodesVariables::NodeValueNotOptimized)
+        jac.coeffRef(row, idx_end) += s;
+      if (idx_first != NodesVariables::NodeValueNotOptimized)
+        jac.coeffRef(row, idx_first) -= s;
+    }
+  }
+}
+
+} /* namespace towr */
@@ -0,0 +1,132 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <towr/io/shared_trajectory_reader.h>
+#include <towr/planning/planning_client.h>
+
+using namespace towr;
+
+/**
+ * Stand-in for the clients of a planning server that measures its latency
+ * and throughput under load:
+ *
+ *   towr-planning-load <socket> [requests, default 100] [clients, default 4]
+ *                      [robot, default 1] [terrain, default 0] [gait, default 0]
+ *
+ * Every client sends its share of requests with random goals, each one after
+ * the previous reply arrived.
+ */
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <socket> [requests] [clients] [robot] [terrain] [gait]" << std::endl;
+    return 1;
+  }
+
+  std::string socket = argv[1];
+  int n_requests = argc > 2? std::stoi(argv[2]) : 100;
+  int n_clients  = argc > 3? std::stoi(argv[3]) : 4;
+  int robot      = argc > 4? std::stoi(argv[4]) : 1;
+  int terrain    = argc > 5? std::stoi(argv[5]) : 0;
+  int gait       = argc > 6? std::stoi(argv[6]) : 0;
+
+  std::atomic<int> next_request(0), n_failed(0), n_feasible(0);
+  std::vector<std::vector<double>> latencies(n_clients);
+
+  auto run_client = [&](int id) {
+    PlanningClient client(socket);
+    if (!client.IsConnected()) {
+      std::cerr << "Can't connect to " << socket << std::endl;
+      return;
+    }
+
+    std::mt19937 random(id);
+    std::uniform_real_distribution<double> goal(0.3, 1.5);
+
+    while (next_request++ < n_requests) {
+      PlanningClient::PlanRequest r = PlanningClient::PlanRequest();
+      r.robot_   = robot;
+      r.terrain_ = terrain;
+      r.gait_    = gait;
+      r.total_duration_  = 2.0;
+      r.initial_base_[2] = 0.5;
+      r.final_base_[0]   = goal(random);
+      r.final_base_[2]   = 0.5;
+
+      auto start = std::chrono::steady_clock::now();
+      uint32_t request_id;
+      PlanningClient::PlanReply reply;
+      std::vector<char> trajectory;
+      if (client.Send(r) == 0 || !client.Receive(request_id, reply, trajectory)) {
+        n_failed++;
+        return;
+      }
+      latencies.at(id).push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+      SharedTrajectoryView view(trajectory.data(), trajectory.size());
+      if (reply.status_ < 0 || !view.IsValid())
+        n_failed++;
+      else if (reply.is_feasible_)
+        n_feasible++;
+    }
+  };
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> clients;
+  for (int i=0; i<n_clients; ++i)
+    clients.emplace_back(run_client, i);
+  for (auto& c : clients)
+    c.join();
+  double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<double> all;
+  for (const auto& l : latencies)
+    all.insert(all.end(), l.begin(), l.end());
+  std::sort(all.begin(), all.end());
+  if (all.empty()) {
+    std::cerr << "No replies received." << std::endl;
+    return 1;
+  }
+
+  auto percentile = [&](double p) { return all.at(std::min<int>(all.size()-1, p*all.size())); };
+  std::cout << "replies:    " << all.size() << " (" << n_feasible << " feasible, " << n_failed << " failed)\n";
+  std::cout << "throughput: " << all.size()/total << " plans/s\n";
+  std::cout << "latency:    p50 " << percentile(0.5) << "s, p95 " << percentile(0.95)
+            << "s, max " << all.back() << "s" << std::endl;
+  return 0;
+}
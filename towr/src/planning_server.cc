@@ -0,0 +1,523 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/planning/planning_server.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <ifopt/problem.h>
+
+#include <towr/initialization/gait_generator.h>
+#include <towr/io/shared_trajectory_writer.h>
+#include <towr/variables/trajectory.h>
+
+namespace towr {
+
+using namespace planning_protocol;
+
+static const int kMaxWarmProblems = 16; ///< per worker.
+
+// the built problem of a robot, terrain and gait, only start and goal change.
+struct WarmProblem {
+  NlpFormulation formulation_;
+  SplineHolder splines_;
+  NlpFormulation::VariablePtrVec variables_;
+  NlpFormulation::ContraintPtrVec constraints_;
+  NlpFormulation::CostPtrVec costs_;
+};
+
+// the initial and final state of the request, the feet in nominal stance.
+static void
+SetStartAndGoal (const PlanRequest& request, NlpFormulation& f)
+{
+  f.initial_base_ = BaseState();
+  f.final_base_   = BaseState();
+  for (int dim=0; dim<3; ++dim) {
+    f.initial_base_.lin.at(kPos)(dim) = request.initial_base_[dim];
+    f.initial_base_.ang.at(kPos)(dim) = request.initial_base_[3+dim];
+    f.final_base_.lin.at(kPos)(dim)   = request.final_base_[dim];
+    f.final_base_.ang.at(kPos)(dim)   = request.final_base_[3+dim];
+  }
+
+  f.initial_ee_W_ = f.model_.kinematic_model_->GetNominalStanceInBase();
+  for (auto& p : f.initial_ee_W_) {
+    p.x() += request.initial_base_[0];
+    p.y() += request.initial_base_[1];
+    p.z()  = f.terrain_->GetHeight(p.x(), p.y());
+  }
+}
+
+NlpFormulation
+PlanningServer::GetFormulation (const PlanRequest& request,
+                                const RobotModel& model,
+                                const HeightMap::Ptr& terrain)
+{
+  NlpFormulation f;
+  f.model_   = model;
+  f.terrain_ = terrain;
+
+  int n_ee = model.kinematic_model_->GetNumberOfEndeffectors();
+  auto gait_gen = GaitGenerator::MakeGaitGenerator(n_ee);
+  gait_gen->SetCombo(static_cast<GaitGenerator::Combos>(request.gait_));
+  for (int ee=0; ee<n_ee; ++ee) {
+    f.params_.ee_phase_durations_.push_back(gait_gen->GetPhaseDurations(request.total_duration_, ee));
+    f.params_.ee_in_contact_at_start_.push_back(gait_gen->IsInContactAtStart(ee));
+  }
+
+  if (request.flags_ & kOptimizePhaseDurations)
+    f.params_.OptimizePhaseDurations();
+
+  SetStartAndGoal(request, f);
+  return f;
+}
+
+PlanningServer::PlanningServer (const std::string& socket_path,
+                                const BatchPlanner::SolverFactory& solver_factory,
+                                int worker_count,
+                                double max_solve_time,
+                                int queue_capacity)
+    : socket_path_(socket_path),
+      solver_factory_(solver_factory),
+      max_solve_time_(max_solve_time),
+      queue_capacity_(queue_capacity)
+{
+  sockaddr_un addr;
+  if (socket_path.size() >= sizeof(addr.sun_path))
+    throw std::runtime_error("socket path " + socket_path + " too long!");
+
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::strcpy(addr.sun_path, socket_path.c_str());
+  unlink(socket_path.c_str());
+
+  listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd_ < 0 || pipe(wake_pipe_) != 0 ||
+      bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      listen(listen_fd_, 64) != 0) {
+    std::string error = std::strerror(errno);
+    if (listen_fd_ >= 0)
+      close(listen_fd_);
+    for (int fd : wake_pipe_)
+      if (fd >= 0)
+        close(fd);
+    throw std::runtime_error("can't listen on " + socket_path + ": " + error + "!");
+  }
+
+  // Stop() must never block, Run() reads all pending wake ups at once.
+  for (int fd : wake_pipe_)
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  int n_workers = worker_count > 0? worker_count : std::thread::hardware_concurrency();
+  for (int i=0; i<std::max(1, n_workers); ++i)
+    workers_.emplace_back(&PlanningServer::Work, this);
+}
+
+PlanningServer::~PlanningServer ()
+{
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stop_workers_ = true;
+    shutdown_.Cancel();
+  }
+  job_added_.notify_all();
+  for (auto& w : workers_)
+    w.join();
+
+  close(listen_fd_);
+  close(wake_pipe_[0]);
+  close(wake_pipe_[1]);
+  unlink(socket_path_.c_str());
+}
+
+void
+PlanningServer::RegisterTerrain (int handle, const HeightMap::Ptr& terrain,
+                                 int version)
+{
+  std::lock_guard<std::mutex> lock(models_mutex_);
+  terrains_[handle] = terrain;
+  terrain_versions_[handle] = version;
+}
+
+int
+PlanningServer::GetTerrainVersion (int handle)
+{
+  std::lock_guard<std::mutex> lock(models_mutex_);
+  auto it = terrain_versions_.find(handle);
+  return it == terrain_versions_.end()? 0 : it->second;
+}
+
+void
+PlanningServer::SetSolutionCache (const std::shared_ptr<SolutionCache>& cache)
+{
+  cache_ = cache;
+}
+
+RobotModel
+PlanningServer::GetRobotModel (int robot)
+{
+  std::lock_guard<std::mutex> lock(models_mutex_);
+  auto it = models_.find(robot);
+  if (it == models_.end())
+    it = models_.emplace(robot, RobotModel(static_cast<RobotModel::Robot>(robot))).first;
+
+  return it->second;
+}
+
+HeightMap::Ptr
+PlanningServer::GetTerrain (int handle)
+{
+  std::lock_guard<std::mutex> lock(models_mutex_);
+  auto it = terrains_.find(handle);
+  if (it == terrains_.end()) {
+    if (handle < 0 || handle >= HeightMap::TERRAIN_COUNT)
+      throw std::runtime_error("unknown terrain " + std::to_string(handle) + "!");
+    auto terrain = HeightMap::MakeTerrain(static_cast<HeightMap::TerrainID>(handle));
+    it = terrains_.emplace(handle, terrain).first;
+  }
+
+  return it->second;
+}
+
+void
+PlanningServer::Stop ()
+{
+  stop_ = true;
+  Wake();
+}
+
+void
+PlanningServer::Wake () const
+{
+  char c = 0;
+  ssize_t n = write(wake_pipe_[1], &c, 1);
+  (void)n; // pipe full, Run() will wake up anyway
+}
+
+void
+PlanningServer::Run ()
+{
+  std::map<int, std::shared_ptr<Connection>> connections;
+
+  auto disconnect = [&](int fd) {
+    auto c = connections.at(fd);
+    std::lock_guard<std::mutex> lock(c->mutex_);
+    c->closed_ = true;
+    c->outbox_.clear();
+    close(c->fd_);
+    connections.erase(fd);
+  };
+
+  std::vector<pollfd> fds;
+  while (true) {
+    fds.clear();
+    fds.push_back({wake_pipe_[0], POLLIN, 0});
+    fds.push_back({listen_fd_, POLLIN, 0});
+    for (const auto& c : connections) {
+      std::lock_guard<std::mutex> lock(c.second->mutex_);
+      short events = c.second->outbox_.empty()? POLLIN : POLLIN | POLLOUT;
+      fds.push_back({c.first, events, 0});
+    }
+
+    if (poll(fds.data(), fds.size(), -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    if (fds.at(0).revents) {
+      char data[64];
+      while (read(wake_pipe_[0], data, sizeof(data)) > 0) {}
+      if (stop_)
+        break;
+    }
+
+    if (fds.at(1).revents & POLLIN) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd >= 0) {
+        auto c = std::make_shared<Connection>();
+        c->fd_ = fd;
+        connections[fd] = c;
+      }
+    }
+
+    for (std::size_t i=2; i<fds.size(); ++i) {
+      auto c = connections.at(fds.at(i).fd);
+      bool connected = true;
+      if (fds.at(i).revents & POLLOUT) {
+        std::lock_guard<std::mutex> lock(c->mutex_);
+        connected = SendQueued(*c);
+      }
+      if (connected && (fds.at(i).revents & ~POLLOUT))
+        connected = ReadRequests(c);
+      if (!connected)
+        disconnect(fds.at(i).fd);
+    }
+  }
+
+  while (!connections.empty())
+    disconnect(connections.begin()->first);
+  stop_ = false;
+}
+
+bool
+PlanningServer::ReadRequests (const std::shared_ptr<Connection>& c)
+{
+  char data[1<<14];
+  ssize_t n = recv(c->fd_, data, sizeof(data), MSG_DONTWAIT);
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+    return true;
+  if (n <= 0)
+    return false; // disconnected
+
+  auto& buffer = c->buffer_;
+  buffer.insert(buffer.end(), data, data+n);
+
+  std::size_t msg_size = sizeof(MessageHeader) + sizeof(PlanRequest);
+  std::size_t consumed = 0;
+  while (buffer.size() - consumed >= sizeof(MessageHeader)) {
+    MessageHeader header;
+    std::memcpy(&header, buffer.data()+consumed, sizeof(header));
+    if (header.magic_ != kMagic || header.version_ != kVersion ||
+        header.type_ != kPlanRequest || header.size_ != sizeof(PlanRequest))
+      return false; // not speaking our protocol
+
+    if (buffer.size() - consumed < msg_size)
+      break; // rest of the message not received yet
+
+    PlanRequest request;
+    std::memcpy(&request, buffer.data()+consumed+sizeof(header), sizeof(request));
+    consumed += msg_size;
+
+    if (!Enqueue(c, header.request_id_, request)) {
+      PlanReply reply;
+      std::memset(&reply, 0, sizeof(reply));
+      reply.status_ = kRejected;
+      Reply(*c, header.request_id_, reply, {});
+    }
+  }
+
+  buffer.erase(buffer.begin(), buffer.begin()+consumed);
+  return true;
+}
+
+bool
+PlanningServer::Enqueue (const std::shared_ptr<Connection>& connection,
+                         uint32_t request_id, const PlanRequest& request)
+{
+  if (request.robot_ < 0 || request.robot_ >= RobotModel::ROBOT_COUNT ||
+      request.gait_ < 0 || request.gait_ >= GaitGenerator::COMBO_COUNT ||
+      !(request.total_duration_ > 0.0))
+    return false;
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (jobs_.size() >= queue_capacity_)
+      return false;
+
+    Job job;
+    job.priority_   = request.priority_;
+    job.sequence_   = job_count_++;
+    job.connection_ = connection;
+    job.request_id_ = request_id;
+    job.request_    = request;
+    job.received_   = std::chrono::steady_clock::now();
+    jobs_.push(job);
+  }
+  job_added_.notify_one();
+  return true;
+}
+
+void
+PlanningServer::Work ()
+{
+  ifopt::Solver::Ptr solver = solver_factory_();
+
+  using Key = std::tuple<int, int, int, double, uint32_t>;
+  std::map<Key, WarmProblem> warm;
+
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      job_added_.wait(lock, [this]{ return stop_workers_ || !jobs_.empty(); });
+      if (stop_workers_)
+        return;
+
+      job = jobs_.top();
+      jobs_.pop();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(job.connection_->mutex_);
+      if (job.connection_->closed_)
+        continue; // nobody waiting for the answer
+    }
+
+    const PlanRequest& r = job.request_;
+    auto start = std::chrono::steady_clock::now();
+
+    PlanReply reply;
+    std::memset(&reply, 0, sizeof(reply));
+    reply.queue_time_ = std::chrono::duration<double>(start - job.received_).count();
+
+    std::vector<char> trajectory;
+    try {
+      Key key(r.robot_, r.terrain_, r.gait_, r.total_duration_, r.flags_);
+      auto it = warm.find(key);
+      if (it == warm.end()) {
+        if (warm.size() >= kMaxWarmProblems)
+          warm.clear();
+        WarmProblem w;
+        w.formulation_ = GetFormulation(r, GetRobotModel(r.robot_), GetTerrain(r.terrain_));
+        it = warm.emplace(key, w).first;
+      } else {
+        SetStartAndGoal(r, it->second.formulation_);
+      }
+      WarmProblem& w = it->second;
+      NlpFormulation& formulation = w.formulation_;
+
+      SolutionCache::Problem problem;
+      if (cache_) {
+        problem = SolutionCache::GetProblem(r.robot_, r.terrain_, GetTerrainVersion(r.terrain_),
+                                            r.gait_, r.flags_, formulation);
+        auto hit = cache_->Find(problem);
+        if (hit) {
+          reply.status_      = kFinished;
+          reply.is_feasible_ = 1;
+          SharedTrajectoryWriter::Serialize(*hit, trajectory);
+          Reply(*job.connection_, job.request_id_, reply, trajectory);
+          continue;
+        }
+        formulation.initial_guess_ = cache_->FindNearest(problem);
+      }
+
+      if (!w.variables_.empty()) {
+        formulation.ResetVariables(w.variables_, w.splines_);
+      } else {
+        w.variables_   = formulation.GetVariableSets(w.splines_);
+        w.constraints_ = formulation.GetConstraints(w.splines_);
+        w.costs_       = formulation.GetCosts();
+      }
+      formulation.initial_guess_.reset();
+
+      // a new problem each time, the solver keeps every iterate in it.
+      ifopt::Problem nlp;
+      for (auto c : w.variables_)
+        nlp.AddVariableSet(c);
+      for (auto c : w.constraints_)
+        nlp.AddConstraintSet(c);
+      for (auto c : w.costs_)
+        nlp.AddCostSet(c);
+
+      double max_time = r.max_solve_time_ > 0.0? r.max_solve_time_ : max_solve_time_;
+      SolveResult result = SolveInterruptible(*solver, nlp, shutdown_, max_time);
+
+      reply.status_               = result.status_;
+      reply.is_feasible_          = result.is_feasible_;
+      reply.constraint_violation_ = result.constraint_violation_;
+      reply.iteration_count_      = result.iteration_count_;
+
+      auto solved = std::make_shared<const Trajectory>(w.splines_);
+      SharedTrajectoryWriter::Serialize(*solved, trajectory);
+      if (cache_ && result.status_ == SolveResult::Finished && result.is_feasible_)
+        cache_->Insert(problem, solved);
+    } catch (const std::exception& e) {
+      reply.status_ = kFailed;
+      trajectory.clear();
+      warm.clear(); // may be half built
+    }
+
+    reply.solve_time_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    Reply(*job.connection_, job.request_id_, reply, trajectory);
+  }
+}
+
+void
+PlanningServer::Reply (Connection& c, uint32_t request_id,
+                       const PlanReply& reply,
+                       const std::vector<char>& trajectory) const
+{
+  PlanReply r = reply;
+  r.trajectory_size_ = trajectory.size();
+
+  MessageHeader header;
+  header.magic_      = kMagic;
+  header.version_    = kVersion;
+  header.type_       = kPlanReply;
+  header.request_id_ = request_id;
+  header.size_       = sizeof(r) + trajectory.size();
+
+  std::vector<char> msg(sizeof(header) + header.size_);
+  std::memcpy(msg.data(), &header, sizeof(header));
+  std::memcpy(msg.data()+sizeof(header), &r, sizeof(r));
+  std::copy(trajectory.begin(), trajectory.end(), msg.begin()+sizeof(header)+sizeof(r));
+
+  std::lock_guard<std::mutex> lock(c.mutex_);
+  if (c.closed_)
+    return;
+
+  c.outbox_.insert(c.outbox_.end(), msg.begin(), msg.end());
+  if (SendQueued(c) && !c.outbox_.empty())
+    Wake(); // so Run() sends the rest once the socket accepts it
+}
+
+bool
+PlanningServer::SendQueued (Connection& c)
+{
+  std::size_t sent = 0;
+  bool connected = true;
+  while (sent < c.outbox_.size()) {
+    ssize_t n = send(c.fd_, c.outbox_.data()+sent, c.outbox_.size()-sent,
+                     MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break; // socket buffer full
+    if (n <= 0) {
+      connected = false; // client gone, Run() will notice
+      break;
+    }
+    sent += n;
+  }
+
+  c.outbox_.erase(c.outbox_.begin(), c.outbox_.begin()+sent);
+  return connected;
+}
+
+} /* namespace towr */
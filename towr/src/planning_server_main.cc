@@ -0,0 +1,110 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <ifopt/ipopt_solver.h>
+
+#include <towr/planning/planning_server.h>
+
+static towr::PlanningServer* server = nullptr;
+
+static void
+StopServer (int)
+{
+  if (server)
+    server->Stop();
+}
+
+/**
+ * Runs a planning server until interrupted (Ctrl+C):
+ *
+ *   towr-planning-server <socket> [workers, default one per core]
+ *                        [max solve time, default 10s] [solution cache file]
+ *                        [linear solver, default ma57]
+ *
+ * The workers solve concurrently, which requires a re-entrant linear
+ * solver (see BatchPlanner). With mumps or ma27 a single worker is used.
+ *
+ * If a cache file is given, solutions are loaded from it on start (if it
+ * exists) and all solutions are saved to it on exit. Requests can be sent
+ * e.g. with towr-planning-load.
+ */
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <socket> [workers] [max_solve_time] [cache] [linear_solver]" << std::endl;
+    return 1;
+  }
+
+  int workers           = argc > 2? std::stoi(argv[2]) : 0;
+  double max_solve_time = argc > 3? std::stod(argv[3]) : 10.0;
+  std::string cache_file = argc > 4? argv[4] : "";
+  std::string linear_solver = argc > 5? argv[5] : "ma57";
+
+  if ((linear_solver == "mumps" || linear_solver == "ma27") && workers != 1) {
+    std::cout << linear_solver << " isn't re-entrant, using a single worker" << std::endl;
+    workers = 1;
+  }
+
+  auto solver_factory = [linear_solver]() {
+    auto solver = std::make_shared<ifopt::IpoptSolver>();
+    solver->SetOption("linear_solver", linear_solver);
+    solver->SetOption("jacobian_approximation", "exact");
+    solver->SetOption("print_level", 0);
+    solver->SetOption("print_timing_statistics", "no");
+    return solver;
+  };
+
+  towr::PlanningServer s(argv[1], solver_factory, workers, max_solve_time);
+  server = &s;
+
+  auto cache = std::make_shared<towr::SolutionCache>();
+  if (!cache_file.empty()) {
+    if (std::ifstream(cache_file).good())
+      cache->Load(cache_file);
+    std::cout << "Loaded " << cache->GetSize() << " cached solutions" << std::endl;
+    s.SetSolutionCache(cache);
+  }
+
+  std::signal(SIGINT, StopServer);
+  std::signal(SIGTERM, StopServer);
+
+  std::cout << "Serving plans on " << argv[1] << std::endl;
+  s.Run();
+  server = nullptr;
+
+  if (!cache_file.empty())
+    cache->Save(cache_file);
+
+  return 0;
+}
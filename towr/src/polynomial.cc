@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <cassert>
 #include <cmath>
+#include <stdexcept>
 
 
 namespace towr {
@@ -73,10 +74,10 @@ Polynomial::GetDerivativeWrtCoeff (double t, Dx deriv, Coefficients c) const
 
 
 
-CubicHermitePolynomial::CubicHermitePolynomial (int dim)
-    : Polynomial(3,dim),
-      n0_(dim),
-      n1_(dim)
+CubicHermitePolynomial::CubicHermitePolynomial (int dim, int n_node_derivatives)
+    : Polynomial(2*n_node_derivatives-1, dim),
+      n0_(dim, n_node_derivatives),
+      n1_(dim, n_node_derivatives)
 {
   T_ = 0.0;
 }
@@ -97,6 +98,17 @@ CubicHermitePolynomial::SetDuration(double duration)
 void
 CubicHermitePolynomial::UpdateCoeff()
 {
+  if (IsQuintic()) {
+    const Node* n[2] = {&n0_, &n1_};
+    for (int c=A; c<=F; ++c) {
+      coeff_[c].setZero();
+      for (int j=0; j<6; ++j)
+        coeff_[c] += GetQuinticCoeffWrtNode(static_cast<Coefficients>(c), j)
+                     * n[j/3]->at(static_cast<Dx>(j%3));
+    }
+    return;
+  }
+
   coeff_[A] =  n0_.p();
   coeff_[B] =  n0_.v();
   coeff_[C] = -( 3*(n0_.p() - n1_.p()) +  T_*(2*n0_.v() + n1_.v()) ) / std::pow(T_,2);
@@ -108,6 +120,9 @@ CubicHermitePolynomial::GetDerivativeWrtStartNode (Dx dfdt,
                                                    Dx node_derivative, // pos or velocity node
                                                    double t_local) const
 {
+  if (IsQuintic())
+    return GetQuinticDerivativeWrtNode(dfdt, node_derivative, t_local);
+
   switch (dfdt) {
     case kPos:
       return GetDerivativeOfPosWrtStartNode(node_derivative, t_local);
@@ -125,6 +140,9 @@ CubicHermitePolynomial::GetDerivativeWrtEndNode (Dx dfdt,
                                                  Dx node_derivative, // pos or velocity node
                                                  double t_local) const
 {
+  if (IsQuintic())
+    return GetQuinticDerivativeWrtNode(dfdt, 3+node_derivative, t_local);
+
   switch (dfdt) {
     case kPos:
       return GetDerivativeOfPosWrtEndNode(node_derivative, t_local);
@@ -236,6 +254,9 @@ CubicHermitePolynomial::GetDerivativeOfAccWrtEndNode (Dx node_value,
 Eigen::VectorXd
 CubicHermitePolynomial::GetDerivativeOfPosWrtDuration(double t) const
 {
+  if (IsQuintic())
+    throw std::runtime_error("duration derivatives only implemented for cubic polynomials!");
+
   VectorXd x0 = n0_.p();
   VectorXd x1 = n1_.p();
   VectorXd v0 = n0_.v();
@@ -256,4 +277,40 @@ CubicHermitePolynomial::GetDerivativeOfPosWrtDuration(double t) const
   return deriv;
 }
 
+double
+CubicHermitePolynomial::GetQuinticCoeffWrtNode (Coefficients c, int node_value) const
+{
+  double T  = T_;
+  double T2 = std::pow(T_,2);
+  double T3 = std::pow(T_,3);
+  double T4 = std::pow(T_,4);
+  double T5 = std::pow(T_,5);
+
+  // columns: start pos, vel, acc, end pos, vel, acc
+  static const int n = 6;
+  double coeff[n][n] = {
+      {      1.0,      0.0,        0.0,      0.0,      0.0,       0.0}, // A
+      {      0.0,      1.0,        0.0,      0.0,      0.0,       0.0}, // B
+      {      0.0,      0.0,        0.5,      0.0,      0.0,       0.0}, // C
+      { -10.0/T3,  -6.0/T2,   -1.5/T,   10.0/T3,  -4.0/T2,   0.5/T  }, // D
+      {  15.0/T4,   8.0/T3,    1.5/T2, -15.0/T4,   7.0/T3,  -1.0/T2 }, // E
+      {  -6.0/T5,  -3.0/T4,   -0.5/T3,   6.0/T5,  -3.0/T4,   0.5/T3 }, // F
+  };
+
+  return coeff[c][node_value];
+}
+
+double
+CubicHermitePolynomial::GetQuinticDerivativeWrtNode (Dx dfdt, int node_value,
+                                                     double t) const
+{
+  double deriv = 0.0;
+  for (int c=A; c<=F; ++c) {
+    auto coeff = static_cast<Coefficients>(c);
+    deriv += GetQuinticCoeffWrtNode(coeff, node_value)*GetDerivativeWrtCoeff(t, dfdt, coeff);
+  }
+
+  return deriv;
+}
+
 } // namespace towr
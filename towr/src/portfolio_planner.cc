@@ -0,0 +1,200 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/planning/portfolio_planner.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+#include <ifopt/problem.h>
+
+#include <towr/initialization/gait_generator.h>
+
+namespace towr {
+
+PortfolioPlanner::PortfolioPlanner (double deadline, bool first_feasible,
+                                    int thread_count)
+    : deadline_(deadline),
+      first_feasible_(first_feasible)
+{
+  thread_count_ = thread_count > 0? thread_count : std::thread::hardware_concurrency();
+  thread_count_ = std::max(1, thread_count_);
+}
+
+int
+PortfolioPlanner::GetThreadCount () const
+{
+  return thread_count_;
+}
+
+std::vector<PortfolioPlanner::Variant>
+PortfolioPlanner::MakeGaitVariants (const NlpFormulation& formulation,
+                                    const BatchPlanner::SolverFactory& solver_factory)
+{
+  auto durations = formulation.params_.ee_phase_durations_;
+  if (durations.empty())
+    throw std::runtime_error("formulation has no phase durations to replace!");
+  double total_duration = std::accumulate(durations.front().begin(),
+                                          durations.front().end(), 0.0);
+
+  int n_ee = formulation.model_.kinematic_model_->GetNumberOfEndeffectors();
+  auto gait_gen = GaitGenerator::MakeGaitGenerator(n_ee);
+
+  std::vector<Variant> variants;
+  for (int c=GaitGenerator::C0; c<GaitGenerator::COMBO_COUNT; ++c) {
+    gait_gen->SetCombo(static_cast<GaitGenerator::Combos>(c));
+
+    Variant v;
+    v.name_ = "C" + std::to_string(c);
+    v.formulation_ = formulation;
+    v.formulation_.params_.ee_phase_durations_.clear();
+    v.formulation_.params_.ee_in_contact_at_start_.clear();
+    for (int ee=0; ee<n_ee; ++ee) {
+      v.formulation_.params_.ee_phase_durations_.push_back(gait_gen->GetPhaseDurations(total_duration, ee));
+      v.formulation_.params_.ee_in_contact_at_start_.push_back(gait_gen->IsInContactAtStart(ee));
+    }
+    v.solver_factory_ = solver_factory;
+    variants.push_back(v);
+  }
+
+  return variants;
+}
+
+// true if a is the better solution: feasible before infeasible, then the
+// lower cost if feasible, or the lower constraint violation if not.
+static bool
+IsBetter (const PortfolioPlanner::Outcome& a, const PortfolioPlanner::Outcome& b)
+{
+  if (!a.error_.empty())
+    return false;
+  if (!b.error_.empty())
+    return true;
+  if (a.result_.is_feasible_ != b.result_.is_feasible_)
+    return a.result_.is_feasible_;
+  if (a.result_.is_feasible_)
+    return a.cost_ < b.cost_;
+  return a.result_.constraint_violation_ < b.result_.constraint_violation_;
+}
+
+PortfolioPlanner::Result
+PortfolioPlanner::Solve (const std::vector<Variant>& variants) const
+{
+  int n_variants = variants.size();
+
+  Result result;
+  result.outcomes_.resize(n_variants);
+  std::vector<Trajectory> trajectories(n_variants);
+
+  CancellationToken token;
+  std::mutex mutex;
+  int first_feasible = -1;
+  std::atomic<int> next_variant(0);
+  auto start_all = std::chrono::steady_clock::now();
+
+  // the variants race against each other, so each thread takes the next one
+  // as soon as it's free; only the number of threads is limited.
+  auto work = [&]() {
+    int i;
+    while ((i = next_variant++) < n_variants) {
+      const Variant& v = variants.at(i);
+      Outcome& o = result.outcomes_.at(i);
+
+      if (token.IsCancelled()) {
+        o.result_.status_ = SolveResult::Cancelled;
+        o.result_.constraint_violation_ = std::numeric_limits<double>::infinity();
+        continue;
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      try {
+        NlpFormulation formulation = v.formulation_;
+        SplineHolder solution;
+        ifopt::Problem nlp;
+        for (auto c : formulation.GetVariableSets(solution))
+          nlp.AddVariableSet(c);
+        for (auto c : formulation.GetConstraints(solution))
+          nlp.AddConstraintSet(c);
+        for (auto c : formulation.GetCosts())
+          nlp.AddCostSet(c);
+
+        // the deadline is shared by all variants, also the ones that waited.
+        double elapsed = std::chrono::duration<double>(start - start_all).count();
+        ifopt::Solver::Ptr solver = v.solver_factory_();
+        o.result_ = SolveInterruptible(*solver, nlp, token, deadline_ - elapsed);
+        Eigen::VectorXd x = nlp.GetVariableValues();
+        o.cost_ = nlp.EvaluateCostFunction(x.data());
+        trajectories.at(i) = Trajectory(solution);
+      } catch (const std::exception& e) {
+        o.error_ = e.what();
+      }
+      o.solve_time_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      bool is_acceptable = o.error_.empty() && o.result_.is_feasible_
+                           && o.result_.status_ == SolveResult::Finished;
+      if (first_feasible_ && is_acceptable) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (first_feasible < 0) {
+          first_feasible = i;
+          token.Cancel(); // all other variants stop with their next callback.
+        }
+      }
+    }
+  };
+
+  int n_threads = std::min(thread_count_, std::max(1, n_variants));
+  std::vector<std::thread> workers;
+  for (int t=1; t<n_threads; ++t)
+    workers.emplace_back(work);
+  work();
+
+  for (auto& w : workers)
+    w.join();
+
+  result.variant_ = first_feasible;
+  if (result.variant_ < 0) {
+    for (int i=0; i<n_variants; ++i) {
+      if (result.variant_ < 0 || IsBetter(result.outcomes_.at(i), result.outcomes_.at(result.variant_)))
+        result.variant_ = i;
+    }
+    if (result.variant_ >= 0 && !result.outcomes_.at(result.variant_).error_.empty())
+      result.variant_ = -1; // every variant failed.
+  }
+
+  if (result.variant_ >= 0)
+    result.trajectory_ = trajectories.at(result.variant_);
+
+  return result;
+}
+
+} /* namespace towr */
@@ -39,7 +39,7 @@ RangeOfMotionConstraint::RangeOfMotionConstraint (const KinematicModel::Ptr& mod
     :TimeDiscretizationConstraint(T, dt, "rangeofmotion-" + std::to_string(ee))
 {
   base_linear_  = spline_holder.base_linear_;
-  base_angular_ = EulerConverter(spline_holder.base_angular_);
+  base_kinematics_ = spline_holder.base_kinematics_;
   ee_motion_    = spline_holder.ee_motion_.at(ee);
 
   max_deviation_from_nominal_ = model->GetMaximumDeviationFromNominal();
@@ -58,12 +58,11 @@ RangeOfMotionConstraint::GetRow (int node, int dim) const
 void
 RangeOfMotionConstraint::UpdateConstraintAtInstance (double t, int k, VectorXd& g) const
 {
-  Vector3d base_W  = base_linear_->GetPoint(t).p();
+  const BaseKinematics& base = base_kinematics_->GetBaseKinematics(t);
   Vector3d pos_ee_W = ee_motion_->GetPoint(t).p();
-  EulerConverter::MatrixSXd b_R_w = base_angular_.GetRotationMatrixBaseToWorld(t).transpose();
 
-  Vector3d vector_base_to_ee_W = pos_ee_W - base_W;
-  Vector3d vector_base_to_ee_B = b_R_w*(vector_base_to_ee_W);
+  Vector3d vector_base_to_ee_W = pos_ee_W - base.lin_.p();
+  Vector3d vector_base_to_ee_B = base.b_R_w_*(vector_base_to_ee_W);
 
   g.middleRows(GetRow(k, X), k3D) = vector_base_to_ee_B;
 }
@@ -85,7 +84,8 @@ RangeOfMotionConstraint::UpdateJacobianAtInstance (double t, int k,
                                                    std::string var_set,
                                                    Jacobian& jac) const
 {
-  EulerConverter::MatrixSXd b_R_w = base_angular_.GetRotationMatrixBaseToWorld(t).transpose();
+  const BaseKinematics& base = base_kinematics_->GetBaseKinematics(t);
+  const EulerConverter::MatrixSXd& b_R_w = base.b_R_w_;
   int row_start = GetRow(k,X);
 
   if (var_set == id::base_lin_nodes) {
@@ -93,13 +93,12 @@ RangeOfMotionConstraint::UpdateJacobianAtInstance (double t, int k,
   }
 
   if (var_set == id::base_ang_nodes) {
-    Vector3d base_W   = base_linear_->GetPoint(t).p();
     Vector3d ee_pos_W = ee_motion_->GetPoint(t).p();
-    Vector3d r_W = ee_pos_W - base_W;
-    jac.middleRows(row_start, k3D) = base_angular_.DerivOfRotVecMult(t,r_W, true);
+    Vector3d r_W = ee_pos_W - base.lin_.p();
+    jac.middleRows(row_start, k3D) = base_kinematics_->DerivOfRotVecMult(t,r_W, true);
   }
 
-  if (var_set == id::EEMotionNodes(ee_)) {
+  if (var_set == ee_motion_->GetNodeVariablesName()) {
     jac.middleRows(row_start, k3D) = b_R_w*ee_motion_->GetJacobianWrtNodes(t,kPos);
   }
 
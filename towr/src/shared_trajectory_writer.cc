@@ -0,0 +1,195 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/io/shared_trajectory_writer.h>
+
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace towr {
+
+SharedTrajectoryWriter::SharedTrajectoryWriter (const std::string& name,
+                                                uint32_t slot_count,
+                                                uint32_t slot_size)
+    : name_(name)
+{
+  slot_size = (slot_size+7)/8*8; // keeps all slots 8-byte aligned
+  region_size_ = shm::GetSlotOffset(slot_count, slot_size);
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+  if (fd < 0)
+    throw std::runtime_error("shared memory " + name + " can't be opened!");
+
+  if (ftruncate(fd, region_size_) != 0) {
+    close(fd);
+    throw std::runtime_error("shared memory " + name + " can't be resized!");
+  }
+
+  void* addr = mmap(nullptr, region_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED)
+    throw std::runtime_error("shared memory " + name + " can't be mapped!");
+  region_ = static_cast<char*>(addr);
+
+  // readers only accept the region once the magic number is written last
+  auto header = reinterpret_cast<shm::RegionHeader*>(region_);
+  header->magic_ = 0;
+  header->version_    = shm::kVersion;
+  header->slot_count_ = slot_count;
+  header->slot_size_  = slot_size;
+  new (&header->latest_) std::atomic<uint64_t>(0);
+
+  for (uint32_t s=0; s<slot_count; ++s) {
+    auto slot = reinterpret_cast<shm::SlotHeader*>(region_ + shm::GetSlotOffset(s, slot_size));
+    new (&slot->sequence_) std::atomic<uint64_t>(0);
+    slot->write_id_ = 0;
+    slot->payload_size_ = 0;
+  }
+
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic_ = shm::kMagic;
+}
+
+SharedTrajectoryWriter::~SharedTrajectoryWriter ()
+{
+  munmap(region_, region_size_);
+  shm_unlink(name_.c_str());
+}
+
+uint64_t
+SharedTrajectoryWriter::Write (const Trajectory& trajectory)
+{
+  auto header = reinterpret_cast<shm::RegionHeader*>(region_);
+
+  Serialize(trajectory, payload_);
+  if (sizeof(shm::SlotHeader) + payload_.size() > header->slot_size_)
+    return 0;
+
+  uint64_t id = ++write_count_;
+  uint32_t slot_id = (id-1) % header->slot_count_;
+  char* slot = region_ + shm::GetSlotOffset(slot_id, header->slot_size_);
+  auto slot_header = reinterpret_cast<shm::SlotHeader*>(slot);
+
+  // sequence lock: odd while writing, so readers can detect torn reads
+  uint64_t seq = slot_header->sequence_.load(std::memory_order_relaxed);
+  slot_header->sequence_.store(seq+1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  slot_header->write_id_     = id;
+  slot_header->payload_size_ = payload_.size();
+  std::memcpy(slot + sizeof(shm::SlotHeader), payload_.data(), payload_.size());
+
+  slot_header->sequence_.store(seq+2, std::memory_order_release);
+  header->latest_.store(id, std::memory_order_release);
+
+  return id;
+}
+
+static void
+AppendBytes (std::vector<char>& buffer, const void* data, std::size_t n_bytes)
+{
+  const char* bytes = static_cast<const char*>(data);
+  buffer.insert(buffer.end(), bytes, bytes + n_bytes);
+}
+
+static void
+AppendSpline (std::vector<char>& buffer, const CubicHermiteSpline& spline)
+{
+  const auto& t = spline.GetKnotTimes();
+
+  shm::SplineBlockHeader h;
+  h.segment_count_ = spline.GetKnotCount()-1;
+  h.dim_ = spline.GetDim();
+  h.coeff_count_ = spline.IsQuintic()? 6 : 4;
+  h.reserved_ = 0;
+  AppendBytes(buffer, &h, sizeof(h));
+  AppendBytes(buffer, t.data(), t.size()*sizeof(double));
+
+  // column-major, so all dimensions of one coefficient are consecutive
+  for (int k=0; k<h.segment_count_; ++k) {
+    Eigen::MatrixXd coeff = spline.GetSegmentCoefficients(k);
+    AppendBytes(buffer, coeff.data(), coeff.size()*sizeof(double));
+  }
+}
+
+static void
+AppendContacts (std::vector<char>& buffer,
+                const std::vector<double>& phase_durations,
+                bool in_contact_at_start)
+{
+  shm::ContactBlockHeader h;
+  h.phase_count_ = phase_durations.size();
+  h.in_contact_at_start_ = in_contact_at_start;
+  AppendBytes(buffer, &h, sizeof(h));
+
+  double t_end = 0.0;
+  for (double d : phase_durations) {
+    t_end += d;
+    AppendBytes(buffer, &t_end, sizeof(t_end));
+  }
+}
+
+void
+SharedTrajectoryWriter::Serialize (const Trajectory& trajectory,
+                                   std::vector<char>& payload)
+{
+  uint32_t n_ee = trajectory.GetEECount();
+
+  shm::PayloadHeader h;
+  h.total_time_  = trajectory.GetTotalTime();
+  h.ee_count_    = n_ee;
+  h.block_count_ = 2 + 3*n_ee;
+
+  payload.clear();
+  AppendBytes(payload, &h, sizeof(h));
+  std::size_t offsets_start = payload.size();
+  payload.resize(offsets_start + h.block_count_*sizeof(uint64_t));
+
+  std::vector<uint64_t> offsets;
+  auto start_block = [&]() { offsets.push_back(payload.size()); };
+
+  start_block(); AppendSpline(payload, trajectory.base_linear_);
+  start_block(); AppendSpline(payload, trajectory.base_angular_);
+  for (const auto& s : trajectory.ee_motion_) {
+    start_block(); AppendSpline(payload, s);
+  }
+  for (const auto& s : trajectory.ee_force_) {
+    start_block(); AppendSpline(payload, s);
+  }
+  for (int ee=0; ee<n_ee; ++ee) {
+    start_block();
+    AppendContacts(payload, trajectory.ee_phase_durations_.at(ee),
+                   trajectory.ee_in_contact_at_start_.at(ee));
+  }
+
+  std::memcpy(payload.data() + offsets_start, offsets.data(), offsets.size()*sizeof(uint64_t));
+}
+
+} /* namespace towr */
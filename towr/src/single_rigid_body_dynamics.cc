@@ -28,6 +28,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ******************************************************************************/
 
 #include <towr/models/single_rigid_body_dynamics.h>
+#include <towr/models/single_rigid_body_kernels.h>
 #include <towr/variables/cartesian_dimensions.h>
 
 namespace towr {
@@ -71,11 +72,22 @@ SingleRigidBodyDynamics::SingleRigidBodyDynamics (double mass, const Eigen::Matr
     :DynamicModel(mass, ee_count)
 {
   I_b = inertia_b.sparseView();
+  I_b_dense = inertia_b;
+  I_b_rows  = inertia_b;
+}
+
+SingleRigidBodyDynamics::Ptr
+SingleRigidBodyDynamics::Clone () const
+{
+  return std::make_shared<SingleRigidBodyDynamics>(*this);
 }
 
 SingleRigidBodyDynamics::BaseAcc
 SingleRigidBodyDynamics::GetDynamicViolation () const
 {
+  if (kernels_ == GeneratedKernels)
+    return GetDynamicViolationGenerated();
+
   // https://en.wikipedia.org/wiki/Newton%E2%80%93Euler_equations
 
   Vector3d f_sum, tau_sum;
@@ -88,11 +100,11 @@ SingleRigidBodyDynamics::GetDynamicViolation () const
   }
 
   // express inertia matrix in world frame based on current body orientation
-  Jac I_w = w_R_b_.sparseView() * I_b * w_R_b_.transpose().sparseView();
+  Eigen::Matrix3d I_w = w_R_b_ * I_b_dense * w_R_b_.transpose();
 
   BaseAcc acc;
   acc.segment(AX, k3D) = I_w*omega_dot_
-                         + Cross(omega_)*(I_w*omega_)
+                         + omega_.cross(I_w*omega_)
                          - tau_sum;
   acc.segment(LX, k3D) = m()*com_acc_
                          - f_sum
@@ -104,6 +116,9 @@ SingleRigidBodyDynamics::Jac
 SingleRigidBodyDynamics::GetJacobianWrtBaseLin (const Jac& jac_pos_base_lin,
                                         const Jac& jac_acc_base_lin) const
 {
+  if (kernels_ == GeneratedKernels)
+    return GetJacobianWrtBaseLinGenerated(jac_pos_base_lin, jac_acc_base_lin);
+
   // build the com jacobian
   int n = jac_pos_base_lin.cols();
 
@@ -124,6 +139,9 @@ SingleRigidBodyDynamics::Jac
 SingleRigidBodyDynamics::GetJacobianWrtBaseAng (const EulerConverter& base_euler,
                                         double t) const
 {
+  if (kernels_ == GeneratedKernels)
+    return GetJacobianWrtBaseAngGenerated(base_euler, t);
+
   Jac I_w = w_R_b_.sparseView() * I_b * w_R_b_.transpose().sparseView();
 
   // Derivative of R*I_b*R^T * wd
@@ -167,6 +185,9 @@ SingleRigidBodyDynamics::GetJacobianWrtBaseAng (const EulerConverter& base_euler
 SingleRigidBodyDynamics::Jac
 SingleRigidBodyDynamics::GetJacobianWrtForce (const Jac& jac_force, EE ee) const
 {
+  if (kernels_ == GeneratedKernels)
+    return GetJacobianWrtForceGenerated(jac_force, ee);
+
   Vector3d r = com_pos_ - ee_pos_.at(ee);
   Jac jac_tau = -Cross(r)*jac_force;
 
@@ -181,6 +202,9 @@ SingleRigidBodyDynamics::GetJacobianWrtForce (const Jac& jac_force, EE ee) const
 SingleRigidBodyDynamics::Jac
 SingleRigidBodyDynamics::GetJacobianWrtEEPos (const Jac& jac_ee_pos, EE ee) const
 {
+  if (kernels_ == GeneratedKernels)
+    return GetJacobianWrtEEPosGenerated(jac_ee_pos, ee);
+
   Vector3d f = ee_force_.at(ee);
   Jac jac_tau = Cross(f)*(-jac_ee_pos);
 
@@ -191,4 +215,101 @@ SingleRigidBodyDynamics::GetJacobianWrtEEPos (const Jac& jac_ee_pos, EE ee) cons
   return jac;
 }
 
+// The generated kernels only provide the partial derivatives w.r.t. the
+// physical quantities, the chain rule to the variables is applied here.
+template<int Rows>
+static SingleRigidBodyDynamics::Jac
+Times (const double* d, const SingleRigidBodyDynamics::Jac& jac)
+{
+  Eigen::Map<const Eigen::Matrix<double, Rows, k3D, Eigen::RowMajor>> D(d);
+  return SingleRigidBodyDynamics::Jac(D.sparseView())*jac;
+}
+
+SingleRigidBodyDynamics::BaseAcc
+SingleRigidBodyDynamics::GetDynamicViolationGenerated () const
+{
+  Matrix3dRows w_R_b = w_R_b_;
+
+  BaseAcc acc, contact;
+  srbd_kernels::BaseViolation(m(), g(), I_b_rows.data(), w_R_b.data(),
+                              omega_.data(), omega_dot_.data(),
+                              com_acc_.data(), acc.data());
+
+  for (int ee=0; ee<ee_pos_.size(); ++ee) {
+    srbd_kernels::ContactViolation(com_pos_.data(), ee_pos_.at(ee).data(),
+                                   ee_force_.at(ee).data(), contact.data());
+    acc += contact;
+  }
+
+  return acc;
+}
+
+SingleRigidBodyDynamics::Jac
+SingleRigidBodyDynamics::GetJacobianWrtBaseLinGenerated (const Jac& jac_pos_base_lin,
+                                                 const Jac& jac_acc_base_lin) const
+{
+  Matrix3dRows d_com_sum = Matrix3dRows::Zero();
+  Matrix3dRows d_com, d_acc;
+  for (const Vector3d& f : ee_force_) {
+    srbd_kernels::ContactJacobianWrtCom(f.data(), d_com.data());
+    d_com_sum += d_com;
+  }
+  srbd_kernels::BaseJacobianWrtLinAcc(m(), d_acc.data());
+
+  Jac jac(k6D, jac_pos_base_lin.cols());
+  jac.middleRows(AX, k3D) = Times<k3D>(d_com_sum.data(), jac_pos_base_lin);
+  jac.middleRows(LX, k3D) = Times<k3D>(d_acc.data(), jac_acc_base_lin);
+
+  return jac;
+}
+
+SingleRigidBodyDynamics::Jac
+SingleRigidBodyDynamics::GetJacobianWrtBaseAngGenerated (const EulerConverter& base_euler,
+                                                 double t) const
+{
+  Matrix3dRows w_R_b = w_R_b_;
+  Eigen::Matrix<double, k3D, 9, Eigen::RowMajor> d_R;
+  Matrix3dRows d_w, d_wd;
+  srbd_kernels::BaseJacobianWrtAng(I_b_rows.data(), w_R_b.data(),
+                                   omega_.data(), omega_dot_.data(),
+                                   d_R.data(), d_w.data(), d_wd.data());
+
+  Jac jac_ang_vel = base_euler.GetDerivOfAngVelWrtEulerNodes(t);
+  Jac jac_ang_acc = base_euler.GetDerivOfAngAccWrtEulerNodes(t);
+  Jac jac_ang = Times<k3D>(d_w.data(),  jac_ang_vel)
+              + Times<k3D>(d_wd.data(), jac_ang_acc);
+
+  // sensitivity through the rotation matrix, element by element
+  EulerConverter::JacRowMatrix Rd = base_euler.GetDerivativeOfRotationMatrixWrtNodes(t);
+  for (int row : {X,Y,Z})
+    for (int i : {X,Y,Z})
+      for (int j : {X,Y,Z})
+        jac_ang.row(row) += d_R(row, 3*i+j)*Rd.at(i).at(j);
+
+  Jac jac(k6D, jac_ang.cols());
+  jac.middleRows(AX, k3D) = jac_ang;
+
+  return jac;
+}
+
+SingleRigidBodyDynamics::Jac
+SingleRigidBodyDynamics::GetJacobianWrtForceGenerated (const Jac& jac_force, EE ee) const
+{
+  Eigen::Matrix<double, k6D, k3D, Eigen::RowMajor> d_f;
+  srbd_kernels::ContactJacobianWrtForce(com_pos_.data(), ee_pos_.at(ee).data(),
+                                        d_f.data());
+  return Times<k6D>(d_f.data(), jac_force);
+}
+
+SingleRigidBodyDynamics::Jac
+SingleRigidBodyDynamics::GetJacobianWrtEEPosGenerated (const Jac& jac_ee_pos, EE ee) const
+{
+  Matrix3dRows d_p;
+  srbd_kernels::ContactJacobianWrtPos(ee_force_.at(ee).data(), d_p.data());
+
+  Jac jac(k6D, jac_ee_pos.cols());
+  jac.middleRows(AX, k3D) = Times<k3D>(d_p.data(), jac_ee_pos);
+  return jac;
+}
+
 } /* namespace towr */
@@ -0,0 +1,326 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+// Generated by scripts/generate_srbd_kernels.py, do not edit.
+
+#include <towr/models/single_rigid_body_kernels.h>
+
+namespace towr {
+namespace srbd_kernels {
+
+/** @brief Base part of the 6D violation (angular, linear). */
+void
+BaseViolation (double m, double g, const double* I_b, const double* w_R_b,
+               const double* w, const double* wd, const double* acc,
+               double* out)
+{
+  const double x0 = I_b[0]*w_R_b[0] + I_b[3]*w_R_b[1] + I_b[6]*w_R_b[2];
+  const double x1 = I_b[1]*w_R_b[0] + I_b[4]*w_R_b[1] + I_b[7]*w_R_b[2];
+  const double x2 = I_b[2]*w_R_b[0] + I_b[5]*w_R_b[1] + I_b[8]*w_R_b[2];
+  const double x3 = w_R_b[0]*x0 + w_R_b[1]*x1 + w_R_b[2]*x2;
+  const double x4 = w_R_b[3]*x0 + w_R_b[4]*x1 + w_R_b[5]*x2;
+  const double x5 = w_R_b[6]*x0 + w_R_b[7]*x1 + w_R_b[8]*x2;
+  const double x6 = I_b[0]*w_R_b[6] + I_b[3]*w_R_b[7] + I_b[6]*w_R_b[8];
+  const double x7 = I_b[1]*w_R_b[6] + I_b[4]*w_R_b[7] + I_b[7]*w_R_b[8];
+  const double x8 = I_b[2]*w_R_b[6] + I_b[5]*w_R_b[7] + I_b[8]*w_R_b[8];
+  const double x9 = w_R_b[0]*x6 + w_R_b[1]*x7 + w_R_b[2]*x8;
+  const double x10 = w_R_b[3]*x6 + w_R_b[4]*x7 + w_R_b[5]*x8;
+  const double x11 = w_R_b[6]*x6 + w_R_b[7]*x7 + w_R_b[8]*x8;
+  const double x12 = w[0]*x9 + w[1]*x10 + w[2]*x11;
+  const double x13 = I_b[0]*w_R_b[3] + I_b[3]*w_R_b[4] + I_b[6]*w_R_b[5];
+  const double x14 = I_b[1]*w_R_b[3] + I_b[4]*w_R_b[4] + I_b[7]*w_R_b[5];
+  const double x15 = I_b[2]*w_R_b[3] + I_b[5]*w_R_b[4] + I_b[8]*w_R_b[5];
+  const double x16 = w_R_b[0]*x13 + w_R_b[1]*x14 + w_R_b[2]*x15;
+  const double x17 = w_R_b[3]*x13 + w_R_b[4]*x14 + w_R_b[5]*x15;
+  const double x18 = w_R_b[6]*x13 + w_R_b[7]*x14 + w_R_b[8]*x15;
+  const double x19 = w[0]*x16 + w[1]*x17 + w[2]*x18;
+  const double x20 = w[0]*x3 + w[1]*x4 + w[2]*x5;
+  out[0] = w[1]*x12 - w[2]*x19 + wd[0]*x3 + wd[1]*x4 + wd[2]*x5;
+  out[1] = -w[0]*x12 + w[2]*x20 + wd[0]*x16 + wd[1]*x17 + wd[2]*x18;
+  out[2] = w[0]*x19 - w[1]*x20 + wd[0]*x9 + wd[1]*x10 + wd[2]*x11;
+  out[3] = acc[0]*m;
+  out[4] = acc[1]*m;
+  out[5] = m*(acc[2] + g);
+}
+
+/** @brief Linear rows of the base part w.r.t. the linear acceleration (3x3). */
+void
+BaseJacobianWrtLinAcc (double m, double* d_acc)
+{
+  d_acc[0] = m;
+  d_acc[1] = 0;
+  d_acc[2] = 0;
+  d_acc[3] = 0;
+  d_acc[4] = m;
+  d_acc[5] = 0;
+  d_acc[6] = 0;
+  d_acc[7] = 0;
+  d_acc[8] = m;
+}
+
+/** @brief Angular rows of the base part w.r.t. w_R_b (3x9), w (3x3) and wd (3x3). */
+void
+BaseJacobianWrtAng (const double* I_b, const double* w_R_b, const double* w,
+                    const double* wd, double* d_R, double* d_w, double* d_wd)
+{
+  const double x0 = I_b[0]*w_R_b[3];
+  const double x1 = I_b[1]*w_R_b[4] + I_b[2]*w_R_b[5];
+  const double x2 = x0 + x1;
+  const double x3 = wd[1]*x2;
+  const double x4 = I_b[0]*w_R_b[6];
+  const double x5 = I_b[1]*w_R_b[7] + I_b[2]*w_R_b[8];
+  const double x6 = x4 + x5;
+  const double x7 = wd[2]*x6;
+  const double x8 = I_b[3]*w_R_b[7] + I_b[6]*w_R_b[8];
+  const double x9 = x4 + x8;
+  const double x10 = w[0]*w[1];
+  const double x11 = x10*x9;
+  const double x12 = I_b[3]*w_R_b[4] + I_b[6]*w_R_b[5];
+  const double x13 = x0 + x12;
+  const double x14 = w[0]*w[2];
+  const double x15 = x13*x14;
+  const double x16 = I_b[0]*w_R_b[0];
+  const double x17 = I_b[3]*w_R_b[1] + I_b[6]*w_R_b[2];
+  const double x18 = I_b[1]*w_R_b[1] + I_b[2]*w_R_b[2];
+  const double x19 = 2*x16 + x17 + x18;
+  const double x20 = I_b[4]*w_R_b[4];
+  const double x21 = I_b[3]*w_R_b[3] + I_b[5]*w_R_b[5];
+  const double x22 = x20 + x21;
+  const double x23 = wd[1]*x22;
+  const double x24 = I_b[4]*w_R_b[7];
+  const double x25 = I_b[3]*w_R_b[6] + I_b[5]*w_R_b[8];
+  const double x26 = x24 + x25;
+  const double x27 = wd[2]*x26;
+  const double x28 = I_b[1]*w_R_b[6] + I_b[7]*w_R_b[8];
+  const double x29 = x24 + x28;
+  const double x30 = x10*x29;
+  const double x31 = I_b[1]*w_R_b[3] + I_b[7]*w_R_b[5];
+  const double x32 = x20 + x31;
+  const double x33 = x14*x32;
+  const double x34 = I_b[4]*w_R_b[1];
+  const double x35 = I_b[1]*w_R_b[0] + I_b[7]*w_R_b[2];
+  const double x36 = I_b[3]*w_R_b[0] + I_b[5]*w_R_b[2];
+  const double x37 = 2*x34 + x35 + x36;
+  const double x38 = I_b[8]*w_R_b[5];
+  const double x39 = I_b[6]*w_R_b[3] + I_b[7]*w_R_b[4];
+  const double x40 = x38 + x39;
+  const double x41 = wd[1]*x40;
+  const double x42 = I_b[8]*w_R_b[8];
+  const double x43 = I_b[6]*w_R_b[6] + I_b[7]*w_R_b[7];
+  const double x44 = x42 + x43;
+  const double x45 = wd[2]*x44;
+  const double x46 = I_b[2]*w_R_b[6] + I_b[5]*w_R_b[7];
+  const double x47 = x42 + x46;
+  const double x48 = x10*x47;
+  const double x49 = I_b[2]*w_R_b[3] + I_b[5]*w_R_b[4];
+  const double x50 = x38 + x49;
+  const double x51 = x14*x50;
+  const double x52 = I_b[8]*w_R_b[2];
+  const double x53 = I_b[2]*w_R_b[0] + I_b[5]*w_R_b[1];
+  const double x54 = I_b[6]*w_R_b[0] + I_b[7]*w_R_b[1];
+  const double x55 = 2*x52 + x53 + x54;
+  const double x56 = x16 + x17;
+  const double x57 = w[1]*w[1];
+  const double x58 = x16 + x18;
+  const double x59 = w[0]*x58;
+  const double x60 = w[2]*x6;
+  const double x61 = 2*x0 + x1 + x12;
+  const double x62 = w[1]*x61 + x59 + x60;
+  const double x63 = x34 + x35;
+  const double x64 = x34 + x36;
+  const double x65 = w[0]*x64;
+  const double x66 = w[2]*x26;
+  const double x67 = 2*x20 + x21 + x31;
+  const double x68 = w[1]*x67 + x65 + x66;
+  const double x69 = x52 + x53;
+  const double x70 = x52 + x54;
+  const double x71 = w[0]*x70;
+  const double x72 = w[2]*x44;
+  const double x73 = 2*x38 + x39 + x49;
+  const double x74 = w[1]*x73 + x71 + x72;
+  const double x75 = w[2]*w[2];
+  const double x76 = w[1]*x2;
+  const double x77 = 2*x4 + x5 + x8;
+  const double x78 = w[2]*x77 + x59 + x76;
+  const double x79 = w[1]*x22;
+  const double x80 = 2*x24 + x25 + x28;
+  const double x81 = w[2]*x80 + x65 + x79;
+  const double x82 = w[1]*x40;
+  const double x83 = 2*x42 + x43 + x46;
+  const double x84 = w[2]*x83 + x71 + x82;
+  const double x85 = w[0]*w[0];
+  const double x86 = w[0]*x19 + x60 + x76;
+  const double x87 = w[0]*x37 + x66 + x79;
+  const double x88 = w[0]*x55 + x72 + x82;
+  const double x89 = wd[0]*x58;
+  const double x90 = w[1]*w[2];
+  const double x91 = x56*x90;
+  const double x92 = wd[0]*x64;
+  const double x93 = x63*x90;
+  const double x94 = wd[0]*x70;
+  const double x95 = x69*x90;
+  const double x96 = w_R_b[0]*x9 + w_R_b[1]*x29 + w_R_b[2]*x47;
+  const double x97 = w_R_b[0]*x13 + w_R_b[1]*x32 + w_R_b[2]*x50;
+  const double x98 = w[0]*x96;
+  const double x99 = w_R_b[6]*x9 + w_R_b[7]*x29 + w_R_b[8]*x47;
+  const double x100 = w[2]*x99;
+  const double x101 = w_R_b[3]*x9 + w_R_b[4]*x29 + w_R_b[5]*x47;
+  const double x102 = w[1]*x101;
+  const double x103 = w_R_b[3]*x13 + w_R_b[4]*x32 + w_R_b[5]*x50;
+  const double x104 = w[0]*x97;
+  const double x105 = w[1]*x103;
+  const double x106 = w_R_b[6]*x13 + w_R_b[7]*x32 + w_R_b[8]*x50;
+  const double x107 = w[2]*x106;
+  const double x108 = w_R_b[0]*x56 + w_R_b[1]*x63 + w_R_b[2]*x69;
+  const double x109 = w_R_b[3]*x56 + w_R_b[4]*x63 + w_R_b[5]*x69;
+  const double x110 = w[0]*x108;
+  const double x111 = w[1]*x109;
+  const double x112 = w_R_b[6]*x56 + w_R_b[7]*x63 + w_R_b[8]*x69;
+  const double x113 = w[2]*x112;
+  d_R[0] = wd[0]*x19 + x11 - x15 + x3 + x7;
+  d_R[1] = wd[0]*x37 + x23 + x27 + x30 - x33;
+  d_R[2] = wd[0]*x55 + x41 + x45 + x48 - x51;
+  d_R[3] = -w[2]*x62 + wd[1]*x56 + x57*x9;
+  d_R[4] = -w[2]*x68 + wd[1]*x63 + x29*x57;
+  d_R[5] = -w[2]*x74 + wd[1]*x69 + x47*x57;
+  d_R[6] = w[1]*x78 + wd[2]*x56 - x13*x75;
+  d_R[7] = w[1]*x81 + wd[2]*x63 - x32*x75;
+  d_R[8] = w[1]*x84 + wd[2]*x69 - x50*x75;
+  d_R[9] = w[2]*x86 + wd[0]*x13 - x85*x9;
+  d_R[10] = w[2]*x87 + wd[0]*x32 - x29*x85;
+  d_R[11] = w[2]*x88 + wd[0]*x50 - x47*x85;
+  d_R[12] = wd[1]*x61 - x11 + x7 + x89 + x91;
+  d_R[13] = wd[1]*x67 + x27 - x30 + x92 + x93;
+  d_R[14] = wd[1]*x73 + x45 - x48 + x94 + x95;
+  d_R[15] = -w[0]*x78 + wd[2]*x13 + x56*x75;
+  d_R[16] = -w[0]*x81 + wd[2]*x32 + x63*x75;
+  d_R[17] = -w[0]*x84 + wd[2]*x50 + x69*x75;
+  d_R[18] = -w[1]*x86 + wd[0]*x9 + x13*x85;
+  d_R[19] = -w[1]*x87 + wd[0]*x29 + x32*x85;
+  d_R[20] = -w[1]*x88 + wd[0]*x47 + x50*x85;
+  d_R[21] = w[0]*x62 + wd[1]*x9 - x56*x57;
+  d_R[22] = w[0]*x68 + wd[1]*x29 - x57*x63;
+  d_R[23] = w[0]*x74 + wd[1]*x47 - x57*x69;
+  d_R[24] = wd[2]*x77 + x15 + x3 + x89 - x91;
+  d_R[25] = wd[2]*x80 + x23 + x33 + x92 - x93;
+  d_R[26] = wd[2]*x83 + x41 + x51 + x94 - x95;
+  d_w[0] = w[1]*x96 - w[2]*x97;
+  d_w[1] = -w[2]*x103 + x100 + 2*x102 + x98;
+  d_w[2] = w[1]*x99 - x104 - x105 - 2*x107;
+  d_w[3] = w[2]*x108 - x100 - x102 - 2*x98;
+  d_w[4] = -w[0]*x101 + w[2]*x109;
+  d_w[5] = -w[0]*x99 + x110 + x111 + 2*x113;
+  d_w[6] = -w[1]*x108 + 2*x104 + x105 + x107;
+  d_w[7] = w[0]*x103 - x110 - 2*x111 - x113;
+  d_w[8] = w[0]*x106 - w[1]*x112;
+  d_wd[0] = x108;
+  d_wd[1] = x109;
+  d_wd[2] = x112;
+  d_wd[3] = x97;
+  d_wd[4] = x103;
+  d_wd[5] = x106;
+  d_wd[6] = x96;
+  d_wd[7] = x101;
+  d_wd[8] = x99;
+}
+
+/** @brief Contribution of one endeffector to the 6D violation (angular, linear). */
+void
+ContactViolation (const double* com, const double* p, const double* f,
+                  double* out)
+{
+  const double x0 = com[2] - p[2];
+  const double x1 = com[1] - p[1];
+  const double x2 = com[0] - p[0];
+  out[0] = -f[1]*x0 + f[2]*x1;
+  out[1] = f[0]*x0 - f[2]*x2;
+  out[2] = -f[0]*x1 + f[1]*x2;
+  out[3] = -f[0];
+  out[4] = -f[1];
+  out[5] = -f[2];
+}
+
+/** @brief Angular rows of one contact w.r.t. the CoM position (3x3). */
+void
+ContactJacobianWrtCom (const double* f, double* d_com)
+{
+  d_com[0] = 0;
+  d_com[1] = f[2];
+  d_com[2] = -f[1];
+  d_com[3] = -f[2];
+  d_com[4] = 0;
+  d_com[5] = f[0];
+  d_com[6] = f[1];
+  d_com[7] = -f[0];
+  d_com[8] = 0;
+}
+
+/** @brief Angular rows of one contact w.r.t. the endeffector position (3x3). */
+void
+ContactJacobianWrtPos (const double* f, double* d_p)
+{
+  d_p[0] = 0;
+  d_p[1] = -f[2];
+  d_p[2] = f[1];
+  d_p[3] = f[2];
+  d_p[4] = 0;
+  d_p[5] = -f[0];
+  d_p[6] = -f[1];
+  d_p[7] = f[0];
+  d_p[8] = 0;
+}
+
+/** @brief Both rows of one contact w.r.t. the endeffector force (6x3). */
+void
+ContactJacobianWrtForce (const double* com, const double* p, double* d_f)
+{
+  const double x0 = com[2] - p[2];
+  const double x1 = com[1] - p[1];
+  const double x2 = com[0] - p[0];
+  d_f[0] = 0;
+  d_f[1] = -x0;
+  d_f[2] = x1;
+  d_f[3] = x0;
+  d_f[4] = 0;
+  d_f[5] = -x2;
+  d_f[6] = -x1;
+  d_f[7] = x2;
+  d_f[8] = 0;
+  d_f[9] = -1;
+  d_f[10] = 0;
+  d_f[11] = 0;
+  d_f[12] = 0;
+  d_f[13] = -1;
+  d_f[14] = 0;
+  d_f[15] = 0;
+  d_f[16] = 0;
+  d_f[17] = -1;
+}
+} /* namespace srbd_kernels */
+} /* namespace towr */
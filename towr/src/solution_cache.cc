@@ -0,0 +1,251 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/planning/solution_cache.h>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include <towr/io/trajectory_file.h>
+
+namespace towr {
+
+static const std::string kProblemColumn = "cache/problem";
+
+SolutionCache::Problem
+SolutionCache::GetProblem (int robot, int terrain, int terrain_version,
+                           int gait, uint32_t flags, const NlpFormulation& f)
+{
+  Problem p;
+  p.robot_           = robot;
+  p.terrain_         = terrain;
+  p.terrain_version_ = terrain_version;
+  p.gait_            = gait;
+  p.flags_           = flags;
+  p.total_duration_  = f.params_.GetTotalTime();
+
+  for (int dim=0; dim<3; ++dim) {
+    p.pose_.at(dim)   = f.initial_base_.lin.p()(dim);
+    p.pose_.at(3+dim) = f.initial_base_.ang.p()(dim);
+    p.pose_.at(6+dim) = f.final_base_.lin.p()(dim);
+    p.pose_.at(9+dim) = f.final_base_.ang.p()(dim);
+  }
+
+  return p;
+}
+
+SolutionCache::SolutionCache (double resolution)
+    : resolution_(resolution)
+{
+}
+
+SolutionCache::GroupKey
+SolutionCache::GetGroupKey (const Problem& p) const
+{
+  int64_t duration_ms = std::llround(p.total_duration_*1e3);
+  return GroupKey(p.robot_, p.terrain_, p.terrain_version_, p.gait_, p.flags_, duration_ms);
+}
+
+SolutionCache::QuantizedKey
+SolutionCache::Quantize (const Pose& pose) const
+{
+  QuantizedKey key;
+  for (int i=0; i<kPoseDim; ++i)
+    key.at(i) = std::llround(pose.at(i)/resolution_);
+  return key;
+}
+
+void
+SolutionCache::Insert (const Problem& problem, const TrajectoryPtr& solution)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Group& group = groups_[GetGroupKey(problem)];
+
+  QuantizedKey key = Quantize(problem.pose_);
+  auto it = group.exact_.find(key);
+  if (it != group.exact_.end()) {
+    group.solutions_.at(it->second) = solution; // keeps position in tree
+    return;
+  }
+
+  int entry = group.problems_.size();
+  group.problems_.push_back(problem);
+  group.solutions_.push_back(solution);
+  group.exact_[key] = entry;
+  AddToTree(group, entry);
+}
+
+void
+SolutionCache::AddToTree (Group& group, int entry)
+{
+  const Pose& pose = group.problems_.at(entry).pose_;
+  TreeNode leaf;
+  leaf.entry_ = entry;
+  leaf.axis_  = 0;
+
+  if (group.tree_.empty()) {
+    group.tree_.push_back(leaf);
+    return;
+  }
+
+  // descend to the leaf, the tree isn't rebalanced.
+  int node = 0;
+  while (true) {
+    const TreeNode& n = group.tree_.at(node);
+    bool left = pose.at(n.axis_) < group.problems_.at(n.entry_).pose_.at(n.axis_);
+    int child = left? n.left_ : n.right_;
+    if (child < 0) {
+      leaf.axis_ = (n.axis_+1) % kPoseDim;
+      int id = group.tree_.size();
+      if (left)
+        group.tree_.at(node).left_ = id;
+      else
+        group.tree_.at(node).right_ = id;
+      group.tree_.push_back(leaf);
+      return;
+    }
+    node = child;
+  }
+}
+
+SolutionCache::TrajectoryPtr
+SolutionCache::Find (const Problem& problem) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto g = groups_.find(GetGroupKey(problem));
+  if (g == groups_.end())
+    return nullptr;
+
+  auto it = g->second.exact_.find(Quantize(problem.pose_));
+  return it == g->second.exact_.end()? nullptr : g->second.solutions_.at(it->second);
+}
+
+SolutionCache::TrajectoryPtr
+SolutionCache::FindNearest (const Problem& problem, double* distance) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto g = groups_.find(GetGroupKey(problem));
+  if (g == groups_.end() || g->second.tree_.empty())
+    return nullptr;
+
+  int best = -1;
+  double best_dist2 = std::numeric_limits<double>::infinity();
+  FindNearest(g->second, 0, problem.pose_, best, best_dist2);
+
+  if (distance)
+    *distance = std::sqrt(best_dist2);
+  return g->second.solutions_.at(best);
+}
+
+void
+SolutionCache::FindNearest (const Group& group, int node, const Pose& pose,
+                            int& best, double& best_dist2)
+{
+  if (node < 0)
+    return;
+
+  const TreeNode& n = group.tree_.at(node);
+  const Pose& p = group.problems_.at(n.entry_).pose_;
+
+  double dist2 = 0.0;
+  for (int i=0; i<kPoseDim; ++i)
+    dist2 += (pose.at(i)-p.at(i))*(pose.at(i)-p.at(i));
+  if (dist2 < best_dist2) {
+    best_dist2 = dist2;
+    best = n.entry_;
+  }
+
+  // first the side of the splitting plane the pose is on, the other only if
+  // the plane is closer than the best solution so far.
+  double diff = pose.at(n.axis_) - p.at(n.axis_);
+  FindNearest(group, diff < 0? n.left_ : n.right_, pose, best, best_dist2);
+  if (diff*diff < best_dist2)
+    FindNearest(group, diff < 0? n.right_ : n.left_, pose, best, best_dist2);
+}
+
+int
+SolutionCache::GetSize () const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  int size = 0;
+  for (const auto& g : groups_)
+    size += g.second.problems_.size();
+  return size;
+}
+
+void
+SolutionCache::Save (const std::string& path) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  TrajectoryFileWriter file(path);
+
+  for (const auto& g : groups_) {
+    const Group& group = g.second;
+    for (int i=0; i<group.problems_.size(); ++i) {
+      const Problem& p = group.problems_.at(i);
+      const Trajectory& solution = *group.solutions_.at(i);
+
+      std::vector<double> values = {double(p.robot_), double(p.terrain_),
+                                    double(p.terrain_version_), double(p.gait_),
+                                    p.total_duration_, double(p.flags_)};
+      values.insert(values.end(), p.pose_.begin(), p.pose_.end());
+
+      auto columns = trajectory_file::GetKnotColumns(solution);
+      columns.emplace_back(kProblemColumn, values);
+      file.Append(columns, solution.GetEECount(), 0.0);
+    }
+  }
+}
+
+void
+SolutionCache::Load (const std::string& path)
+{
+  TrajectoryFileReader file(path);
+
+  for (int r=0; r<file.GetRecordCount(); ++r) {
+    uint64_t count = 0;
+    const double* v = file.GetColumn(r, kProblemColumn, count);
+    if (!v || count != 6+kPoseDim)
+      throw std::runtime_error(path + " is not a solution cache!");
+
+    Problem p;
+    p.robot_           = v[0];
+    p.terrain_         = v[1];
+    p.terrain_version_ = v[2];
+    p.gait_            = v[3];
+    p.total_duration_  = v[4];
+    p.flags_           = v[5];
+    std::copy(v+6, v+6+kPoseDim, p.pose_.begin());
+
+    Insert(p, std::make_shared<const Trajectory>(file.GetTrajectory(r)));
+  }
+}
+
+} /* namespace towr */
@@ -0,0 +1,158 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/planning/solve_monitor.h>
+
+#include <algorithm>
+
+namespace towr {
+
+SolveMonitor::SolveMonitor (const CancellationToken& token,
+                            double max_wall_time)
+    : VariableSet(0, "solve-monitor"),
+      token_(token),
+      max_wall_time_(max_wall_time)
+{
+  start_ = Clock::now();
+}
+
+void
+SolveMonitor::Start ()
+{
+  start_ = Clock::now();
+  status_ = SolveResult::Finished;
+  is_active_ = true;
+}
+
+void
+SolveMonitor::Stop ()
+{
+  is_active_ = false;
+}
+
+double
+SolveMonitor::GetElapsedTime () const
+{
+  return std::chrono::duration<double>(Clock::now() - start_).count();
+}
+
+void
+SolveMonitor::CheckForInterrupt () const
+{
+  if (!is_active_)
+    return;
+
+  if (token_.IsCancelled())
+    status_ = SolveResult::Cancelled;
+  else if (GetElapsedTime() > max_wall_time_)
+    status_ = SolveResult::DeadlineReached;
+
+  // keeps throwing, as the solver might call again while shutting down
+  if (status_ != SolveResult::Finished)
+    throw SolveInterrupted(status_ == SolveResult::Cancelled? "solve cancelled"
+                                                            : "solve deadline reached");
+}
+
+SolveMonitor::VectorXd
+SolveMonitor::GetValues () const
+{
+  CheckForInterrupt(); // called with every completed iteration
+  return VectorXd();
+}
+
+void
+SolveMonitor::SetVariables (const VectorXd& x)
+{
+  CheckForInterrupt(); // called before every evaluation of costs/constraints
+}
+
+
+SolveResult
+SolveInterruptible (ifopt::Solver& solver,
+                    ifopt::Problem& nlp,
+                    const CancellationToken& token,
+                    double max_wall_time,
+                    double feasibility_tolerance)
+{
+  auto monitor = std::make_shared<SolveMonitor>(token, max_wall_time);
+  nlp.AddVariableSet(monitor);
+
+  Eigen::VectorXd x_init = nlp.GetVariableValues();
+  int n_iter_before = nlp.GetIterationCount();
+
+  monitor->Start();
+  try {
+    solver.Solve(nlp);
+  } catch (const SolveInterrupted&) {
+    // Ipopt catches this itself, other solvers might forward it.
+  }
+  monitor->Stop();
+
+  SolveResult result;
+  result.status_          = monitor->GetStatus();
+  result.wall_time_       = monitor->GetElapsedTime();
+  result.iteration_count_ = nlp.GetIterationCount() - n_iter_before;
+
+  // the variables still hold the values of the aborted evaluation, which
+  // might have been a trial point the solver would have rejected.
+  if (result.status_ != SolveResult::Finished) {
+    if (result.iteration_count_ > 0)
+      nlp.SetOptVariables(nlp.GetIterationCount()-1);
+    else
+      nlp.GetOptVariables()->SetVariables(x_init);
+  }
+
+  result.constraint_violation_ = GetMaxBoundViolation(nlp);
+  result.is_feasible_ = result.constraint_violation_ <= feasibility_tolerance;
+  return result;
+}
+
+static double
+GetMaxViolation (const Eigen::VectorXd& values, const ifopt::Component::VecBound& bounds)
+{
+  double violation = 0.0;
+  for (int i=0; i<bounds.size(); ++i) {
+    violation = std::max(violation, bounds.at(i).lower_ - values(i));
+    violation = std::max(violation, values(i) - bounds.at(i).upper_);
+  }
+
+  return violation;
+}
+
+double
+GetMaxBoundViolation (ifopt::Problem& nlp)
+{
+  Eigen::VectorXd x = nlp.GetVariableValues();
+  Eigen::VectorXd g = nlp.EvaluateConstraints(x.data());
+
+  return std::max(GetMaxViolation(x, nlp.GetBoundsOnOptimizationVariables()),
+                  GetMaxViolation(g, nlp.GetBoundsOnConstraints()));
+}
+
+} /* namespace towr */
@@ -33,11 +33,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace towr {
 
-Spline::Spline(const VecTimes& poly_durations, int n_dim)
+Spline::Spline(const VecTimes& poly_durations, int n_dim, int n_node_derivatives)
 {
   uint n_polys = poly_durations.size();
 
-  cubic_polys_.assign(n_polys, CubicHermitePolynomial(n_dim));
+  cubic_polys_.assign(n_polys, CubicHermitePolynomial(n_dim, n_node_derivatives));
   for (int i=0; i<cubic_polys_.size(); ++i) {
     cubic_polys_.at(i).SetDuration(poly_durations.at(i));
   }
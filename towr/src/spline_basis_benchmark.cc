@@ -0,0 +1,148 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <ifopt/ipopt_solver.h>
+
+#include <towr/nlp_formulation.h>
+#include <towr/initialization/gait_generator.h>
+#include <towr/terrain/examples/height_map_examples.h>
+#include <towr/planning/solve_monitor.h>
+
+using namespace towr;
+
+// a walk over flat ground for the given robot, starting and ending in stance.
+static NlpFormulation
+MakeFormulation (RobotModel::Robot robot, double goal_x, double duration)
+{
+  NlpFormulation formulation;
+  formulation.model_ = RobotModel(robot);
+  formulation.terrain_ = std::make_shared<FlatGround>(0.0);
+
+  auto nominal_stance_B = formulation.model_.kinematic_model_->GetNominalStanceInBase();
+  double z_ground = 0.0;
+  formulation.initial_ee_W_ = nominal_stance_B;
+  for (auto& ee : formulation.initial_ee_W_)
+    ee.z() = z_ground;
+  formulation.initial_base_.lin.at(kPos).z() = -nominal_stance_B.front().z() + z_ground;
+  formulation.final_base_.lin.at(kPos) << goal_x, 0.0, formulation.initial_base_.lin.at(kPos).z();
+
+  int n_ee = formulation.model_.kinematic_model_->GetNumberOfEndeffectors();
+  auto gait_gen = GaitGenerator::MakeGaitGenerator(n_ee);
+  gait_gen->SetCombo(GaitGenerator::C0);
+  for (int ee=0; ee<n_ee; ++ee) {
+    formulation.params_.ee_phase_durations_.push_back(gait_gen->GetPhaseDurations(duration, ee));
+    formulation.params_.ee_in_contact_at_start_.push_back(gait_gen->IsInContactAtStart(ee));
+  }
+
+  return formulation;
+}
+
+// integral of the squared base acceleration (linear and angular), sampled.
+static double
+GetAccelerationEffort (const SplineHolder& splines, double dt = 0.005)
+{
+  double effort = 0.0;
+  double T = splines.base_linear_->GetTotalTime();
+  for (double t=0.0; t<T; t+=dt) {
+    effort += splines.base_linear_->GetPoint(t).a().squaredNorm()*dt;
+    effort += splines.base_angular_->GetPoint(t).a().squaredNorm()*dt;
+  }
+  return effort;
+}
+
+/**
+ * Compares problem size and solve time of the base spline bases
+ * (Parameters::SplineBasis) on walks of different robots:
+ *
+ *   towr-spline-basis-benchmark [max solve time, default 20s]
+ *
+ * For every robot the same problem is built once with cubic Hermite base
+ * polynomials and once with quintic Hermite ones (Parameters::UseQuinticBase)
+ * and solved with IPOPT from the default initialization. Besides the size
+ * and effort of the solve, the integral of the squared base acceleration
+ * shows that both bases reach motions of similar quality.
+ */
+int main(int argc, char *argv[])
+{
+  double max_solve_time = argc > 1? std::stod(argv[1]) : 20.0;
+
+  struct Case { std::string name_; RobotModel::Robot robot_; double goal_x_; double T_; };
+  std::vector<Case> cases = { {"monoped",   RobotModel::Monoped,   1.0, 2.0},
+                              {"biped",     RobotModel::Biped,     1.0, 2.0},
+                              {"quadruped", RobotModel::Anymal,    1.0, 2.0} };
+
+  std::cout << std::left << std::setw(11) << "robot" << std::setw(9) << "basis"
+            << std::right << std::setw(7) << "vars" << std::setw(7) << "cons"
+            << std::setw(9) << "jac nnz" << std::setw(7) << "iter"
+            << std::setw(10) << "time[s]" << std::setw(11) << "violation"
+            << std::setw(10) << "effort" << std::endl;
+
+  for (const auto& c : cases) {
+    for (bool quintic : {false, true}) {
+      NlpFormulation formulation = MakeFormulation(c.robot_, c.goal_x_, c.T_);
+      if (quintic)
+        formulation.params_.UseQuinticBase();
+
+      SplineHolder splines;
+      ifopt::Problem nlp;
+      for (auto v : formulation.GetVariableSets(splines))
+        nlp.AddVariableSet(v);
+      for (auto constraint : formulation.GetConstraints(splines))
+        nlp.AddConstraintSet(constraint);
+      for (auto cost : formulation.GetCosts())
+        nlp.AddCostSet(cost);
+
+      int n_vars = nlp.GetNumberOfOptimizationVariables();
+      int n_cons = nlp.GetNumberOfConstraints();
+      int n_nnz  = nlp.GetJacobianOfConstraints().nonZeros();
+
+      ifopt::IpoptSolver solver;
+      solver.SetOption("jacobian_approximation", "exact");
+      solver.SetOption("print_level", 0);
+      solver.SetOption("print_timing_statistics", "no");
+      auto result = SolveInterruptible(solver, nlp, CancellationToken(), max_solve_time);
+
+      std::cout << std::left << std::setw(11) << c.name_
+                << std::setw(9) << (quintic? "quintic" : "cubic")
+                << std::right << std::setw(7) << n_vars << std::setw(7) << n_cons
+                << std::setw(9) << n_nnz << std::setw(7) << result.iteration_count_
+                << std::setw(10) << std::setprecision(3) << std::fixed << result.wall_time_
+                << std::setw(11) << std::scientific << std::setprecision(1) << result.constraint_violation_
+                << std::setw(10) << std::fixed << std::setprecision(2) << GetAccelerationEffort(splines)
+                << std::endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/costs/spline_integral_cost.h>
+
+#include <cmath>
+#include <stdexcept>
+
+#include <towr/variables/nodes_variables_phase_based.h>
+
+namespace towr {
+
+SplineIntegralCost::SplineIntegralCost (const std::string& nodes_id,
+                                        const VecTimes& durations,
+                                        Dx deriv, double weight)
+    : CostTerm(nodes_id + "-integral-dx_" + std::to_string(deriv))
+{
+  node_id_   = nodes_id;
+  durations_ = durations;
+  deriv_     = deriv;
+  weight_    = weight;
+}
+
+Eigen::Matrix4d
+SplineIntegralCost::GetSegmentMatrix (double T, Dx deriv)
+{
+  // polynomial coefficients a0..a3 from (p0, v0, p1, v1), see
+  // CubicHermitePolynomial::UpdateCoeff()
+  Eigen::Matrix4d A;
+  A <<         1.0,        0.0,          0.0,        0.0,
+               0.0,        1.0,          0.0,        0.0,
+       -3/(T*T),     -2/T,      3/(T*T),     -1/T,
+        2/(T*T*T),  1/(T*T),   -2/(T*T*T),  1/(T*T);
+
+  // int_0^T d^k(t^i) d^k(t^j) dt
+  int k = deriv;
+  Eigen::Matrix4d Q = Eigen::Matrix4d::Zero();
+  for (int i=k; i<4; ++i) {
+    for (int j=k; j<4; ++j) {
+      double fi = 1.0, fj = 1.0;
+      for (int n=0; n<k; ++n) {
+        fi *= i-n;
+        fj *= j-n;
+      }
+      int p = i+j-2*k+1;
+      Q(i,j) = fi*fj*std::pow(T,p)/p;
+    }
+  }
+
+  return A.transpose()*Q*A;
+}
+
+int
+SplineIntegralCost::GetValueIndex (int node_id, Dx deriv, int dim) const
+{
+  return (2*node_id + deriv)*nodes_->GetDim() + dim;
+}
+
+void
+SplineIntegralCost::InitVariableDependedQuantities (const VariablesPtr& x)
+{
+  if (deriv_ > kJerk)
+    throw std::runtime_error("integral cost only defined up to the jerk!");
+
+  nodes_ = x->GetComponent<NodesVariables>(node_id_);
+  if (nodes_->GetNodes().front().GetDerivativeCount() != Node::n_derivatives)
+    throw std::runtime_error("integral costs only implemented for cubic polynomials!");
+
+  VecTimes T = durations_;
+  auto phase_based = std::dynamic_pointer_cast<NodesVariablesPhaseBased>(nodes_);
+  if (phase_based)
+    T = phase_based->ConvertPhaseToPolyDurations(durations_);
+
+  int n_nodes = nodes_->GetNodes().size();
+  if (T.size() != n_nodes-1)
+    throw std::runtime_error("durations don't match nodes of " + node_id_ + "!");
+
+  int n_dim    = nodes_->GetDim();
+  int n_values = 2*n_nodes*n_dim;
+  int n_opt    = nodes_->GetOptVariablesCount();
+
+  // the same for every dimension, polynomials share the node in between.
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (int s=0; s<T.size(); ++s) {
+    Eigen::Matrix4d M = GetSegmentMatrix(T.at(s), deriv_);
+    for (int dim=0; dim<n_dim; ++dim) {
+      int idx[4] = { GetValueIndex(s,   kPos, dim), GetValueIndex(s,   kVel, dim),
+                     GetValueIndex(s+1, kPos, dim), GetValueIndex(s+1, kVel, dim) };
+      for (int a=0; a<4; ++a)
+        for (int b=0; b<4; ++b)
+          triplets.push_back(Eigen::Triplet<double>(idx[a], idx[b], M(a,b)));
+    }
+  }
+  H_.resize(n_values, n_values);
+  H_.setFromTriplets(triplets.begin(), triplets.end());
+
+  // node values w.r.t. optimization variables
+  triplets.clear();
+  for (int i=0; i<n_opt; ++i)
+    for (auto nvi : nodes_->GetNodeValuesInfo(i))
+      triplets.push_back(Eigen::Triplet<double>(GetValueIndex(nvi.id_, nvi.deriv_, nvi.dim_),
+                                                i, nodes_->GetScale(nvi.dim_)));
+  Hessian S(n_values, n_opt);
+  S.setFromTriplets(triplets.begin(), triplets.end());
+
+  gradient_ = 2.0*weight_*Hessian(S.transpose())*H_;
+  hessian_  = gradient_*S;
+}
+
+std::string
+SplineIntegralCost::GetHessianVariablesName () const
+{
+  return nodes_->GetOptVariablesName();
+}
+
+Eigen::VectorXd
+SplineIntegralCost::GetNodeValues () const
+{
+  auto nodes = nodes_->GetNodes();
+
+  Eigen::VectorXd u(2*nodes.size()*nodes_->GetDim());
+  for (int id=0; id<nodes.size(); ++id)
+    for (Dx d : {kPos, kVel})
+      u.segment(GetValueIndex(id, d, 0), nodes_->GetDim()) = nodes.at(id).at(d);
+
+  return u;
+}
+
+double
+SplineIntegralCost::GetCost () const
+{
+  Eigen::VectorXd u = GetNodeValues();
+  return weight_*u.dot(H_*u);
+}
+
+void
+SplineIntegralCost::FillJacobianBlock (std::string var_set, Jacobian& jac) const
+{
+  if (var_set == nodes_->GetOptVariablesName()) {
+    Eigen::VectorXd grad = gradient_*GetNodeValues();
+    for (int i=0; i<grad.size(); ++i)
+      jac.coeffRef(0, i) += grad(i);
+  }
+}
+
+} /* namespace towr */
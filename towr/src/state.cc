@@ -37,7 +37,7 @@ State::State (int dim, int n_derivatives)
   values_ = std::vector<VectorXd>(n_derivatives, VectorXd::Zero(dim));
 }
 
-const Eigen::VectorXd
+const Eigen::VectorXd&
 State::at (Dx deriv) const
 {
   return values_.at(deriv);
@@ -49,23 +49,29 @@ State::at (Dx deriv)
   return values_.at(deriv);
 }
 
-const Eigen::VectorXd
+const Eigen::VectorXd&
 State::p () const
 {
   return at(kPos);
 }
 
-const Eigen::VectorXd
+const Eigen::VectorXd&
 State::v () const
 {
   return at(kVel);
 }
 
-const Eigen::VectorXd
+const Eigen::VectorXd&
 State::a () const
 {
   return at(kAcc);
 }
 
+int
+State::GetDerivativeCount () const
+{
+  return values_.size();
+}
+
 } // namespace towr
 
@@ -47,6 +47,7 @@ TerrainConstraint::InitVariableDependedQuantities (const VariablesPtr& x)
   ee_motion_ = x->GetComponent<NodesVariablesPhaseBased>(ee_motion_id_);
 
   // skip first node, b/c already constrained by initial stance
+  node_ids_.clear();
   for (int id=1; id<ee_motion_->GetNodes().size(); ++id)
     node_ids_.push_back(id);
 
@@ -90,17 +91,17 @@ TerrainConstraint::GetBounds () const
 void
 TerrainConstraint::FillJacobianBlock (std::string var_set, Jacobian& jac) const
 {
-  if (var_set == ee_motion_->GetName()) {
+  if (var_set == ee_motion_->GetOptVariablesName()) {
     auto nodes = ee_motion_->GetNodes();
     int row = 0;
     for (int id : node_ids_) {
       int idx = ee_motion_->GetOptIndex(NodesVariables::NodeValueInfo(id, kPos, Z));
-      jac.coeffRef(row, idx) = 1.0;
+      jac.coeffRef(row, idx) = ee_motion_->GetScale(Z);
 
       Vector3d p = nodes.at(id).p();
       for (auto dim : {X,Y}) {
         int idx = ee_motion_->GetOptIndex(NodesVariables::NodeValueInfo(id, kPos, dim));
-        jac.coeffRef(row, idx) = -terrain_->GetDerivativeOfHeightWrt(To2D(dim), p.x(), p.y());
+        jac.coeffRef(row, idx) = -ee_motion_->GetScale(dim)*terrain_->GetDerivativeOfHeightWrt(To2D(dim), p.x(), p.y());
       }
       row++;
     }
@@ -0,0 +1,142 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/variables/trajectory.h>
+
+#include <algorithm>
+
+namespace towr {
+
+Trajectory::Trajectory (const SplineHolder& s)
+{
+  base_linear_  = CubicHermiteSpline(*s.base_linear_);
+  base_angular_ = CubicHermiteSpline(*s.base_angular_);
+
+  for (int ee=0; ee<s.ee_motion_.size(); ++ee) {
+    ee_motion_.push_back(CubicHermiteSpline(*s.ee_motion_.at(ee)));
+    ee_force_.push_back(CubicHermiteSpline(*s.ee_force_.at(ee)));
+
+    auto phase_durations = s.phase_durations_.at(ee);
+    ee_phase_durations_.push_back(phase_durations->GetPhaseDurations());
+    ee_in_contact_at_start_.push_back(phase_durations->IsContactPhase(0.0));
+  }
+}
+
+bool
+Trajectory::IsContactPhase (int ee, double t) const
+{
+  const VecDurations& durations = ee_phase_durations_.at(ee);
+  t = std::max(0.0, std::min(t, GetTotalTime()));
+
+  // at junctions, returns previous phase, same as Spline::GetSegmentID()
+  int phase_id = 0;
+  double t_end = durations.front();
+  while (t > t_end + 1e-10 && phase_id < durations.size()-1)
+    t_end += durations.at(++phase_id);
+
+  bool initial_contact = ee_in_contact_at_start_.at(ee);
+  return phase_id%2 == 0? initial_contact : !initial_contact;
+}
+
+double
+Trajectory::GetTotalTime () const
+{
+  return base_linear_.GetTotalTime();
+}
+
+int
+Trajectory::GetEECount () const
+{
+  return ee_motion_.size();
+}
+
+static CubicHermiteSpline
+TileSpline (const CubicHermiteSpline& s, int cycle_count, const Eigen::VectorXd& translation)
+{
+  int n = s.GetKnotCount();
+  int n_tiled = (n-1)*cycle_count + 1;
+  double T = s.GetTotalTime();
+
+  CubicHermiteSpline::VecTimes times(n_tiled);
+  Eigen::MatrixXd pos(s.GetDim(), n_tiled);
+  Eigen::MatrixXd vel(s.GetDim(), n_tiled);
+  Eigen::MatrixXd acc(s.GetDim(), s.IsQuintic()? n_tiled : 0);
+
+  times.front() = s.GetKnotTimes().front();
+  pos.col(0) = s.GetKnotPositions().col(0);
+  vel.col(0) = s.GetKnotVelocities().col(0);
+  if (s.IsQuintic())
+    acc.col(0) = s.GetKnotAccelerations().col(0);
+  for (int c=0; c<cycle_count; ++c) {
+    for (int k=1; k<n; ++k) {
+      int i = c*(n-1) + k;
+      times.at(i) = s.GetKnotTimes().at(k) + c*T;
+      pos.col(i)  = s.GetKnotPositions().col(k) + c*translation;
+      vel.col(i)  = s.GetKnotVelocities().col(k);
+      if (s.IsQuintic())
+        acc.col(i) = s.GetKnotAccelerations().col(k);
+    }
+  }
+
+  return s.IsQuintic()? CubicHermiteSpline(times, pos, vel, acc)
+                      : CubicHermiteSpline(times, pos, vel);
+}
+
+Trajectory
+TileTrajectory (const Trajectory& cycle, int cycle_count,
+                const Eigen::Vector3d& translation)
+{
+  Eigen::Vector3d zero = Eigen::Vector3d::Zero();
+
+  Trajectory tiled;
+  tiled.base_linear_  = TileSpline(cycle.base_linear_,  cycle_count, translation);
+  tiled.base_angular_ = TileSpline(cycle.base_angular_, cycle_count, zero);
+
+  for (int ee=0; ee<cycle.GetEECount(); ++ee) {
+    tiled.ee_motion_.push_back(TileSpline(cycle.ee_motion_.at(ee), cycle_count, translation));
+    tiled.ee_force_.push_back(TileSpline(cycle.ee_force_.at(ee), cycle_count, zero));
+
+    const auto& d = cycle.ee_phase_durations_.at(ee);
+    bool same_at_seam = d.size()%2 == 1; // contact state at end equals the start
+    Trajectory::VecDurations durations = d;
+    for (int c=1; c<cycle_count; ++c) {
+      if (same_at_seam) {
+        durations.back() += d.front();
+        durations.insert(durations.end(), d.begin()+1, d.end());
+      } else
+        durations.insert(durations.end(), d.begin(), d.end());
+    }
+    tiled.ee_phase_durations_.push_back(durations);
+    tiled.ee_in_contact_at_start_.push_back(cycle.ee_in_contact_at_start_.at(ee));
+  }
+
+  return tiled;
+}
+
+} /* namespace towr */
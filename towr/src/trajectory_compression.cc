@@ -0,0 +1,257 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/io/trajectory_compression.h>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <tuple>
+
+namespace towr {
+
+namespace {
+
+// The cubic-Hermite polynomial from t0 to t1 whose dimensions are its basis
+// functions, so its value at t holds the weights of (p0, v0, p1, v1).
+CubicHermiteSpline
+GetBasis (double t0, double t1)
+{
+  Eigen::MatrixXd pos = Eigen::MatrixXd::Zero(4,2);
+  Eigen::MatrixXd vel = Eigen::MatrixXd::Zero(4,2);
+  pos(0,0) = 1.0;
+  vel(1,0) = 1.0;
+  pos(2,1) = 1.0;
+  vel(3,1) = 1.0;
+  return CubicHermiteSpline({t0, t1}, pos, vel);
+}
+
+} // namespace
+
+CubicHermiteSpline
+CompressSpline (const CubicHermiteSpline& spline, double tolerance,
+                int samples_per_polynomial)
+{
+  int n_knots = spline.GetKnotCount();
+  if (n_knots < 3 || spline.IsQuintic())
+    return spline;
+
+  const auto& knot_times = spline.GetKnotTimes();
+  int dim = spline.GetDim();
+  int n   = std::max(3, samples_per_polynomial); // >= 4 samples per fitted polynomial
+
+  // sample the original spline, knot k is sample k*n.
+  int n_samples = (n_knots-1)*n + 1;
+  std::vector<double> sample_times(n_samples);
+  Eigen::MatrixXd samples(dim, n_samples);
+  Eigen::VectorXd v(dim), a(dim);
+  for (int k=0; k<n_knots-1; ++k) {
+    double T = knot_times.at(k+1) - knot_times.at(k);
+    for (int j=0; j<n; ++j) {
+      int i = k*n + j;
+      sample_times.at(i) = knot_times.at(k) + j*T/n;
+      spline.GetPoint(sample_times.at(i), samples.col(i), v, a);
+    }
+  }
+  sample_times.back() = knot_times.back();
+  samples.col(n_samples-1) = spline.GetKnotPositions().col(n_knots-1);
+
+  // the values of the remaining knots are fitted to the samples, only the
+  // first and last knot keep their original values.
+  Eigen::MatrixXd pos = spline.GetKnotPositions();
+  Eigen::MatrixXd vel = spline.GetKnotVelocities();
+
+  // the remaining knots as a doubly linked list.
+  std::vector<int> prev(n_knots), next(n_knots), version(n_knots, 0);
+  std::vector<bool> removed(n_knots, false);
+  for (int k=0; k<n_knots; ++k) {
+    prev.at(k) = k-1;
+    next.at(k) = k+1;
+  }
+
+  // Removing knot k only changes the polynomials touching its neighbours
+  // k0 and k1, so only their values are refit by least squares over the
+  // samples of these polynomials, all other knots stay fixed.
+  Eigen::MatrixXd fit_pos(dim, 2), fit_vel(dim, 2);
+  auto removal_error = [&](int k) {
+    int k0 = prev.at(k), k1 = next.at(k);
+    std::vector<int> knots = {k0, k1};
+    if (k0 > 0)
+      knots.insert(knots.begin(), prev.at(k0));
+    if (k1 < n_knots-1)
+      knots.push_back(next.at(k1));
+
+    std::vector<bool> is_free = {k0 > 0, k1 < n_knots-1};
+    std::vector<int> col(2, -1); // of the free values of k0 and k1
+    int n_free = 0;
+    for (int j=0; j<2; ++j)
+      if (is_free.at(j)) {
+        col.at(j) = n_free;
+        n_free += 2;
+      }
+
+    // per sample the weights of the free values, the rest is fixed.
+    int n_rows = (knots.back() - knots.front())*n + 1;
+    Eigen::MatrixXd A = Eigen::MatrixXd::Zero(n_rows, n_free);
+    Eigen::MatrixXd b(n_rows, dim);
+    Eigen::VectorXd w(4), dw(4), ddw(4);
+    int row = 0;
+    for (std::size_t j=0; j+1<knots.size(); ++j) {
+      int l = knots.at(j), r = knots.at(j+1);
+      auto basis = GetBasis(knot_times.at(l), knot_times.at(r));
+      for (int i=l*n + (j>0); i<=r*n; ++i, ++row) {
+        basis.GetPoint(sample_times.at(i), w, dw, ddw);
+        b.row(row) = samples.col(i).transpose();
+        int sides[2] = {l, r};
+        for (int side=0; side<2; ++side) {
+          int knot = sides[side];
+          double wp = w(2*side), wv = w(2*side+1);
+          int free = knot == k0? 0 : (knot == k1? 1 : -1);
+          if (free >= 0 && is_free.at(free)) {
+            A(row, col.at(free))   += wp;
+            A(row, col.at(free)+1) += wv;
+          } else {
+            b.row(row) -= wp*pos.col(knot).transpose() + wv*vel.col(knot).transpose();
+          }
+        }
+      }
+    }
+
+    Eigen::MatrixXd x = n_free > 0? (A.transpose()*A).ldlt().solve(A.transpose()*b).eval()
+                                  : Eigen::MatrixXd(0, dim);
+    for (int j=0; j<2; ++j) {
+      int knot = j==0? k0 : k1;
+      if (is_free.at(j)) {
+        fit_pos.col(j) = x.row(col.at(j)).transpose();
+        fit_vel.col(j) = x.row(col.at(j)+1).transpose();
+      } else {
+        fit_pos.col(j) = pos.col(knot);
+        fit_vel.col(j) = vel.col(knot);
+      }
+    }
+
+    double max_error = n_free > 0? (A*x - b).rowwise().norm().maxCoeff()
+                                 : b.rowwise().norm().maxCoeff();
+    return max_error;
+  };
+
+  // (error, knot, version), smallest error first
+  using Candidate = std::tuple<double, int, int>;
+  std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+  for (int k=1; k<n_knots-1; ++k)
+    queue.emplace(removal_error(k), k, 0);
+
+  while (!queue.empty()) {
+    double error; int k, ver;
+    std::tie(error, k, ver) = queue.top();
+    queue.pop();
+
+    if (removed.at(k) || ver != version.at(k))
+      continue; // outdated, neighbours changed since.
+    if (error > tolerance)
+      break;
+
+    removal_error(k); // the fit of this candidate
+    removed.at(k) = true;
+    int k0 = prev.at(k), k1 = next.at(k);
+    pos.col(k0) = fit_pos.col(0);
+    vel.col(k0) = fit_vel.col(0);
+    pos.col(k1) = fit_pos.col(1);
+    vel.col(k1) = fit_vel.col(1);
+    next.at(k0) = k1;
+    prev.at(k1) = k0;
+
+    // the candidates whose fit involves the changed knots.
+    int first = k0, last = k1;
+    for (int j=0; j<2; ++j) {
+      first = std::max(0, prev.at(std::max(0, first)));
+      last  = std::min(n_knots-1, next.at(std::min(n_knots-1, last)));
+    }
+    for (int nb=first; nb<=last; nb = nb<n_knots-1? next.at(nb) : n_knots) {
+      if (nb == 0 || nb == n_knots-1 || removed.at(nb))
+        continue;
+      queue.emplace(removal_error(nb), nb, ++version.at(nb));
+    }
+  }
+
+  CubicHermiteSpline::VecTimes times;
+  std::vector<int> kept;
+  for (int k=0; k<n_knots; k=next.at(k)) {
+    times.push_back(knot_times.at(k));
+    kept.push_back(k);
+  }
+
+  Eigen::MatrixXd new_pos(dim, kept.size()), new_vel(dim, kept.size());
+  for (int i=0; i<kept.size(); ++i) {
+    new_pos.col(i) = pos.col(kept.at(i));
+    new_vel.col(i) = vel.col(kept.at(i));
+  }
+
+  return CubicHermiteSpline(times, new_pos, new_vel);
+}
+
+Trajectory
+CompressTrajectory (const Trajectory& trajectory,
+                    const CompressionTolerance& tol)
+{
+  int n = tol.samples_per_polynomial_;
+
+  Trajectory c = trajectory;
+  c.base_linear_  = CompressSpline(trajectory.base_linear_, tol.position_, n);
+  c.base_angular_ = CompressSpline(trajectory.base_angular_, tol.orientation_, n);
+
+  for (int ee=0; ee<trajectory.GetEECount(); ++ee) {
+    c.ee_motion_.at(ee) = CompressSpline(trajectory.ee_motion_.at(ee), tol.position_, n);
+    c.ee_force_.at(ee)  = CompressSpline(trajectory.ee_force_.at(ee), tol.force_, n);
+  }
+
+  return c;
+}
+
+Trajectory
+CompressTrajectory (const SplineHolder& splines,
+                    const CompressionTolerance& tolerance)
+{
+  return CompressTrajectory(Trajectory(splines), tolerance);
+}
+
+int
+GetKnotCount (const Trajectory& trajectory)
+{
+  int count = trajectory.base_linear_.GetKnotCount()
+            + trajectory.base_angular_.GetKnotCount();
+
+  for (int ee=0; ee<trajectory.GetEECount(); ++ee)
+    count += trajectory.ee_motion_.at(ee).GetKnotCount()
+           + trajectory.ee_force_.at(ee).GetKnotCount();
+
+  return count;
+}
+
+} /* namespace towr */
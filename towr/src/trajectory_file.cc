@@ -0,0 +1,410 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/io/trajectory_file.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace towr {
+namespace trajectory_file {
+
+static std::vector<std::pair<std::string, const CubicHermiteSpline*>>
+GetNamedSplines (const Trajectory& traj)
+{
+  std::vector<std::pair<std::string, const CubicHermiteSpline*>> splines;
+  splines.push_back({"base_lin", &traj.base_linear_});
+  splines.push_back({"base_ang", &traj.base_angular_});
+  for (int ee=0; ee<traj.GetEECount(); ++ee) {
+    splines.push_back({"ee" + std::to_string(ee) + "_motion", &traj.ee_motion_.at(ee)});
+    splines.push_back({"ee" + std::to_string(ee) + "_force",  &traj.ee_force_.at(ee)});
+  }
+
+  return splines;
+}
+
+static std::vector<double>
+ToVector (const Eigen::VectorXd& v)
+{
+  return std::vector<double>(v.data(), v.data()+v.size());
+}
+
+Columns
+GetKnotColumns (const Trajectory& traj)
+{
+  Columns columns;
+
+  for (const auto& s : GetNamedSplines(traj)) {
+    const CubicHermiteSpline& spline = *s.second;
+    columns.push_back({s.first + "/t", spline.GetKnotTimes()});
+    for (int dim=0; dim<spline.GetDim(); ++dim)
+      columns.push_back({s.first + "/p" + std::to_string(dim), ToVector(spline.GetKnotPositions().row(dim))});
+    for (int dim=0; dim<spline.GetDim(); ++dim)
+      columns.push_back({s.first + "/v" + std::to_string(dim), ToVector(spline.GetKnotVelocities().row(dim))});
+    if (spline.IsQuintic())
+      for (int dim=0; dim<spline.GetDim(); ++dim)
+        columns.push_back({s.first + "/a" + std::to_string(dim), ToVector(spline.GetKnotAccelerations().row(dim))});
+  }
+
+  for (int ee=0; ee<traj.GetEECount(); ++ee) {
+    std::string name = "ee" + std::to_string(ee) + "_contact";
+    columns.push_back({name + "/durations", traj.ee_phase_durations_.at(ee)});
+    columns.push_back({name + "/start", {traj.ee_in_contact_at_start_.at(ee)? 1.0 : 0.0}});
+  }
+
+  return columns;
+}
+
+Columns
+GetSampleColumns (const Trajectory& traj, double dt)
+{
+  Columns columns;
+
+  std::vector<double> times;
+  for (double t=0.0; t<=traj.GetTotalTime()+1e-5; t+=dt)
+    times.push_back(t);
+  columns.push_back({"sample/t", times});
+
+  for (const auto& s : GetNamedSplines(traj)) {
+    const CubicHermiteSpline& spline = *s.second;
+    int n_dim = spline.GetDim();
+
+    Eigen::MatrixXd values(3*n_dim, times.size()); // pos, vel, acc stacked
+    Eigen::VectorXd pos(n_dim), vel(n_dim), acc(n_dim);
+    for (int i=0; i<times.size(); ++i) {
+      spline.GetPoint(times.at(i), pos, vel, acc);
+      values.col(i) << pos, vel, acc;
+    }
+
+    std::string derivatives = "pva";
+    for (int d=0; d<3; ++d)
+      for (int dim=0; dim<n_dim; ++dim)
+        columns.push_back({"sample/" + s.first + "/" + derivatives.at(d) + std::to_string(dim),
+                           ToVector(values.row(d*n_dim + dim))});
+  }
+
+  for (int ee=0; ee<traj.GetEECount(); ++ee) {
+    std::vector<double> contact;
+    for (double t : times)
+      contact.push_back(traj.IsContactPhase(ee, t)? 1.0 : 0.0);
+    columns.push_back({"sample/ee" + std::to_string(ee) + "_contact", contact});
+  }
+
+  return columns;
+}
+
+} /* namespace trajectory_file */
+
+
+using namespace trajectory_file;
+
+TrajectoryFileWriter::TrajectoryFileWriter (const std::string& path)
+{
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_)
+    throw std::runtime_error("trajectory file " + path + " can't be opened!");
+
+  FileHeader header;
+  std::memcpy(header.magic_, kMagic, sizeof(kMagic));
+  header.version_  = kVersion;
+  header.reserved_ = 0;
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+uint64_t
+TrajectoryFileWriter::Append (const Trajectory& trajectory,
+                              double sample_dt,
+                              double stamp)
+{
+  Columns columns = GetKnotColumns(compress_? CompressTrajectory(trajectory, tolerance_)
+                                            : trajectory);
+
+  if (sample_dt > 0.0) {
+    Columns samples = GetSampleColumns(trajectory, sample_dt);
+    columns.insert(columns.end(), samples.begin(), samples.end());
+  }
+
+  return Append(columns, trajectory.GetEECount(), stamp);
+}
+
+void
+TrajectoryFileWriter::SetCompression (const CompressionTolerance& tolerance)
+{
+  compress_  = true;
+  tolerance_ = tolerance;
+}
+
+uint64_t
+TrajectoryFileWriter::Append (const Columns& columns, int ee_count, double stamp)
+{
+  RecordHeader header;
+  header.id_           = record_count_++;
+  header.stamp_        = stamp;
+  header.ee_count_     = ee_count;
+  header.column_count_ = columns.size();
+
+  std::vector<ColumnInfo> infos(columns.size());
+  uint64_t offset = sizeof(RecordHeader) + infos.size()*sizeof(ColumnInfo);
+  for (int c=0; c<columns.size(); ++c) {
+    const std::string& name = columns.at(c).first;
+    if (name.size() >= sizeof(ColumnInfo::name_))
+      throw std::runtime_error("column name " + name + " too long!");
+
+    std::memset(infos.at(c).name_, 0, sizeof(ColumnInfo::name_));
+    std::memcpy(infos.at(c).name_, name.data(), name.size());
+    infos.at(c).offset_ = offset;
+    infos.at(c).count_  = columns.at(c).second.size();
+    offset += infos.at(c).count_*sizeof(double);
+  }
+  header.size_ = offset;
+
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file_.write(reinterpret_cast<const char*>(infos.data()), infos.size()*sizeof(ColumnInfo));
+  for (const auto& c : columns)
+    file_.write(reinterpret_cast<const char*>(c.second.data()), c.second.size()*sizeof(double));
+
+  return header.id_;
+}
+
+void
+TrajectoryFileWriter::Flush ()
+{
+  file_.flush();
+}
+
+
+TrajectoryFileReader::TrajectoryFileReader (const std::string& path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("trajectory file " + path + " can't be opened!");
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < sizeof(FileHeader)) {
+    close(fd);
+    throw std::runtime_error("trajectory file " + path + " is too short!");
+  }
+
+  void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED)
+    throw std::runtime_error("trajectory file " + path + " can't be mapped!");
+
+  data_ = static_cast<const char*>(addr);
+  size_ = st.st_size;
+
+  auto header = reinterpret_cast<const FileHeader*>(data_);
+  if (std::memcmp(header->magic_, kMagic, sizeof(kMagic)) != 0 || header->version_ != kVersion) {
+    munmap(const_cast<char*>(data_), size_);
+    throw std::runtime_error("trajectory file " + path + " has an unknown format!");
+  }
+
+  // a partially written last record (e.g. program crashed) is ignored
+  std::size_t offset = sizeof(FileHeader);
+  while (offset + sizeof(RecordHeader) <= size_) {
+    auto record = reinterpret_cast<const RecordHeader*>(data_ + offset);
+    if (record->size_ < sizeof(RecordHeader) || record->size_ > size_ - offset)
+      break;
+
+    if (!IsValidRecord(record)) {
+      munmap(const_cast<char*>(data_), size_);
+      throw std::runtime_error("trajectory file " + path + " has a corrupt record "
+                               + std::to_string(records_.size()) + "!");
+    }
+
+    records_.push_back(record);
+    offset += record->size_;
+  }
+}
+
+static const ColumnInfo*
+GetColumnInfos (const RecordHeader* record)
+{
+  return reinterpret_cast<const ColumnInfo*>(record+1);
+}
+
+bool
+TrajectoryFileReader::IsValidRecord (const RecordHeader* record)
+{
+  // all sizes are checked by division, so corrupt counts can't overflow.
+  uint64_t size = record->size_;
+  uint64_t infos_end = sizeof(RecordHeader);
+  if (record->column_count_ > (size - infos_end)/sizeof(ColumnInfo))
+    return false;
+  infos_end += record->column_count_*sizeof(ColumnInfo);
+
+  for (uint32_t c=0; c<record->column_count_; ++c) {
+    const ColumnInfo& info = GetColumnInfos(record)[c];
+    if (std::memchr(info.name_, '\0', sizeof(info.name_)) == nullptr)
+      return false;
+    if (info.offset_ < infos_end || info.offset_ > size || info.offset_%sizeof(double) != 0)
+      return false;
+    if (info.count_ > (size - info.offset_)/sizeof(double))
+      return false;
+  }
+
+  return true;
+}
+
+TrajectoryFileReader::~TrajectoryFileReader ()
+{
+  munmap(const_cast<char*>(data_), size_);
+}
+
+int
+TrajectoryFileReader::GetRecordCount () const
+{
+  return records_.size();
+}
+
+double
+TrajectoryFileReader::GetStamp (int record) const
+{
+  return records_.at(record)->stamp_;
+}
+
+std::vector<std::string>
+TrajectoryFileReader::GetColumnNames (int record) const
+{
+  auto r = records_.at(record);
+  std::vector<std::string> names;
+  for (int c=0; c<r->column_count_; ++c)
+    names.push_back(GetColumnInfos(r)[c].name_);
+
+  return names;
+}
+
+const double*
+TrajectoryFileReader::GetColumn (int record, const std::string& name,
+                                 uint64_t& count) const
+{
+  auto r = records_.at(record);
+  for (int c=0; c<r->column_count_; ++c) {
+    const ColumnInfo& info = GetColumnInfos(r)[c];
+    if (name == info.name_) {
+      count = info.count_;
+      return reinterpret_cast<const double*>(reinterpret_cast<const char*>(r) + info.offset_);
+    }
+  }
+
+  count = 0;
+  return nullptr;
+}
+
+bool
+TrajectoryFileReader::HasSamples (int record) const
+{
+  uint64_t count;
+  return GetColumn(record, "sample/t", count) != nullptr;
+}
+
+Trajectory
+TrajectoryFileReader::GetTrajectory (int record) const
+{
+  auto column = [&](const std::string& name, uint64_t expected_count = 0) {
+    uint64_t count;
+    const double* values = GetColumn(record, name, count);
+    if (!values)
+      throw std::runtime_error("trajectory file has no column " + name + "!");
+    if (expected_count > 0 && count != expected_count)
+      throw std::runtime_error("trajectory file column " + name + " has the wrong size!");
+    return std::vector<double>(values, values+count);
+  };
+
+  auto spline = [&](const std::string& name, int n_dim) {
+    auto t = column(name + "/t");
+    if (t.size() < 2)
+      throw std::runtime_error("trajectory file column " + name + "/t has less than two knots!");
+    uint64_t count;
+    bool is_quintic = GetColumn(record, name + "/a0", count) != nullptr;
+    Eigen::MatrixXd p(n_dim, t.size()), v(n_dim, t.size()), a(n_dim, is_quintic? t.size() : 0);
+    for (int dim=0; dim<n_dim; ++dim) {
+      p.row(dim) = Eigen::Map<const Eigen::RowVectorXd>(column(name + "/p" + std::to_string(dim), t.size()).data(), t.size());
+      v.row(dim) = Eigen::Map<const Eigen::RowVectorXd>(column(name + "/v" + std::to_string(dim), t.size()).data(), t.size());
+      if (is_quintic)
+        a.row(dim) = Eigen::Map<const Eigen::RowVectorXd>(column(name + "/a" + std::to_string(dim), t.size()).data(), t.size());
+    }
+    return is_quintic? CubicHermiteSpline(t, p, v, a) : CubicHermiteSpline(t, p, v);
+  };
+
+  Trajectory traj;
+  traj.base_linear_  = spline("base_lin", 3);
+  traj.base_angular_ = spline("base_ang", 3);
+  for (int ee=0; ee<records_.at(record)->ee_count_; ++ee) {
+    std::string name = "ee" + std::to_string(ee);
+    traj.ee_motion_.push_back(spline(name + "_motion", 3));
+    traj.ee_force_.push_back(spline(name + "_force", 3));
+    traj.ee_phase_durations_.push_back(column(name + "_contact/durations"));
+    traj.ee_in_contact_at_start_.push_back(column(name + "_contact/start").front() != 0.0);
+  }
+
+  return traj;
+}
+
+
+void
+WriteCsv (const TrajectoryFileReader& reader, int record,
+          std::ostream& out, double dt)
+{
+  std::vector<std::string> names;
+  std::vector<const double*> values;
+  uint64_t n_rows = 0;
+
+  Columns sampled; // only filled if the record doesn't contain samples
+  if (reader.HasSamples(record)) {
+    for (const auto& name : reader.GetColumnNames(record)) {
+      if (name.compare(0, 7, "sample/") == 0) {
+        names.push_back(name.substr(7));
+        values.push_back(reader.GetColumn(record, name, n_rows));
+      }
+    }
+  } else {
+    sampled = GetSampleColumns(reader.GetTrajectory(record), dt);
+    for (const auto& c : sampled) {
+      names.push_back(c.first.substr(7));
+      values.push_back(c.second.data());
+      n_rows = c.second.size();
+    }
+  }
+
+  for (int c=0; c<names.size(); ++c)
+    out << names.at(c) << (c+1<names.size()? "," : "\n");
+
+  out.precision(17); // round-trip exact
+  for (uint64_t row=0; row<n_rows; ++row)
+    for (int c=0; c<values.size(); ++c)
+      out << values.at(c)[row] << (c+1<values.size()? "," : "\n");
+}
+
+} /* namespace towr */
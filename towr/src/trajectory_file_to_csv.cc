@@ -0,0 +1,60 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <iostream>
+#include <string>
+
+#include <towr/io/trajectory_file.h>
+
+/**
+ * Prints one trajectory of a towr trajectory file as CSV, e.g. for plotting:
+ *
+ *   towr-trajectory-to-csv <file> [record, default last] [dt, default 0.01] > out.csv
+ *
+ * Uses the stored samples if available, otherwise samples the exact splines.
+ */
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file> [record] [dt]" << std::endl;
+    return 1;
+  }
+
+  towr::TrajectoryFileReader reader(argv[1]);
+  if (reader.GetRecordCount() == 0) {
+    std::cerr << "No trajectories in " << argv[1] << std::endl;
+    return 1;
+  }
+
+  int record = argc > 2? std::stoi(argv[2]) : reader.GetRecordCount()-1;
+  double dt  = argc > 3? std::stod(argv[3]) : 0.01;
+
+  towr::WriteCsv(reader, record, std::cout, dt);
+  return 0;
+}
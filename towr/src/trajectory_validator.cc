@@ -0,0 +1,226 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/planning/trajectory_validator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include <towr/variables/cartesian_dimensions.h>
+
+namespace towr {
+
+namespace {
+
+// Same as the EulerConverter (Euler ZYX), but dense and fixed-size so
+// nothing is allocated.
+Eigen::Matrix3d
+GetRotationMatrixBaseToWorld (const Eigen::VectorXd& xyz)
+{
+  double x = xyz(X);
+  double y = xyz(Y);
+  double z = xyz(Z);
+
+  Eigen::Matrix3d M;
+  M << cos(y)*cos(z), cos(z)*sin(x)*sin(y) - cos(x)*sin(z), sin(x)*sin(z) + cos(x)*cos(z)*sin(y),
+       cos(y)*sin(z), cos(x)*cos(z) + sin(x)*sin(y)*sin(z), cos(x)*sin(y)*sin(z) - cos(z)*sin(x),
+             -sin(y),                        cos(y)*sin(x),                        cos(x)*cos(y);
+  return M;
+}
+
+// Euler ZYX rates to angular velocity
+Eigen::Matrix3d
+GetM (const Eigen::VectorXd& xyz)
+{
+  double y = xyz(Y);
+  double z = xyz(Z);
+
+  Eigen::Matrix3d M;
+  M << cos(y)*cos(z), -sin(z), 0.0,
+       cos(y)*sin(z),  cos(z), 0.0,
+             -sin(y),     0.0, 1.0;
+  return M;
+}
+
+Eigen::Matrix3d
+GetMdot (const Eigen::VectorXd& xyz, const Eigen::VectorXd& xyz_d)
+{
+  double y  = xyz(Y);
+  double z  = xyz(Z);
+  double yd = xyz_d(Y);
+  double zd = xyz_d(Z);
+
+  Eigen::Matrix3d Mdot;
+  Mdot << -cos(z)*sin(y)*yd - cos(y)*sin(z)*zd, -cos(z)*zd, 0.0,
+           cos(y)*cos(z)*zd - sin(y)*sin(z)*yd, -sin(z)*zd, 0.0,
+                                   -cos(y)*yd,         0.0, 0.0;
+  return Mdot;
+}
+
+} // namespace
+
+
+TrajectoryValidator::TrajectoryValidator (const RobotModel& model,
+                                          const HeightMap::Ptr& terrain,
+                                          const TrajectoryValidatorOptions& options)
+    : options_(options)
+{
+  dynamic_model_ = model.dynamic_model_->Clone();
+  nominal_ee_pos_B_ = model.kinematic_model_->GetNominalStanceInBase();
+  max_deviation_from_nominal_ = model.kinematic_model_->GetMaximumDeviationFromNominal();
+  terrain_ = terrain;
+
+  for (auto v : {&base_pos_, &base_vel_, &base_acc_, &euler_, &euler_vel_,
+                 &euler_acc_, &pos_, &vel_, &acc_})
+    v->resize(k3D);
+
+  ee_pos_.resize(nominal_ee_pos_B_.size());
+  ee_force_.resize(nominal_ee_pos_B_.size());
+}
+
+void
+TrajectoryValidator::SetTerrain (const HeightMap::Ptr& terrain)
+{
+  terrain_ = terrain;
+}
+
+TrajectoryValidator::Result
+TrajectoryValidator::Validate (const Trajectory& motion, double t_start) const
+{
+  if (motion.GetEECount() != static_cast<int>(nominal_ee_pos_B_.size()))
+    throw std::runtime_error("motion and robot have different number of endeffectors!");
+
+  Result r;
+  double T = motion.GetTotalTime();
+  int n_steps = std::max(0.0, std::ceil((T-t_start)/options_.dt_));
+  for (int i=0; i<=n_steps; ++i) {
+    double t = std::min(t_start + i*options_.dt_, T);
+
+    motion.base_linear_.GetPoint(t, base_pos_, base_vel_, base_acc_);
+    motion.base_angular_.GetPoint(t, euler_, euler_vel_, euler_acc_);
+    w_R_b_ = GetRotationMatrixBaseToWorld(euler_);
+
+    for (int ee=0; ee<motion.GetEECount(); ++ee)
+      if (CheckEndeffector(motion, ee, t, r))
+        return r;
+
+    if (CheckDynamics(t, r))
+      return r;
+  }
+
+  return r;
+}
+
+bool
+TrajectoryValidator::CheckEndeffector (const Trajectory& motion, int ee,
+                                       double t, Result& r) const
+{
+  const double tol_d = options_.distance_tolerance_;
+  const double tol_f = options_.force_tolerance_;
+
+  motion.ee_motion_.at(ee).GetPoint(t, pos_, vel_, acc_);
+  ee_pos_.at(ee) = pos_;
+  motion.ee_force_.at(ee).GetPoint(t, pos_, vel_, acc_);
+  ee_force_.at(ee) = pos_;
+
+  const Eigen::Vector3d& p = ee_pos_.at(ee);
+  const Eigen::Vector3d& f = ee_force_.at(ee);
+
+  // range of motion box around the nominal stance in base frame
+  Eigen::Vector3d p_B = w_R_b_.transpose()*(p - base_pos_) - nominal_ee_pos_B_.at(ee);
+  double rom = (p_B.cwiseAbs() - max_deviation_from_nominal_).maxCoeff();
+  if (Exceeds(rom, tol_d, RangeOfMotion, ee, t, r))
+    return true;
+
+  double height = p.z() - terrain_->GetHeight(p.x(), p.y());
+  bool in_contact = motion.IsContactPhase(ee, t);
+
+  if (!in_contact)
+    return Exceeds(-height, tol_d, Terrain, ee, t, r)
+        || Exceeds(f.norm(), tol_f, Friction, ee, t, r);
+
+  if (Exceeds(std::abs(height), tol_d, Terrain, ee, t, r))
+    return true;
+
+  Eigen::Vector3d n  = terrain_->GetNormalizedBasis(HeightMap::Normal,   p.x(), p.y());
+  Eigen::Vector3d t1 = terrain_->GetNormalizedBasis(HeightMap::Tangent1, p.x(), p.y());
+  Eigen::Vector3d t2 = terrain_->GetNormalizedBasis(HeightMap::Tangent2, p.x(), p.y());
+  double mu = terrain_->GetFrictionCoeff();
+  double fn = f.dot(n);
+
+  double friction = std::max(-fn, fn - options_.force_limit_);
+  friction = std::max(friction, std::abs(f.dot(t1)) - mu*fn);
+  friction = std::max(friction, std::abs(f.dot(t2)) - mu*fn);
+  return Exceeds(friction, tol_f, Friction, ee, t, r);
+}
+
+bool
+TrajectoryValidator::CheckDynamics (double t, Result& r) const
+{
+  Eigen::Matrix3d M = GetM(euler_);
+  Eigen::Vector3d omega = M*euler_vel_;
+  Eigen::Vector3d omega_dot = GetMdot(euler_, euler_vel_)*euler_vel_ + M*euler_acc_;
+
+  dynamic_model_->SetCurrent(base_pos_, base_acc_, w_R_b_, omega, omega_dot,
+                             ee_force_, ee_pos_);
+  double violation = dynamic_model_->GetDynamicViolation().cwiseAbs().maxCoeff();
+  return Exceeds(violation, options_.dynamic_tolerance_, Dynamics, -1, t, r);
+}
+
+bool
+TrajectoryValidator::Exceeds (double violation, double tolerance, Check check,
+                              int ee, double t, Result& r)
+{
+  if (!(violation <= tolerance)) { // also catches NaN
+    r.check_ = check;
+    r.ee_ = ee;
+    r.time_ = t;
+    r.magnitude_ = violation - tolerance;
+    return true;
+  }
+
+  return false;
+}
+
+double
+TrajectoryValidator::GetDeviation (const Trajectory& motion, double t,
+                                   const BaseState& state)
+{
+  State lin = motion.base_linear_.GetPoint(t);
+  State ang = motion.base_angular_.GetPoint(t);
+
+  double d = (lin.p() - state.lin.p()).cwiseAbs().maxCoeff();
+  d = std::max(d, (lin.v() - state.lin.v()).cwiseAbs().maxCoeff());
+  d = std::max(d, (ang.p() - state.ang.p()).cwiseAbs().maxCoeff());
+  d = std::max(d, (ang.v() - state.ang.v()).cwiseAbs().maxCoeff());
+  return d;
+}
+
+} /* namespace towr */
@@ -0,0 +1,132 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <ifopt/problem.h>
+
+#include <towr/nlp_formulation.h>
+#include <towr/initialization/gait_generator.h>
+#include <towr/planning/trajectory_validator.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+using namespace towr;
+using Clock = std::chrono::steady_clock;
+
+static double
+GetMicroseconds (Clock::time_point start)
+{
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+/**
+ * Measures how long checking a motion before a replan takes:
+ *
+ *   towr-validator-benchmark [duration, default 3s] [repetitions, default 1000]
+ *
+ * For each robot walking over flat ground, the initial guess of the
+ * NlpFormulation is validated with infinite tolerances, so every point of
+ * the default 10ms grid is evaluated (the worst case, a valid motion).
+ * Prints the mean and worst time of one Validate().
+ */
+int main(int argc, char *argv[])
+{
+  double duration = argc > 1? std::stod(argv[1]) : 3.0;
+  int n_repetitions = argc > 2? std::stoi(argv[2]) : 1000;
+
+  struct Case { std::string name_; RobotModel::Robot robot_; };
+  std::vector<Case> cases = { {"monoped",   RobotModel::Monoped},
+                              {"biped",     RobotModel::Biped},
+                              {"quadruped", RobotModel::Anymal} };
+
+  TrajectoryValidatorOptions options;
+  options.dynamic_tolerance_  = std::numeric_limits<double>::infinity();
+  options.distance_tolerance_ = std::numeric_limits<double>::infinity();
+  options.force_tolerance_    = std::numeric_limits<double>::infinity();
+
+  std::cout << std::left << std::setw(11) << "robot" << std::right
+            << std::setw(8) << "points" << std::setw(16) << "validate [us]"
+            << std::setw(11) << "worst" << std::endl;
+
+  for (const auto& c : cases) {
+    NlpFormulation formulation;
+    formulation.model_ = RobotModel(c.robot_);
+    formulation.terrain_ = std::make_shared<FlatGround>(0.0);
+
+    auto nominal_stance_B = formulation.model_.kinematic_model_->GetNominalStanceInBase();
+    formulation.initial_ee_W_ = nominal_stance_B;
+    for (auto& ee : formulation.initial_ee_W_)
+      ee.z() = 0.0;
+    formulation.initial_base_.lin.at(kPos).z() = -nominal_stance_B.front().z();
+    formulation.final_base_.lin.at(kPos) << 1.0, 0.0, -nominal_stance_B.front().z();
+
+    int n_ee = nominal_stance_B.size();
+    auto gait_gen = GaitGenerator::MakeGaitGenerator(n_ee);
+    gait_gen->SetCombo(GaitGenerator::C0);
+    for (int ee=0; ee<n_ee; ++ee) {
+      formulation.params_.ee_phase_durations_.push_back(gait_gen->GetPhaseDurations(duration, ee));
+      formulation.params_.ee_in_contact_at_start_.push_back(gait_gen->IsInContactAtStart(ee));
+    }
+
+    SplineHolder splines;
+    ifopt::Problem nlp;
+    for (auto v : formulation.GetVariableSets(splines))
+      nlp.AddVariableSet(v);
+    Trajectory motion(splines);
+
+    TrajectoryValidator validator(formulation.model_, formulation.terrain_, options);
+    std::vector<double> times;
+    for (int i=0; i<n_repetitions; ++i) {
+      auto start = Clock::now();
+      TrajectoryValidator::Result r = validator.Validate(motion);
+      times.push_back(GetMicroseconds(start));
+      if (!r.IsValid())
+        std::cerr << "unexpected violation of " << c.name_ << std::endl;
+    }
+
+    double mean = 0.0;
+    for (double t : times)
+      mean += t/times.size();
+
+    int n_points = std::ceil(motion.GetTotalTime()/options.dt_) + 1;
+    std::cout << std::left << std::setw(11) << c.name_ << std::right
+              << std::setw(8) << n_points << std::fixed << std::setprecision(1)
+              << std::setw(16) << mean << std::setw(11) << *std::max_element(times.begin(), times.end())
+              << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <ifopt/problem.h>
+#include <ifopt/solver.h>
+
+#include <towr/planning/async_planner.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+// stand-in for a solver, which iterates until it is released, so the test
+// decides when a solve finishes. It checks for cancellation (through
+// SetVariables) after reading the release flag, so a solve that is
+// cancelled before the release can never finish.
+class GatedSolver : public ifopt::Solver {
+public:
+  void Solve (ifopt::Problem& nlp) override
+  {
+    ++started_;
+    Eigen::VectorXd x = nlp.GetVariableValues();
+    while (true) {
+      bool is_released = released_;
+      nlp.SetVariables(x.data());
+      nlp.SaveCurrent();
+      if (is_released)
+        return;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  void WaitUntilStarted (int n_solves) const
+  {
+    while (started_ < n_solves)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  std::atomic<int> started_{0};
+  std::atomic<bool> released_{false};
+};
+
+static NlpFormulation
+GetGoal (double goal_x)
+{
+  return GetBipedFormulation(RobotModel(RobotModel::Biped),
+                             std::make_shared<FlatGround>(), goal_x);
+}
+
+TEST(AsyncPlannerTest, NewerGoalCancelsRunningAndPendingGoals)
+{
+  auto solver = std::make_shared<GatedSolver>();
+  AsyncPlanner planner(solver);
+  EXPECT_FALSE(planner.GetLatestPlan().IsValid());
+
+  planner.RequestPlan(GetGoal(0.1));
+  solver->WaitUntilStarted(1);
+  EXPECT_TRUE(planner.IsBusy());
+
+  // the second goal cancels the first one, and is itself either replaced
+  // while waiting or cancelled while running.
+  planner.RequestPlan(GetGoal(0.2));
+  int last_id = planner.RequestPlan(GetGoal(0.3));
+  solver->released_ = true;
+  planner.WaitUntilIdle();
+  EXPECT_FALSE(planner.IsBusy());
+
+  // only the newest goal was ever published
+  auto plan = planner.GetLatestPlan();
+  ASSERT_TRUE(plan.IsValid());
+  EXPECT_EQ(1, plan.GetVersion());
+  EXPECT_EQ(last_id, plan->goal_id_);
+  EXPECT_EQ(SolveResult::Finished, plan->result_.status_);
+  double T = plan->trajectory_.GetTotalTime();
+  EXPECT_NEAR(0.3, plan->trajectory_.base_linear_.GetPoint(T).p().x(), 1e-6);
+}
+
+TEST(AsyncPlannerTest, WithoutPreemptionOnlyPendingGoalIsReplaced)
+{
+  auto solver = std::make_shared<GatedSolver>();
+  AsyncPlanner planner(solver, std::numeric_limits<double>::infinity(), false);
+
+  int first_id = planner.RequestPlan(GetGoal(0.1));
+  solver->WaitUntilStarted(1);
+  planner.RequestPlan(GetGoal(0.2)); // replaced before it's started
+  int last_id = planner.RequestPlan(GetGoal(0.3));
+
+  // the running goal finishes and is published, then the newest one.
+  solver->released_ = true;
+  planner.WaitUntilIdle();
+
+  EXPECT_EQ(2, solver->started_);
+  auto plan = planner.GetLatestPlan();
+  ASSERT_TRUE(plan.IsValid());
+  EXPECT_EQ(2, plan.GetVersion());
+  EXPECT_EQ(last_id, plan->goal_id_);
+  EXPECT_NE(first_id, last_id);
+}
+
+} /* namespace towr */
@@ -0,0 +1,101 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <towr/variables/nodes_variables_all.h>
+#include <towr/variables/spline_holder.h>
+
+namespace towr {
+
+class BaseKinematicsCacheTest : public ::testing::Test {
+protected:
+  void SetUp () override
+  {
+    std::vector<double> durations(5, 0.2);
+    int n_nodes = durations.size() + 1;
+    lin_ = std::make_shared<NodesVariablesAll>(n_nodes, k3D, "lin");
+    ang_ = std::make_shared<NodesVariablesAll>(n_nodes, k3D, "ang");
+    lin_->SetVariables(Eigen::VectorXd::Random(lin_->GetRows()));
+    ang_->SetVariables(0.3*Eigen::VectorXd::Random(ang_->GetRows()));
+
+    linear_  = std::make_shared<NodeSpline>(lin_.get(), durations);
+    angular_ = std::make_shared<NodeSpline>(ang_.get(), durations);
+    cache_   = std::make_shared<BaseKinematicsCache>(linear_, angular_);
+  }
+
+  void ExpectUpToDate (double t) const
+  {
+    EulerConverter euler(angular_);
+    const BaseKinematics& k = cache_->GetBaseKinematics(t);
+    EXPECT_TRUE(k.lin_.p().isApprox(linear_->GetPoint(t).p()));
+    EXPECT_TRUE(k.lin_.a().isApprox(linear_->GetPoint(t).a()));
+    EXPECT_TRUE(Eigen::Matrix3d(k.w_R_b_).isApprox(Eigen::Matrix3d(euler.GetRotationMatrixBaseToWorld(t))));
+    EXPECT_TRUE(k.omega_.isApprox(euler.GetAngularVelocityInWorld(t)));
+    EXPECT_TRUE(k.omega_dot_.isApprox(euler.GetAngularAccelerationInWorld(t)));
+
+    Eigen::Vector3d v(0.1, -0.4, 0.7);
+    Eigen::MatrixXd jac(cache_->DerivOfRotVecMult(t, v, true));
+    EXPECT_TRUE(jac.isApprox(Eigen::MatrixXd(euler.DerivOfRotVecMult(t, v, true))));
+  }
+
+  NodesVariablesAll::Ptr lin_, ang_;
+  NodeSpline::Ptr linear_, angular_;
+  BaseKinematicsCache::Ptr cache_;
+};
+
+TEST_F(BaseKinematicsCacheTest, ComputesEachTimeOnce)
+{
+  for (double t : {0.0, 0.3, 0.75})
+    ExpectUpToDate(t);
+  int n_computed = cache_->GetComputeCount();
+
+  // repeated queries, also with rounding errors in the times
+  for (double t : {0.0, 0.1+0.2, 0.75}) {
+    cache_->GetBaseKinematics(t);
+    cache_->GetDerivOfRotationWrtNodes(t);
+  }
+  EXPECT_EQ(n_computed, cache_->GetComputeCount());
+}
+
+TEST_F(BaseKinematicsCacheTest, InvalidatedByNewVariables)
+{
+  for (double t : {0.0, 0.3, 0.75})
+    ExpectUpToDate(t);
+
+  ang_->SetVariables(0.3*Eigen::VectorXd::Random(ang_->GetRows()));
+  for (double t : {0.0, 0.3, 0.75})
+    ExpectUpToDate(t);
+
+  lin_->SetVariables(Eigen::VectorXd::Random(lin_->GetRows()));
+  for (double t : {0.0, 0.3, 0.75})
+    ExpectUpToDate(t);
+}
+
+} /* namespace towr */
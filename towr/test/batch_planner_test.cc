@@ -0,0 +1,111 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <ifopt/problem.h>
+#include <ifopt/solver.h>
+
+#include <towr/planning/batch_planner.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+// deterministic stand-in for a solver, whose iterates depend on the
+// values of all constraints, including the dynamics.
+class FixedStepSolver : public ifopt::Solver {
+public:
+  void Solve (ifopt::Problem& nlp) override
+  {
+    Eigen::VectorXd x = nlp.GetVariableValues();
+    for (int iter=0; iter<5; ++iter) {
+      Eigen::VectorXd g = nlp.EvaluateConstraints(x.data());
+      x.array() += 1e-8*g.sum();
+      nlp.SetVariables(x.data());
+      nlp.SaveCurrent();
+    }
+  }
+};
+
+static std::vector<NlpFormulation>
+GetProblems (int n_problems)
+{
+  // shared read-only by all problems
+  RobotModel model(RobotModel::Biped);
+  auto terrain = std::make_shared<Block>();
+
+  std::vector<NlpFormulation> problems;
+  for (int i=0; i<n_problems; ++i) {
+    auto f = GetBipedFormulation(model, terrain, 0.1*i);
+    problems.push_back(f);
+  }
+
+  return problems;
+}
+
+TEST(BatchPlannerTest, ResultsInInputOrderAndIndependentOfThreads)
+{
+  auto problems = GetProblems(12);
+  auto factory = []() { return std::make_shared<FixedStepSolver>(); };
+
+  auto sequential = BatchPlanner(factory, 1).Solve(problems);
+  auto parallel   = BatchPlanner(factory, 4).Solve(problems);
+
+  ASSERT_EQ(problems.size(), parallel.size());
+  for (std::size_t i=0; i<problems.size(); ++i) {
+    EXPECT_EQ("", parallel.at(i).error_);
+    EXPECT_EQ(SolveResult::Finished, parallel.at(i).result_.status_);
+
+    // result belongs to the problem at the same index
+    const Trajectory& p = parallel.at(i).trajectory_;
+    double T = p.GetTotalTime();
+    EXPECT_NEAR(0.1*i, p.base_linear_.GetPoint(T).p().x(), 1e-3);
+
+    // bitwise identical, so no state was shared between threads
+    const Trajectory& s = sequential.at(i).trajectory_;
+    EXPECT_EQ(s.base_linear_.GetKnotPositions(), p.base_linear_.GetKnotPositions());
+    EXPECT_EQ(s.base_angular_.GetKnotPositions(), p.base_angular_.GetKnotPositions());
+    for (int ee=0; ee<p.GetEECount(); ++ee)
+      EXPECT_EQ(s.ee_force_.at(ee).GetKnotPositions(), p.ee_force_.at(ee).GetKnotPositions());
+  }
+}
+
+TEST(BatchPlannerTest, SharedDynamicModelIsCloned)
+{
+  RobotModel model(RobotModel::Biped);
+  auto clone = model.dynamic_model_->Clone();
+
+  EXPECT_NE(model.dynamic_model_, clone);
+  EXPECT_EQ(model.dynamic_model_->m(), clone->m());
+  EXPECT_EQ(model.dynamic_model_->GetEECount(), clone->GetEECount());
+}
+
+} /* namespace towr */
@@ -0,0 +1,128 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cstdio>
+
+#include <gtest/gtest.h>
+
+#include <towr/io/callback_trace.h>
+#include <towr/planning/planning_server.h>
+
+namespace towr {
+
+using namespace callback_trace;
+
+class CallbackTraceTest : public ::testing::Test {
+protected:
+  void SetUp () override
+  {
+    request_ = planning_protocol::PlanRequest();
+    request_.robot_ = RobotModel::Monoped;
+    request_.total_duration_  = 1.0;
+    request_.initial_base_[2] = 0.5;
+    request_.final_base_[0]   = 0.5;
+    request_.final_base_[2]   = 0.5;
+  }
+
+  void TearDown () override
+  {
+    std::remove(path_.c_str());
+  }
+
+  // the problem of the request, with a cost so all callbacks are used.
+  void Build (SplineHolder& solution, ifopt::Problem& nlp) const
+  {
+    NlpFormulation f = PlanningServer::GetFormulation(request_, RobotModel(RobotModel::Monoped),
+                                                      HeightMap::MakeTerrain(HeightMap::FlatID));
+    f.params_.costs_.push_back({Parameters::ForcesCostID, 1.0});
+    for (auto c : f.GetVariableSets(solution))
+      nlp.AddVariableSet(c);
+    for (auto c : f.GetConstraints(solution))
+      nlp.AddConstraintSet(c);
+    for (auto c : f.GetCosts())
+      nlp.AddCostSet(c);
+  }
+
+  planning_protocol::PlanRequest request_;
+  std::string path_ = "callback_trace_test.trace";
+};
+
+TEST_F(CallbackTraceTest, RecordAndReplay)
+{
+  SplineHolder solution, solution_probed;
+  ifopt::Problem nlp, nlp_probed;
+  Build(solution, nlp);
+  Build(solution_probed, nlp_probed);
+
+  int n = nlp_probed.GetNumberOfOptimizationVariables();
+  auto writer = std::make_shared<CallbackTraceWriter>(path_, request_, n);
+  RecordCallbacks(nlp_probed, writer);
+
+  // the calls of a solver for two iterates, the last one only for values.
+  Eigen::VectorXd x0 = nlp_probed.GetVariableValues();
+  std::vector<Eigen::VectorXd> xs = {x0, x0 + 0.01*Eigen::VectorXd::Random(n)};
+  std::vector<Callback> expected;
+  for (const auto& x : xs) {
+    double cost = nlp_probed.EvaluateCostFunction(x.data());
+    Eigen::VectorXd grad = nlp_probed.EvaluateCostFunctionGradient(x.data());
+    Eigen::VectorXd g = nlp_probed.EvaluateConstraints(x.data());
+    expected.insert(expected.end(), {kCost, kGradient, kConstraints});
+
+    // the probes don't change any result.
+    EXPECT_EQ(nlp.EvaluateCostFunction(x.data()), cost);
+    EXPECT_EQ(nlp.EvaluateCostFunctionGradient(x.data()), grad);
+    EXPECT_EQ(nlp.EvaluateConstraints(x.data()), g);
+  }
+  nlp_probed.SetVariables(xs.front().data());
+  nlp_probed.GetJacobianOfConstraints();
+  expected.push_back(kJacobian);
+  writer->Flush();
+
+  CallbackTraceReader trace(path_);
+  EXPECT_EQ(n, trace.GetVariableCount());
+  EXPECT_EQ(request_.final_base_[0], trace.GetRequest().final_base_[0]);
+  ASSERT_EQ(expected.size(), trace.GetEventCount());
+  for (int e=0; e<trace.GetEventCount(); ++e)
+    EXPECT_EQ(expected.at(e), trace.GetCallback(e));
+  EXPECT_EQ(xs.at(1), trace.GetVariables(3));
+  EXPECT_EQ(xs.at(0), trace.GetVariables(6));
+
+  // replays on separately built problems compute identical outputs.
+  ReplayResult replay = ReplayCallbacks(trace, nlp);
+  SplineHolder solution_replay;
+  ifopt::Problem nlp_replay;
+  Build(solution_replay, nlp_replay);
+  EXPECT_EQ(replay.digests_, ReplayCallbacks(trace, nlp_replay).digests_);
+
+  EXPECT_EQ(2, replay.count_.at(kConstraints));
+  EXPECT_EQ(1, replay.count_.at(kJacobian));
+  EXPECT_NE(replay.digests_.at(0), replay.digests_.at(3)); // different x
+}
+
+} /* namespace towr */
@@ -0,0 +1,99 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <towr/planning/double_buffer.h>
+
+namespace towr {
+
+TEST(DoubleBufferTest, ReadersNeverSeeTornValues)
+{
+  // large enough that copying it isn't atomic, every element holds the version.
+  using Value = std::array<uint64_t, 256>;
+  DoubleBuffer<Value> buffer;
+  EXPECT_FALSE(buffer.Read().IsValid());
+
+  const uint64_t n_writes = 5000;
+  std::atomic<bool> done(false);
+  std::atomic<int> n_torn(0), n_backwards(0), n_reads(0);
+
+  auto read = [&]() {
+    uint64_t last_version = 0;
+    while (!done) {
+      auto handle = buffer.Read();
+      if (!handle.IsValid())
+        continue;
+
+      uint64_t version = handle.GetVersion();
+      for (uint64_t v : *handle)
+        if (v != version)
+          ++n_torn;
+      if (version < last_version)
+        ++n_backwards;
+      last_version = version;
+      ++n_reads;
+      std::this_thread::yield(); // like a control loop, which doesn't spin.
+    }
+  };
+
+  Value first;
+  first.fill(1);
+  buffer.Write(first);
+
+  std::vector<std::thread> readers;
+  for (int i=0; i<4; ++i)
+    readers.emplace_back(read);
+  while (n_reads < 4)
+    std::this_thread::yield();
+
+  for (uint64_t version=2; version<=n_writes; ++version) {
+    Value value;
+    value.fill(version);
+    buffer.Write(value);
+  }
+  done = true;
+  for (auto& r : readers)
+    r.join();
+
+  EXPECT_EQ(0, n_torn);
+  EXPECT_EQ(0, n_backwards);
+  EXPECT_GT(n_reads, 0);
+
+  auto latest = buffer.Read();
+  EXPECT_EQ(n_writes, latest.GetVersion());
+  EXPECT_EQ(n_writes, latest->front());
+}
+
+} /* namespace towr */
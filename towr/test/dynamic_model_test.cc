@@ -30,6 +30,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <gtest/gtest.h>
 
 #include <towr/models/single_rigid_body_dynamics.h>
+#include <towr/variables/nodes_variables_all.h>
+#include <towr/variables/euler_converter.h>
 
 namespace towr {
 
@@ -48,4 +50,53 @@ TEST(DynamicModelTest, TestRotations)
   // update test
 }
 
+TEST(DynamicModelTest, GeneratedKernelsMatchHandWritten)
+{
+  using Jac = DynamicModel::Jac;
+  int n_ee = 2;
+  SingleRigidBodyDynamics hand(20.0, 1.2, 5.5, 6.0, 0.1, -0.2, 0.3, n_ee);
+  SingleRigidBodyDynamics generated(hand);
+  generated.SetKernels(SingleRigidBodyDynamics::GeneratedKernels);
+
+  std::vector<double> durations(4, 0.25);
+  auto nodes = std::make_shared<NodesVariablesAll>(durations.size()+1, k3D, "ang");
+  nodes->SetVariables(0.5*Eigen::VectorXd::Random(nodes->GetRows()));
+  auto euler_spline = std::make_shared<NodeSpline>(nodes.get(), durations);
+  EulerConverter euler(euler_spline);
+
+  double t = 0.6;
+  DynamicModel::EEPos pos(n_ee), force(n_ee);
+  for (int ee=0; ee<n_ee; ++ee) {
+    pos.at(ee).setRandom();
+    force.at(ee) = 100*Eigen::Vector3d::Random();
+  }
+  for (DynamicModel* m : std::vector<DynamicModel*>{&hand, &generated})
+    m->SetCurrent(Eigen::Vector3d::Random(), Eigen::Vector3d::Random(),
+                  euler.GetRotationMatrixBaseToWorld(t),
+                  euler.GetAngularVelocityInWorld(t),
+                  euler.GetAngularAccelerationInWorld(t), force, pos);
+  // same state in both, as the random vectors differ between calls
+  generated = SingleRigidBodyDynamics(hand);
+  generated.SetKernels(SingleRigidBodyDynamics::GeneratedKernels);
+
+  auto expect_equal = [](const Jac& a, const Jac& b) {
+    EXPECT_TRUE(Eigen::MatrixXd(a).isApprox(Eigen::MatrixXd(b), 1e-10));
+  };
+
+  EXPECT_TRUE(hand.GetDynamicViolation().isApprox(generated.GetDynamicViolation()));
+
+  Jac jac_pos = Eigen::MatrixXd::Random(k3D, 7).sparseView();
+  Jac jac_acc = Eigen::MatrixXd::Random(k3D, 7).sparseView();
+  expect_equal(hand.GetJacobianWrtBaseLin(jac_pos, jac_acc),
+               generated.GetJacobianWrtBaseLin(jac_pos, jac_acc));
+  expect_equal(hand.GetJacobianWrtBaseAng(euler, t),
+               generated.GetJacobianWrtBaseAng(euler, t));
+  for (int ee=0; ee<n_ee; ++ee) {
+    expect_equal(hand.GetJacobianWrtForce(jac_pos, ee),
+                 generated.GetJacobianWrtForce(jac_pos, ee));
+    expect_equal(hand.GetJacobianWrtEEPos(jac_pos, ee),
+                 generated.GetJacobianWrtEEPos(jac_pos, ee));
+  }
+}
+
 } /* namespace xpp */
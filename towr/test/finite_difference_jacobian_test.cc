@@ -0,0 +1,190 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <ifopt/problem.h>
+
+#include <towr/constraints/finite_difference_constraint.h>
+#include <towr/variables/nodes_variables_all.h>
+#include <towr/variables/cartesian_dimensions.h>
+
+namespace towr {
+
+using Jacobian = FiniteDifferenceJacobian::Jacobian;
+using VectorXd = Eigen::VectorXd;
+
+// g_i = x_{i-1}*x_i + sin(x_{i+1}), a tridiagonal Jacobian.
+static VectorXd Banded (const VectorXd& x)
+{
+  int n = x.rows();
+  VectorXd g(n);
+  for (int i=0; i<n; ++i)
+    g(i) = (i>0? x(i-1)*x(i) : 0.0) + (i<n-1? std::sin(x(i+1)) : 0.0);
+  return g;
+}
+
+static Jacobian BandedJacobian (const VectorXd& x)
+{
+  int n = x.rows();
+  Jacobian jac(n, n);
+  for (int i=0; i<n; ++i) {
+    if (i>0) {
+      jac.coeffRef(i, i-1) = x(i);
+      jac.coeffRef(i, i)   = x(i-1);
+    }
+    if (i<n-1)
+      jac.coeffRef(i, i+1) = std::cos(x(i+1));
+  }
+  return jac;
+}
+
+TEST(FiniteDifferenceJacobianTest, ColorsIndependentOfSize)
+{
+  int n = 200;
+  Jacobian sparsity(n, n);
+  for (int i=0; i<n; ++i)
+    for (int j=std::max(0, i-1); j<=std::min(n-1, i+1); ++j)
+      sparsity.insert(i, j) = 1.0;
+
+  FiniteDifferenceJacobian fd(sparsity);
+  EXPECT_EQ(3, fd.GetColorCount());
+
+  // no two columns of the same colour share a row
+  const std::vector<int>& colors = fd.GetColors();
+  for (int row=0; row<sparsity.outerSize(); ++row) {
+    std::vector<int> used;
+    for (Jacobian::InnerIterator it(sparsity, row); it; ++it) {
+      int c = colors.at(it.col());
+      EXPECT_EQ(used.end(), std::find(used.begin(), used.end(), c));
+      used.push_back(c);
+    }
+  }
+}
+
+TEST(FiniteDifferenceJacobianTest, MatchesAnalyticJacobian)
+{
+  int n = 50;
+  VectorXd x = VectorXd::Random(n);
+  Jacobian analytic = BandedJacobian(x);
+
+  FiniteDifferenceJacobian serial(analytic);
+  FiniteDifferenceJacobian parallel(analytic, 4);
+
+  Eigen::MatrixXd jac = serial.Evaluate(Banded, x);
+  EXPECT_TRUE(jac.isApprox(Eigen::MatrixXd(analytic), 1e-6));
+  EXPECT_TRUE(jac.isApprox(Eigen::MatrixXd(parallel.Evaluate(Banded, x))));
+}
+
+class BandedConstraint : public FiniteDifferenceConstraint {
+public:
+  BandedConstraint (const Jacobian& sparsity)
+      : FiniteDifferenceConstraint(sparsity.rows(), "banded", "nodes", sparsity) {}
+
+  VecBound GetBounds () const override
+  {
+    return VecBound(GetRows(), ifopt::BoundZero);
+  }
+
+private:
+  VectorXd EvaluateAt (const VectorXd& x) const override { return Banded(x); }
+};
+
+TEST(FiniteDifferenceJacobianTest, ConstraintInProblem)
+{
+  auto nodes = std::make_shared<NodesVariablesAll>(4, k3D, "nodes");
+  int n = nodes->GetRows();
+  nodes->SetVariables(VectorXd::Random(n));
+
+  ifopt::Problem nlp;
+  nlp.AddVariableSet(nodes);
+  auto constraint = std::make_shared<BandedConstraint>(BandedJacobian(VectorXd::Ones(n)));
+  nlp.AddConstraintSet(constraint);
+
+  VectorXd x = nlp.GetVariableValues();
+  EXPECT_TRUE(nlp.EvaluateConstraints(x.data()).isApprox(Banded(x)));
+
+  Eigen::MatrixXd jac = nlp.GetJacobianOfConstraints();
+  EXPECT_TRUE(jac.isApprox(Eigen::MatrixXd(BandedJacobian(x)), 1e-6));
+  EXPECT_EQ(3, constraint->GetColorCount());
+}
+
+// the elementwise product of two variable sets
+class ProductConstraint : public FiniteDifferenceConstraint {
+public:
+  ProductConstraint (const Jacobian& sparsity)
+      : FiniteDifferenceConstraint(sparsity.rows(), "product",
+                                   VariableSetNames{"x", "y"}, sparsity) {}
+
+  VecBound GetBounds () const override
+  {
+    return VecBound(GetRows(), ifopt::BoundZero);
+  }
+
+private:
+  VectorXd EvaluateAt (const VectorXd& xy) const override
+  {
+    int n = xy.size()/2;
+    return xy.head(n).cwiseProduct(xy.tail(n));
+  }
+};
+
+TEST(FiniteDifferenceJacobianTest, ConstraintOfSeveralVariableSets)
+{
+  auto x = std::make_shared<NodesVariablesAll>(2, k3D, "x");
+  auto y = std::make_shared<NodesVariablesAll>(2, k3D, "y");
+  int n = x->GetRows();
+  x->SetVariables(VectorXd::Random(n));
+  y->SetVariables(VectorXd::Random(n));
+
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (int i=0; i<n; ++i) {
+    triplets.emplace_back(i, i, 1.0);
+    triplets.emplace_back(i, n+i, 1.0);
+  }
+  Jacobian sparsity(n, 2*n);
+  sparsity.setFromTriplets(triplets.begin(), triplets.end());
+
+  ifopt::Problem nlp;
+  nlp.AddVariableSet(x);
+  nlp.AddVariableSet(y);
+  auto constraint = std::make_shared<ProductConstraint>(sparsity);
+  nlp.AddConstraintSet(constraint);
+
+  VectorXd xy = nlp.GetVariableValues();
+  EXPECT_TRUE(nlp.EvaluateConstraints(xy.data()).isApprox(xy.head(n).cwiseProduct(xy.tail(n))));
+
+  Eigen::MatrixXd analytic(n, 2*n);
+  analytic << Eigen::MatrixXd(xy.tail(n).asDiagonal()), Eigen::MatrixXd(xy.head(n).asDiagonal());
+  Eigen::MatrixXd jac = nlp.GetJacobianOfConstraints();
+  EXPECT_TRUE(jac.isApprox(analytic, 1e-6));
+  EXPECT_EQ(2, constraint->GetColorCount()); // x_i and y_i share a row
+}
+
+} /* namespace towr */
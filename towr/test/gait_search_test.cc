@@ -0,0 +1,121 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include <towr/initialization/gait_search.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+TEST(GaitSearchTest, DistanceToFeasibility)
+{
+  // x0 + x1 = 1, x0 - x1 = 0 is solved by x = (0.5, 0.5)
+  Eigen::MatrixXd A(2, 2);
+  A << 1.0,  1.0,
+       1.0, -1.0;
+  Eigen::VectorXd b(2);
+  b << 1.0, 0.0;
+  EXPECT_NEAR(0.0, GaitSearch::GetDistanceToFeasibility(A, b), 1e-9);
+
+  // x0 + x1 = -1 misses by at least 1 for x >= 0
+  b << -1.0, 0.0;
+  EXPECT_NEAR(1.0, GaitSearch::GetDistanceToFeasibility(A, b), 1e-9);
+
+  // x0 = 1 and x0 = 3 can't both hold, |x0-1| + |x0-3| >= 2
+  Eigen::MatrixXd A2(2, 1);
+  A2 << 1.0, 1.0;
+  Eigen::VectorXd b2(2);
+  b2 << 1.0, 3.0;
+  EXPECT_NEAR(2.0, GaitSearch::GetDistanceToFeasibility(A2, b2), 1e-9);
+}
+
+TEST(GaitSearchTest, EnumeratesAllStrideSequences)
+{
+  RobotModel model(RobotModel::Biped);
+  auto problem = GetBipedFormulation(model, std::make_shared<FlatGround>(), 0.5);
+
+  GaitSearchOptions options;
+  options.strides_ = {GaitGenerator::Walk1, GaitGenerator::Run1, GaitGenerator::Hop1};
+  options.min_stride_count_ = 1;
+  options.max_stride_count_ = 3;
+  options.impulse_check_count_ = 1000;
+  auto candidates = GaitSearch(options).Search(problem, 1000);
+
+  // 3^1 + 3^2 + 3^3 sequences, each between two stands and none twice
+  ASSERT_EQ(3u + 9u + 27u, candidates.size());
+  std::set<GaitSearch::Gaits> sequences;
+  for (const auto& c : candidates) {
+    EXPECT_EQ(GaitGenerator::Stand, c.gaits_.front());
+    EXPECT_EQ(GaitGenerator::Stand, c.gaits_.back());
+    EXPECT_GE(c.gaits_.size(), 3u);
+    EXPECT_LE(c.gaits_.size(), 5u);
+    sequences.insert(c.gaits_);
+  }
+  EXPECT_EQ(candidates.size(), sequences.size());
+
+  for (std::size_t i=1; i<candidates.size(); ++i)
+    EXPECT_LE(candidates.at(i-1).score_, candidates.at(i).score_);
+}
+
+TEST(GaitSearchTest, FootholdsInGapRankLast)
+{
+  RobotModel model(RobotModel::Biped);
+  auto problem = GetBipedFormulation(model, std::make_shared<Gap>(), 2.5);
+
+  GaitSearchOptions options;
+  options.max_stride_count_ = 2;
+  options.impulse_check_count_ = 1000;
+
+  // the best sequence steps over the gap
+  auto candidates = GaitSearch(options).Search(problem, 1000);
+  ASSERT_FALSE(candidates.empty());
+  EXPECT_EQ(0.0, candidates.front().terrain_cost_);
+
+  // flat ground costs nothing, so only footholds in (or at the edge of)
+  // the gap have a terrain cost. If it dominates, they rank last.
+  options.weight_terrain_ = 100.0;
+  candidates = GaitSearch(options).Search(problem, 1000);
+  int n_gap = 0;
+  for (std::size_t i=0; i<candidates.size(); ++i) {
+    bool in_gap = candidates.at(i).terrain_cost_ > 0.0;
+    if (in_gap)
+      ++n_gap;
+    else
+      EXPECT_EQ(0, n_gap) << "sequence " << i << " avoids the gap, but ranks behind one that doesn't";
+  }
+  EXPECT_GT(n_gap, 0);
+  EXPECT_LT(n_gap, int(candidates.size()));
+}
+
+} /* namespace towr */
@@ -0,0 +1,215 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <ifopt/problem.h>
+#include <ifopt/solver.h>
+
+#include <towr/planning/horizon_decomposition.h>
+#include <towr/terrain/examples/height_map_examples.h>
+#include <towr/variables/nodes_variables.h>
+#include <towr/variables/variable_names.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+// stand-in for a solver, whose solution of a window only depends on the
+// boundary states: the base follows the cubic between its first and last
+// node, as fixed by the bounds. Nodes are 0.1s apart, the default duration
+// of the base polynomials, so windows must be multiples of that.
+class BoundaryCubicSolver : public ifopt::Solver {
+public:
+  void Solve (ifopt::Problem& nlp) override
+  {
+    for (auto id : {id::base_lin_nodes, id::base_ang_nodes}) {
+      auto variables = nlp.GetOptVariables()->GetComponent<NodesVariables>(id);
+      auto bounds = variables->GetBounds();
+      Eigen::VectorXd x = variables->GetValues();
+
+      std::vector<Node> nodes = variables->GetNodes();
+      for (int i=0; i<x.size(); ++i)
+        if (bounds.at(i).lower_ == bounds.at(i).upper_)
+          for (auto nvi : variables->GetNodeValuesInfo(i))
+            nodes.at(nvi.id_).at(nvi.deriv_)(nvi.dim_) = bounds.at(i).lower_;
+
+      const double dt = 0.1;
+      CubicHermiteSpline cubic({nodes.front(), nodes.back()}, {dt*(nodes.size()-1)});
+      for (int i=0; i<x.size(); ++i)
+        for (auto nvi : variables->GetNodeValuesInfo(i))
+          if (nvi.id_ > 0 && nvi.id_+1 < static_cast<int>(nodes.size()))
+            x(i) = cubic.GetPoint(dt*nvi.id_).at(nvi.deriv_)(nvi.dim_);
+
+      variables->SetVariables(x);
+    }
+
+    nlp.SaveCurrent();
+  }
+};
+
+// a biped standing on both legs, moving its base from rest to rest.
+static NlpFormulation
+GetStandingBiped (const RobotModel& model, double goal_x, double T)
+{
+  auto f = GetBipedFormulation(model, std::make_shared<FlatGround>(), goal_x);
+  double z = -model.kinematic_model_->GetNominalStanceInBase().front().z();
+  f.initial_base_.lin.at(kPos).z() = z;
+  f.final_base_.lin.at(kPos).z() = z;
+  f.params_.ee_phase_durations_ = {{T}, {T}};
+  return f;
+}
+
+static bool
+IsFullStance (const Parameters& params, double t)
+{
+  for (int ee=0; ee<params.GetEECount(); ++ee) {
+    bool contact = params.ee_in_contact_at_start_.at(ee);
+    double t_phase = 0.0;
+    for (double d : params.ee_phase_durations_.at(ee)) {
+      if (t < t_phase + d)
+        break;
+      t_phase += d;
+      contact = !contact;
+    }
+    if (!contact)
+      return false;
+  }
+
+  return true;
+}
+
+TEST(HorizonDecompositionTest, WindowsSplitInFullStance)
+{
+  auto problem = GetBipedFormulation(RobotModel(RobotModel::Biped),
+                                     std::make_shared<FlatGround>(), 0.4);
+  double T = problem.params_.GetTotalTime();
+
+  for (int n_windows : {2, 3}) {
+    HorizonDecompositionOptions options;
+    options.window_count_ = n_windows;
+    options.overlap_ = 0.4;
+    HorizonDecomposition decomposition(nullptr, options);
+    auto windows = decomposition.GetWindows(problem);
+
+    ASSERT_EQ(n_windows, windows.size());
+    EXPECT_EQ(0.0, windows.front().t_start_);
+    EXPECT_EQ(T, windows.back().t_end_);
+    EXPECT_EQ(T, windows.back().t_seam_);
+
+    for (int k=0; k<n_windows; ++k) {
+      const auto& w = windows.at(k);
+      EXPECT_LE(w.t_start_, w.t_seam_);
+      EXPECT_LE(w.t_seam_, w.t_end_);
+      if (k > 0) {
+        EXPECT_TRUE(IsFullStance(problem.params_, w.t_start_));
+        EXPECT_LT(w.t_start_, windows.at(k-1).t_seam_);
+      }
+      if (k+1 < n_windows) {
+        EXPECT_TRUE(IsFullStance(problem.params_, w.t_seam_));
+        EXPECT_TRUE(IsFullStance(problem.params_, w.t_end_));
+        EXPECT_GT(w.t_end_, w.t_seam_);
+      }
+
+      // the cut phases cover exactly the window
+      const Parameters& params = w.formulation_.params_;
+      for (int ee=0; ee<params.GetEECount(); ++ee) {
+        double sum = 0.0;
+        for (double d : params.ee_phase_durations_.at(ee))
+          sum += d;
+        EXPECT_NEAR(w.t_end_ - w.t_start_, sum, 1e-9);
+      }
+    }
+  }
+}
+
+TEST(HorizonDecompositionTest, StitchIsContinuousAtSeams)
+{
+  auto problem = GetStandingBiped(RobotModel(RobotModel::Biped), 0.3, 1.2);
+  HorizonDecompositionOptions options;
+  options.window_count_ = 2;
+  options.overlap_ = 0.4;
+  auto windows = HorizonDecomposition(nullptr, options).GetWindows(problem);
+
+  // the initial guesses of the windows, which disagree at the seam
+  std::vector<Trajectory> motions;
+  for (auto& w : windows) {
+    SplineHolder s;
+    ifopt::Problem nlp;
+    BuildProblem(w.formulation_, s, nlp);
+    motions.push_back(Trajectory(s));
+  }
+
+  Trajectory stitched = HorizonDecomposition::Stitch(problem, windows, motions);
+  EXPECT_NEAR(problem.params_.GetTotalTime(), stitched.GetTotalTime(), 1e-9);
+
+  const double eps = 1e-6;
+  for (std::size_t k=0; k+1<windows.size(); ++k) {
+    double t = windows.at(k).t_seam_;
+    State left  = stitched.base_linear_.GetPoint(t-eps);
+    State right = stitched.base_linear_.GetPoint(t+eps);
+    EXPECT_LT((left.p() - right.p()).norm(), 1e-4);
+    EXPECT_LT((left.v() - right.v()).norm(), 1e-4);
+
+    // the seam lies between both windows
+    State l = motions.at(k).base_linear_.GetPoint(t - windows.at(k).t_start_);
+    State r = motions.at(k+1).base_linear_.GetPoint(t - windows.at(k+1).t_start_);
+    EXPECT_TRUE(stitched.base_linear_.GetPoint(t).p().isApprox((l.p()+r.p())/2));
+    EXPECT_TRUE(stitched.base_linear_.GetPoint(t).v().isApprox((l.v()+r.v())/2));
+  }
+}
+
+TEST(HorizonDecompositionTest, SolveConvergesOnShortMotion)
+{
+  RobotModel model(RobotModel::Biped);
+  double T = 1.2;
+  double goal_x = 0.3;
+  auto problem = GetStandingBiped(model, goal_x, T);
+
+  HorizonDecompositionOptions options;
+  options.window_count_ = 2;
+  options.overlap_ = 0.4;
+  options.max_iterations_ = 30;
+  options.thread_count_ = 1;
+  auto factory = []() { return std::make_shared<BoundaryCubicSolver>(); };
+  auto result = HorizonDecomposition(factory, options).Solve(problem);
+
+  EXPECT_TRUE(result.converged_);
+  EXPECT_GT(result.iteration_count_, 1);
+  EXPECT_LT(result.seam_error_, options.tolerance_);
+
+  // the windows agree on the cubic the whole motion would follow
+  CubicHermiteSpline cubic({problem.initial_base_.lin, problem.final_base_.lin}, {T});
+  for (double t=0.0; t<=T; t+=0.05) {
+    State s = result.trajectory_.base_linear_.GetPoint(t);
+    EXPECT_NEAR(cubic.GetPoint(t).p().x(), s.p().x(), 1e-2) << "t=" << t;
+  }
+}
+
+} /* namespace towr */
@@ -0,0 +1,190 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cstdio>
+
+#include <gtest/gtest.h>
+
+#include <towr/io/iteration_history.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+TEST(IterationHistoryTest, KeptIterationsIncludeFirstAndLast)
+{
+  using Options = IterationHistoryOptions;
+  std::vector<Options> all_options;
+  for (Options::Decimation d : {Options::All, Options::EveryKth, Options::LogSpaced}) {
+    for (int n : {0, 1, 2, 3, 10, 50, 2000}) {
+      Options o;
+      o.decimation_ = d;
+      o.every_k_    = n;
+      o.log_count_  = n;
+      all_options.push_back(o);
+    }
+  }
+
+  EXPECT_TRUE(GetKeptIterations(0, Options()).empty());
+
+  for (const auto& o : all_options) {
+    for (int n_iterations : {1, 2, 3, 7, 10, 57, 1000}) {
+      auto kept = GetKeptIterations(n_iterations, o);
+      std::string info = "decimation " + std::to_string(o.decimation_)
+                       + ", k " + std::to_string(o.every_k_)
+                       + ", n " + std::to_string(n_iterations);
+
+      ASSERT_FALSE(kept.empty()) << info;
+      EXPECT_EQ(0, kept.front()) << info;
+      EXPECT_EQ(n_iterations-1, kept.back()) << info;
+      for (int i=1; i<kept.size(); ++i)
+        EXPECT_LT(kept.at(i-1), kept.at(i)) << info; // sorted, no duplicates
+
+      switch (o.decimation_) {
+        case Options::All:
+          EXPECT_EQ(n_iterations, kept.size()) << info;
+          break;
+        case Options::EveryKth:
+          for (int i=0; i<kept.size()-1; ++i)
+            EXPECT_EQ(0, kept.at(i)%std::max(1, o.every_k_)) << info;
+          break;
+        case Options::LogSpaced:
+          EXPECT_LE(kept.size(), std::max(2, o.log_count_)+1) << info;
+          break;
+      }
+    }
+  }
+
+  // the early iterations are kept densely
+  Options log;
+  log.decimation_ = Options::LogSpaced;
+  log.log_count_  = 20;
+  auto kept = GetKeptIterations(1000, log);
+  EXPECT_EQ(std::vector<int>({0, 1, 2}), std::vector<int>(kept.begin(), kept.begin()+3));
+}
+
+class IterationHistoryFileTest : public ::testing::Test {
+protected:
+  void SetUp () override
+  {
+    formulation_ = GetBipedFormulation(RobotModel(RobotModel::Biped),
+                                       std::make_shared<FlatGround>(), 0.3);
+    BuildProblem(formulation_, splines_, nlp_);
+
+    // a few solver iterations that move away from the initial guess
+    Eigen::VectorXd x = nlp_.GetVariableValues();
+    Eigen::VectorXd dx = 0.01*Eigen::VectorXd::Random(x.size());
+    for (int i=0; i<12; ++i) {
+      Eigen::VectorXd xi = x + i*dx;
+      nlp_.SetVariables(xi.data());
+      nlp_.SaveCurrent();
+    }
+  }
+
+  void TearDown () override
+  {
+    std::remove(path_full_.c_str());
+    std::remove(path_x_.c_str());
+  }
+
+  static void ExpectEqual (const CubicHermiteSpline& a, const CubicHermiteSpline& b)
+  {
+    EXPECT_EQ(a.GetKnotTimes(), b.GetKnotTimes());
+    EXPECT_EQ(a.GetKnotPositions(), b.GetKnotPositions());
+    EXPECT_EQ(a.GetKnotVelocities(), b.GetKnotVelocities());
+  }
+
+  NlpFormulation formulation_;
+  SplineHolder splines_;
+  ifopt::Problem nlp_;
+  std::string path_full_ = "iteration_history_full.trj";
+  std::string path_x_    = "iteration_history_x.trj";
+};
+
+TEST_F(IterationHistoryFileTest, LazyReconstructionEqualsFullStorage)
+{
+  IterationHistoryOptions options;
+  options.decimation_ = IterationHistoryOptions::EveryKth;
+  options.every_k_ = 5;
+  {
+    TrajectoryFileWriter full(path_full_), x_only(path_x_);
+    EXPECT_EQ(4, WriteIterationHistory(nlp_, splines_, options, full));
+    options.x_only_ = true;
+    EXPECT_EQ(4, WriteIterationHistory(nlp_, splines_, options, x_only));
+  }
+
+  // the variables are back at the last iteration
+  Eigen::VectorXd x_last = nlp_.GetVariableValues();
+  nlp_.SetOptVariables(nlp_.GetIterationCount()-1);
+  EXPECT_EQ(x_last, nlp_.GetVariableValues());
+
+  IterationHistoryReader full(path_full_, formulation_);
+  IterationHistoryReader x_only(path_x_, formulation_);
+  ASSERT_EQ(4, full.GetRecordCount());
+  ASSERT_EQ(4, x_only.GetRecordCount());
+
+  std::vector<int> iterations = {0, 5, 10, 11};
+  for (int r=0; r<iterations.size(); ++r) {
+    EXPECT_EQ(iterations.at(r), full.GetIteration(r));
+    EXPECT_EQ(iterations.at(r), x_only.GetIteration(r));
+
+    Trajectory a = full.GetTrajectory(r);
+    Trajectory b = x_only.GetTrajectory(r);
+    ExpectEqual(a.base_linear_, b.base_linear_);
+    ExpectEqual(a.base_angular_, b.base_angular_);
+    ASSERT_EQ(a.GetEECount(), b.GetEECount());
+    for (int ee=0; ee<a.GetEECount(); ++ee) {
+      ExpectEqual(a.ee_motion_.at(ee), b.ee_motion_.at(ee));
+      ExpectEqual(a.ee_force_.at(ee), b.ee_force_.at(ee));
+      EXPECT_EQ(a.ee_phase_durations_.at(ee), b.ee_phase_durations_.at(ee));
+    }
+  }
+
+  // the iterations differ, so this compares more than the initial guess
+  EXPECT_NE(full.GetTrajectory(0).base_linear_.GetKnotPositions(),
+            full.GetTrajectory(3).base_linear_.GetKnotPositions());
+}
+
+TEST_F(IterationHistoryFileTest, ReconstructionRejectsOtherFormulation)
+{
+  IterationHistoryOptions options;
+  options.x_only_ = true;
+  {
+    TrajectoryFileWriter x_only(path_x_);
+    WriteIterationHistory(nlp_, splines_, options, x_only);
+  }
+
+  NlpFormulation other = formulation_;
+  other.params_.ee_phase_durations_.at(0) = {0.3, 0.2, 0.3, 0.2, 0.1, 0.1, 0.1};
+  IterationHistoryReader reader(path_x_, other);
+  EXPECT_THROW(reader.GetTrajectory(0), std::runtime_error);
+}
+
+} /* namespace towr */
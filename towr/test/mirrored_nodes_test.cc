@@ -0,0 +1,187 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include <ifopt/problem.h>
+
+#include <towr/initialization/gait_generator.h>
+#include <towr/nlp_formulation.h>
+#include <towr/terrain/examples/height_map_examples.h>
+#include <towr/variables/variable_names.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+// rises to the left, so the feet of a straight motion are on different heights.
+class SideSlope : public HeightMap {
+public:
+  double GetHeight (double x, double y) const override { return 0.1*x + 0.2*y; };
+  double GetHeightDerivWrtX (double x, double y) const override { return 0.1; };
+  double GetHeightDerivWrtY (double x, double y) const override { return 0.2; };
+};
+
+// both legs of the biped move together, as in hopping
+static NlpFormulation
+GetHoppingBiped (bool share_mirrored_ee,
+                 const HeightMap::Ptr& terrain = std::make_shared<FlatGround>())
+{
+  auto f = GetBipedFormulation(RobotModel(RobotModel::Biped), terrain, 0.4, true);
+  f.params_.costs_.push_back({Parameters::ForcesCostID, 1.0});
+  f.params_.share_mirrored_ee_ = share_mirrored_ee;
+  return f;
+}
+
+TEST(MirroredNodesTest, SharesVariablesOfMirroredLeg)
+{
+  auto full_formulation = GetHoppingBiped(false);
+  auto mirrored_formulation = GetHoppingBiped(true);
+  EXPECT_EQ(std::vector<int>({-1, 0}), mirrored_formulation.GetMirroredEndeffectors());
+
+  SplineHolder s_full, s;
+  ifopt::Problem full, nlp;
+  BuildProblem(full_formulation, s_full, full);
+  BuildProblem(mirrored_formulation, s, nlp);
+  EXPECT_LT(nlp.GetNumberOfOptimizationVariables(), full.GetNumberOfOptimizationVariables());
+
+  Eigen::VectorXd x = nlp.GetVariableValues();
+  x += 0.01*Eigen::VectorXd::Random(x.size());
+  nlp.SetVariables(x.data());
+
+  // the right foot follows the left one, reflected about the x-z plane
+  for (double t : {0.0, 0.4, 0.9, 1.3}) {
+    Eigen::Vector3d l = s.ee_motion_.at(0)->GetPoint(t).p();
+    Eigen::Vector3d r = s.ee_motion_.at(1)->GetPoint(t).p();
+    EXPECT_DOUBLE_EQ(l.x(), r.x());
+    EXPECT_DOUBLE_EQ(l.y(), -r.y());
+    EXPECT_DOUBLE_EQ(l.z(), r.z());
+  }
+}
+
+TEST(MirroredNodesTest, MirroredLegOnAsymmetricTerrain)
+{
+  auto formulation = GetHoppingBiped(true, std::make_shared<SideSlope>());
+  SplineHolder s;
+  ifopt::Problem nlp;
+  BuildProblem(formulation, s, nlp);
+
+  // the right foot is constrained by the terrain it stands on
+  auto terrain = nlp.GetConstraints().GetComponent("terrain-" + id::EEMotionNodes(1));
+  auto force   = nlp.GetConstraints().GetComponent("force-" + id::EEForceNodes(1));
+  EXPECT_LT(0, terrain->GetRows());
+  EXPECT_LT(0, force->GetRows());
+
+  // height above the terrain at the last node
+  Eigen::Vector3d p = s.ee_motion_.at(1)->GetPoint(1.3).p();
+  double height = p.z() - formulation.terrain_->GetHeight(p.x(), p.y());
+  EXPECT_NEAR(height, terrain->GetValues().tail(1)(0), 1e-12);
+}
+
+TEST(MirroredNodesTest, RejectsAlternatingLegs)
+{
+  auto f = GetBipedFormulation(RobotModel(RobotModel::Biped),
+                               std::make_shared<FlatGround>(), 0.4, false);
+  f.params_.share_mirrored_ee_ = true;
+  EXPECT_EQ(std::vector<int>({-1, -1}), f.GetMirroredEndeffectors());
+
+  SplineHolder s;
+  EXPECT_THROW(f.GetVariableSets(s), std::runtime_error);
+}
+
+// the legs of walking, running, trotting and pacing alternate
+TEST(MirroredNodesTest, RejectsAlternatingGaits)
+{
+  struct Case { RobotModel::Robot robot; GaitGenerator::Combos combo; bool has_pairs; };
+  std::vector<Case> cases = {{RobotModel::Biped, GaitGenerator::C0, false}, // walk
+                             {RobotModel::Biped, GaitGenerator::C1, false}, // run
+                             {RobotModel::Biped, GaitGenerator::C2, true},  // hop
+                             {RobotModel::Hyq,   GaitGenerator::C0, false}, // walk
+                             {RobotModel::Hyq,   GaitGenerator::C1, false}, // trot
+                             {RobotModel::Hyq,   GaitGenerator::C2, false}, // pace
+                             {RobotModel::Hyq,   GaitGenerator::C3, true}}; // bound
+
+  for (const auto& c : cases) {
+    NlpFormulation f;
+    f.model_ = RobotModel(c.robot);
+    f.terrain_ = std::make_shared<FlatGround>();
+    f.initial_ee_W_ = f.model_.kinematic_model_->GetNominalStanceInBase();
+    f.final_base_.lin.at(kPos).x() = 0.4;
+    f.params_.share_mirrored_ee_ = true;
+
+    int n_ee = f.model_.kinematic_model_->GetNumberOfEndeffectors();
+    auto gait = GaitGenerator::MakeGaitGenerator(n_ee);
+    gait->SetCombo(c.combo);
+    for (int ee=0; ee<n_ee; ++ee) {
+      f.params_.ee_phase_durations_.push_back(gait->GetPhaseDurations(2.0, ee));
+      f.params_.ee_in_contact_at_start_.push_back(gait->IsInContactAtStart(ee));
+    }
+
+    auto mirrored = f.GetMirroredEndeffectors();
+    bool has_pairs = std::any_of(mirrored.begin(), mirrored.end(), [](int m) { return m >= 0; });
+    EXPECT_EQ(c.has_pairs, has_pairs) << "robot " << c.robot << ", combo " << c.combo;
+
+    if (!c.has_pairs) {
+      SplineHolder s;
+      EXPECT_THROW(f.GetVariableSets(s), std::runtime_error);
+    }
+  }
+}
+
+TEST(MirroredNodesTest, JacobianWrtSharedVariables)
+{
+  auto formulation = GetHoppingBiped(true, std::make_shared<SideSlope>());
+  SplineHolder s;
+  ifopt::Problem nlp;
+  BuildProblem(formulation, s, nlp);
+
+  Eigen::VectorXd x = nlp.GetVariableValues();
+  x += 0.01*Eigen::VectorXd::Random(x.size());
+
+  Eigen::VectorXd g = nlp.EvaluateConstraints(x.data());
+  Eigen::MatrixXd jac(nlp.GetJacobianOfConstraints());
+  Eigen::VectorXd grad = nlp.EvaluateCostFunctionGradient(x.data());
+  double cost = nlp.EvaluateCostFunction(x.data());
+
+  double h = 1e-7;
+  for (int i=0; i<x.size(); ++i) {
+    Eigen::VectorXd xh = x;
+    xh(i) += h;
+    Eigen::VectorXd jac_fd = (nlp.EvaluateConstraints(xh.data()) - g)/h;
+    double scale = 1.0 + jac.col(i).cwiseAbs().maxCoeff();
+    EXPECT_LT((jac_fd - jac.col(i)).cwiseAbs().maxCoeff(), 1e-4*scale) << "variable " << i;
+
+    double grad_fd = (nlp.EvaluateCostFunction(xh.data()) - cost)/h;
+    EXPECT_NEAR(grad_fd, grad(i), 1e-2) << "variable " << i;
+  }
+}
+
+} /* namespace towr */
@@ -0,0 +1,118 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <ifopt/problem.h>
+
+#include <towr/nlp_formulation.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+static void
+AddToProblem (const NlpFormulation::VariablePtrVec& variables,
+              const NlpFormulation::ContraintPtrVec& constraints,
+              const NlpFormulation::CostPtrVec& costs,
+              ifopt::Problem& nlp)
+{
+  for (auto c : variables)
+    nlp.AddVariableSet(c);
+  for (auto c : constraints)
+    nlp.AddConstraintSet(c);
+  for (auto c : costs)
+    nlp.AddCostSet(c);
+}
+
+TEST(NlpFormulationTest, ResetVariablesMatchesNewBuild)
+{
+  for (bool optimize_timings : {false, true}) {
+    auto f = GetBipedFormulation(RobotModel(RobotModel::Biped),
+                                 std::make_shared<Block>(), 0.4);
+    f.params_.costs_.push_back({Parameters::ForcesCostID, 1.0});
+    if (optimize_timings)
+      f.params_.OptimizePhaseDurations();
+
+    // built once, then moved around as by a previous solve
+    SplineHolder s;
+    auto variables   = f.GetVariableSets(s);
+    auto constraints = f.GetConstraints(s);
+    auto costs       = f.GetCosts();
+    {
+      ifopt::Problem first;
+      AddToProblem(variables, constraints, costs, first);
+      Eigen::VectorXd x = first.GetVariableValues();
+      x += 0.01*Eigen::VectorXd::Random(x.size());
+      first.SetVariables(x.data());
+    }
+
+    // another start and goal
+    f.initial_base_.lin.at(kPos).x() = 0.1;
+    f.final_base_.lin.at(kPos).x()   = 0.9;
+    for (auto& p : f.initial_ee_W_)
+      p.x() += 0.1;
+    f.ResetVariables(variables, s);
+    ifopt::Problem reset;
+    AddToProblem(variables, constraints, costs, reset);
+
+    SplineHolder s_new;
+    ifopt::Problem built;
+    auto variables_new = f.GetVariableSets(s_new);
+    AddToProblem(variables_new, f.GetConstraints(s_new), f.GetCosts(), built);
+
+    Eigen::VectorXd x = built.GetVariableValues();
+    ASSERT_EQ(x.size(), reset.GetNumberOfOptimizationVariables());
+    EXPECT_TRUE(x.isApprox(reset.GetVariableValues()));
+    EXPECT_EQ(built.GetNumberOfConstraints(), reset.GetNumberOfConstraints());
+    EXPECT_TRUE(built.EvaluateConstraints(x.data()).isApprox(reset.EvaluateConstraints(x.data())));
+    EXPECT_DOUBLE_EQ(built.EvaluateCostFunction(x.data()), reset.EvaluateCostFunction(x.data()));
+
+    auto bounds_built = built.GetBoundsOnOptimizationVariables();
+    auto bounds_reset = reset.GetBoundsOnOptimizationVariables();
+    for (int i=0; i<x.size(); ++i) {
+      EXPECT_EQ(bounds_built.at(i).lower_, bounds_reset.at(i).lower_) << "variable " << i;
+      EXPECT_EQ(bounds_built.at(i).upper_, bounds_reset.at(i).upper_) << "variable " << i;
+    }
+  }
+}
+
+TEST(NlpFormulationTest, ResetVariablesRejectsMirrored)
+{
+  auto f = GetBipedFormulation(RobotModel(RobotModel::Biped),
+                               std::make_shared<FlatGround>(), 0.4, true);
+  f.params_.share_mirrored_ee_ = true;
+
+  SplineHolder s;
+  auto variables = f.GetVariableSets(s);
+  EXPECT_THROW(f.ResetVariables(variables, s), std::runtime_error);
+}
+
+} /* namespace towr */
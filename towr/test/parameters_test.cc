@@ -0,0 +1,182 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include <gtest/gtest.h>
+
+#include <towr/initialization/gait_generator.h>
+#include <towr/parameters.h>
+#include <towr/variables/cubic_hermite_spline.h>
+
+namespace towr {
+
+static Parameters::VecTimes
+GetKnotTimes (const Parameters::VecTimes& durations)
+{
+  Parameters::VecTimes knots = {0.0};
+  for (double d : durations)
+    knots.push_back(knots.back() + d);
+  return knots;
+}
+
+static int
+GetContactCount (const Parameters& params, double t)
+{
+  int count = 0;
+  for (int ee=0; ee<params.GetEECount(); ++ee) {
+    bool contact = params.ee_in_contact_at_start_.at(ee);
+    double t_phase = 0.0;
+    for (double d : params.ee_phase_durations_.at(ee)) {
+      if (t < t_phase + d)
+        break;
+      t_phase += d;
+      contact = !contact;
+    }
+    count += contact;
+  }
+
+  return count;
+}
+
+TEST(ParametersTest, ContactKnotsMergeCloseSwitches)
+{
+  Parameters params;
+  params.ee_phase_durations_ = {{0.3, 0.3, 0.4}, {0.32, 0.3, 0.38},
+                                {0.33, 0.3, 0.37}, {0.97, 0.03}};
+  params.ee_in_contact_at_start_ = {true, true, true, true};
+  params.AlignBaseKnotsWithContacts();
+
+  auto durations = params.GetBasePolyDurations();
+  double T = params.GetTotalTime();
+  EXPECT_NEAR(T, std::accumulate(durations.begin(), durations.end(), 0.0), 1e-9);
+
+  double t_min = params.bound_base_poly_duration_.first;
+  double t_max = params.bound_base_poly_duration_.second;
+  for (double d : durations) {
+    EXPECT_GE(d, t_min - 1e-9);
+    EXPECT_LE(d, t_max + 1e-9);
+  }
+
+  // each group of switches shares the knot at its middle switch, the one
+  // before the end snaps to it.
+  auto knots = GetKnotTimes(durations);
+  for (double t : {0.32, 0.62}) {
+    auto it = std::find_if(knots.begin(), knots.end(),
+                           [t](double k) { return std::abs(k-t) < 1e-9; });
+    EXPECT_TRUE(it != knots.end()) << "no knot at " << t;
+  }
+  for (double t : params.GetContactSwitchTimes()) {
+    double distance = T;
+    for (double k : knots)
+      distance = std::min(distance, std::abs(k-t));
+    EXPECT_LT(distance, t_min) << "switch at " << t;
+  }
+}
+
+// The base acceleration of a trot changes with the number of feet in
+// contact. Interpolating the exact motion at the knots, the linear dynamics
+// m*a = sum(f) - m*g are violated less by knots at the contact switches,
+// which here lie between those of the uniform knots, even though these are
+// fewer.
+TEST(ParametersTest, ContactKnotsReduceDynamicsResidual)
+{
+  Parameters::VecTimes lifts_first = {0.25, 0.15, 0.15, 0.15, 0.15, 0.15, 0.15, 0.15,
+                                      0.15, 0.15, 0.15, 0.15, 0.15};
+  Parameters::VecTimes lifts_second = {0.4, 0.15, 0.15, 0.15, 0.15, 0.15, 0.15, 0.15,
+                                       0.15, 0.15, 0.15, 0.15};
+  Parameters params;
+  params.ee_phase_durations_ = {lifts_first, lifts_second, lifts_second, lifts_first};
+  params.ee_in_contact_at_start_ = {true, true, true, true};
+  double T = params.GetTotalTime();
+
+  // exact vertical motion for a constant force per foot in contact
+  const double g = 9.81;
+  const double f = g/2; // per unit mass
+  auto acc = [&](double t) { return f*GetContactCount(params, t) - g; };
+
+  const double dt = 1e-4;
+  std::vector<double> times, pos, vel;
+  double p = 0.0, v = 0.0;
+  for (int i=0; i*dt < T+dt/2; ++i) {
+    times.push_back(i*dt);
+    pos.push_back(p);
+    vel.push_back(v);
+    double a = acc((i+0.5)*dt);
+    p += v*dt + 0.5*a*dt*dt;
+    v += a*dt;
+  }
+
+  auto rms_residual = [&](const Parameters::VecTimes& durations) {
+    auto knots = GetKnotTimes(durations);
+    Eigen::MatrixXd P(1, knots.size()), V(1, knots.size());
+    for (std::size_t k=0; k<knots.size(); ++k) {
+      int i = std::round(knots.at(k)/dt);
+      P(0,k) = pos.at(i);
+      V(0,k) = vel.at(i);
+    }
+    knots.back() = times.back();
+    CubicHermiteSpline spline(knots, P, V);
+
+    double sum = 0.0;
+    int n = 0;
+    for (double t=0.0005; t<T; t+=0.001, ++n)
+      sum += std::pow(spline.GetPoint(t).a().x() - acc(t), 2);
+    return std::sqrt(sum/n);
+  };
+
+  auto uniform = params.GetBasePolyDurations();
+  params.AlignBaseKnotsWithContacts();
+  auto aligned = params.GetBasePolyDurations();
+
+  EXPECT_LT(aligned.size(), uniform.size());
+  EXPECT_LE(rms_residual(aligned), rms_residual(uniform));
+  EXPECT_LT(rms_residual(aligned), 0.1*rms_residual(uniform));
+}
+
+TEST(ParametersTest, ContactKnotsOfTrotAreFewer)
+{
+  auto gait = GaitGenerator::MakeGaitGenerator(4);
+  gait->SetCombo(GaitGenerator::C1);
+
+  Parameters params;
+  for (int ee=0; ee<4; ++ee) {
+    params.ee_phase_durations_.push_back(gait->GetPhaseDurations(2.4, ee));
+    params.ee_in_contact_at_start_.push_back(gait->IsInContactAtStart(ee));
+  }
+
+  auto uniform = params.GetBasePolyDurations();
+  params.AlignBaseKnotsWithContacts();
+  auto aligned = params.GetBasePolyDurations();
+  EXPECT_LT(aligned.size(), uniform.size());
+}
+
+} /* namespace towr */
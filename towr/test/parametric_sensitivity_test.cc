@@ -0,0 +1,275 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include <ifopt/cost_term.h>
+#include <ifopt/problem.h>
+
+#include <towr/planning/parametric_sensitivity.h>
+#include <towr/variables/variable_names.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+using VectorXd = Eigen::VectorXd;
+using MatrixXd = Eigen::MatrixXd;
+
+/**
+ * Weighted squared distance of all variables to a reference, so the problem
+ * has a unique solution. Forces are in N, so they are weighted less.
+ */
+class DistanceCost : public ifopt::CostTerm {
+public:
+  DistanceCost (const VectorXd& reference)
+      : CostTerm("distance"), reference_(reference) {}
+
+  void InitVariableDependedQuantities (const VariablesPtr& x) override
+  {
+    x_ = x;
+  }
+
+  double GetCost () const override
+  {
+    double cost = 0.0;
+    int col = 0;
+    for (const auto& c : x_->GetComponents()) {
+      VectorXd diff = c->GetValues() - reference_.segment(col, c->GetRows());
+      cost += 0.5*GetWeight(c->GetName())*diff.squaredNorm();
+      col += c->GetRows();
+    }
+    return cost;
+  }
+
+  void FillJacobianBlock (std::string var_set, Jacobian& jac) const override
+  {
+    int col = 0;
+    for (const auto& c : x_->GetComponents()) {
+      if (c->GetName() == var_set) {
+        VectorXd diff = c->GetValues() - reference_.segment(col, c->GetRows());
+        for (int i=0; i<c->GetRows(); ++i)
+          jac.coeffRef(0, i) = GetWeight(var_set)*diff(i);
+      }
+      col += c->GetRows();
+    }
+  }
+
+private:
+  VariablesPtr x_;
+  VectorXd reference_;
+
+  static double GetWeight (const std::string& var_set)
+  {
+    return var_set.find(id::ee_force_nodes) == 0? 1e-4 : 1.0;
+  }
+};
+
+/** A quadruped standing on all legs, moving its base from start to goal. */
+static NlpFormulation
+GetStandingQuadruped (double goal_x)
+{
+  NlpFormulation f;
+  f.model_ = RobotModel(RobotModel::Anymal);
+  f.terrain_ = std::make_shared<FlatGround>(0.0);
+  f.initial_base_.lin.at(kPos).z() = 0.5;
+  f.initial_ee_W_ = f.model_.kinematic_model_->GetNominalStanceInBase();
+  for (auto& p : f.initial_ee_W_)
+    p.z() = 0.0;
+  f.final_base_.lin.at(kPos) << goal_x, 0.0, 0.5;
+  for (std::size_t ee=0; ee<f.initial_ee_W_.size(); ++ee) {
+    f.params_.ee_phase_durations_.push_back({0.6});
+    f.params_.ee_in_contact_at_start_.push_back(true);
+  }
+  return f;
+}
+
+/**
+ * Solves min f s.t. the equality constraints and fixed variables of nlp by
+ * Newton's method on the dense KKT conditions, ignoring the inequalities.
+ */
+static VectorXd
+SolveEqualityConstrained (ifopt::Problem& nlp)
+{
+  auto x_bounds = nlp.GetBoundsOnOptimizationVariables();
+  auto g_bounds = nlp.GetBoundsOnConstraints();
+  VectorXd x = nlp.GetVariableValues();
+
+  std::vector<int> free, eq;
+  for (std::size_t i=0; i<x_bounds.size(); ++i) {
+    if (x_bounds.at(i).lower_ == x_bounds.at(i).upper_)
+      x(i) = x_bounds.at(i).lower_;
+    else
+      free.push_back(i);
+  }
+  for (std::size_t i=0; i<g_bounds.size(); ++i)
+    if (g_bounds.at(i).lower_ == g_bounds.at(i).upper_)
+      eq.push_back(i);
+
+  int n_f = free.size();
+  int n_e = eq.size();
+  VectorXd lambda = VectorXd::Zero(g_bounds.size());
+
+  auto lagrangian_gradient = [&](const VectorXd& x) -> VectorXd {
+    nlp.SetVariables(x.data());
+    VectorXd jac_t_lambda = MatrixXd(nlp.GetJacobianOfConstraints()).transpose()*lambda;
+    return nlp.EvaluateCostFunctionGradient(x.data()) + jac_t_lambda;
+  };
+
+  for (int iter=0; iter<50; ++iter) {
+    VectorXd g = nlp.EvaluateConstraints(x.data());
+    MatrixXd jac(nlp.GetJacobianOfConstraints());
+    VectorXd grad_l = lagrangian_gradient(x);
+
+    MatrixXd kkt = MatrixXd::Zero(n_f+n_e, n_f+n_e);
+    VectorXd rhs(n_f+n_e);
+    const double h = 1e-7;
+    for (int j=0; j<n_f; ++j) {
+      VectorXd xh = x;
+      xh(free.at(j)) += h;
+      VectorXd column = (lagrangian_gradient(xh) - grad_l)/h;
+      for (int i=0; i<n_f; ++i)
+        kkt(i,j) += 0.5*column(free.at(i));
+      for (int i=0; i<n_f; ++i)
+        kkt(j,i) += 0.5*column(free.at(i));
+    }
+    for (int e=0; e<n_e; ++e) {
+      for (int j=0; j<n_f; ++j) {
+        kkt(n_f+e, j) = jac(eq.at(e), free.at(j));
+        kkt(j, n_f+e) = jac(eq.at(e), free.at(j));
+      }
+      kkt(n_f+e, n_f+e) = -1e-10;
+      rhs(n_f+e) = g_bounds.at(eq.at(e)).lower_ - g(eq.at(e));
+    }
+    for (int j=0; j<n_f; ++j)
+      rhs(j) = -grad_l(free.at(j));
+
+    VectorXd step = kkt.fullPivLu().solve(rhs);
+    for (int j=0; j<n_f; ++j)
+      x(free.at(j)) += step(j);
+    for (int e=0; e<n_e; ++e)
+      lambda(eq.at(e)) += step(n_f+e);
+
+    if (step.head(n_f).lpNorm<Eigen::Infinity>() < 1e-12)
+      break;
+  }
+
+  nlp.SetVariables(x.data());
+  return x;
+}
+
+/** The problem of f with a DistanceCost, solved starting from x_init. */
+static VectorXd
+Solve (NlpFormulation& f, SplineHolder& s, ifopt::Problem& nlp,
+       const VectorXd& reference, const VectorXd& x_init)
+{
+  BuildProblem(f, s, nlp);
+  nlp.AddCostSet(std::make_shared<DistanceCost>(reference));
+  nlp.SetVariables(x_init.data());
+  return SolveEqualityConstrained(nlp);
+}
+
+/** The reference of the DistanceCost, the initial values of f. */
+static VectorXd
+GetReference (NlpFormulation f)
+{
+  SplineHolder s;
+  ifopt::Problem nlp;
+  BuildProblem(f, s, nlp);
+  return nlp.GetVariableValues();
+}
+
+/** The number of constraints and variables with equal bounds. */
+static int
+GetEqualityCount (ifopt::Problem& nlp)
+{
+  int count = 0;
+  for (auto b : nlp.GetBoundsOnOptimizationVariables())
+    count += b.lower_ == b.upper_;
+  for (auto b : nlp.GetBoundsOnConstraints())
+    count += b.lower_ == b.upper_;
+  return count;
+}
+
+TEST(ParametricSensitivityTest, PredictAndCorrectMatchResolve)
+{
+  NlpFormulation f = GetStandingQuadruped(0.0);
+  VectorXd reference = GetReference(f);
+
+  SplineHolder s;
+  ifopt::Problem nlp;
+  VectorXd x_solved = Solve(f, s, nlp, reference, reference);
+
+  ParametricSensitivity sensitivity(f);
+  sensitivity.Linearize(nlp);
+  // only the equalities are active, as in the reference solve
+  EXPECT_EQ(GetEqualityCount(nlp), sensitivity.GetActiveCount());
+
+  NlpFormulation perturbed = GetStandingQuadruped(0.005);
+  SplineHolder s_resolved;
+  ifopt::Problem nlp_resolved;
+  VectorXd x_resolved = Solve(perturbed, s_resolved, nlp_resolved, reference,
+                             x_solved);
+
+  double error_unchanged = (x_solved - x_resolved).lpNorm<Eigen::Infinity>();
+  VectorXd x_predicted = sensitivity.Predict(perturbed);
+  double error_predicted = (x_predicted - x_resolved).lpNorm<Eigen::Infinity>();
+  EXPECT_LT(error_predicted, 0.1*error_unchanged);
+
+  nlp.SetVariables(x_predicted.data());
+  VectorXd x_corrected = sensitivity.Correct(nlp, perturbed);
+  double error_corrected = (x_corrected - x_resolved).lpNorm<Eigen::Infinity>();
+  EXPECT_LT(error_corrected, 0.1*error_predicted);
+}
+
+TEST(ParametricSensitivityTest, PredictIsSubMillisecond)
+{
+  NlpFormulation f = GetStandingQuadruped(0.0);
+  SplineHolder s;
+  ifopt::Problem nlp;
+  VectorXd reference = GetReference(f);
+  Solve(f, s, nlp, reference, reference);
+
+  ParametricSensitivity sensitivity(f);
+  sensitivity.Linearize(nlp);
+
+  NlpFormulation perturbed = GetStandingQuadruped(0.02);
+  const int n = 100;
+  auto start = std::chrono::steady_clock::now();
+  for (int i=0; i<n; ++i)
+    sensitivity.Update(nlp, perturbed, false);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_LT(elapsed.count()/n, 1e-3);
+}
+
+} /* namespace towr */
@@ -0,0 +1,162 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <numeric>
+
+#include <gtest/gtest.h>
+
+#include <ifopt/problem.h>
+
+#include <towr/constraints/periodic_constraint.h>
+#include <towr/terrain/examples/height_map_examples.h>
+#include <towr/variables/trajectory.h>
+#include <towr/variables/variable_names.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+// a single hop forward, whose right leg shares the variables of the left.
+static NlpFormulation
+GetPeriodicHop ()
+{
+  auto f = GetBipedFormulation(RobotModel(RobotModel::Biped),
+                               std::make_shared<FlatGround>(), 0.4, true);
+  f.params_.share_mirrored_ee_ = true;
+  f.params_.MakePeriodic();
+  return f;
+}
+
+TEST(PeriodicConstraintTest, JacobianWithMirroredNodes)
+{
+  auto formulation = GetPeriodicHop();
+  SplineHolder s;
+  ifopt::Problem nlp;
+  BuildProblem(formulation, s, nlp);
+
+  // the formulation skips the mirrored leg, constrain it anyway to check
+  // the derivatives scaled by the reflection.
+  Eigen::Vector3d translation(0.4, 0.0, 0.0);
+  auto motion = std::make_shared<PeriodicConstraint>(id::EEMotionNodes(1), translation,
+                                                     std::vector<int>{X,Y});
+  auto force  = std::make_shared<PeriodicConstraint>(id::EEForceNodes(1), Eigen::Vector3d::Zero());
+  nlp.AddConstraintSet(motion);
+  nlp.AddConstraintSet(force);
+  EXPECT_LT(0, motion->GetRows());
+  EXPECT_LT(0, force->GetRows());
+
+  Eigen::VectorXd x = nlp.GetVariableValues();
+  x += 0.01*Eigen::VectorXd::Random(x.size());
+  Eigen::VectorXd g = nlp.EvaluateConstraints(x.data());
+  Eigen::MatrixXd jac(nlp.GetJacobianOfConstraints());
+
+  double h = 1e-7;
+  for (int i=0; i<x.size(); ++i) {
+    Eigen::VectorXd xh = x;
+    xh(i) += h;
+    Eigen::VectorXd jac_fd = (nlp.EvaluateConstraints(xh.data()) - g)/h;
+    double scale = 1.0 + jac.col(i).cwiseAbs().maxCoeff();
+    EXPECT_LT((jac_fd - jac.col(i)).cwiseAbs().maxCoeff(), 1e-4*scale) << "variable " << i;
+  }
+
+  // the reflected leg violates the constraint in y the other way round
+  auto left = nlp.GetConstraints().GetComponent("periodic-" + id::EEMotionNodes(0));
+  Eigen::VectorXd g_left = left->GetValues();
+  Eigen::VectorXd g_right = motion->GetValues();
+  ASSERT_EQ(g_left.size(), g_right.size());
+  for (int row=0; row<g_left.size(); ++row)
+    EXPECT_NEAR(std::abs(g_left(row)), std::abs(g_right(row)), 1e-12);
+}
+
+// a periodic cycle of duration 1s moving forward by 0.4m.
+static Trajectory
+GetCycle ()
+{
+  std::vector<double> times = {0.0, 0.4, 1.0};
+  Eigen::MatrixXd pos(3,3), vel(3,3), zero = Eigen::MatrixXd::Zero(3,3);
+  pos << 0.0, 0.15, 0.4,
+         0.0, 0.02, 0.0,
+         0.6, 0.65, 0.6;
+  vel << 0.4, 0.5, 0.4,
+         0.1, 0.0, 0.1,
+         0.0, 0.0, 0.0;
+
+  Trajectory cycle;
+  cycle.base_linear_  = CubicHermiteSpline(times, pos, vel);
+  cycle.base_angular_ = CubicHermiteSpline(times, zero, zero);
+  cycle.ee_motion_    = {CubicHermiteSpline(times, pos, vel), CubicHermiteSpline(times, pos, vel)};
+  cycle.ee_force_     = {CubicHermiteSpline(times, zero, zero), CubicHermiteSpline(times, zero, zero)};
+  cycle.ee_phase_durations_ = {{0.3, 0.4, 0.3}, {0.5, 0.5}};
+  cycle.ee_in_contact_at_start_ = {true, false};
+  return cycle;
+}
+
+TEST(PeriodicConstraintTest, TileTrajectory)
+{
+  Trajectory cycle = GetCycle();
+  Eigen::Vector3d translation(0.4, 0.0, 0.0);
+  Trajectory tiled = TileTrajectory(cycle, 3, translation);
+
+  EXPECT_DOUBLE_EQ(3.0, tiled.GetTotalTime());
+  EXPECT_DOUBLE_EQ(3.0, tiled.base_linear_.GetTotalTime());
+
+  // continuous in position and velocity at the seams
+  double eps = 1e-9;
+  for (double t_seam : {1.0, 2.0}) {
+    for (const auto& s : {tiled.base_linear_, tiled.ee_motion_.at(0)}) {
+      State before = s.GetPoint(t_seam - eps);
+      State after  = s.GetPoint(t_seam + eps);
+      EXPECT_TRUE(before.p().isApprox(after.p(), 1e-6)) << "seam at " << t_seam;
+      EXPECT_TRUE(before.v().isApprox(after.v(), 1e-6)) << "seam at " << t_seam;
+    }
+  }
+
+  // each cycle is the original one, shifted in time and space
+  for (int c=0; c<3; ++c) {
+    for (double t : {0.1, 0.4, 0.7}) {
+      State expected = cycle.base_linear_.GetPoint(t);
+      State tile = tiled.base_linear_.GetPoint(c + t);
+      EXPECT_TRUE(tile.p().isApprox(expected.p() + c*translation, 1e-12));
+      EXPECT_TRUE(tile.v().isApprox(expected.v(), 1e-12));
+    }
+  }
+
+  // the stance phases at the seams merge, the alternating ones are repeated
+  EXPECT_EQ(std::vector<double>({0.3, 0.4, 0.6, 0.4, 0.6, 0.4, 0.3}), tiled.ee_phase_durations_.at(0));
+  EXPECT_EQ(std::vector<double>({0.5, 0.5, 0.5, 0.5, 0.5, 0.5}), tiled.ee_phase_durations_.at(1));
+  EXPECT_EQ(cycle.ee_in_contact_at_start_, tiled.ee_in_contact_at_start_);
+  for (int ee=0; ee<2; ++ee) {
+    const auto& d = tiled.ee_phase_durations_.at(ee);
+    EXPECT_NEAR(3.0, std::accumulate(d.begin(), d.end(), 0.0), 1e-12);
+  }
+  EXPECT_TRUE(tiled.IsContactPhase(0, 1.1));
+  EXPECT_FALSE(tiled.IsContactPhase(0, 1.5));
+}
+
+} /* namespace towr */
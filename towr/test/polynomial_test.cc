@@ -0,0 +1,154 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <towr/variables/cartesian_dimensions.h>
+#include <towr/variables/cubic_hermite_spline.h>
+#include <towr/variables/node_spline.h>
+#include <towr/variables/nodes_variables_all.h>
+#include <towr/variables/polynomial.h>
+
+namespace towr {
+
+// a polynomial through random nodes, quintic if the nodes hold accelerations.
+static CubicHermitePolynomial
+GetPolynomial (const Node& n0, const Node& n1, double T)
+{
+  CubicHermitePolynomial p(n0.p().rows(), n0.GetDerivativeCount());
+  p.SetNodes(n0, n1);
+  p.SetDuration(T);
+  p.UpdateCoeff();
+  return p;
+}
+
+static Node
+GetRandomNode (int n_derivatives)
+{
+  Node n(3, n_derivatives);
+  for (int d=0; d<n_derivatives; ++d)
+    n.at(static_cast<Dx>(d)) = Eigen::Vector3d::Random();
+  return n;
+}
+
+TEST(PolynomialTest, DerivativeWrtNodesMatchesFiniteDifference)
+{
+  std::srand(7);
+  const double h = 1e-6;
+  const double T = 0.4;
+
+  for (int n_derivatives : {2, 3}) {
+    Node n0 = GetRandomNode(n_derivatives);
+    Node n1 = GetRandomNode(n_derivatives);
+    auto p = GetPolynomial(n0, n1, T);
+
+    for (int node_deriv=0; node_deriv<n_derivatives; ++node_deriv) {
+      Dx nd = static_cast<Dx>(node_deriv);
+      for (int dim=0; dim<3; ++dim) {
+        Node n0h = n0, n1h = n1;
+        n0h.at(nd)(dim) += h;
+        n1h.at(nd)(dim) += h;
+        auto p0h = GetPolynomial(n0h, n1, T);
+        auto p1h = GetPolynomial(n0, n1h, T);
+
+        for (double t : {0.0, 0.05, 0.17, 0.3, T}) {
+          State s = p.GetPoint(t);
+          State s0 = p0h.GetPoint(t);
+          State s1 = p1h.GetPoint(t);
+          for (Dx dfdt : {kPos, kVel, kAcc}) {
+            double fd_start = (s0.at(dfdt)(dim) - s.at(dfdt)(dim))/h;
+            double fd_end   = (s1.at(dfdt)(dim) - s.at(dfdt)(dim))/h;
+            EXPECT_NEAR(fd_start, p.GetDerivativeWrtStartNode(dfdt, nd, t), 1e-4)
+              << "nodes with " << n_derivatives << " derivatives, node deriv "
+              << node_deriv << ", dfdt " << dfdt << ", t=" << t;
+            EXPECT_NEAR(fd_end, p.GetDerivativeWrtEndNode(dfdt, nd, t), 1e-4)
+              << "nodes with " << n_derivatives << " derivatives, node deriv "
+              << node_deriv << ", dfdt " << dfdt << ", t=" << t;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(PolynomialTest, DerivativeWrtDurationMatchesFiniteDifference)
+{
+  std::srand(11);
+  const double h = 1e-7;
+  const double T = 0.4;
+
+  Node n0 = GetRandomNode(2);
+  Node n1 = GetRandomNode(2);
+  auto p = GetPolynomial(n0, n1, T);
+  auto ph = GetPolynomial(n0, n1, T+h);
+
+  for (double t : {0.05, 0.17, 0.3}) {
+    Eigen::VectorXd fd = (ph.GetPoint(t).p() - p.GetPoint(t).p())/h;
+    EXPECT_TRUE(fd.isApprox(p.GetDerivativeOfPosWrtDuration(t), 1e-4)) << "t=" << t;
+  }
+
+  // durations of quintic polynomials can't be optimized
+  auto quintic = GetPolynomial(GetRandomNode(3), GetRandomNode(3), T);
+  EXPECT_THROW(quintic.GetDerivativeOfPosWrtDuration(0.1), std::runtime_error);
+}
+
+TEST(PolynomialTest, QuinticSplineIsCopiedExactly)
+{
+  std::srand(13);
+  std::vector<double> durations = {0.3, 0.15, 0.4};
+  auto nodes = std::make_shared<NodesVariablesAll>(durations.size()+1, k3D, "lin", 3);
+  nodes->SetVariables(Eigen::VectorXd::Random(nodes->GetRows()));
+  NodeSpline spline(nodes.get(), durations);
+
+  CubicHermiteSpline copy(spline);
+  EXPECT_TRUE(copy.IsQuintic());
+  EXPECT_EQ(durations.size()+1, copy.GetKnotCount());
+
+  double t_total = copy.GetTotalTime();
+  for (double t=0.0; t<=t_total; t+=t_total/97) {
+    State s = spline.GetPoint(t);
+    State c = copy.GetPoint(t);
+    EXPECT_TRUE(s.p().isApprox(c.p(), 1e-10)) << "t=" << t;
+    EXPECT_TRUE(s.v().isApprox(c.v(), 1e-10)) << "t=" << t;
+    EXPECT_TRUE(s.a().isApprox(c.a(), 1e-10)) << "t=" << t;
+  }
+
+  // the acceleration is continuous across the knots.
+  for (int k=1; k<copy.GetKnotCount()-1; ++k) {
+    double t = copy.GetKnotTimes().at(k);
+    Eigen::VectorXd before = copy.GetPoint(t-1e-9).a();
+    Eigen::VectorXd after  = copy.GetPoint(t+1e-9).a();
+    EXPECT_LT((before - after).norm(), 1e-4);
+    EXPECT_TRUE(copy.GetKnotAccelerations().col(k).isApprox(after, 1e-4));
+  }
+}
+
+} /* namespace towr */
@@ -0,0 +1,151 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <ifopt/problem.h>
+#include <ifopt/solver.h>
+
+#include <towr/planning/portfolio_planner.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+// stand-in for a solver, which moves the variables onto their bounds after
+// a few iterations and then offsets them by a fixed constraint violation.
+// Each iteration takes some time, so the solves can be cancelled.
+class ProjectingSolver : public ifopt::Solver {
+public:
+  ProjectingSolver (int iterations, double violation = 0.0)
+      : iterations_(iterations), violation_(violation) {}
+
+  void Solve (ifopt::Problem& nlp) override
+  {
+    auto bounds = nlp.GetBoundsOnOptimizationVariables();
+    Eigen::VectorXd x = nlp.GetVariableValues();
+    for (std::size_t i=0; i<bounds.size(); ++i)
+      x(i) = std::min(std::max(x(i), bounds.at(i).lower_), bounds.at(i).upper_) + violation_;
+
+    for (int iter=0; iter<iterations_; ++iter) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      nlp.SetVariables(x.data());
+      nlp.SaveCurrent();
+    }
+  }
+
+private:
+  int iterations_;
+  double violation_;
+};
+
+// without constraints, the variable bounds decide if a solution is feasible.
+static PortfolioPlanner::Variant
+GetVariant (double goal_x, int iterations, double violation = 0.0)
+{
+  RobotModel model(RobotModel::Biped);
+  PortfolioPlanner::Variant v;
+  v.name_ = std::to_string(goal_x);
+  v.formulation_ = GetBipedFormulation(model, std::make_shared<FlatGround>(), goal_x);
+  v.formulation_.params_.constraints_.clear();
+  v.formulation_.params_.costs_ = {{Parameters::BaseAccCostID, 1.0}};
+  v.solver_factory_ = [iterations, violation]() {
+    return std::make_shared<ProjectingSolver>(iterations, violation);
+  };
+  return v;
+}
+
+TEST(PortfolioPlannerTest, FirstFeasibleWinsAndCancelsOthers)
+{
+  std::vector<PortfolioPlanner::Variant> variants;
+  variants.push_back(GetVariant(0.1, 1000));     // would take 10s
+  variants.push_back(GetVariant(0.2, 1000, 1.0)); // never feasible
+  variants.push_back(GetVariant(0.3, 3));
+
+  auto start = std::chrono::steady_clock::now();
+  auto result = PortfolioPlanner(10.0, true, 3).Solve(variants);
+  double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  EXPECT_EQ(2, result.variant_);
+  EXPECT_LT(time, 5.0);
+  EXPECT_EQ(SolveResult::Finished,  result.outcomes_.at(2).result_.status_);
+  EXPECT_TRUE(result.outcomes_.at(2).result_.is_feasible_);
+  EXPECT_EQ(SolveResult::Cancelled, result.outcomes_.at(0).result_.status_);
+  EXPECT_EQ(SolveResult::Cancelled, result.outcomes_.at(1).result_.status_);
+
+  double T = result.trajectory_.GetTotalTime();
+  EXPECT_NEAR(0.3, result.trajectory_.base_linear_.GetPoint(T).p().x(), 1e-6);
+}
+
+TEST(PortfolioPlannerTest, WaitingVariantsAreNotStartedAfterAWin)
+{
+  std::vector<PortfolioPlanner::Variant> variants;
+  variants.push_back(GetVariant(0.1, 3));
+  variants.push_back(GetVariant(0.2, 1000));
+
+  auto planner = PortfolioPlanner(10.0, true, 1);
+  EXPECT_EQ(1, planner.GetThreadCount());
+
+  auto result = planner.Solve(variants);
+  EXPECT_EQ(0, result.variant_);
+  EXPECT_EQ(SolveResult::Cancelled, result.outcomes_.at(1).result_.status_);
+  EXPECT_EQ(0, result.outcomes_.at(1).result_.iteration_count_);
+  EXPECT_EQ(0.0, result.outcomes_.at(1).solve_time_);
+}
+
+TEST(PortfolioPlannerTest, BestAtDeadlineByCostThenViolation)
+{
+  // all feasible, but the longer motion accelerates the base more.
+  std::vector<PortfolioPlanner::Variant> variants;
+  variants.push_back(GetVariant(0.4, 3));
+  variants.push_back(GetVariant(0.1, 3));
+  variants.push_back(GetVariant(0.0, 1000, 0.5)); // stopped by the deadline
+
+  auto result = PortfolioPlanner(0.5, false, 3).Solve(variants);
+  EXPECT_EQ(1, result.variant_);
+  EXPECT_LT(result.outcomes_.at(1).cost_, result.outcomes_.at(0).cost_);
+  EXPECT_EQ(SolveResult::DeadlineReached, result.outcomes_.at(2).result_.status_);
+  EXPECT_FALSE(result.outcomes_.at(2).result_.is_feasible_);
+
+  // none feasible, so the smallest constraint violation wins.
+  variants.clear();
+  variants.push_back(GetVariant(0.1, 3, 0.3));
+  variants.push_back(GetVariant(0.1, 3, 0.1));
+  variants.push_back(GetVariant(0.1, 3, 0.2));
+
+  result = PortfolioPlanner(0.5, false, 3).Solve(variants);
+  EXPECT_EQ(1, result.variant_);
+  EXPECT_NEAR(0.1, result.outcomes_.at(1).result_.constraint_violation_, 1e-6);
+}
+
+} /* namespace towr */
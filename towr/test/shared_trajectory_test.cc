@@ -0,0 +1,177 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <towr/io/shared_trajectory_writer.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+// the initial guess of the biped problem, optionally with a quintic base.
+static Trajectory
+GetTrajectory (double goal_x, bool quintic_base = false)
+{
+  NlpFormulation f = GetBipedFormulation(RobotModel(RobotModel::Biped),
+                                         std::make_shared<FlatGround>(), goal_x);
+  if (quintic_base)
+    f.params_.UseQuinticBase();
+
+  SplineHolder splines;
+  ifopt::Problem nlp;
+  BuildProblem(f, splines, nlp);
+  return Trajectory(splines);
+}
+
+static void
+ExpectEqual (const CubicHermiteSpline& s, const SharedSplineView& view, double t)
+{
+  State expected = s.GetPoint(t);
+  double pos[3], vel[3], acc[3];
+  view.GetPoint(t, pos, vel, acc);
+  for (int dim=0; dim<3; ++dim) {
+    EXPECT_NEAR(expected.p()(dim), pos[dim], 1e-9) << "t=" << t;
+    EXPECT_NEAR(expected.v()(dim), vel[dim], 1e-9) << "t=" << t;
+    EXPECT_NEAR(expected.a()(dim), acc[dim], 1e-6) << "t=" << t;
+  }
+}
+
+TEST(SharedTrajectoryTest, RoundTripThroughView)
+{
+  SharedTrajectoryWriter writer("/towr_test_round_trip");
+  SharedTrajectoryReader reader("/towr_test_round_trip");
+  ASSERT_TRUE(reader.IsOpen());
+  EXPECT_EQ(0, reader.GetLatestId());
+  EXPECT_FALSE(reader.Read([](const SharedTrajectoryView&, uint64_t) {}));
+
+  for (bool quintic_base : {false, true}) {
+    Trajectory traj = GetTrajectory(0.3, quintic_base);
+    uint64_t id = writer.Write(traj);
+    ASSERT_NE(0, id);
+
+    bool called = false;
+    bool ok = reader.Read([&](const SharedTrajectoryView& view, uint64_t write_id) {
+      called = true;
+      EXPECT_EQ(id, write_id);
+      EXPECT_EQ(traj.GetTotalTime(), view.GetTotalTime());
+      ASSERT_EQ(traj.GetEECount(), view.GetEECount());
+
+      for (double t=0.0; t<=traj.GetTotalTime(); t+=0.013) {
+        ExpectEqual(traj.base_linear_,  view.GetBaseLinear(), t);
+        ExpectEqual(traj.base_angular_, view.GetBaseAngular(), t);
+        for (int ee=0; ee<traj.GetEECount(); ++ee) {
+          ExpectEqual(traj.ee_motion_.at(ee), view.GetEEMotion(ee), t);
+          ExpectEqual(traj.ee_force_.at(ee),  view.GetEEForce(ee), t);
+          EXPECT_EQ(traj.IsContactPhase(ee, t), view.IsContactPhase(ee, t)) << "t=" << t;
+        }
+      }
+    });
+    EXPECT_TRUE(ok);
+    EXPECT_TRUE(called);
+  }
+}
+
+TEST(SharedTrajectoryTest, LaggingReaderDetectsOverwrittenSlot)
+{
+  SharedTrajectoryWriter writer("/towr_test_lagging", 2);
+  SharedTrajectoryReader reader("/towr_test_lagging");
+  Trajectory slow = GetTrajectory(0.1);
+  Trajectory fast = GetTrajectory(0.2);
+  writer.Write(slow);
+
+  // while the reader evaluates the slot, the writer wraps around the ring
+  // and overwrites it.
+  auto read_while_writing = [&](const SharedTrajectoryView&, uint64_t id) {
+    if (id == 1) {
+      writer.Write(fast);
+      writer.Write(fast);
+    }
+  };
+  EXPECT_FALSE(reader.Read(read_while_writing, 1));
+
+  // retrying reads the latest trajectory.
+  uint64_t read_id = 0;
+  EXPECT_TRUE(reader.Read([&](const SharedTrajectoryView&, uint64_t id) { read_id = id; }));
+  EXPECT_EQ(3, read_id);
+}
+
+// modifies the region header the way a different writer version would.
+static void
+ModifyRegion (const std::string& name, uint32_t version, off_t size)
+{
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  ASSERT_GE(fd, 0);
+  void* addr = mmap(nullptr, sizeof(shm::RegionHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ASSERT_NE(MAP_FAILED, addr);
+  static_cast<shm::RegionHeader*>(addr)->version_ = version;
+  munmap(addr, sizeof(shm::RegionHeader));
+  if (size > 0)
+    ASSERT_EQ(0, ftruncate(fd, size));
+  close(fd);
+}
+
+TEST(SharedTrajectoryTest, IncompatibleRegionIsRejected)
+{
+  EXPECT_FALSE(SharedTrajectoryReader("/towr_test_missing").IsOpen());
+
+  SharedTrajectoryWriter writer("/towr_test_incompatible", 2, 4096);
+  EXPECT_TRUE(SharedTrajectoryReader("/towr_test_incompatible").IsOpen());
+
+  ModifyRegion("/towr_test_incompatible", shm::kVersion+1, 0);
+  EXPECT_FALSE(SharedTrajectoryReader("/towr_test_incompatible").IsOpen());
+
+  // the slots don't fit into the region anymore
+  ModifyRegion("/towr_test_incompatible", shm::kVersion, shm::GetSlotOffset(2, 4096)-8);
+  EXPECT_FALSE(SharedTrajectoryReader("/towr_test_incompatible").IsOpen());
+}
+
+TEST(SharedTrajectoryTest, CorruptPayloadIsInvalid)
+{
+  std::vector<char> payload;
+  SharedTrajectoryWriter::Serialize(GetTrajectory(0.1), payload);
+  EXPECT_TRUE(SharedTrajectoryView(payload.data(), payload.size()).IsValid());
+
+  // truncated, so the last block doesn't fit anymore
+  EXPECT_FALSE(SharedTrajectoryView(payload.data(), payload.size()-8).IsValid());
+
+  // unknown polynomial order of the first spline
+  std::vector<char> corrupt = payload;
+  auto offsets = reinterpret_cast<const uint64_t*>(corrupt.data() + sizeof(shm::PayloadHeader));
+  auto h = reinterpret_cast<shm::SplineBlockHeader*>(corrupt.data() + offsets[0]);
+  h->coeff_count_ = 5;
+  EXPECT_FALSE(SharedTrajectoryView(corrupt.data(), corrupt.size()).IsValid());
+}
+
+} /* namespace towr */
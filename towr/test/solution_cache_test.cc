@@ -0,0 +1,177 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include <towr/io/trajectory_file.h>
+#include <towr/planning/planning_protocol.h>
+#include <towr/planning/solution_cache.h>
+
+namespace towr {
+
+static SolutionCache::TrajectoryPtr
+GetSolution (double goal_x)
+{
+  Eigen::MatrixXd pos = Eigen::MatrixXd::Zero(3,2);
+  Eigen::MatrixXd vel = Eigen::MatrixXd::Zero(3,2);
+  pos(0,1) = goal_x;
+
+  auto solution = std::make_shared<Trajectory>();
+  solution->base_linear_  = CubicHermiteSpline({0.0, 1.0}, pos, vel);
+  solution->base_angular_ = CubicHermiteSpline({0.0, 1.0}, vel, vel);
+  return solution;
+}
+
+static SolutionCache::Problem
+GetProblem (int terrain_version, uint32_t flags)
+{
+  SolutionCache::Problem p;
+  p.terrain_version_ = terrain_version;
+  p.flags_           = flags;
+  p.total_duration_  = 1.0;
+  p.pose_.at(6)      = 0.5; // goal x
+  return p;
+}
+
+TEST(SolutionCacheTest, FlagsAndTerrainVersionSeparateSolutions)
+{
+  using planning_protocol::kOptimizePhaseDurations;
+
+  SolutionCache cache;
+  cache.Insert(GetProblem(7, 0), GetSolution(0.5));
+  EXPECT_TRUE(cache.Find(GetProblem(7, 0)));
+  EXPECT_FALSE(cache.Find(GetProblem(7, kOptimizePhaseDurations)));
+  EXPECT_FALSE(cache.FindNearest(GetProblem(7, kOptimizePhaseDurations)));
+  EXPECT_FALSE(cache.Find(GetProblem(8, 0)));
+
+  cache.Insert(GetProblem(7, kOptimizePhaseDurations), GetSolution(0.5));
+  EXPECT_EQ(2, cache.GetSize());
+}
+
+TEST(SolutionCacheTest, SaveAndLoadKeepsKey)
+{
+  using planning_protocol::kOptimizePhaseDurations;
+
+  SolutionCache cache;
+  cache.Insert(GetProblem(7, kOptimizePhaseDurations), GetSolution(0.5));
+
+  std::string path = "solution_cache_test.trj";
+  cache.Save(path);
+  SolutionCache loaded;
+  loaded.Load(path);
+  std::remove(path.c_str());
+
+  auto hit = loaded.Find(GetProblem(7, kOptimizePhaseDurations));
+  ASSERT_TRUE(hit);
+  EXPECT_DOUBLE_EQ(0.5, hit->base_linear_.GetPoint(1.0).p().x());
+  EXPECT_FALSE(loaded.Find(GetProblem(7, 0)));
+  EXPECT_FALSE(loaded.Find(GetProblem(8, kOptimizePhaseDurations)));
+}
+
+TEST(SolutionCacheTest, LoadRejectsProblemsWithoutFlags)
+{
+  std::vector<double> values(5+SolutionCache::kPoseDim, 0.0);
+  auto columns = trajectory_file::GetKnotColumns(*GetSolution(0.5));
+  columns.emplace_back("cache/problem", values);
+
+  std::string path = "solution_cache_test.trj";
+  {
+    TrajectoryFileWriter file(path);
+    file.Append(columns, 0, 0.0);
+  }
+  SolutionCache cache;
+  EXPECT_THROW(cache.Load(path), std::runtime_error);
+  std::remove(path.c_str());
+}
+
+TEST(SolutionCacheTest, FindNearestEqualsBruteForce)
+{
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+  std::uniform_int_distribution<int> grid(-2, 2);
+
+  // the first axes only take a few values, so many poses lie on the
+  // splitting planes and the nearest one is often on the other side.
+  auto random_pose = [&]() {
+    SolutionCache::Pose pose;
+    for (int i=0; i<SolutionCache::kPoseDim; ++i)
+      pose.at(i) = i < 3? 0.5*grid(gen) : uniform(gen);
+    return pose;
+  };
+
+  SolutionCache cache;
+  std::vector<SolutionCache::Pose> poses;
+  std::vector<SolutionCache::TrajectoryPtr> solutions;
+  for (int i=0; i<500; ++i) {
+    SolutionCache::Problem p = GetProblem(7, 0);
+    p.pose_ = random_pose();
+    poses.push_back(p.pose_);
+    solutions.push_back(GetSolution(i));
+    cache.Insert(p, solutions.back());
+  }
+  ASSERT_EQ(500, cache.GetSize());
+
+  auto dist = [](const SolutionCache::Pose& a, const SolutionCache::Pose& b) {
+    double d2 = 0.0;
+    for (int i=0; i<SolutionCache::kPoseDim; ++i)
+      d2 += (a.at(i)-b.at(i))*(a.at(i)-b.at(i));
+    return std::sqrt(d2);
+  };
+
+  for (int q=0; q<300; ++q) {
+    SolutionCache::Problem query = GetProblem(7, 0);
+    query.pose_ = random_pose();
+    if (q%2 == 0) { // close to a stored pose, but across its splitting plane
+      query.pose_ = poses.at(q);
+      query.pose_.at(q%SolutionCache::kPoseDim) -= 0.01;
+    }
+
+    double expected = std::numeric_limits<double>::infinity();
+    for (const auto& p : poses)
+      expected = std::min(expected, dist(query.pose_, p));
+
+    double distance = -1.0;
+    auto nearest = cache.FindNearest(query, &distance);
+    ASSERT_TRUE(nearest);
+    EXPECT_NEAR(expected, distance, 1e-12) << "query " << q;
+
+    // the returned solution is the one stored at that distance
+    int i = std::find(solutions.begin(), solutions.end(), nearest) - solutions.begin();
+    ASSERT_LT(i, poses.size());
+    EXPECT_NEAR(distance, dist(query.pose_, poses.at(i)), 1e-12) << "query " << q;
+  }
+}
+
+} /* namespace towr */
@@ -0,0 +1,170 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <ifopt/constraint_set.h>
+#include <ifopt/problem.h>
+#include <ifopt/solver.h>
+
+#include <towr/planning/solve_monitor.h>
+#include <towr/variables/nodes_variables_all.h>
+
+namespace towr {
+
+// the sum of all variables within [0, 0.5].
+class SumConstraint : public ifopt::ConstraintSet {
+public:
+  SumConstraint () : ConstraintSet(1, "sum") {}
+
+  VectorXd GetValues () const override
+  {
+    VectorXd g(1);
+    g(0) = GetVariables()->GetComponent("nodes")->GetValues().sum();
+    return g;
+  }
+
+  VecBound GetBounds () const override { return VecBound(1, ifopt::Bounds(0.0, 0.5)); }
+
+  void FillJacobianBlock (std::string var_set, Jacobian& jac) const override
+  {
+    if (var_set == "nodes")
+      for (int i=0; i<jac.cols(); ++i)
+        jac.coeffRef(0, i) = 1.0;
+  }
+};
+
+// stand-in for a solver, which adds 0.1 to all variables per iteration.
+// Before every iteration a trial point is evaluated, which is where an
+// aborted solve stops.
+class StepSolver : public ifopt::Solver {
+public:
+  using Callback = std::function<void(int iteration)>;
+
+  StepSolver (int iterations, const Callback& after_iteration = [](int){})
+      : iterations_(iterations), after_iteration_(after_iteration) {}
+
+  void Solve (ifopt::Problem& nlp) override
+  {
+    Eigen::VectorXd x = nlp.GetVariableValues();
+    for (int iter=0; iter<iterations_; ++iter) {
+      Eigen::VectorXd trial = x.array() + 100.0;
+      nlp.SetVariables(trial.data());
+
+      x.array() += 0.1;
+      nlp.SetVariables(x.data());
+      nlp.SaveCurrent();
+      after_iteration_(iter);
+    }
+  }
+
+private:
+  int iterations_;
+  Callback after_iteration_;
+};
+
+static void
+BuildProblem (ifopt::Problem& nlp)
+{
+  auto nodes = std::make_shared<NodesVariablesAll>(2, 1, "nodes"); // 4 values, all 0
+  nlp.AddVariableSet(nodes);
+  nlp.AddConstraintSet(std::make_shared<SumConstraint>());
+}
+
+TEST(SolveMonitorTest, FinishedSolveReportsViolation)
+{
+  ifopt::Problem nlp;
+  BuildProblem(nlp);
+
+  CancellationToken token;
+  StepSolver solver(5);
+  SolveResult r = SolveInterruptible(solver, nlp, token);
+
+  // 4 variables of 0.5 each, so the sum exceeds its bound by 1.5
+  EXPECT_EQ(SolveResult::Finished, r.status_);
+  EXPECT_EQ(5, r.iteration_count_);
+  EXPECT_NEAR(1.5, r.constraint_violation_, 1e-12);
+  EXPECT_FALSE(r.is_feasible_);
+
+  // the initial guess (sum 0) fulfills the constraint
+  ifopt::Problem feasible;
+  BuildProblem(feasible);
+  StepSolver no_steps(0);
+  r = SolveInterruptible(no_steps, feasible, token);
+  EXPECT_EQ(0.0, r.constraint_violation_);
+  EXPECT_TRUE(r.is_feasible_);
+}
+
+TEST(SolveMonitorTest, CancelRestoresLastIterate)
+{
+  ifopt::Problem nlp;
+  BuildProblem(nlp);
+
+  // cancelled after the third iteration, so the trial point of the fourth
+  // is aborted.
+  CancellationToken token;
+  StepSolver solver(10, [&](int iter) { if (iter == 2) token.Cancel(); });
+  SolveResult r = SolveInterruptible(solver, nlp, token);
+
+  EXPECT_EQ(SolveResult::Cancelled, r.status_);
+  EXPECT_EQ(3, r.iteration_count_);
+  EXPECT_TRUE(nlp.GetVariableValues().isApproxToConstant(0.3));
+  EXPECT_NEAR(4*0.3 - 0.5, r.constraint_violation_, 1e-12);
+
+  // cancelled before the first iteration, so the initial guess is restored.
+  ifopt::Problem nlp_cancelled;
+  BuildProblem(nlp_cancelled);
+  r = SolveInterruptible(solver, nlp_cancelled, token);
+  EXPECT_EQ(SolveResult::Cancelled, r.status_);
+  EXPECT_EQ(0, r.iteration_count_);
+  EXPECT_TRUE(nlp_cancelled.GetVariableValues().isZero());
+  EXPECT_TRUE(r.is_feasible_);
+}
+
+TEST(SolveMonitorTest, DeadlineStopsSolve)
+{
+  ifopt::Problem nlp;
+  BuildProblem(nlp);
+
+  CancellationToken token;
+  StepSolver solver(1000, [](int) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); });
+  SolveResult r = SolveInterruptible(solver, nlp, token, 0.05);
+
+  EXPECT_EQ(SolveResult::DeadlineReached, r.status_);
+  EXPECT_GE(r.wall_time_, 0.05);
+  EXPECT_LT(r.wall_time_, 1.0);
+  EXPECT_GT(r.iteration_count_, 0);
+  EXPECT_TRUE(nlp.GetVariableValues().isApproxToConstant(0.1*r.iteration_count_));
+}
+
+} /* namespace towr */
@@ -0,0 +1,125 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <ifopt/problem.h>
+
+#include <towr/costs/spline_integral_cost.h>
+#include <towr/nlp_formulation.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+TEST(SplineIntegralCostTest, SegmentMatrixMatchesQuadrature)
+{
+  double T = 0.7;
+  Node n0(1), n1(1);
+  n0.at(kPos) << 0.3;  n0.at(kVel) << -1.2;
+  n1.at(kPos) << -0.5; n1.at(kVel) << 2.0;
+
+  CubicHermitePolynomial p(1);
+  p.SetNodes(n0, n1);
+  p.SetDuration(T);
+  p.UpdateCoeff();
+  double jerk = (p.GetPoint(T).a()(0) - p.GetPoint(0.0).a()(0))/T; // constant
+
+  Eigen::Vector4d u(0.3, -1.2, -0.5, 2.0);
+  for (Dx d : {kPos, kVel, kAcc, kJerk}) {
+    // Simpson's rule is exact up to cubic integrands, so sample finely.
+    int n = 1000;
+    double h = T/n, integral = 0.0;
+    for (int i=0; i<=n; ++i) {
+      double w = (i==0 || i==n)? 1.0 : (i%2==1? 4.0 : 2.0);
+      double v = d==kJerk? jerk : p.GetPoint(i*h).at(d)(0);
+      integral += w*v*v*h/3;
+    }
+
+    double closed_form = u.transpose()*SplineIntegralCost::GetSegmentMatrix(T, d)*u;
+    EXPECT_NEAR(integral, closed_form, 1e-6*(1.0+std::abs(integral))) << "derivative " << d;
+  }
+}
+
+TEST(SplineIntegralCostTest, GradientAndHessian)
+{
+  auto f = GetBipedFormulation(RobotModel(RobotModel::Biped),
+                               std::make_shared<FlatGround>(), 0.4);
+
+  for (auto cost : {Parameters::BaseAccCostID, Parameters::BaseJerkCostID,
+                    Parameters::ForcesIntegralCostID, Parameters::ForceRateCostID}) {
+    f.params_.costs_ = {{cost, 0.1}};
+
+    SplineHolder s;
+    ifopt::Problem nlp;
+    for (auto c : f.GetVariableSets(s))
+      nlp.AddVariableSet(c);
+    auto costs = f.GetCosts();
+    for (auto c : costs)
+      nlp.AddCostSet(c);
+
+    Eigen::VectorXd x = nlp.GetVariableValues();
+    x += 0.1*Eigen::VectorXd::Random(x.size());
+    Eigen::VectorXd grad = nlp.EvaluateCostFunctionGradient(x.data());
+
+    // quadratic, so central differences are exact up to round-off
+    double h = 1e-4;
+    for (int i=0; i<x.size(); ++i) {
+      Eigen::VectorXd xp = x, xm = x;
+      xp(i) += h;
+      xm(i) -= h;
+      double grad_fd = (nlp.EvaluateCostFunction(xp.data()) - nlp.EvaluateCostFunction(xm.data()))/(2*h);
+      EXPECT_NEAR(grad_fd, grad(i), 1e-5*(1.0+std::abs(grad(i)))) << "cost " << cost << " variable " << i;
+    }
+
+    // c(x+d) = c(x) + grad^T d + 0.5 d^T H d, each cost only depends on
+    // the variables of its nodes.
+    Eigen::VectorXd d = 0.1*Eigen::VectorXd::Random(x.size());
+    double quadratic = 0.0;
+    int row = 0;
+    for (auto vars : nlp.GetOptVariables()->GetComponents()) {
+      for (auto c : costs) {
+        auto integral = std::dynamic_pointer_cast<SplineIntegralCost>(c);
+        if (integral->GetHessianVariablesName() == vars->GetName()) {
+          Eigen::VectorXd di = d.segment(row, vars->GetRows());
+          quadratic += 0.5*di.dot(integral->GetHessian()*di);
+        }
+      }
+      row += vars->GetRows();
+    }
+
+    Eigen::VectorXd xd = x + d;
+    double expected = nlp.EvaluateCostFunction(x.data()) + grad.dot(d) + quadratic;
+    double c = nlp.EvaluateCostFunction(xd.data());
+    EXPECT_NEAR(expected, c, 1e-8*(1.0+std::abs(c))) << "cost " << cost;
+  }
+}
+
+} /* namespace towr */
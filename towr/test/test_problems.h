@@ -0,0 +1,82 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_TEST_TEST_PROBLEMS_H_
+#define TOWR_TEST_TEST_PROBLEMS_H_
+
+#include <ifopt/problem.h>
+
+#include <towr/nlp_formulation.h>
+
+namespace towr {
+
+/**
+ * @brief A biped moving its base to @a goal_x within 1.3s.
+ *
+ * The left leg steps with phases {0.3, 0.2, 0.3, 0.2, 0.3}. When walking
+ * the right leg lifts off later than the left, when @a hopping both legs
+ * move together. The model and terrain are passed in, so several
+ * formulations can share them.
+ */
+inline NlpFormulation
+GetBipedFormulation (const RobotModel& model, const HeightMap::Ptr& terrain,
+                     double goal_x, bool hopping = false)
+{
+  NlpFormulation f;
+  f.model_ = model;
+  f.terrain_ = terrain;
+  f.initial_base_.lin.at(kPos).z() = 0.65;
+  f.initial_ee_W_ = model.kinematic_model_->GetNominalStanceInBase();
+  for (auto& p : f.initial_ee_W_)
+    p.z() = 0.0;
+  f.final_base_.lin.at(kPos) << goal_x, 0.0, 0.65;
+  f.params_.ee_phase_durations_.push_back({0.3, 0.2, 0.3, 0.2, 0.3});
+  if (hopping)
+    f.params_.ee_phase_durations_.push_back({0.3, 0.2, 0.3, 0.2, 0.3});
+  else
+    f.params_.ee_phase_durations_.push_back({0.4, 0.2, 0.3, 0.2, 0.2});
+  f.params_.ee_in_contact_at_start_ = {true, true};
+  return f;
+}
+
+/** @brief Adds all variables, constraints and costs of @a f to @a nlp. */
+inline void
+BuildProblem (NlpFormulation& f, SplineHolder& s, ifopt::Problem& nlp)
+{
+  for (auto c : f.GetVariableSets(s))
+    nlp.AddVariableSet(c);
+  for (auto c : f.GetConstraints(s))
+    nlp.AddConstraintSet(c);
+  for (auto c : f.GetCosts())
+    nlp.AddCostSet(c);
+}
+
+} /* namespace towr */
+
+#endif /* TOWR_TEST_TEST_PROBLEMS_H_ */
@@ -0,0 +1,111 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+
+#include <gtest/gtest.h>
+
+#include <towr/io/trajectory_compression.h>
+#include <towr/io/trajectory_file.h>
+
+namespace towr {
+
+// a smooth 3D motion with a knot every dt.
+static CubicHermiteSpline
+GetSmoothSpline (double dt, double T)
+{
+  int n_knots = std::round(T/dt) + 1;
+  CubicHermiteSpline::VecTimes times(n_knots);
+  Eigen::MatrixXd pos(3, n_knots), vel(3, n_knots);
+  for (int k=0; k<n_knots; ++k) {
+    double t = k*dt;
+    times.at(k) = t;
+    pos.col(k) << std::sin(2*t),   std::cos(3*t),    0.5*t*t;
+    vel.col(k) << 2*std::cos(2*t), -3*std::sin(3*t), t;
+  }
+  return CubicHermiteSpline(times, pos, vel);
+}
+
+TEST(TrajectoryCompressionTest, FewerKnotsWithinTolerance)
+{
+  auto spline = GetSmoothSpline(0.02, 2.0);
+  double tolerance = 1e-3;
+  int n = 10;
+  auto compressed = CompressSpline(spline, tolerance, n);
+
+  EXPECT_LT(compressed.GetKnotCount(), spline.GetKnotCount()/3);
+  EXPECT_EQ(spline.GetKnotTimes().front(), compressed.GetKnotTimes().front());
+  EXPECT_EQ(spline.GetKnotTimes().back(), compressed.GetKnotTimes().back());
+  int last = compressed.GetKnotCount()-1;
+  EXPECT_EQ(spline.GetKnotPositions().col(0), compressed.GetKnotPositions().col(0));
+  EXPECT_EQ(spline.GetKnotVelocities().rightCols(1), compressed.GetKnotVelocities().col(last));
+
+  // at the sample times the tolerance is guaranteed
+  const auto& knots = spline.GetKnotTimes();
+  for (std::size_t k=0; k+1<knots.size(); ++k) {
+    for (int j=0; j<n; ++j) {
+      double t = knots.at(k) + j*(knots.at(k+1) - knots.at(k))/n;
+      double error = (spline.GetPoint(t).p() - compressed.GetPoint(t).p()).norm();
+      EXPECT_LE(error, tolerance) << "t=" << t;
+    }
+  }
+}
+
+TEST(TrajectoryCompressionTest, IndependentOfKnotSpacing)
+{
+  // the same motion optimized with a different node spacing
+  auto fine   = CompressSpline(GetSmoothSpline(0.01, 2.0), 1e-3);
+  auto coarse = CompressSpline(GetSmoothSpline(0.05, 2.0), 1e-3);
+  EXPECT_LE(std::abs(fine.GetKnotCount() - coarse.GetKnotCount()), 3);
+}
+
+TEST(TrajectoryCompressionTest, FileStoresCompressedKnots)
+{
+  Trajectory trajectory;
+  trajectory.base_linear_  = GetSmoothSpline(0.02, 2.0);
+  trajectory.base_angular_ = GetSmoothSpline(0.02, 2.0);
+
+  std::string path = "trajectory_compression_test.trj";
+  {
+    TrajectoryFileWriter file(path);
+    file.Append(trajectory);
+    file.SetCompression(CompressionTolerance());
+    file.Append(trajectory);
+  }
+
+  TrajectoryFileReader file(path);
+  ASSERT_EQ(2, file.GetRecordCount());
+  EXPECT_EQ(GetKnotCount(trajectory), GetKnotCount(file.GetTrajectory(0)));
+  EXPECT_EQ(GetKnotCount(CompressTrajectory(trajectory)), GetKnotCount(file.GetTrajectory(1)));
+  EXPECT_LT(GetKnotCount(file.GetTrajectory(1)), GetKnotCount(trajectory));
+  std::remove(path.c_str());
+}
+
+} /* namespace towr */
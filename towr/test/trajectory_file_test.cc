@@ -0,0 +1,186 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <towr/io/trajectory_file.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#include "test_problems.h"
+
+namespace towr {
+
+class TrajectoryFileTest : public ::testing::Test {
+protected:
+  void TearDown () override
+  {
+    std::remove(path_.c_str());
+  }
+
+  // the initial guess of the biped problem, optionally with a quintic base.
+  static Trajectory GetTrajectory (double goal_x, bool quintic_base = false)
+  {
+    NlpFormulation f = GetBipedFormulation(RobotModel(RobotModel::Biped),
+                                           std::make_shared<FlatGround>(), goal_x);
+    if (quintic_base)
+      f.params_.UseQuinticBase();
+
+    SplineHolder splines;
+    ifopt::Problem nlp;
+    BuildProblem(f, splines, nlp);
+    return Trajectory(splines);
+  }
+
+  static void ExpectEqual (const CubicHermiteSpline& a, const CubicHermiteSpline& b)
+  {
+    EXPECT_EQ(a.GetKnotTimes(), b.GetKnotTimes());
+    EXPECT_EQ(a.GetKnotPositions(), b.GetKnotPositions());
+    EXPECT_EQ(a.GetKnotVelocities(), b.GetKnotVelocities());
+    EXPECT_EQ(a.IsQuintic(), b.IsQuintic());
+    EXPECT_EQ(a.GetKnotAccelerations(), b.GetKnotAccelerations());
+  }
+
+  static void ExpectEqual (const Trajectory& a, const Trajectory& b)
+  {
+    ExpectEqual(a.base_linear_, b.base_linear_);
+    ExpectEqual(a.base_angular_, b.base_angular_);
+    ASSERT_EQ(a.GetEECount(), b.GetEECount());
+    for (int ee=0; ee<a.GetEECount(); ++ee) {
+      ExpectEqual(a.ee_motion_.at(ee), b.ee_motion_.at(ee));
+      ExpectEqual(a.ee_force_.at(ee), b.ee_force_.at(ee));
+      EXPECT_EQ(a.ee_phase_durations_.at(ee), b.ee_phase_durations_.at(ee));
+      EXPECT_EQ(a.ee_in_contact_at_start_.at(ee), b.ee_in_contact_at_start_.at(ee));
+    }
+  }
+
+  std::string path_ = "trajectory_file_test.trj";
+};
+
+TEST_F(TrajectoryFileTest, RoundTripOfSeveralRecords)
+{
+  std::vector<Trajectory> trajectories = {GetTrajectory(0.1),
+                                          GetTrajectory(0.3),
+                                          GetTrajectory(0.2, true)};
+  {
+    TrajectoryFileWriter writer(path_);
+    EXPECT_EQ(0, writer.Append(trajectories.at(0), 0.0, 1.5));
+    EXPECT_EQ(1, writer.Append(trajectories.at(1), 0.05, 2.5));
+    EXPECT_EQ(2, writer.Append(trajectories.at(2), 0.0, 3.5));
+  }
+
+  TrajectoryFileReader reader(path_);
+  ASSERT_EQ(3, reader.GetRecordCount());
+  for (int r=0; r<reader.GetRecordCount(); ++r) {
+    EXPECT_EQ(1.5+r, reader.GetStamp(r));
+    EXPECT_EQ(r==1, reader.HasSamples(r));
+    ExpectEqual(trajectories.at(r), reader.GetTrajectory(r));
+  }
+  EXPECT_TRUE(reader.GetTrajectory(2).base_linear_.IsQuintic());
+
+  // the samples are those of the trajectory
+  uint64_t n_samples, n_values;
+  const double* t = reader.GetColumn(1, "sample/t", n_samples);
+  const double* x = reader.GetColumn(1, "sample/base_lin/p0", n_values);
+  ASSERT_NE(nullptr, t);
+  ASSERT_NE(nullptr, x);
+  ASSERT_EQ(n_samples, n_values);
+  for (uint64_t i=0; i<n_samples; ++i)
+    EXPECT_EQ(trajectories.at(1).base_linear_.GetPoint(t[i]).p().x(), x[i]);
+}
+
+TEST_F(TrajectoryFileTest, TruncatedLastRecordIsIgnored)
+{
+  {
+    TrajectoryFileWriter writer(path_);
+    writer.Append(GetTrajectory(0.1));
+    writer.Append(GetTrajectory(0.2));
+  }
+
+  std::ifstream file(path_, std::ios::binary | std::ios::ate);
+  long size = file.tellg();
+  file.close();
+  ASSERT_EQ(0, truncate(path_.c_str(), size-100));
+
+  TrajectoryFileReader reader(path_);
+  ASSERT_EQ(1, reader.GetRecordCount());
+  ExpectEqual(GetTrajectory(0.1), reader.GetTrajectory(0));
+}
+
+TEST_F(TrajectoryFileTest, BadMagicIsRejected)
+{
+  {
+    TrajectoryFileWriter writer(path_);
+    writer.Append(GetTrajectory(0.1));
+  }
+
+  std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+  file.write("X", 1);
+  file.close();
+
+  EXPECT_THROW(TrajectoryFileReader reader(path_), std::runtime_error);
+}
+
+TEST_F(TrajectoryFileTest, ColumnOutsideOfRecordIsRejected)
+{
+  {
+    TrajectoryFileWriter writer(path_);
+    writer.Append(GetTrajectory(0.1));
+  }
+
+  // the count of the first column of the first record reaches past its end
+  using namespace trajectory_file;
+  uint64_t count = 1u<<20;
+  std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(sizeof(FileHeader) + sizeof(RecordHeader) + offsetof(ColumnInfo, count_));
+  file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+  file.close();
+
+  EXPECT_THROW(TrajectoryFileReader reader(path_), std::runtime_error);
+
+  // or the column table itself doesn't fit into the record
+  {
+    TrajectoryFileWriter writer(path_);
+    writer.Append(GetTrajectory(0.1));
+  }
+  uint32_t column_count = 1u<<30;
+  file.open(path_, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(sizeof(FileHeader) + offsetof(RecordHeader, column_count_));
+  file.write(reinterpret_cast<const char*>(&column_count), sizeof(column_count));
+  file.close();
+
+  EXPECT_THROW(TrajectoryFileReader reader(path_), std::runtime_error);
+}
+
+} /* namespace towr */
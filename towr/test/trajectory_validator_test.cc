@@ -0,0 +1,125 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <atomic>
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include <towr/planning/trajectory_validator.h>
+#include <towr/terrain/examples/height_map_examples.h>
+
+#ifdef __GLIBC__
+// counts the heap allocations of this process, including those of Eigen.
+extern "C" void* __libc_malloc (std::size_t size);
+static std::atomic<int> malloc_count(0);
+extern "C" void* malloc (std::size_t size)
+{
+  malloc_count++;
+  return __libc_malloc(size);
+}
+#endif
+
+namespace towr {
+
+// Anymal standing still for one second, all feet carrying the same load.
+static Trajectory
+GetStandingAnymal (double force_scale = 1.0)
+{
+  RobotModel model(RobotModel::Anymal);
+  auto stance_B = model.kinematic_model_->GetNominalStanceInBase();
+  int n_ee = stance_B.size();
+  double height = -stance_B.front().z();
+  double fz = model.dynamic_model_->m()*model.dynamic_model_->g()/n_ee;
+
+  std::vector<double> times = {0.0, 0.6, 1.0};
+  Eigen::MatrixXd zero = Eigen::MatrixXd::Zero(k3D, times.size());
+  auto constant = [&](const Eigen::Vector3d& v) {
+    return CubicHermiteSpline(times, v.replicate(1, times.size()), zero);
+  };
+
+  Trajectory motion;
+  motion.base_linear_  = constant(Eigen::Vector3d(0.0, 0.0, height));
+  motion.base_angular_ = constant(Eigen::Vector3d::Zero());
+  for (int ee=0; ee<n_ee; ++ee) {
+    Eigen::Vector3d p = stance_B.at(ee);
+    p.z() = 0.0;
+    motion.ee_motion_.push_back(constant(p));
+    motion.ee_force_.push_back(constant(Eigen::Vector3d(0.0, 0.0, force_scale*fz)));
+    motion.ee_phase_durations_.push_back({times.back()});
+    motion.ee_in_contact_at_start_.push_back(true);
+  }
+
+  return motion;
+}
+
+TEST(TrajectoryValidatorTest, FeasibleMotionWithoutAllocating)
+{
+  Trajectory motion = GetStandingAnymal();
+  TrajectoryValidator validator(RobotModel(RobotModel::Anymal), std::make_shared<FlatGround>());
+
+#ifdef __GLIBC__
+  int n_malloc = malloc_count;
+  TrajectoryValidator::Result r = validator.Validate(motion);
+  EXPECT_EQ(n_malloc, malloc_count);
+#else
+  TrajectoryValidator::Result r = validator.Validate(motion);
+#endif
+  EXPECT_TRUE(r.IsValid());
+}
+
+TEST(TrajectoryValidatorTest, FindsFirstViolation)
+{
+  TrajectoryValidator validator(RobotModel(RobotModel::Anymal), std::make_shared<FlatGround>());
+
+  // left front foot lifted by 5cm during the last 0.4s of its stance phase.
+  Trajectory lifted = GetStandingAnymal();
+  Eigen::MatrixXd pos = lifted.ee_motion_.at(0).GetNodes().front().p().replicate(1, 3);
+  pos(Z, 2) = 0.05;
+  lifted.ee_motion_.at(0) = CubicHermiteSpline({0.0, 0.6, 1.0}, pos, Eigen::MatrixXd::Zero(k3D, 3));
+
+  TrajectoryValidator::Result r = validator.Validate(lifted);
+  EXPECT_EQ(TrajectoryValidator::Terrain, r.check_);
+  EXPECT_EQ(0, r.ee_);
+  EXPECT_GT(r.time_, 0.6);
+  EXPECT_LT(r.time_, 1.0);
+  EXPECT_GT(r.magnitude_, 0.0);
+  EXPECT_LT(r.magnitude_, 0.005); // the first grid point above the tolerance
+
+  // 10% too much force, so the base would accelerate upwards.
+  Trajectory pushing = GetStandingAnymal(1.1);
+  RobotModel anymal(RobotModel::Anymal);
+  double m_g = anymal.dynamic_model_->m()*anymal.dynamic_model_->g();
+  r = validator.Validate(pushing, 0.3);
+  EXPECT_EQ(TrajectoryValidator::Dynamics, r.check_);
+  EXPECT_DOUBLE_EQ(0.3, r.time_);
+  EXPECT_NEAR(0.1*m_g - TrajectoryValidatorOptions().dynamic_tolerance_, r.magnitude_, 1e-9);
+}
+
+} /* namespace towr */
@@ -41,6 +41,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <towr_ros/TowrCommand.h>
 
 #include <towr/nlp_formulation.h>
+#include <towr/io/iteration_history.h>
 #include <ifopt/ipopt_solver.h>
 
 
@@ -87,6 +88,11 @@ protected:
   NlpFormulation formulation_;         ///< the default formulation, can be adapted
   ifopt::IpoptSolver::Ptr solver_; ///< NLP solver, could also use SNOPT.
 
+  /// which solver iterations are saved to the rosbag and history file.
+  IterationHistoryOptions iteration_history_;
+  /// if not empty, the solver iterations are streamed to this towr file.
+  std::string iteration_history_file_;
+
 private:
   SplineHolder solution; ///< the solution splines linked to the opt-variables.
   ifopt::Problem nlp_;   ///< the actual nonlinear program to be solved.
@@ -100,7 +106,6 @@ private:
   XppVec GetTrajectory() const;
   virtual BaseState GetGoalState(const TowrCommandMsg& msg) const;
   void PublishInitialState();
-  std::vector<XppVec>GetIntermediateSolutions();
   xpp_msgs::RobotParameters BuildRobotParametersMsg(const RobotModel& model) const;
   void SaveOptimizationAsRosbag(const std::string& bag_name,
                                 const xpp_msgs::RobotParameters& robot_params,
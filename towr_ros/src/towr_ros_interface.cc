@@ -110,6 +110,12 @@ TowrRosInterface::UserCommandCallback(const TowrCommandMsg& msg)
       nlp_.AddCostSet(c);
 
     solver_->Solve(nlp_);
+
+    if (!iteration_history_file_.empty()) {
+      TrajectoryFileWriter history(iteration_history_file_);
+      WriteIterationHistory(nlp_, solution, iteration_history_, history);
+    }
+
     SaveOptimizationAsRosbag(bag_file, robot_params_msg, msg, false);
   }
 
@@ -148,19 +154,6 @@ TowrRosInterface::PublishInitialState()
   initial_state_pub_.publish(xpp::Convert::ToRos(xpp));
 }
 
-std::vector<TowrRosInterface::XppVec>
-TowrRosInterface::GetIntermediateSolutions ()
-{
-  std::vector<XppVec> trajectories;
-
-  for (int iter=0; iter<nlp_.GetIterationCount(); ++iter) {
-    nlp_.SetOptVariables(iter);
-    trajectories.push_back(GetTrajectory());
-  }
-
-  return trajectories;
-}
-
 TowrRosInterface::XppVec
 TowrRosInterface::GetTrajectory () const
 {
@@ -230,12 +223,15 @@ TowrRosInterface::SaveOptimizationAsRosbag (const std::string& bag_name,
   bag.write(xpp_msgs::robot_parameters, t0, robot_params);
   bag.write(towr_msgs::user_command+"_saved", t0, user_command_msg);
 
-  // save the trajectory of each iteration
+  // save the trajectory of the kept iterations, one at a time
   if (include_iterations) {
-    auto trajectories = GetIntermediateSolutions();
-    int n_iterations = trajectories.size();
-    for (int i=0; i<n_iterations; ++i)
-      SaveTrajectoryInRosbag(bag, trajectories.at(i), towr_msgs::nlp_iterations_name + std::to_string(i));
+    auto iterations = GetKeptIterations(nlp_.GetIterationCount(), iteration_history_);
+    int n_iterations = iterations.size();
+    for (int i=0; i<n_iterations; ++i) {
+      nlp_.SetOptVariables(iterations.at(i));
+      SaveTrajectoryInRosbag(bag, GetTrajectory(), towr_msgs::nlp_iterations_name + std::to_string(i));
+    }
+    nlp_.SetOptVariablesFinal();
 
     // save number of iterations the optimizer took
     std_msgs::Int32 m;
@@ -0,0 +1,117 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <iostream>
+#include <string>
+
+#include <ros/init.h>
+#include <rosbag/bag.h>
+#include <std_msgs/Int32.h>
+
+#include <xpp_states/convert.h>
+#include <xpp_msgs/topic_names.h>
+
+#include <towr/io/trajectory_file.h>
+#include <towr/variables/euler_converter.h>
+#include <towr_ros/topic_names.h>
+#include <towr_ros/towr_xpp_ee_map.h>
+
+using namespace towr;
+
+static void
+WriteTrajectory (rosbag::Bag& bag, const Trajectory& traj,
+                 const std::string& topic, double dt)
+{
+  int n_ee = traj.GetEECount();
+
+  double t = 0.0;
+  while (t <= traj.GetTotalTime()+1e-5) {
+    xpp::RobotStateCartesian state(n_ee);
+    state.base_.lin = ToXpp(traj.base_linear_.GetPoint(t));
+
+    State euler = traj.base_angular_.GetPoint(t);
+    state.base_.ang.q  = EulerConverter::GetQuaternionBaseToWorld(euler.p());
+    state.base_.ang.w  = EulerConverter::GetAngularVelocityInWorld(euler.p(), euler.v());
+    state.base_.ang.wd = EulerConverter::GetAngularAccelerationInWorld(euler);
+
+    for (int ee_towr=0; ee_towr<n_ee; ++ee_towr) {
+      int ee_xpp = ToXppEndeffector(n_ee, ee_towr).first;
+      state.ee_contact_.at(ee_xpp) = traj.IsContactPhase(ee_towr, t);
+      state.ee_motion_.at(ee_xpp)  = ToXpp(traj.ee_motion_.at(ee_towr).GetPoint(t));
+      state.ee_forces_.at(ee_xpp)  = traj.ee_force_.at(ee_towr).GetPoint(t).p();
+    }
+    state.t_global_ = t;
+
+    auto timestamp = ::ros::Time(t + 1e-6); // t=0.0 throws ROS exception
+    bag.write(topic, timestamp, xpp::Convert::ToRos(state));
+    t += dt;
+  }
+}
+
+/**
+ * Converts a towr trajectory file into a ROS bag for visualization in rviz:
+ *
+ *   trajectory_file_to_rosbag <file> <bag> [record|all, default last] [dt, default 0.01]
+ *
+ * A single record is written to the desired robot state topic. With "all",
+ * each record is written as one optimization iteration, the layout also
+ * produced by TowrRosInterface and read by rosbag_traj_combiner.
+ */
+int main(int argc, char *argv[])
+{
+  ros::init(argc, argv, "trajectory_file_to_rosbag");
+
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <file> <bag> [record|all] [dt]" << std::endl;
+    return 1;
+  }
+
+  TrajectoryFileReader reader(argv[1]);
+  int n_records = reader.GetRecordCount();
+  std::string which = argc > 3? argv[3] : std::to_string(n_records-1);
+  double dt = argc > 4? std::stod(argv[4]) : 0.01;
+
+  rosbag::Bag bag;
+  bag.open(argv[2], rosbag::bagmode::Write);
+
+  if (which == "all") {
+    for (int i=0; i<n_records; ++i)
+      WriteTrajectory(bag, reader.GetTrajectory(i), towr_msgs::nlp_iterations_name + std::to_string(i), dt);
+
+    std_msgs::Int32 m;
+    m.data = n_records;
+    bag.write(towr_msgs::nlp_iterations_count, ::ros::Time(1e-6), m);
+  } else {
+    WriteTrajectory(bag, reader.GetTrajectory(std::stoi(which)), xpp_msgs::robot_state_desired, dt);
+  }
+
+  bag.close();
+  ROS_INFO_STREAM("Successfully created bag " + bag.getFileName());
+  return 0;
+}